@@ -114,6 +114,18 @@ static int bpf_load(char *errbuf);
 #else /* _AIX */
 
 #include <net/bpf.h>
+#ifdef __rtems__
+
+/*
+ * If both BIOCROTZBUF and BPF_BUFMODE_ZBUF are defined, we have
+ * zero-copy BPF.
+ */
+#if defined(BIOCROTZBUF) && defined(BPF_BUFMODE_ZBUF)
+  #define HAVE_ZEROCOPY_BPF
+  #include <sys/mman.h>
+  #include <machine/atomic.h>
+#endif
+#endif /* __rtems__ */
 
 #endif /* _AIX */
 
@@ -1496,6 +1508,17 @@ pcap_cleanup_bpf(pcap_t *p)
 		 * null it out so that pcap_cleanup_live_common()
 		 * doesn't try to free it.
 		 */
+#ifdef __rtems__
+		/*
+		 * The kernel stores packets directly into the buffers
+		 * until the descriptor is closed, and munmap() frees
+		 * them.  Close it first.
+		 */
+		if (p->fd >= 0) {
+			close(p->fd);
+			p->fd = -1;
+		}
+#endif /* __rtems__ */
 		if (pb->zbuf1 != MAP_FAILED && pb->zbuf1 != NULL)
 			(void) munmap(pb->zbuf1, pb->zbufsize);
 		if (pb->zbuf2 != MAP_FAILED && pb->zbuf2 != NULL)
@@ -1965,10 +1988,17 @@ pcap_activate_bpf(pcap_t *p)
 		pb->zbufsize = roundup(v, getpagesize());
 		if (pb->zbufsize > zbufmax)
 			pb->zbufsize = zbufmax;
+#ifndef __rtems__
 		pb->zbuf1 = mmap(NULL, pb->zbufsize, PROT_READ | PROT_WRITE,
 		    MAP_ANON, -1, 0);
 		pb->zbuf2 = mmap(NULL, pb->zbufsize, PROT_READ | PROT_WRITE,
 		    MAP_ANON, -1, 0);
+#else /* __rtems__ */
+		pb->zbuf1 = mmap(NULL, pb->zbufsize, PROT_READ | PROT_WRITE,
+		    MAP_ANON | MAP_PRIVATE, -1, 0);
+		pb->zbuf2 = mmap(NULL, pb->zbufsize, PROT_READ | PROT_WRITE,
+		    MAP_ANON | MAP_PRIVATE, -1, 0);
+#endif /* __rtems__ */
 		if (pb->zbuf1 == MAP_FAILED || pb->zbuf2 == MAP_FAILED) {
 			pcap_fmt_errmsg_for_errno(p->errbuf, PCAP_ERRBUF_SIZE,
 			    errno, "mmap");
@@ -127,6 +127,11 @@ __FBSDID("$FreeBSD$");
 #endif
 #include "res_debug.h"
 #include "res_private.h"
+#ifdef __rtems__
+#include <stdint.h>
+
+#include <machine/rtems-bsd-dns-cache.h>
+#endif /* __rtems__ */
 
 #define EXT(res) ((res)->_u._ext)
 
@@ -157,6 +162,10 @@ static int		pselect(int, void *, void *, void *,
 				const sigset_t *);
 #endif
 void res_pquery(const res_state, const u_char *, int, FILE *);
+#ifdef __rtems__
+static int		res_nsend_uncached(res_state, const u_char *, int,
+				u_char *, int);
+#endif /* __rtems__ */
 
 static const int niflags = NI_NUMERICHOST | NI_NUMERICSERV;
 
@@ -303,9 +312,15 @@ res_queriesmatch(const u_char *buf1, const u_char *eom1,
 	return (1);
 }
 
+#ifndef __rtems__
 int
 res_nsend(res_state statp,
 	  const u_char *buf, int buflen, u_char *ans, int anssiz)
+#else /* __rtems__ */
+static int
+res_nsend_uncached(res_state statp,
+	  const u_char *buf, int buflen, u_char *ans, int anssiz)
+#endif /* __rtems__ */
 {
 	int gotsomewhere, terrno, tries, v_circuit, resplen, ns, n;
 #ifdef USE_KQUEUE
@@ -575,6 +590,111 @@ res_nsend(res_state statp,
 #endif
 	return (-1);
 }
+#ifdef __rtems__
+
+/*
+ * Returns the time to live of an answer for the answer cache.  This is the
+ * minimum time to live of the answer records.  Negative answers are cached
+ * for the time to live of the SOA record in the authority section, limited
+ * by the SOA minimum field (RFC 2308).  Other answers are not cached.
+ */
+static uint32_t
+res_cache_ttl(const u_char *ans, int anslen)
+{
+	ns_msg handle;
+	ns_rr rr;
+	ns_sect sect;
+	uint32_t ttl;
+	int count, i, rcode;
+
+	if (ns_initparse(ans, anslen, &handle) < 0)
+		return (0);
+	if (ns_msg_getflag(handle, ns_f_tc))
+		return (0);
+	rcode = ns_msg_getflag(handle, ns_f_rcode);
+	if (rcode != ns_r_noerror && rcode != ns_r_nxdomain)
+		return (0);
+
+	if (rcode == ns_r_noerror && ns_msg_count(handle, ns_s_an) > 0)
+		sect = ns_s_an;
+	else
+		sect = ns_s_ns;
+
+	ttl = UINT32_MAX;
+	count = ns_msg_count(handle, sect);
+	for (i = 0; i < count; i++) {
+		if (ns_parserr(&handle, sect, i, &rr) < 0)
+			return (0);
+		if (sect == ns_s_an) {
+			ttl = MIN(ttl, ns_rr_ttl(rr));
+		} else if (ns_rr_type(rr) == ns_t_soa &&
+		    ns_rr_rdlen(rr) >= 5 * NS_INT32SZ) {
+			ttl = MIN(ttl, ns_rr_ttl(rr));
+			ttl = MIN(ttl, ns_get32(ns_rr_rdata(rr) +
+			    ns_rr_rdlen(rr) - NS_INT32SZ));
+		}
+	}
+	if (ttl == UINT32_MAX)
+		return (0);
+	return (ttl);
+}
+
+/*
+ * Standard queries for one question go through the answer cache.  Answers
+ * and timeouts are shared with concurrent queries for the same question.
+ */
+int
+res_nsend(res_state statp,
+	  const u_char *buf, int buflen, u_char *ans, int anssiz)
+{
+	struct rtems_bsd_dns_cache_entry *entry;
+	ns_msg handle;
+	ns_rr rr;
+	size_t len;
+	int error, n, serrno;
+
+	if (anssiz < HFIXEDSZ ||
+	    ns_initparse(buf, buflen, &handle) < 0 ||
+	    ns_msg_getflag(handle, ns_f_opcode) != ns_o_query ||
+	    ns_msg_count(handle, ns_s_qd) != 1 ||
+	    ns_msg_count(handle, ns_s_an) != 0 ||
+	    ns_msg_count(handle, ns_s_ar) != 0 ||
+	    ns_parserr(&handle, ns_s_qd, 0, &rr) < 0)
+		return (res_nsend_uncached(statp, buf, buflen, ans, anssiz));
+
+	len = (size_t)anssiz;
+	switch (rtems_bsd_dns_cache_lookup(RTEMS_BSD_DNS_CACHE_DNS,
+	    ns_rr_name(rr), ns_rr_class(rr), ns_rr_type(rr), ans, &len,
+	    &error, &entry)) {
+	case RTEMS_BSD_DNS_CACHE_HIT:
+		if (error != 0) {
+			errno = error;
+			return (-1);
+		}
+		/* The answer carries the ID of this query */
+		memcpy(ans, buf, INT16SZ);
+		return ((int)len);
+	case RTEMS_BSD_DNS_CACHE_MISS:
+		n = res_nsend_uncached(statp, buf, buflen, ans, anssiz);
+		serrno = errno;
+		if (n < 0) {
+			/* Cache only the failures to reach a name server */
+			rtems_bsd_dns_cache_enter(entry, NULL, 0,
+			    serrno == ETIMEDOUT || serrno == ECONNREFUSED ?
+			    UINT32_MAX : 0, serrno);
+		} else if (n > anssiz) {
+			rtems_bsd_dns_cache_enter(entry, NULL, 0, 0, EMSGSIZE);
+		} else {
+			rtems_bsd_dns_cache_enter(entry, ans, (size_t)n,
+			    res_cache_ttl(ans, n), 0);
+		}
+		errno = serrno;
+		return (n);
+	default:
+		return (res_nsend_uncached(statp, buf, buflen, ans, anssiz));
+	}
+}
+#endif /* __rtems__ */
 
 /* Private */
 
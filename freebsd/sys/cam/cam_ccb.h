@@ -46,7 +46,11 @@
 #include <cam/nvme/nvme_all.h>
 #include <cam/mmc/mmc_all.h>
 #ifdef __rtems__
+#include <sys/uio.h>
 #include <rtems/blkdev.h>
+
+/* Maximum count of scatter/gather entries of a block device CCB */
+#define	CAM_RTEMS_IOV_MAX	16
 #endif /* __rtems__ */
 
 /* General allocation length definitions for CCB structures */
@@ -347,6 +351,7 @@ struct ccb_hdr {
 	camq_entry	periph_links;	/* For chaining in the type driver */
 #else /* __rtems__ */
 	struct cam_sim	*sim;
+	TAILQ_ENTRY(ccb_hdr) sim_links;
 #endif /* __rtems__ */
 	u_int32_t	retry_count;
 	void		(*cbfcnp)(struct cam_periph *, union ccb *);
@@ -615,6 +620,9 @@ typedef enum {
 } pi_tmflag;
 
 typedef enum {
+#ifdef __rtems__
+	PIM_IOVEC_SG	= 0x40000000,/* CAM_DATA_SG with iovec lists supported */
+#endif /* __rtems__ */
 	PIM_ATA_EXT	= 0x200,/* ATA requests can understand ata_ext requests */
 	PIM_EXTLUNS	= 0x100,/* 64bit extended LUNs supported */
 	PIM_SCANHILO	= 0x80,	/* Bus scans from high ID to low ID */
@@ -777,6 +785,7 @@ struct ccb_scsiio {
 	rtems_blkdev_sg_buffer *sg_current;
 	rtems_blkdev_sg_buffer *sg_end;
 	rtems_blkdev_request *req;
+	struct iovec sg_iov[CAM_RTEMS_IOV_MAX];
 #endif /* __rtems__ */
 };
 
@@ -103,6 +103,7 @@ static __inline u_int32_t    cam_sim_bus(struct cam_sim *sim);
  *     BSD_SIM_INIT -> BSD_SIM_IDLE;
  *     BSD_SIM_INIT_BUSY -> BSD_SIM_INIT_READY;
  *     BSD_SIM_BUSY -> BSD_SIM_IDLE;
+ *     BSD_SIM_BUSY -> BSD_SIM_BUSY;
  *     BSD_SIM_INIT_READY -> BSD_SIM_INIT;
  *     BSD_SIM_IDLE -> BSD_SIM_BUSY;
  *     BSD_SIM_IDLE -> BSD_SIM_DELETED;
@@ -138,6 +139,15 @@ struct cam_sim {
 	enum bsd_sim_state	state;
 	struct cv		state_changed;
 	union ccb		ccb;
+	union ccb		*ccb_pool;
+	TAILQ_HEAD(, ccb_hdr)	free_ccbs;
+	TAILQ_HEAD(, ccb_hdr)	pending_ccbs;
+	TAILQ_HEAD(, ccb_hdr)	active_ccbs;
+	int			max_openings;
+	int			openings;
+	u_int32_t		block_size;
+	u_int32_t		maxio;
+	int			iov_max;
 #endif /* __rtems__ */
 	u_int32_t		unit_number;
 #ifndef __rtems__
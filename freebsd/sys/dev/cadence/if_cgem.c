@@ -40,6 +40,11 @@
 #include <sys/cdefs.h>
 __FBSDID("$FreeBSD$");
 
+#ifdef __rtems__
+#include <rtems/bsd/local/opt_inet.h>
+#include <rtems/bsd/local/opt_inet6.h>
+
+#endif /* __rtems__ */
 #include <sys/param.h>
 #include <sys/systm.h>
 #include <sys/bus.h>
@@ -68,6 +73,12 @@ __FBSDID("$FreeBSD$");
 #include <netinet/in_var.h>
 #include <netinet/ip.h>
 #endif
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+#include <netinet/tcp_lro.h>
+#endif
+#include <net/if_poll.h>
+#endif /* __rtems__ */
 
 #include <net/bpf.h>
 #include <net/bpfdesc.h>
@@ -142,6 +153,12 @@ struct cgem_softc {
 	u_int			rxnobufs;	/* rx buf ring empty events */
 	u_int			rxdmamapfails;	/* rx dmamap failures */
 	uint32_t		rx_frames_prev;
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+	struct lro_ctrl		lro;		/* large receive offload */
+#endif
+	struct if_poll		poll;		/* adaptive polling */
+#endif /* __rtems__ */
 
 	/* transmit descriptor ring */
 	struct cgem_tx_desc	*txring;
@@ -560,11 +577,20 @@ cgem_fill_rqueue(struct cgem_softc *sc)
 }
 
 /* Pull received packets off of receive descriptor ring. */
+#ifndef __rtems__
 static void
 cgem_recv(struct cgem_softc *sc)
+#else /* __rtems__ */
+static int
+cgem_recv(struct cgem_softc *sc, int budget)
+#endif /* __rtems__ */
 {
 	if_t ifp = sc->ifp;
 	struct mbuf *m, *m_hd, **m_tl;
+#ifdef __rtems__
+	struct mbuf *m_batch;
+	int n = 0;
+#endif /* __rtems__ */
 	uint32_t ctl;
 
 	CGEM_ASSERT_LOCKED(sc);
@@ -573,7 +599,13 @@ cgem_recv(struct cgem_softc *sc)
 	m_hd = NULL;
 	m_tl = &m_hd;
 	while (sc->rxring_queued > 0 &&
+#ifdef __rtems__
+	       n < budget &&
+#endif /* __rtems__ */
 	       (sc->rxring[sc->rxring_tl_ptr].addr & CGEM_RXDESC_OWN) != 0) {
+#ifdef __rtems__
+		++n;
+#endif /* __rtems__ */
 
 		ctl = sc->rxring[sc->rxring_tl_ptr].ctl;
 
@@ -655,14 +687,39 @@ cgem_recv(struct cgem_softc *sc)
 
 	/* Unlock and send up packets. */
 	CGEM_UNLOCK(sc);
+#ifdef __rtems__
+	m_tl = &m_batch;
+#endif /* __rtems__ */
 	while (m_hd != NULL) {
 		m = m_hd;
 		m_hd = m_hd->m_next;
 		m->m_next = NULL;
 		if_inc_counter(ifp, IFCOUNTER_IPACKETS, 1);
+#ifndef __rtems__
 		if_input(ifp, m);
+#else /* __rtems__ */
+#if defined(INET) || defined(INET6)
+		if ((if_getcapenable(ifp) & IFCAP_LRO) != 0 &&
+		    tcp_lro_rx_csum(&sc->lro, m) == 0)
+			continue;
+#endif
+		*m_tl = m;
+		m_tl = &m->m_nextpkt;
+#endif /* __rtems__ */
 	}
+#ifdef __rtems__
+	*m_tl = NULL;
+	if (m_batch != NULL)
+		if_input_batch(ifp, m_batch);
+#if defined(INET) || defined(INET6)
+	tcp_lro_flush_all(&sc->lro);
+#endif
+#endif /* __rtems__ */
 	CGEM_LOCK(sc);
+#ifdef __rtems__
+
+	return (n);
+#endif /* __rtems__ */
 }
 
 /* Find completed transmits and free their mbufs. */
@@ -1029,12 +1086,18 @@ cgem_intr(void *arg)
 	istatus = RD4(sc, CGEM_INTR_STAT);
 	WR4(sc, CGEM_INTR_STAT, istatus);
 
+#ifndef __rtems__
 	/* Packets received. */
 	if ((istatus & CGEM_INTR_RX_COMPLETE) != 0)
 		cgem_recv(sc);
 
 	/* Free up any completed transmit buffers. */
 	cgem_clean_tx(sc);
+#else /* __rtems__ */
+	/* Received packets are picked up by cgem_poll() */
+	if ((istatus & CGEM_INTR_RX_COMPLETE) == 0)
+		cgem_clean_tx(sc);
+#endif /* __rtems__ */
 
 	/* Hresp not ok.  Something is very bad with DMA.  Try to clear. */
 	if ((istatus & CGEM_INTR_HRESP_NOT_OK) != 0) {
@@ -1063,7 +1126,53 @@ cgem_intr(void *arg)
 		cgem_start_locked(ifp);
 
 	CGEM_UNLOCK(sc);
+#ifdef __rtems__
+
+	if ((istatus & CGEM_INTR_RX_COMPLETE) != 0)
+		if_poll_intr(&sc->poll);
+#endif /* __rtems__ */
 }
+#ifdef __rtems__
+
+static int
+cgem_poll(struct if_poll *ip, int budget)
+{
+	struct cgem_softc *sc = ip->ip_softc;
+	if_t ifp = sc->ifp;
+	int n;
+
+	CGEM_LOCK(sc);
+
+	if ((if_getdrvflags(ifp) & IFF_DRV_RUNNING) == 0) {
+		CGEM_UNLOCK(sc);
+		return (0);
+	}
+
+	n = cgem_recv(sc, budget);
+	cgem_clean_tx(sc);
+
+	if (!if_sendq_empty(ifp))
+		cgem_start_locked(ifp);
+
+	CGEM_UNLOCK(sc);
+	return (n);
+}
+
+static void
+cgem_poll_intr(struct if_poll *ip, bool enable)
+{
+	struct cgem_softc *sc = ip->ip_softc;
+
+	CGEM_LOCK(sc);
+
+	/* The receive complete status stays set while masked */
+	if ((if_getdrvflags(sc->ifp) & IFF_DRV_RUNNING) != 0)
+		WR4(sc, enable ? CGEM_INTR_EN : CGEM_INTR_DIS,
+		    CGEM_INTR_RX_COMPLETE);
+
+	CGEM_UNLOCK(sc);
+}
+#endif /* __rtems__ */
 
 /* Reset hardware. */
 static void
@@ -1340,6 +1449,13 @@ cgem_ioctl(if_t ifp, u_long cmd, caddr_t data)
 			if_setcapenablebit(ifp, IFCAP_VLAN_HWCSUM, 0);
 		else
 			if_setcapenablebit(ifp, 0, IFCAP_VLAN_HWCSUM);
+#ifdef __rtems__
+
+		/* LRO is flushed at the end of each receive batch. */
+		if ((mask & IFCAP_LRO) != 0 &&
+		    (if_getcapabilities(ifp) & IFCAP_LRO) != 0)
+			if_togglecapenable(ifp, IFCAP_LRO);
+#endif /* __rtems__ */
 
 		CGEM_UNLOCK(sc);
 		break;
@@ -1585,6 +1701,20 @@ cgem_add_sysctls(device_t dev)
 			&sc->txdefragfails, 0,
 			"Transmit m_defrag() failures");
 
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+	SYSCTL_ADD_U64(ctx, child, OID_AUTO, "lro_queued", CTLFLAG_RD,
+			 &sc->lro.lro_queued, 0, "LRO segments queued");
+
+	SYSCTL_ADD_U64(ctx, child, OID_AUTO, "lro_flushed", CTLFLAG_RD,
+			 &sc->lro.lro_flushed, 0, "LRO packets flushed");
+
+	SYSCTL_ADD_U64(ctx, child, OID_AUTO, "lro_bad_csum", CTLFLAG_RD,
+			 &sc->lro.lro_bad_csum, 0,
+			 "LRO frames with bad checksum");
+
+#endif
+#endif /* __rtems__ */
 	tree = SYSCTL_ADD_NODE(ctx, child, OID_AUTO, "stats", CTLFLAG_RD,
 			       NULL, "GEM statistics");
 	child = SYSCTL_CHILDREN(tree);
@@ -1791,6 +1921,14 @@ cgem_attach(device_t dev)
 	if_setstartfn(ifp, cgem_start);
 	if_setcapabilitiesbit(ifp, IFCAP_HWCSUM | IFCAP_HWCSUM_IPV6 |
 			      IFCAP_VLAN_MTU | IFCAP_VLAN_HWCSUM, 0);
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+	if (tcp_lro_init(&sc->lro) == 0) {
+		sc->lro.ifp = ifp;
+		if_setcapabilitiesbit(ifp, IFCAP_LRO, 0);
+	}
+#endif
+#endif /* __rtems__ */
 	if_setsendqlen(ifp, CGEM_NUM_TX_DESCS);
 	if_setsendqready(ifp);
 
@@ -1834,6 +1972,14 @@ cgem_attach(device_t dev)
 
 	ether_ifattach(ifp, eaddr);
 
+#ifdef __rtems__
+	/* No interrupt moderation on this controller */
+	sc->poll.ip_softc = sc;
+	sc->poll.ip_poll = cgem_poll;
+	sc->poll.ip_intr = cgem_poll_intr;
+	if_poll_attach(&sc->poll, dev);
+
+#endif /* __rtems__ */
 	err = bus_setup_intr(dev, sc->irq_res, INTR_TYPE_NET | INTR_MPSAFE |
 			     INTR_EXCL, NULL, cgem_intr, sc, &sc->intrhand);
 	if (err) {
@@ -1866,6 +2012,12 @@ cgem_detach(device_t dev)
 		callout_drain(&sc->tick_ch);
 		if_setflagbits(sc->ifp, 0, IFF_UP);
 		ether_ifdetach(sc->ifp);
+#ifdef __rtems__
+		if_poll_detach(&sc->poll);
+#if defined(INET) || defined(INET6)
+		tcp_lro_free(&sc->lro);
+#endif
+#endif /* __rtems__ */
 	}
 
 	if (sc->miibus != NULL) {
@@ -41,6 +41,11 @@
 #include <sys/cdefs.h>
 __FBSDID("$FreeBSD$");
 
+#ifdef __rtems__
+#include <rtems/bsd/local/opt_inet.h>
+#include <rtems/bsd/local/opt_inet6.h>
+
+#endif /* __rtems__ */
 #include <sys/param.h>
 #include <sys/systm.h>
 #include <sys/bus.h>
@@ -54,6 +59,9 @@ __FBSDID("$FreeBSD$");
 #include <sys/rman.h>
 #include <sys/socket.h>
 #include <sys/sockio.h>
+#ifdef __rtems__
+#include <sys/sysctl.h>
+#endif /* __rtems__ */
 
 #include <net/bpf.h>
 #include <net/if.h>
@@ -62,6 +70,12 @@ __FBSDID("$FreeBSD$");
 #include <net/if_media.h>
 #include <net/if_types.h>
 #include <net/if_var.h>
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+#include <netinet/tcp_lro.h>
+#endif
+#include <net/if_poll.h>
+#endif /* __rtems__ */
 
 #include <machine/bus.h>
 
@@ -159,7 +173,11 @@ static struct resource_spec dwc_spec[] = {
 };
 
 static void dwc_txfinish_locked(struct dwc_softc *sc);
+#ifndef __rtems__
 static void dwc_rxfinish_locked(struct dwc_softc *sc);
+#else /* __rtems__ */
+static int dwc_rxfinish_locked(struct dwc_softc *sc, int budget);
+#endif /* __rtems__ */
 static void dwc_stop_locked(struct dwc_softc *sc);
 static void dwc_setup_rxfilter(struct dwc_softc *sc);
 
@@ -794,6 +812,13 @@ dwc_ioctl(struct ifnet *ifp, u_long cmd, caddr_t data)
 			/* No work to do except acknowledge the change took */
 			ifp->if_capenable ^= IFCAP_VLAN_MTU;
 		}
+#ifdef __rtems__
+		if ((mask & IFCAP_LRO) != 0 &&
+		    (ifp->if_capabilities & IFCAP_LRO) != 0) {
+			/* Queued segments are flushed after each receive. */
+			ifp->if_capenable ^= IFCAP_LRO;
+		}
+#endif /* __rtems__ */
 		break;
 
 	default:
@@ -837,8 +862,13 @@ dwc_txfinish_locked(struct dwc_softc *sc)
 	}
 }
 
+#ifndef __rtems__
 static void
 dwc_rxfinish_locked(struct dwc_softc *sc)
+#else /* __rtems__ */
+static int
+dwc_rxfinish_locked(struct dwc_softc *sc, int budget)
+#endif /* __rtems__ */
 {
 	struct ifnet *ifp;
 	struct mbuf *m0;
@@ -846,15 +876,25 @@ dwc_rxfinish_locked(struct dwc_softc *sc)
 	int error, idx, len;
 	uint32_t rdes0;
 	uint32_t rdes4;
+#ifdef __rtems__
+	int n = 0;
+#endif /* __rtems__ */
 
 	ifp = sc->ifp;
 
 	for (;;) {
+#ifdef __rtems__
+		if (n >= budget)
+			break;
+#endif /* __rtems__ */
 		idx = sc->rx_idx;
 
 		rdes0 = sc->rxdesc_ring[idx].tdes0;
 		if ((rdes0 & DDESC_RDES0_OWN) != 0)
 			break;
+#ifdef __rtems__
+		++n;
+#endif /* __rtems__ */
 
 		sc->rx_idx = next_rxidx(sc, idx);
 
@@ -925,12 +965,30 @@ dwc_rxfinish_locked(struct dwc_softc *sc)
 			rtems_cache_invalidate_multiple_data_lines(m->m_data, m->m_len);
 #endif /* __rtems__ */
 			DWC_UNLOCK(sc);
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+			if ((ifp->if_capenable & IFCAP_LRO) == 0 ||
+			    tcp_lro_rx_csum(&sc->lro, m) != 0)
+#endif
+#endif /* __rtems__ */
 			(*ifp->if_input)(ifp, m);
 			DWC_LOCK(sc);
 		} else {
 			/* XXX Zero-length packet ? */
 		}
 	}
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+
+	if (!LIST_EMPTY(&sc->lro.lro_active)) {
+		DWC_UNLOCK(sc);
+		tcp_lro_flush_all(&sc->lro);
+		DWC_LOCK(sc);
+	}
+#endif
+
+	return (n);
+#endif /* __rtems__ */
 }
 
 static void
@@ -950,8 +1008,10 @@ dwc_intr(void *arg)
 	reg = READ4(sc, DMA_STATUS);
 	WRITE4(sc, DMA_STATUS, reg & DMA_STATUS_INTR_MASK);
 
+#ifndef __rtems__
 	if (reg & (DMA_STATUS_RI | DMA_STATUS_RU))
 		dwc_rxfinish_locked(sc);
+#endif /* __rtems__ */
 
 	if (reg & DMA_STATUS_TI)
 		dwc_txfinish_locked(sc);
@@ -965,7 +1025,58 @@ dwc_intr(void *arg)
 	}
 
 	DWC_UNLOCK(sc);
+#ifdef __rtems__
+
+	/* Received frames are picked up by dwc_poll() */
+	if (reg & (DMA_STATUS_RI | DMA_STATUS_RU))
+		if_poll_intr(&sc->poll);
+#endif /* __rtems__ */
 }
+#ifdef __rtems__
+
+static int
+dwc_poll(struct if_poll *ip, int budget)
+{
+	struct dwc_softc *sc;
+	int n;
+
+	sc = ip->ip_softc;
+
+	DWC_LOCK(sc);
+
+	if ((sc->ifp->if_drv_flags & IFF_DRV_RUNNING) == 0) {
+		DWC_UNLOCK(sc);
+		return (0);
+	}
+
+	dwc_txfinish_locked(sc);
+	n = dwc_rxfinish_locked(sc, budget);
+
+	DWC_UNLOCK(sc);
+	return (n);
+}
+
+static void
+dwc_poll_intr(struct if_poll *ip, bool enable)
+{
+	struct dwc_softc *sc;
+	uint32_t reg;
+
+	sc = ip->ip_softc;
+
+	DWC_LOCK(sc);
+
+	/* The DMA status bits are set regardless of the enable register */
+	if ((sc->ifp->if_drv_flags & IFF_DRV_RUNNING) != 0) {
+		reg = INT_EN_DEFAULT;
+		if (!enable)
+			reg &= ~(INT_EN_RIE | INT_EN_TIE);
+		WRITE4(sc, INTERRUPT_ENABLE, reg);
+	}
+
+	DWC_UNLOCK(sc);
+}
+#endif /* __rtems__ */
 
 static int
 setup_dma(struct dwc_softc *sc)
@@ -1399,6 +1510,27 @@ dwc_attach(device_t dev)
 	ifp->if_flags = IFF_BROADCAST | IFF_SIMPLEX | IFF_MULTICAST;
 	ifp->if_capabilities |= IFCAP_HWCSUM | IFCAP_HWCSUM_IPV6 |
 	    IFCAP_VLAN_MTU | IFCAP_VLAN_HWCSUM;
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+	if (tcp_lro_init(&sc->lro) == 0) {
+		struct sysctl_ctx_list *ctx;
+		struct sysctl_oid_list *child;
+
+		sc->lro.ifp = ifp;
+		ifp->if_capabilities |= IFCAP_LRO;
+
+		ctx = device_get_sysctl_ctx(dev);
+		child = SYSCTL_CHILDREN(device_get_sysctl_tree(dev));
+		SYSCTL_ADD_U64(ctx, child, OID_AUTO, "lro_queued", CTLFLAG_RD,
+		    &sc->lro.lro_queued, 0, "LRO segments queued");
+		SYSCTL_ADD_U64(ctx, child, OID_AUTO, "lro_flushed", CTLFLAG_RD,
+		    &sc->lro.lro_flushed, 0, "LRO packets flushed");
+		SYSCTL_ADD_U64(ctx, child, OID_AUTO, "lro_bad_csum",
+		    CTLFLAG_RD, &sc->lro.lro_bad_csum, 0,
+		    "LRO frames with bad checksum");
+	}
+#endif
+#endif /* __rtems__ */
 	ifp->if_capenable = ifp->if_capabilities;
 	ifp->if_hwassist = DWC_CKSUM_ASSIST;
 	ifp->if_start = dwc_txstart;
@@ -1419,6 +1551,14 @@ dwc_attach(device_t dev)
 	}
 	sc->mii_softc = device_get_softc(sc->miibus);
 
+#ifdef __rtems__
+	/* The receive watchdog timer needs the CSR clock, no coalescing */
+	sc->poll.ip_softc = sc;
+	sc->poll.ip_poll = dwc_poll;
+	sc->poll.ip_intr = dwc_poll_intr;
+	if_poll_attach(&sc->poll, dev);
+
+#endif /* __rtems__ */
 	/* Setup interrupt handler. */
 	error = bus_setup_intr(dev, sc->res[1], INTR_TYPE_NET | INTR_MPSAFE,
 	    NULL, dwc_intr, sc, &sc->intr_cookie);
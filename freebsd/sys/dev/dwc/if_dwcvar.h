@@ -109,6 +109,16 @@ struct dwc_softc {
 	uint32_t		tx_idx_head;
 	uint32_t		tx_idx_tail;
 	int			txcount;
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+
+	/* Large receive offload */
+	struct lro_ctrl		lro;
+#endif
+
+	/* Adaptive polling */
+	struct if_poll		poll;
+#endif /* __rtems__ */
 };
 
 #endif	/* __IF_DWCVAR_H__ */
@@ -58,6 +58,11 @@ __FBSDID("$FreeBSD$");
  * (and thus the busy-wait time) in half.
  */
 
+#ifdef __rtems__
+#include <rtems/bsd/local/opt_inet.h>
+#include <rtems/bsd/local/opt_inet6.h>
+
+#endif /* __rtems__ */
 #include <sys/param.h>
 #include <sys/systm.h>
 #include <sys/bus.h>
@@ -85,6 +90,12 @@ __FBSDID("$FreeBSD$");
 #include <net/if_vlan_var.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+#include <netinet/tcp_lro.h>
+#endif
+#include <net/if_poll.h>
+#endif /* __rtems__ */
 
 #include <dev/fdt/fdt_common.h>
 #include <dev/ffec/if_ffecreg.h>
@@ -201,6 +212,20 @@ struct ffec_softc {
 	int		rx_ic_count;	/* RW, valid values 0..255 */
 	int		tx_ic_time;
 	int		tx_ic_count;
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+
+	/* large receive offload */
+	struct lro_ctrl	lro;
+#endif
+
+	/* frames of one receive run, passed up as a batch */
+	struct mbuf	*rx_batch;
+	struct mbuf	**rx_batch_tail;
+
+	/* adaptive polling */
+	struct if_poll	poll;
+#endif /* __rtems__ */
 };
 
 static struct resource_spec irq_res_spec[MAX_IRQ_COUNT + 1] = {
@@ -919,7 +944,9 @@ ffec_rxfinish_onebuf(struct ffec_softc *sc, int len, uint32_t flags2)
 		return;
 	}
 
+#ifndef __rtems__
 	FFEC_UNLOCK(sc);
+#endif /* __rtems__ */
 
 	bmap = &sc->rxbuf_map[sc->rx_idx];
 	len -= ETHER_CRC_LEN;
@@ -957,9 +984,20 @@ ffec_rxfinish_onebuf(struct ffec_softc *sc, int len, uint32_t flags2)
 		bcopy(src, dst, len);
 		m->m_data = dst;
 	}
+#ifndef __rtems__
 	sc->ifp->if_input(sc->ifp, m);
 
 	FFEC_LOCK(sc);
+#else /* __rtems__ */
+#if defined(INET) || defined(INET6)
+	if ((sc->ifp->if_capenable & IFCAP_LRO) == 0 ||
+	    tcp_lro_rx_csum(&sc->lro, m) != 0)
+#endif
+	{
+		*sc->rx_batch_tail = m;
+		sc->rx_batch_tail = &m->m_nextpkt;
+	}
+#endif /* __rtems__ */
 
 	if ((error = ffec_setup_rxbuf(sc, sc->rx_idx, newmbuf)) != 0) {
 		device_printf(sc->dev, "ffec_setup_rxbuf error %d\n", error);
@@ -968,12 +1006,20 @@ ffec_rxfinish_onebuf(struct ffec_softc *sc, int len, uint32_t flags2)
 
 }
 
+#ifndef __rtems__
 static void
 ffec_rxfinish_locked(struct ffec_softc *sc)
+#else /* __rtems__ */
+static int
+ffec_rxfinish_locked(struct ffec_softc *sc, int budget)
+#endif /* __rtems__ */
 {
 	struct ffec_hwdesc *desc;
 	int len;
 	boolean_t produced_empty_buffer;
+#ifdef __rtems__
+	int n = 0;
+#endif /* __rtems__ */
 
 	FFEC_ASSERT_LOCKED(sc);
 
@@ -981,10 +1027,21 @@ ffec_rxfinish_locked(struct ffec_softc *sc)
 	bus_dmamap_sync(sc->rxdesc_tag, sc->rxdesc_map, BUS_DMASYNC_PREREAD);
 	bus_dmamap_sync(sc->rxdesc_tag, sc->rxdesc_map, BUS_DMASYNC_POSTREAD);
 	produced_empty_buffer = false;
+#ifdef __rtems__
+	sc->rx_batch = NULL;
+	sc->rx_batch_tail = &sc->rx_batch;
+#endif /* __rtems__ */
 	for (;;) {
+#ifdef __rtems__
+		if (n >= budget)
+			break;
+#endif /* __rtems__ */
 		desc = &sc->rxdesc_ring[sc->rx_idx];
 		if (desc->flags_len & FEC_RXDESC_EMPTY)
 			break;
+#ifdef __rtems__
+		++n;
+#endif /* __rtems__ */
 		produced_empty_buffer = true;
 		len = (desc->flags_len & FEC_RXDESC_LEN_MASK);
 		if (len < 64) {
@@ -1031,6 +1088,23 @@ ffec_rxfinish_locked(struct ffec_softc *sc)
 		WR4(sc, FEC_RDAR_REG, FEC_RDAR_RDAR);
 		bus_dmamap_sync(sc->rxdesc_tag, sc->rxdesc_map, BUS_DMASYNC_POSTWRITE);
 	}
+#ifdef __rtems__
+	if (sc->rx_batch != NULL) {
+		FFEC_UNLOCK(sc);
+		if_input_batch(sc->ifp, sc->rx_batch);
+		FFEC_LOCK(sc);
+	}
+#if defined(INET) || defined(INET6)
+
+	if (!LIST_EMPTY(&sc->lro.lro_active)) {
+		FFEC_UNLOCK(sc);
+		tcp_lro_flush_all(&sc->lro);
+		FFEC_LOCK(sc);
+	}
+#endif
+
+	return (n);
+#endif /* __rtems__ */
 }
 
 static void
@@ -1404,7 +1478,9 @@ ffec_intr(void *arg)
 
 	if (ier & FEC_IER_RXF) {
 		WR4(sc, FEC_IER_REG, FEC_IER_RXF);
+#ifndef __rtems__
 		ffec_rxfinish_locked(sc);
+#endif /* __rtems__ */
 	}
 
 	/*
@@ -1425,6 +1501,11 @@ ffec_intr(void *arg)
 
 	FFEC_UNLOCK(sc);
 
+#ifdef __rtems__
+	/* Received frames are picked up by ffec_poll() */
+	if (ier & FEC_IER_RXF)
+		if_poll_intr(&sc->poll);
+#endif /* __rtems__ */
 }
 
 static int
@@ -1480,6 +1561,13 @@ ffec_ioctl(struct ifnet *ifp, u_long cmd, caddr_t data)
 			/* No work to do except acknowledge the change took. */
 			ifp->if_capenable ^= IFCAP_VLAN_MTU;
 		}
+#ifdef __rtems__
+		if ((mask & IFCAP_LRO) != 0 &&
+		    (ifp->if_capabilities & IFCAP_LRO) != 0) {
+			/* Queued segments are flushed after each receive. */
+			ifp->if_capenable ^= IFCAP_LRO;
+		}
+#endif /* __rtems__ */
 		break;
 
 	default:
@@ -1511,6 +1599,12 @@ ffec_detach(device_t dev)
 		FFEC_UNLOCK(sc);
 		callout_drain(&sc->ffec_callout);
 		ether_ifdetach(sc->ifp);
+#ifdef __rtems__
+		if_poll_detach(&sc->poll);
+#if defined(INET) || defined(INET6)
+		tcp_lro_free(&sc->lro);
+#endif
+#endif /* __rtems__ */
 	}
 
 	/* XXX no miibus detach? */
@@ -1573,6 +1667,18 @@ ffec_add_sysctls(struct ffec_softc *sc)
 
 	ctx = device_get_sysctl_ctx(sc->dev);
 	children = SYSCTL_CHILDREN(device_get_sysctl_tree(sc->dev));
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "lro_queued", CTLFLAG_RD,
+	    &sc->lro.lro_queued, 0, "LRO segments queued");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "lro_flushed", CTLFLAG_RD,
+	    &sc->lro.lro_flushed, 0, "LRO packets flushed");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "lro_bad_csum", CTLFLAG_RD,
+	    &sc->lro.lro_bad_csum, 0, "LRO frames with bad checksum");
+
+#endif
+#endif /* __rtems__ */
 	tree = SYSCTL_ADD_NODE(ctx, children, OID_AUTO, "int_coal",
 	    CTLFLAG_RD, 0, "FEC Interrupts coalescing");
 	children = SYSCTL_CHILDREN(tree);
@@ -1708,6 +1814,68 @@ ffec_set_txic(struct ffec_softc *sc)
 
 	ffec_set_ic(sc, FEC_TXIC0_REG, sc->tx_ic_count, sc->tx_ic_time);
 }
+#ifdef __rtems__
+
+static int
+ffec_poll(struct if_poll *ip, int budget)
+{
+	struct ffec_softc *sc;
+	int n;
+
+	sc = ip->ip_softc;
+
+	FFEC_LOCK(sc);
+
+	if ((sc->ifp->if_drv_flags & IFF_DRV_RUNNING) == 0) {
+		FFEC_UNLOCK(sc);
+		return (0);
+	}
+
+	ffec_txfinish_locked(sc);
+	n = ffec_rxfinish_locked(sc, budget);
+
+	FFEC_UNLOCK(sc);
+	return (n);
+}
+
+static void
+ffec_poll_intr(struct if_poll *ip, bool enable)
+{
+	struct ffec_softc *sc;
+	uint32_t iem;
+
+	sc = ip->ip_softc;
+
+	FFEC_LOCK(sc);
+
+	/* Masked events stay pending in the EIR */
+	if ((sc->ifp->if_drv_flags & IFF_DRV_RUNNING) != 0) {
+		iem = FEC_IER_EBERR;
+		if (enable)
+			iem |= FEC_IER_TXF | FEC_IER_RXF;
+		WR4(sc, FEC_IEM_REG, iem);
+	}
+
+	FFEC_UNLOCK(sc);
+}
+
+static void
+ffec_poll_coalesce(struct if_poll *ip, bool enable)
+{
+	struct ffec_softc *sc;
+
+	sc = ip->ip_softc;
+
+	FFEC_LOCK(sc);
+
+	if (enable)
+		ffec_set_rxic(sc);
+	else
+		ffec_set_ic(sc, FEC_RXIC0_REG, 0, 0);
+
+	FFEC_UNLOCK(sc);
+}
+#endif /* __rtems__ */
 
 static int
 ffec_attach(device_t dev)
@@ -1948,6 +2116,14 @@ ffec_attach(device_t dev)
 	else
 		WR4(sc, FEC_ECR_REG, FEC_ECR_RESET);
 
+#ifdef __rtems__
+	sc->poll.ip_softc = sc;
+	sc->poll.ip_poll = ffec_poll;
+	sc->poll.ip_intr = ffec_poll_intr;
+	sc->poll.ip_coalesce = ffec_poll_coalesce;
+	if_poll_attach(&sc->poll, dev);
+
+#endif /* __rtems__ */
 	/* Setup interrupt handler. */
 	for (irq = 0; irq < MAX_IRQ_COUNT; ++irq) {
 		if (sc->irq_res[irq] != NULL) {
@@ -2011,6 +2187,14 @@ ffec_attach(device_t dev)
 	ifp->if_flags = IFF_BROADCAST | IFF_SIMPLEX | IFF_MULTICAST;
 	ifp->if_capabilities = IFCAP_HWCSUM | IFCAP_HWCSUM_IPV6 |
 	    IFCAP_VLAN_MTU;
+#ifdef __rtems__
+#if defined(INET) || defined(INET6)
+	if (tcp_lro_init(&sc->lro) == 0) {
+		sc->lro.ifp = ifp;
+		ifp->if_capabilities |= IFCAP_LRO;
+	}
+#endif
+#endif /* __rtems__ */
 	ifp->if_capenable = ifp->if_capabilities;
 	ifp->if_hwassist = CSUM_IP | CSUM_TCP | CSUM_UDP;
 	ifp->if_start = ffec_txstart;
@@ -190,7 +190,11 @@ static const struct usb_config cdce_ncm_config[CDCE_N_TRANSFER] = {
 		.if_index = 0,
 		.frames = CDCE_NCM_RX_FRAMES_MAX,
 		.bufsize = (CDCE_NCM_RX_FRAMES_MAX * CDCE_NCM_RX_MAXLEN),
+#ifndef __rtems__
 		.flags = {.pipe_bof = 1,.short_frames_ok = 1,.short_xfer_ok = 1,},
+#else /* __rtems__ */
+		.flags = {.pipe_bof = 1,.short_frames_ok = 1,.short_xfer_ok = 1,.ext_buffer = 1,},
+#endif /* __rtems__ */
 		.callback = cdce_ncm_bulk_read_callback,
 		.timeout = 0,	/* no timeout */
 		.usb_mode = USB_MODE_DUAL,	/* both modes */
@@ -1534,15 +1538,20 @@ cdce_ncm_bulk_read_callback(struct usb_xfer *xfer, usb_error_t error)
 				m = NULL;
 				/* silently ignore this frame */
 				continue;
+#ifndef __rtems__
 			} else if (temp > (int)(MHLEN - ETHER_ALIGN)) {
 				m = m_getcl(M_NOWAIT, MT_DATA, M_PKTHDR);
 			} else {
 				m = m_gethdr(M_NOWAIT, MT_DATA);
 			}
+#else /* __rtems__ */
+			}
+#endif /* __rtems__ */
 
 			DPRINTFN(16, "frame %u, offset = %u, length = %u \n",
 			    x, offset, temp);
 
+#ifndef __rtems__
 			/* check if we have a buffer */
 			if (m) {
 				m->m_len = m->m_pkthdr.len = temp + ETHER_ALIGN;
@@ -1557,13 +1566,46 @@ cdce_ncm_bulk_read_callback(struct usb_xfer *xfer, usb_error_t error)
 			} else {
 				if_inc_counter(ifp, IFCOUNTER_IERRORS, 1);
 			}
+#else /* __rtems__ */
+			/* reference the frame in the receive buffer */
+			if (uether_rxref(&sc->sc_ue, sc->sc_rx_buf[0],
+			    offset, temp) == 0)
+				sumdata += temp;
+			else
+				if_inc_counter(ifp, IFCOUNTER_IERRORS, 1);
+#endif /* __rtems__ */
 		}
 
 		DPRINTFN(1, "Efficiency: %u/%u bytes\n", sumdata, actlen);
+#ifdef __rtems__
+
+		/* the received frames still reference the buffer */
+		m = sc->sc_rx_buf[0];
+		if (m->m_ext.ext_count != 1) {
+			sc->sc_rx_buf[0] = NULL;
+			m_freem(m);
+		}
+#endif /* __rtems__ */
 
 	case USB_ST_SETUP:
 tr_setup:
+#ifndef __rtems__
 		usbd_xfer_set_frame_len(xfer, 0, sc->sc_ncm.rx_max);
+#else /* __rtems__ */
+		/*
+		 * Receive directly into a cluster, so that the frames of
+		 * the transfer can be passed to the stack without a copy.
+		 */
+		if (sc->sc_rx_buf[0] == NULL) {
+			m = m_getjcl(M_NOWAIT, MT_DATA, M_PKTHDR,
+			    MJUM16BYTES);
+			if (m == NULL)
+				goto tr_stall;
+			sc->sc_rx_buf[0] = m;
+		}
+		usbd_xfer_set_frame_data(xfer, 0,
+		    mtod(sc->sc_rx_buf[0], void *), sc->sc_ncm.rx_max);
+#endif /* __rtems__ */
 		usbd_xfer_set_frames(xfer, 1);
 		usbd_transfer_submit(xfer);
 		uether_rxflush(&sc->sc_ue);	/* must be last */
@@ -1581,7 +1623,15 @@ tr_stall:
 				usbd_xfer_set_frames(xfer, 0);
 				usbd_transfer_submit(xfer);
 			}
+#ifdef __rtems__
+			break;
+#endif /* __rtems__ */
 		}
+#ifdef __rtems__
+
+		/* need to free the RX buffer when we are cancelled */
+		cdce_free_queue(sc->sc_rx_buf, CDCE_FRAMES_MAX);
+#endif /* __rtems__ */
 		break;
 	}
 }
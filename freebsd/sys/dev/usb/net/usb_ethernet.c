@@ -633,6 +633,68 @@ uether_rxbuf(struct usb_ether *ue, struct usb_page_cache *pc,
 	_IF_ENQUEUE(&ue->ue_rxq, m);
 	return (0);
 }
+#ifdef __rtems__
+
+/*
+ * Enqueue a frame received into the external storage of the mbuf "buf",
+ * e.g. one datagram of an aggregated transfer.  Up to MHLEN bytes are
+ * copied into the packet header mbuf so that the protocol headers are
+ * contiguous and aligned.  The rest of the frame references the storage
+ * of "buf", so the caller must receive the next transfer into a new
+ * buffer if the reference count of "buf" went up.
+ */
+int
+uether_rxref(struct usb_ether *ue, struct mbuf *buf,
+    unsigned int offset, unsigned int len)
+{
+	struct ifnet *ifp = ue->ue_ifp;
+	struct mbuf *m;
+	struct mbuf *n;
+	unsigned int hlen;
+
+	UE_LOCK_ASSERT(ue, MA_OWNED);
+	KASSERT(buf->m_flags & M_EXT, ("%s: no external storage", __func__));
+
+	if (len < ETHER_HDR_LEN || offset + len > buf->m_ext.ext_size)
+		return (1);
+
+	hlen = MIN(len, MHLEN - ETHER_ALIGN);
+
+	m = m_gethdr(M_NOWAIT, MT_DATA);
+	n = NULL;
+	if (m != NULL && hlen < len) {
+		n = m_get(M_NOWAIT, MT_DATA);
+		if (n == NULL) {
+			m_free(m);
+			m = NULL;
+		}
+	}
+	if (m == NULL) {
+		if_inc_counter(ifp, IFCOUNTER_IQDROPS, 1);
+		return (ENOMEM);
+	}
+
+	m->m_data += ETHER_ALIGN;
+	memcpy(mtod(m, uint8_t *), buf->m_ext.ext_buf + offset, hlen);
+	m->m_len = hlen;
+
+	if (n != NULL) {
+		mb_dupcl(n, buf);
+		n->m_data = buf->m_ext.ext_buf + offset + hlen;
+		n->m_len = len - hlen;
+		m->m_next = n;
+	}
+
+	/* finalize mbuf */
+	if_inc_counter(ifp, IFCOUNTER_IPACKETS, 1);
+	m->m_pkthdr.rcvif = ifp;
+	m->m_pkthdr.len = len;
+
+	/* enqueue for later when the lock can be released */
+	_IF_ENQUEUE(&ue->ue_rxq, m);
+	return (0);
+}
+#endif /* __rtems__ */
 
 void
 uether_rxflush(struct usb_ether *ue)
@@ -642,6 +704,7 @@ uether_rxflush(struct usb_ether *ue)
 
 	UE_LOCK_ASSERT(ue, MA_OWNED);
 
+#ifndef __rtems__
 	for (;;) {
 		_IF_DEQUEUE(&ue->ue_rxq, m);
 		if (m == NULL)
@@ -654,6 +717,19 @@ uether_rxflush(struct usb_ether *ue)
 		ifp->if_input(ifp, m);
 		UE_LOCK(ue);
 	}
+#else /* __rtems__ */
+	_IF_DEQUEUE_ALL(&ue->ue_rxq, m);
+	if (m == NULL)
+		return;
+
+	/*
+	 * The USB xfer has been resubmitted so its safe to unlock now.
+	 * Hand over all frames of the transfer(s) at once.
+	 */
+	UE_UNLOCK(ue);
+	(*ifp->if_input_batch)(ifp, m);
+	UE_LOCK(ue);
+#endif /* __rtems__ */
 }
 
 /*
@@ -124,6 +124,10 @@ int		uether_rxmbuf(struct usb_ether *, struct mbuf *,
 int		uether_rxbuf(struct usb_ether *,
 		    struct usb_page_cache *, 
 		    unsigned int, unsigned int);
+#ifdef __rtems__
+int		uether_rxref(struct usb_ether *, struct mbuf *,
+		    unsigned int, unsigned int);
+#endif /* __rtems__ */
 void		uether_rxflush(struct usb_ether *);
 uint8_t		uether_is_gone(struct usb_ether *);
 void		uether_start(struct ifnet *);
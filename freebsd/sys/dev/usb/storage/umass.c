@@ -124,6 +124,9 @@ __FBSDID("$FreeBSD$");
 #include <sys/callout.h>
 #include <sys/malloc.h>
 #include <sys/priv.h>
+#ifdef __rtems__
+#include <sys/uio.h>
+#endif /* __rtems__ */
 
 #include <dev/usb/usb.h>
 #include <dev/usb/usbdi.h>
@@ -181,6 +184,10 @@ SYSCTL_INT(_hw_usb_umass, OID_AUTO, throttle, CTLFLAG_RWTUN,
 #endif
 
 #define	UMASS_BULK_SIZE (1 << 17)
+#ifdef __rtems__
+/* Frames of a data transfer, one for each iovec of the data buffer */
+#define	UMASS_DATA_FRAMES CAM_RTEMS_IOV_MAX
+#endif /* __rtems__ */
 #define	UMASS_CBI_DIAGNOSTIC_CMDLEN 12	/* bytes */
 #define	UMASS_MAX_CMDLEN MAX(12, CAM_MAX_CDBLEN)	/* bytes */
 
@@ -377,6 +384,11 @@ struct umass_softc {
 	struct mtx sc_mtx;
 	struct {
 		uint8_t *data_ptr;
+#ifdef __rtems__
+		struct iovec *data_iov;	/* NULL if data_ptr is a buffer */
+		uint32_t data_iovcnt;
+		uint32_t data_iovoff;	/* bytes */
+#endif /* __rtems__ */
 		union ccb *ccb;
 		umass_callback_t *callback;
 
@@ -486,6 +498,11 @@ static uint8_t	umass_atapi_transform(struct umass_softc *, uint8_t *,
 static uint8_t	umass_no_transform(struct umass_softc *, uint8_t *, uint8_t);
 static uint8_t	umass_std_transform(struct umass_softc *, union ccb *, uint8_t
 		    *, uint8_t);
+#ifdef __rtems__
+static void	umass_data_advance(struct umass_softc *, uint32_t);
+static void	umass_data_setup(struct umass_softc *, struct usb_xfer *,
+		    uint32_t);
+#endif /* __rtems__ */
 
 #ifdef USB_DEBUG
 static void	umass_bbb_dump_cbw(struct umass_softc *, umass_bbb_cbw_t *);
@@ -541,6 +558,9 @@ static struct usb_config umass_bbb_config[UMASS_T_BBB_MAX] = {
 		.endpoint = UE_ADDR_ANY,
 		.direction = UE_DIR_IN,
 		.bufsize = UMASS_BULK_SIZE,
+#ifdef __rtems__
+		.frames = UMASS_DATA_FRAMES,
+#endif /* __rtems__ */
 		.flags = {.proxy_buffer = 1,.short_xfer_ok = 1,.ext_buffer=1,},
 		.callback = &umass_t_bbb_data_read_callback,
 		.timeout = 0,	/* overwritten later */
@@ -560,6 +580,9 @@ static struct usb_config umass_bbb_config[UMASS_T_BBB_MAX] = {
 		.endpoint = UE_ADDR_ANY,
 		.direction = UE_DIR_OUT,
 		.bufsize = UMASS_BULK_SIZE,
+#ifdef __rtems__
+		.frames = UMASS_DATA_FRAMES,
+#endif /* __rtems__ */
 		.flags = {.proxy_buffer = 1,.short_xfer_ok = 1,.ext_buffer=1,},
 		.callback = &umass_t_bbb_data_write_callback,
 		.timeout = 0,	/* overwritten later */
@@ -633,6 +656,9 @@ static struct usb_config umass_cbi_config[UMASS_T_CBI_MAX] = {
 		.endpoint = UE_ADDR_ANY,
 		.direction = UE_DIR_IN,
 		.bufsize = UMASS_BULK_SIZE,
+#ifdef __rtems__
+		.frames = UMASS_DATA_FRAMES,
+#endif /* __rtems__ */
 		.flags = {.proxy_buffer = 1,.short_xfer_ok = 1,.ext_buffer=1,},
 		.callback = &umass_t_cbi_data_read_callback,
 		.timeout = 0,	/* overwritten later */
@@ -652,6 +678,9 @@ static struct usb_config umass_cbi_config[UMASS_T_CBI_MAX] = {
 		.endpoint = UE_ADDR_ANY,
 		.direction = UE_DIR_OUT,
 		.bufsize = UMASS_BULK_SIZE,
+#ifdef __rtems__
+		.frames = UMASS_DATA_FRAMES,
+#endif /* __rtems__ */
 		.flags = {.proxy_buffer = 1,.short_xfer_ok = 1,.ext_buffer=1,},
 		.callback = &umass_t_cbi_data_write_callback,
 		.timeout = 0,	/* overwritten later */
@@ -1367,7 +1396,11 @@ umass_t_bbb_data_read_callback(struct usb_xfer *xfer, usb_error_t error)
 	switch (USB_GET_STATE(xfer)) {
 	case USB_ST_TRANSFERRED:
 		sc->sc_transfer.data_rem -= actlen;
+#ifndef __rtems__
 		sc->sc_transfer.data_ptr += actlen;
+#else /* __rtems__ */
+		umass_data_advance(sc, actlen);
+#endif /* __rtems__ */
 		sc->sc_transfer.actlen += actlen;
 
 		if (actlen < sumlen) {
@@ -1387,8 +1420,12 @@ umass_t_bbb_data_read_callback(struct usb_xfer *xfer, usb_error_t error)
 		}
 		usbd_xfer_set_timeout(xfer, sc->sc_transfer.data_timeout);
 
+#ifndef __rtems__
 		usbd_xfer_set_frame_data(xfer, 0, sc->sc_transfer.data_ptr,
 		    max_bulk);
+#else /* __rtems__ */
+		umass_data_setup(sc, xfer, max_bulk);
+#endif /* __rtems__ */
 
 		usbd_transfer_submit(xfer);
 		return;
@@ -1422,7 +1459,11 @@ umass_t_bbb_data_write_callback(struct usb_xfer *xfer, usb_error_t error)
 	switch (USB_GET_STATE(xfer)) {
 	case USB_ST_TRANSFERRED:
 		sc->sc_transfer.data_rem -= actlen;
+#ifndef __rtems__
 		sc->sc_transfer.data_ptr += actlen;
+#else /* __rtems__ */
+		umass_data_advance(sc, actlen);
+#endif /* __rtems__ */
 		sc->sc_transfer.actlen += actlen;
 
 		if (actlen < sumlen) {
@@ -1442,8 +1483,12 @@ umass_t_bbb_data_write_callback(struct usb_xfer *xfer, usb_error_t error)
 		}
 		usbd_xfer_set_timeout(xfer, sc->sc_transfer.data_timeout);
 
+#ifndef __rtems__
 		usbd_xfer_set_frame_data(xfer, 0, sc->sc_transfer.data_ptr,
 		    max_bulk);
+#else /* __rtems__ */
+		umass_data_setup(sc, xfer, max_bulk);
+#endif /* __rtems__ */
 
 		usbd_transfer_submit(xfer);
 		return;
@@ -1583,6 +1628,77 @@ tr_error:
 	}
 }
 
+#ifdef __rtems__
+static void
+umass_data_advance(struct umass_softc *sc, uint32_t len)
+{
+	struct iovec *iov = sc->sc_transfer.data_iov;
+	uint32_t off;
+
+	if (iov == NULL) {
+		sc->sc_transfer.data_ptr += len;
+		return;
+	}
+
+	off = sc->sc_transfer.data_iovoff + len;
+	while (sc->sc_transfer.data_iovcnt > 0 && off >= iov->iov_len) {
+		off -= iov->iov_len;
+		++iov;
+		--sc->sc_transfer.data_iovcnt;
+	}
+	sc->sc_transfer.data_iov = iov;
+	sc->sc_transfer.data_iovoff = off;
+}
+
+/*
+ * Maps the next max_bulk bytes of the data buffer to the frames of the
+ * transfer.  Each iovec gets its own frame, so that the host controller
+ * moves the whole data stage of a scatter/gather command without
+ * intermediate completions.  A frame which is not a multiple of the maximum
+ * frame length ends the transfer, since a short packet in the middle of
+ * the transfer would terminate it.
+ */
+static void
+umass_data_setup(struct umass_softc *sc, struct usb_xfer *xfer,
+    uint32_t max_bulk)
+{
+	struct iovec *iov = sc->sc_transfer.data_iov;
+	usb_frlength_t frame_len;
+	usb_frcount_t max_frames;
+	usb_frcount_t nframes;
+	uint32_t off;
+	uint32_t len;
+
+	if (iov == NULL) {
+		usbd_xfer_set_frame_data(xfer, 0, sc->sc_transfer.data_ptr,
+		    max_bulk);
+		usbd_xfer_set_frames(xfer, 1);
+		return;
+	}
+
+	frame_len = usbd_xfer_max_framelen(xfer);
+	max_frames = usbd_xfer_max_frames(xfer);
+	off = sc->sc_transfer.data_iovoff;
+	nframes = 0;
+
+	while (max_bulk > 0 && nframes < max_frames) {
+		len = MIN(iov->iov_len - off, max_bulk);
+		usbd_xfer_set_frame_data(xfer, nframes,
+		    (uint8_t *)iov->iov_base + off, len);
+		++nframes;
+		max_bulk -= len;
+
+		if ((len % frame_len) != 0)
+			break;
+
+		off = 0;
+		++iov;
+	}
+
+	usbd_xfer_set_frames(xfer, nframes);
+}
+
+#endif /* __rtems__ */
 static void
 umass_command_start(struct umass_softc *sc, uint8_t dir,
     void *data_ptr, uint32_t data_len,
@@ -1601,6 +1717,18 @@ umass_command_start(struct umass_softc *sc, uint8_t dir,
 	sc->sc_transfer.data_ptr = data_ptr;
 	sc->sc_transfer.data_len = data_len;
 	sc->sc_transfer.data_rem = data_len;
+#ifdef __rtems__
+	/* Only the data buffer of the CCB may be an iovec list */
+	if (data_ptr == ccb->csio.data_ptr &&
+	    (ccb->ccb_h.flags & CAM_DATA_MASK) == CAM_DATA_SG) {
+		sc->sc_transfer.data_iov = (struct iovec *)data_ptr;
+		sc->sc_transfer.data_iovcnt = ccb->csio.sglist_cnt;
+	} else {
+		sc->sc_transfer.data_iov = NULL;
+		sc->sc_transfer.data_iovcnt = 0;
+	}
+	sc->sc_transfer.data_iovoff = 0;
+#endif /* __rtems__ */
 	sc->sc_transfer.data_timeout = (data_timeout + UMASS_TIMEOUT);
 
 	sc->sc_transfer.actlen = 0;
@@ -1880,7 +2008,11 @@ umass_t_cbi_data_read_callback(struct usb_xfer *xfer, usb_error_t error)
 	switch (USB_GET_STATE(xfer)) {
 	case USB_ST_TRANSFERRED:
 		sc->sc_transfer.data_rem -= actlen;
+#ifndef __rtems__
 		sc->sc_transfer.data_ptr += actlen;
+#else /* __rtems__ */
+		umass_data_advance(sc, actlen);
+#endif /* __rtems__ */
 		sc->sc_transfer.actlen += actlen;
 
 		if (actlen < sumlen) {
@@ -1900,8 +2032,12 @@ umass_t_cbi_data_read_callback(struct usb_xfer *xfer, usb_error_t error)
 		}
 		usbd_xfer_set_timeout(xfer, sc->sc_transfer.data_timeout);
 
+#ifndef __rtems__
 		usbd_xfer_set_frame_data(xfer, 0, sc->sc_transfer.data_ptr,
 		    max_bulk);
+#else /* __rtems__ */
+		umass_data_setup(sc, xfer, max_bulk);
+#endif /* __rtems__ */
 
 		usbd_transfer_submit(xfer);
 		break;
@@ -1936,7 +2072,11 @@ umass_t_cbi_data_write_callback(struct usb_xfer *xfer, usb_error_t error)
 	switch (USB_GET_STATE(xfer)) {
 	case USB_ST_TRANSFERRED:
 		sc->sc_transfer.data_rem -= actlen;
+#ifndef __rtems__
 		sc->sc_transfer.data_ptr += actlen;
+#else /* __rtems__ */
+		umass_data_advance(sc, actlen);
+#endif /* __rtems__ */
 		sc->sc_transfer.actlen += actlen;
 
 		if (actlen < sumlen) {
@@ -1956,8 +2096,12 @@ umass_t_cbi_data_write_callback(struct usb_xfer *xfer, usb_error_t error)
 		}
 		usbd_xfer_set_timeout(xfer, sc->sc_transfer.data_timeout);
 
+#ifndef __rtems__
 		usbd_xfer_set_frame_data(xfer, 0, sc->sc_transfer.data_ptr,
 		    max_bulk);
+#else /* __rtems__ */
+		umass_data_setup(sc, xfer, max_bulk);
+#endif /* __rtems__ */
 
 		usbd_transfer_submit(xfer);
 		break;
@@ -2212,6 +2356,16 @@ umass_cam_action(struct cam_sim *sim, union ccb *ccb)
 			default:
 				dir = DIR_NONE;
 			}
+#ifdef __rtems__
+			if ((ccb->ccb_h.flags & CAM_DATA_MASK) !=
+			    CAM_DATA_VADDR &&
+			    ((ccb->ccb_h.flags & CAM_DATA_MASK) != CAM_DATA_SG ||
+			    (ccb->ccb_h.xflags & CAM_SG_FORMAT_IOVEC) == 0)) {
+				ccb->ccb_h.status = CAM_REQ_INVALID;
+				xpt_done(ccb);
+				goto done;
+			}
+#endif /* __rtems__ */
 
 			ccb->ccb_h.status = CAM_REQ_INPROG | CAM_SIM_QUEUED;
 
@@ -2321,6 +2475,9 @@ umass_cam_action(struct cam_sim *sim, union ccb *ccb)
 			cpi->hba_inquiry = 0;
 			cpi->target_sprt = 0;
 			cpi->hba_misc = PIM_NO_6_BYTE;
+#ifdef __rtems__
+			cpi->hba_misc |= PIM_IOVEC_SG;
+#endif /* __rtems__ */
 			cpi->hba_eng_cnt = 0;
 			cpi->max_target = UMASS_SCSIID_MAX;	/* one target */
 			cpi->initiator_id = UMASS_SCSIID_HOST;
@@ -2360,6 +2517,21 @@ umass_cam_action(struct cam_sim *sim, union ccb *ccb)
 				}
 				cpi->max_lun = sc->sc_maxlun;
 			}
+#ifdef __rtems__
+
+			/*
+			 * The data stage is split into USB transfers of
+			 * UMASS_BULK_SIZE bytes, so let the block device
+			 * layer issue commands of this size.  The data stage
+			 * of a command is then a single transfer.  A second
+			 * data transfer queued on the endpoint would have
+			 * nothing to overlap with, since the Bulk-Only
+			 * protocol puts the status stage of a command before
+			 * the next command.
+			 */
+			if (cpi->maxio == 0)
+				cpi->maxio = UMASS_BULK_SIZE;
+#endif /* __rtems__ */
 
 			cpi->ccb_h.status = CAM_REQ_CMP;
 			xpt_done(ccb);
@@ -98,6 +98,9 @@ __FBSDID("$FreeBSD$");
 
 #include <ddb/ddb.h>
 #include <ddb/db_sym.h>
+#ifdef __rtems__
+#include <machine/rtems-bsd-boot-profile.h>
+#endif /* __rtems__ */
 
 void mi_startup(void);				/* Should be elsewhere */
 
@@ -242,6 +245,7 @@ mi_startup(void)
 #ifdef __rtems__
 	struct sysinit **sysinit = NULL;
 	struct sysinit **sysinit_end = NULL;
+	uint64_t profile;
 #endif /* __rtems__ */
 
 #if defined(VERBOSE_SYSINIT)
@@ -326,7 +330,13 @@ restart:
 #endif
 
 		/* Call function */
+#ifdef __rtems__
+		profile = rtems_bsd_boot_profile_begin();
+#endif /* __rtems__ */
 		(*((*sipp)->func))((*sipp)->udata);
+#ifdef __rtems__
+		rtems_bsd_boot_profile_sysinit(*sipp, profile);
+#endif /* __rtems__ */
 
 #if defined(VERBOSE_SYSINIT)
 		if (verbose)
@@ -72,6 +72,9 @@ __FBSDID("$FreeBSD$");
 #include <vm/vm.h>
 
 #include <ddb/ddb.h>
+#ifdef __rtems__
+#include <machine/rtems-bsd-boot-profile.h>
+#endif /* __rtems__ */
 
 SYSCTL_NODE(_hw, OID_AUTO, bus, CTLFLAG_RW, NULL, NULL);
 SYSCTL_ROOT_NODE(OID_AUTO, dev, CTLFLAG_RW, NULL, NULL);
@@ -2947,6 +2950,11 @@ device_probe_and_attach(device_t dev)
 	else if (error != 0)
 		return (error);
 
+#ifdef __rtems__
+	if (rtems_bsd_boot_defer_attach_check(dev))
+		return (0);
+
+#endif /* __rtems__ */
 	CURVNET_SET_QUIET(vnet0);
 	error = device_attach(dev);
 	CURVNET_RESTORE();
@@ -2978,6 +2986,9 @@ device_attach(device_t dev)
 	uint64_t attachtime;
 	uint16_t attachentropy;
 	int error;
+#ifdef __rtems__
+	uint64_t profile;
+#endif /* __rtems__ */
 
 #ifndef __rtems__
 	if (resource_disabled(dev->driver->name, dev->unit)) {
@@ -2993,7 +3004,14 @@ device_attach(device_t dev)
 		device_print_child(dev->parent, dev);
 	attachtime = get_cyclecount();
 	dev->state = DS_ATTACHING;
+#ifndef __rtems__
 	if ((error = DEVICE_ATTACH(dev)) != 0) {
+#else /* __rtems__ */
+	profile = rtems_bsd_boot_profile_begin();
+	error = DEVICE_ATTACH(dev);
+	rtems_bsd_boot_profile_attach(dev, profile, error);
+	if (error != 0) {
+#endif /* __rtems__ */
 		printf("device_attach: %s%d attach returned %d\n",
 		    dev->driver->name, dev->unit, error);
 		if (!(dev->flags & DF_FIXEDCLASS))
@@ -3019,6 +3037,8 @@ device_attach(device_t dev)
 #ifndef __rtems__
 	EVENTHANDLER_INVOKE(device_attach, dev);
 	EVENTHANDLER_DIRECT_INVOKE(device_attach, dev);
+#else /* __rtems__ */
+	rtems_bsd_boot_attach_done(dev);
 #endif /* __rtems__ */
 	devadded(dev);
 	return (0);
@@ -1164,18 +1164,72 @@ rtems_bsd_sendto(int socket, struct mbuf *m, int flags,
 	struct socket *so;
 	int error;
 
-	error = getsock_cap(td->td_proc->p_fd, socket, CAP_WRITE, &fp, NULL, NULL);
+	if (td == NULL) {
+		m_freem(m);
+		return (ENOMEM);
+	}
+
+	error = getsock_cap(td, socket, &cap_send_rights, &fp, NULL, NULL);
+	if (error) {
+		m_freem(m);
+		return (error);
+	}
+	so = (struct socket *)fp->f_data;
+
+	error = sosend(so, __DECONST(struct sockaddr *, dest_addr),
+	    NULL, m, NULL, flags, td);
+
+	fdrop(fp, td);
+	return (error);
+}
+
+int
+rtems_bsd_recvfrom(int socket, struct mbuf **mp, size_t *len, int flags,
+    struct sockaddr *from, socklen_t *fromlen)
+{
+	struct thread *td = rtems_bsd_get_curthread_or_null();
+	struct sockaddr *fromsa = NULL;
+	struct file *fp;
+	struct socket *so;
+	struct uio auio;
+	int error;
+
+	*mp = NULL;
+
+	if (td == NULL)
+		return (ENOMEM);
+
+	error = getsock_cap(td, socket, &cap_recv_rights, &fp, NULL, NULL);
 	if (error)
 		return (error);
 	so = (struct socket *)fp->f_data;
 
-	if (td != NULL) {
-		error = sosend(so, __DECONST(struct sockaddr *, dest_addr),
-		    NULL, m, NULL, flags, td);
+	auio.uio_iov = NULL;
+	auio.uio_iovcnt = 0;
+	auio.uio_segflg = UIO_SYSSPACE;
+	auio.uio_rw = UIO_READ;
+	auio.uio_td = td;
+	auio.uio_offset = 0;
+	auio.uio_resid = *len;
+	error = soreceive(so, from != NULL ? &fromsa : NULL, &auio, mp, NULL,
+	    &flags);
+	if (error == 0) {
+		*len -= auio.uio_resid;
+		if (from != NULL) {
+			if (fromsa != NULL) {
+				*fromlen = MIN(*fromlen, fromsa->sa_len);
+				memcpy(from, fromsa, *fromlen);
+			} else {
+				*fromlen = 0;
+			}
+		}
 	} else {
-		error = ENOMEM;
+		m_freem(*mp);
+		*mp = NULL;
 	}
 
+	fdrop(fp, td);
+	free(fromsa, M_SONAME);
 	return (error);
 }
 #endif /* __rtems__ */
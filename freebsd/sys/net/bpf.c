@@ -216,9 +216,11 @@ SYSCTL_INT(_net_bpf, OID_AUTO, maxinsns, CTLFLAG_RW,
     &bpf_maxinsns, 0, "Maximum bpf program instructions");
 #ifndef __rtems__
 static int bpf_zerocopy_enable = 0;
+#else /* __rtems__ */
+static int bpf_zerocopy_enable = 1;
+#endif /* __rtems__ */
 SYSCTL_INT(_net_bpf, OID_AUTO, zerocopy_enable, CTLFLAG_RW,
     &bpf_zerocopy_enable, 0, "Enable new zero-copy BPF buffer sessions");
-#endif /* __rtems__ */
 static SYSCTL_NODE(_net_bpf, OID_AUTO, stats, CTLFLAG_MPSAFE | CTLFLAG_RW,
     bpf_stats_sysctl, "bpf statistics portal");
 
@@ -301,11 +303,9 @@ bpf_append_bytes(struct bpf_d *d, caddr_t buf, u_int offset, void *src,
 	case BPF_BUFMODE_BUFFER:
 		return (bpf_buffer_append_bytes(d, buf, offset, src, len));
 
-#ifndef __rtems__
 	case BPF_BUFMODE_ZBUF:
 		counter_u64_add(d->bd_zcopy, 1);
 		return (bpf_zerocopy_append_bytes(d, buf, offset, src, len));
-#endif /* __rtems__ */
 
 	default:
 		panic("bpf_buf_append_bytes");
@@ -323,11 +323,9 @@ bpf_append_mbuf(struct bpf_d *d, caddr_t buf, u_int offset, void *src,
 	case BPF_BUFMODE_BUFFER:
 		return (bpf_buffer_append_mbuf(d, buf, offset, src, len));
 
-#ifndef __rtems__
 	case BPF_BUFMODE_ZBUF:
 		counter_u64_add(d->bd_zcopy, 1);
 		return (bpf_zerocopy_append_mbuf(d, buf, offset, src, len));
-#endif /* __rtems__ */
 
 	default:
 		panic("bpf_buf_append_mbuf");
@@ -347,11 +345,9 @@ bpf_buf_reclaimed(struct bpf_d *d)
 	case BPF_BUFMODE_BUFFER:
 		return;
 
-#ifndef __rtems__
 	case BPF_BUFMODE_ZBUF:
 		bpf_zerocopy_buf_reclaimed(d);
 		return;
-#endif /* __rtems__ */
 
 	default:
 		panic("bpf_buf_reclaimed");
@@ -369,12 +365,10 @@ bpf_canfreebuf(struct bpf_d *d)
 
 	BPFD_LOCK_ASSERT(d);
 
-#ifndef __rtems__
 	switch (d->bd_bufmode) {
 	case BPF_BUFMODE_ZBUF:
 		return (bpf_zerocopy_canfreebuf(d));
 	}
-#endif /* __rtems__ */
 	return (0);
 }
 
@@ -388,12 +382,10 @@ bpf_canwritebuf(struct bpf_d *d)
 {
 	BPFD_LOCK_ASSERT(d);
 
-#ifndef __rtems__
 	switch (d->bd_bufmode) {
 	case BPF_BUFMODE_ZBUF:
 		return (bpf_zerocopy_canwritebuf(d));
 	}
-#endif /* __rtems__ */
 	return (1);
 }
 
@@ -408,13 +400,11 @@ bpf_buffull(struct bpf_d *d)
 
 	BPFD_LOCK_ASSERT(d);
 
-#ifndef __rtems__
 	switch (d->bd_bufmode) {
 	case BPF_BUFMODE_ZBUF:
 		bpf_zerocopy_buffull(d);
 		break;
 	}
-#endif /* __rtems__ */
 }
 
 /*
@@ -426,13 +416,11 @@ bpf_bufheld(struct bpf_d *d)
 
 	BPFD_LOCK_ASSERT(d);
 
-#ifndef __rtems__
 	switch (d->bd_bufmode) {
 	case BPF_BUFMODE_ZBUF:
 		bpf_zerocopy_bufheld(d);
 		break;
 	}
-#endif /* __rtems__ */
 }
 
 static void
@@ -443,10 +431,8 @@ bpf_free(struct bpf_d *d)
 	case BPF_BUFMODE_BUFFER:
 		return (bpf_buffer_free(d));
 
-#ifndef __rtems__
 	case BPF_BUFMODE_ZBUF:
 		return (bpf_zerocopy_free(d));
-#endif /* __rtems__ */
 
 	default:
 		panic("bpf_buf_free");
@@ -475,39 +461,27 @@ static int
 bpf_ioctl_getzmax(struct thread *td, struct bpf_d *d, size_t *i)
 {
 
-#ifndef __rtems__
 	if (d->bd_bufmode != BPF_BUFMODE_ZBUF)
 		return (EOPNOTSUPP);
 	return (bpf_zerocopy_ioctl_getzmax(td, d, i));
-#else /* __rtems__ */
-	return (EOPNOTSUPP);
-#endif /* __rtems__ */
 }
 
 static int
 bpf_ioctl_rotzbuf(struct thread *td, struct bpf_d *d, struct bpf_zbuf *bz)
 {
 
-#ifndef __rtems__
 	if (d->bd_bufmode != BPF_BUFMODE_ZBUF)
 		return (EOPNOTSUPP);
 	return (bpf_zerocopy_ioctl_rotzbuf(td, d, bz));
-#else /* __rtems__ */
-	return (EOPNOTSUPP);
-#endif /* __rtems__ */
 }
 
 static int
 bpf_ioctl_setzbuf(struct thread *td, struct bpf_d *d, struct bpf_zbuf *bz)
 {
 
-#ifndef __rtems__
 	if (d->bd_bufmode != BPF_BUFMODE_ZBUF)
 		return (EOPNOTSUPP);
 	return (bpf_zerocopy_ioctl_setzbuf(td, d, bz));
-#else /* __rtems__ */
-	return (EOPNOTSUPP);
-#endif /* __rtems__ */
 }
 
 /*
@@ -1869,12 +1843,10 @@ bpfioctl(struct bpf_d *d, u_long cmd, caddr_t addr, int flags,
 		case BPF_BUFMODE_BUFFER:
 			break;
 
-#ifndef __rtems__
 		case BPF_BUFMODE_ZBUF:
 			if (bpf_zerocopy_enable)
 				break;
 			/* FALLSTHROUGH */
-#endif /* __rtems__ */
 
 		default:
 			CURVNET_RESTORE();
@@ -2065,9 +2037,7 @@ bpf_setif(struct bpf_d *d, struct ifreq *ifr)
 	 */
 	switch (d->bd_bufmode) {
 	case BPF_BUFMODE_BUFFER:
-#ifndef __rtems__
 	case BPF_BUFMODE_ZBUF:
-#endif /* __rtems__ */
 		if (d->bd_sbuf == NULL)
 			return (EINVAL);
 		break;
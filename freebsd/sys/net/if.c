@@ -265,6 +265,9 @@ static void	if_attachdomain1(struct ifnet *);
 static int	ifconf(u_long, caddr_t);
 static void	*if_grow(void);
 static void	if_input_default(struct ifnet *, struct mbuf *);
+#ifdef __rtems__
+static void	if_input_batch_default(struct ifnet *, struct mbuf *);
+#endif /* __rtems__ */
 static int	if_requestencap_default(struct ifnet *, struct if_encap_req *);
 static void	if_route(struct ifnet *, int flag, int fam);
 static int	if_setflag(struct ifnet *, int, int, int *, int);
@@ -807,6 +810,10 @@ if_attach_internal(struct ifnet *ifp, int vmove, struct if_clone *ifc)
 	}
 	if (ifp->if_input == NULL)
 		ifp->if_input = if_input_default;
+#ifdef __rtems__
+	if (ifp->if_input_batch == NULL)
+		ifp->if_input_batch = if_input_batch_default;
+#endif /* __rtems__ */
 
 	if (ifp->if_requestencap == NULL)
 		ifp->if_requestencap = if_requestencap_default;
@@ -2925,9 +2932,25 @@ ifhwioctl(u_long cmd, struct ifnet *ifp, caddr_t data, struct thread *td)
 
 			ifipfr = (struct rtems_ifinputreq *)data;
 			ifipfr->old_if_input = ifp->if_input;
+			ifipfr->old_if_input_batch = ifp->if_input_batch;
 			ifp->if_input_arg = ifipfr->arg;
 			(*ifipfr->init)(ifp, ifipfr->arg);
-			ifp->if_input = ifipfr->new_if_input;
+			if (ifipfr->new_if_input_batch != NULL) {
+				/* A single packet is a chain of length one */
+				ifp->if_input = ifipfr->new_if_input != NULL ?
+				    ifipfr->new_if_input :
+				    ifipfr->new_if_input_batch;
+				ifp->if_input_batch =
+				    ifipfr->new_if_input_batch;
+			} else {
+				/*
+				 * Route batches through the new per-packet
+				 * handler, otherwise drivers using the batch
+				 * entry point would bypass it.
+				 */
+				ifp->if_input = ifipfr->new_if_input;
+				ifp->if_input_batch = if_input_batch_default;
+			}
 			error = 0;
 		} else {
 			return (EEXIST);
@@ -4048,6 +4071,25 @@ if_input_default(struct ifnet *ifp __unused, struct mbuf *m)
 
 	m_freem(m);
 }
+#ifdef __rtems__
+
+/*
+ * Split a chain of packets linked with m_nextpkt and pass them one by one to
+ * if_input().  Used for interfaces without a batched input routine.
+ */
+static void
+if_input_batch_default(struct ifnet *ifp, struct mbuf *m)
+{
+	struct mbuf *mn;
+
+	while (m != NULL) {
+		mn = m->m_nextpkt;
+		m->m_nextpkt = NULL;
+		(*ifp->if_input)(ifp, m);
+		m = mn;
+	}
+}
+#endif /* __rtems__ */
 
 int
 if_handoff(struct ifqueue *ifq, struct mbuf *m, struct ifnet *ifp, int adjust)
@@ -4369,6 +4411,15 @@ if_input(if_t ifp, struct mbuf* sendmp)
 	return (0);
 
 }
+#ifdef __rtems__
+
+int
+if_input_batch(if_t ifp, struct mbuf *m)
+{
+	(*((struct ifnet *)ifp)->if_input_batch)((struct ifnet *)ifp, m);
+	return (0);
+}
+#endif /* __rtems__ */
 
 /* XXX */
 #ifndef ETH_ADDR_LEN
@@ -105,6 +105,9 @@ __FBSDID("$FreeBSD$");
 #include <sys/proc.h>
 #include <sys/lock.h>
 #include <sys/mutex.h>
+#ifdef __rtems__
+#include <sys/sx.h>
+#endif /* __rtems__ */
 
 #include <net/bpf.h>
 #include <net/if.h>
@@ -182,7 +185,11 @@ __FBSDID("$FreeBSD$");
  * Bridge interface list entry.
  */
 struct bridge_iflist {
+#ifndef __rtems__
 	LIST_ENTRY(bridge_iflist) bif_next;
+#else /* __rtems__ */
+	CK_LIST_ENTRY(bridge_iflist) bif_next;
+#endif /* __rtems__ */
 	struct ifnet		*bif_ifp;	/* member if */
 	struct bstp_port	bif_stp;	/* STP state */
 	uint32_t		bif_flags;	/* member if flags */
@@ -190,19 +197,30 @@ struct bridge_iflist {
 	uint32_t		bif_addrmax;	/* max # of addresses */
 	uint32_t		bif_addrcnt;	/* cur. # of addresses */
 	uint32_t		bif_addrexceeded;/* # of address violations */
+#ifdef __rtems__
+	struct epoch_context	bif_epoch_ctx;
+#endif /* __rtems__ */
 };
 
 /*
  * Bridge route node.
  */
 struct bridge_rtnode {
+#ifndef __rtems__
 	LIST_ENTRY(bridge_rtnode) brt_hash;	/* hash table linkage */
 	LIST_ENTRY(bridge_rtnode) brt_list;	/* list linkage */
+#else /* __rtems__ */
+	CK_LIST_ENTRY(bridge_rtnode) brt_hash;	/* hash table linkage */
+	CK_LIST_ENTRY(bridge_rtnode) brt_list;	/* list linkage */
+#endif /* __rtems__ */
 	struct bridge_iflist	*brt_dst;	/* destination if */
 	unsigned long		brt_expire;	/* expiration time */
 	uint8_t			brt_flags;	/* address flags */
 	uint8_t			brt_addr[ETHER_ADDR_LEN];
 	uint16_t		brt_vlan;	/* vlan id */
+#ifdef __rtems__
+	struct epoch_context	brt_epoch_ctx;
+#endif /* __rtems__ */
 };
 #define	brt_ifp			brt_dst->bif_ifp
 
@@ -212,12 +230,18 @@ struct bridge_rtnode {
 struct bridge_softc {
 	struct ifnet		*sc_ifp;	/* make this an interface */
 	LIST_ENTRY(bridge_softc) sc_list;
+#ifndef __rtems__
 	struct mtx		sc_mtx;
 	struct cv		sc_cv;
+#else /* __rtems__ */
+	struct sx		sc_sx;
+	struct mtx		sc_rt_mtx;
+#endif /* __rtems__ */
 	uint32_t		sc_brtmax;	/* max # of addresses */
 	uint32_t		sc_brtcnt;	/* cur. # of addresses */
 	uint32_t		sc_brttimeout;	/* rt timeout in seconds */
 	struct callout		sc_brcallout;	/* bridge callout */
+#ifndef __rtems__
 	uint32_t		sc_iflist_ref;	/* refcount for sc_iflist */
 	uint32_t		sc_iflist_xcnt;	/* refcount for sc_iflist */
 	LIST_HEAD(, bridge_iflist) sc_iflist;	/* member interface list */
@@ -225,14 +249,54 @@ struct bridge_softc {
 	LIST_HEAD(, bridge_rtnode) sc_rtlist;	/* list version of above */
 	uint32_t		sc_rthash_key;	/* key for hash */
 	LIST_HEAD(, bridge_iflist) sc_spanlist;	/* span ports list */
+#else /* __rtems__ */
+	CK_LIST_HEAD(, bridge_iflist) sc_iflist;	/* member interface list */
+	CK_LIST_HEAD(, bridge_rtnode) *sc_rthash;	/* our forwarding table */
+	CK_LIST_HEAD(, bridge_rtnode) sc_rtlist;	/* list version of above */
+	uint32_t		sc_rthash_key;	/* key for hash */
+	CK_LIST_HEAD(, bridge_iflist) sc_spanlist;	/* span ports list */
+#endif /* __rtems__ */
 	struct bstp_state	sc_stp;		/* STP state */
 	uint32_t		sc_brtexceeded;	/* # of cache drops */
 	struct ifnet		*sc_ifaddr;	/* member mac copied from */
 	u_char			sc_defaddr[6];	/* Default MAC address */
 };
 
+#ifndef __rtems__
 VNET_DEFINE_STATIC(struct mtx, bridge_list_mtx);
 #define	V_bridge_list_mtx	VNET(bridge_list_mtx)
+#else /* __rtems__ */
+/*
+ * The member, span and forwarding lists are read without locks within the
+ * network epoch.  The configuration path serializes on the sx lock and the
+ * forwarding table is modified with the rt mutex held.  Removed entries are
+ * freed once all readers have left the epoch.
+ */
+#define	BRIDGE_LOCK_INIT(_sc)		do {				\
+	sx_init(&(_sc)->sc_sx, "if_bridge");				\
+	mtx_init(&(_sc)->sc_rt_mtx, "if_bridge rt", NULL, MTX_DEF);	\
+} while (0)
+#define	BRIDGE_LOCK_DESTROY(_sc)	do {	\
+	sx_destroy(&(_sc)->sc_sx);		\
+	mtx_destroy(&(_sc)->sc_rt_mtx);		\
+} while (0)
+#define	BRIDGE_LOCK(_sc)		sx_xlock(&(_sc)->sc_sx)
+#define	BRIDGE_UNLOCK(_sc)		sx_xunlock(&(_sc)->sc_sx)
+#define	BRIDGE_LOCK_ASSERT(_sc)		sx_assert(&(_sc)->sc_sx, SA_XLOCKED)
+#define	BRIDGE_LOCK_OR_NET_EPOCH_ASSERT(_sc)				\
+	MPASS(in_epoch(net_epoch_preempt) || sx_xlocked(&(_sc)->sc_sx))
+#define	BRIDGE_RT_LOCK(_sc)		mtx_lock(&(_sc)->sc_rt_mtx)
+#define	BRIDGE_RT_UNLOCK(_sc)		mtx_unlock(&(_sc)->sc_rt_mtx)
+#define	BRIDGE_RT_LOCK_ASSERT(_sc)	mtx_assert(&(_sc)->sc_rt_mtx, MA_OWNED)
+#define	BRIDGE_RT_LOCK_OR_NET_EPOCH_ASSERT(_sc)				\
+	MPASS(in_epoch(net_epoch_preempt) || mtx_owned(&(_sc)->sc_rt_mtx))
+#define	BRIDGE_RLOCK()	struct epoch_tracker bridge_et; epoch_enter_preempt(net_epoch_preempt, &bridge_et)
+#define	BRIDGE_RUNLOCK()	epoch_exit_preempt(net_epoch_preempt, &bridge_et)
+#define	BRIDGE_RLOCK_ASSERT()	MPASS(in_epoch(net_epoch_preempt))
+
+VNET_DEFINE_STATIC(struct sx, bridge_list_sx);
+#define	V_bridge_list_sx	VNET(bridge_list_sx)
+#endif /* __rtems__ */
 static eventhandler_tag bridge_detach_cookie;
 
 int	bridge_rtable_prune_period = BRIDGE_RTABLE_PRUNE_PERIOD;
@@ -288,6 +352,9 @@ static int	bridge_rtnode_insert(struct bridge_softc *,
 		    struct bridge_rtnode *);
 static void	bridge_rtnode_destroy(struct bridge_softc *,
 		    struct bridge_rtnode *);
+#ifdef __rtems__
+static void	bridge_rtnode_destroy_cb(struct epoch_context *);
+#endif /* __rtems__ */
 static void	bridge_rtable_expire(struct ifnet *, int);
 static void	bridge_state_change(struct ifnet *, int);
 
@@ -297,6 +364,9 @@ static struct bridge_iflist *bridge_lookup_member_if(struct bridge_softc *,
 		    struct ifnet *ifp);
 static void	bridge_delete_member(struct bridge_softc *,
 		    struct bridge_iflist *, int);
+#ifdef __rtems__
+static void	bridge_delete_member_cb(struct epoch_context *);
+#endif /* __rtems__ */
 static void	bridge_delete_span(struct bridge_softc *,
 		    struct bridge_iflist *);
 
@@ -514,11 +584,19 @@ const int bridge_control_table_size = nitems(bridge_control_table);
 
 VNET_DEFINE_STATIC(LIST_HEAD(, bridge_softc), bridge_list);
 #define	V_bridge_list	VNET(bridge_list)
+#ifndef __rtems__
 #define	BRIDGE_LIST_LOCK_INIT(x)	mtx_init(&V_bridge_list_mtx,	\
 					    "if_bridge list", NULL, MTX_DEF)
 #define	BRIDGE_LIST_LOCK_DESTROY(x)	mtx_destroy(&V_bridge_list_mtx)
 #define	BRIDGE_LIST_LOCK(x)		mtx_lock(&V_bridge_list_mtx)
 #define	BRIDGE_LIST_UNLOCK(x)		mtx_unlock(&V_bridge_list_mtx)
+#else /* __rtems__ */
+#define	BRIDGE_LIST_LOCK_INIT(x)	sx_init(&V_bridge_list_sx,	\
+					    "if_bridge list")
+#define	BRIDGE_LIST_LOCK_DESTROY(x)	sx_destroy(&V_bridge_list_sx)
+#define	BRIDGE_LIST_LOCK(x)		sx_xlock(&V_bridge_list_sx)
+#define	BRIDGE_LIST_UNLOCK(x)		sx_xunlock(&V_bridge_list_sx)
+#endif /* __rtems__ */
 
 VNET_DEFINE_STATIC(struct if_clone *, bridge_cloner);
 #define	V_bridge_cloner	VNET(bridge_cloner)
@@ -565,6 +643,9 @@ bridge_modevent(module_t mod, int type, void *data)
 	case MOD_UNLOAD:
 		EVENTHANDLER_DEREGISTER(ifnet_departure_event,
 		    bridge_detach_cookie);
+#ifdef __rtems__
+		epoch_drain_callbacks(net_epoch_preempt);
+#endif /* __rtems__ */
 		uma_zdestroy(bridge_rtnode_zone);
 		bridge_dn_p = NULL;
 		break;
@@ -646,10 +727,17 @@ bridge_clone_create(struct if_clone *ifc, int unit, caddr_t params)
 	/* Initialize our routing table. */
 	bridge_rtable_init(sc);
 
+#ifndef __rtems__
 	callout_init_mtx(&sc->sc_brcallout, &sc->sc_mtx, 0);
 
 	LIST_INIT(&sc->sc_iflist);
 	LIST_INIT(&sc->sc_spanlist);
+#else /* __rtems__ */
+	callout_init_mtx(&sc->sc_brcallout, &sc->sc_rt_mtx, 0);
+
+	CK_LIST_INIT(&sc->sc_iflist);
+	CK_LIST_INIT(&sc->sc_spanlist);
+#endif /* __rtems__ */
 
 	ifp->if_softc = sc;
 	if_initname(ifp, bridge_name, unit);
@@ -727,10 +815,17 @@ bridge_clone_destroy(struct ifnet *ifp)
 	bridge_stop(ifp, 1);
 	ifp->if_flags &= ~IFF_UP;
 
+#ifndef __rtems__
 	while ((bif = LIST_FIRST(&sc->sc_iflist)) != NULL)
 		bridge_delete_member(sc, bif, 0);
 
 	while ((bif = LIST_FIRST(&sc->sc_spanlist)) != NULL) {
+#else /* __rtems__ */
+	while ((bif = CK_LIST_FIRST(&sc->sc_iflist)) != NULL)
+		bridge_delete_member(sc, bif, 0);
+
+	while ((bif = CK_LIST_FIRST(&sc->sc_spanlist)) != NULL) {
+#endif /* __rtems__ */
 		bridge_delete_span(sc, bif);
 	}
 
@@ -745,6 +840,11 @@ bridge_clone_destroy(struct ifnet *ifp)
 	bstp_detach(&sc->sc_stp);
 	ether_ifdetach(ifp);
 	if_free(ifp);
+#ifdef __rtems__
+
+	/* Wait for readers which may still reference the bridge. */
+	NET_EPOCH_WAIT();
+#endif /* __rtems__ */
 
 	/* Tear down the routing table. */
 	bridge_rtable_fini(sc);
@@ -857,12 +957,20 @@ bridge_ioctl(struct ifnet *ifp, u_long cmd, caddr_t data)
 			error = EINVAL;
 			break;
 		}
+#ifndef __rtems__
 		if (LIST_EMPTY(&sc->sc_iflist)) {
+#else /* __rtems__ */
+		if (CK_LIST_EMPTY(&sc->sc_iflist)) {
+#endif /* __rtems__ */
 			sc->sc_ifp->if_mtu = ifr->ifr_mtu;
 			break;
 		}
 		BRIDGE_LOCK(sc);
+#ifndef __rtems__
 		LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+		CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 			if (bif->bif_ifp->if_mtu != ifr->ifr_mtu) {
 				log(LOG_NOTICE, "%s: invalid MTU: %u(%s)"
 				    " != %d\n", sc->sc_ifp->if_xname,
@@ -902,23 +1010,36 @@ bridge_mutecaps(struct bridge_softc *sc)
 	/* Initial bitmask of capabilities to test */
 	mask = BRIDGE_IFCAPS_MASK;
 
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		/* Every member must support it or its disabled */
 		mask &= bif->bif_savedcaps;
 	}
 
+#ifndef __rtems__
 	BRIDGE_XLOCK(sc);
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		enabled = bif->bif_ifp->if_capenable;
 		enabled &= ~BRIDGE_IFCAPS_STRIP;
 		/* strip off mask bits and enable them again if allowed */
 		enabled &= ~BRIDGE_IFCAPS_MASK;
 		enabled |= mask;
+#ifndef __rtems__
 		BRIDGE_UNLOCK(sc);
 		bridge_set_ifcap(sc, bif, enabled);
 		BRIDGE_LOCK(sc);
 	}
 	BRIDGE_XDROP(sc);
+#else /* __rtems__ */
+		bridge_set_ifcap(sc, bif, enabled);
+	}
+#endif /* __rtems__ */
 
 }
 
@@ -929,7 +1050,11 @@ bridge_set_ifcap(struct bridge_softc *sc, struct bridge_iflist *bif, int set)
 	struct ifreq ifr;
 	int error;
 
+#ifndef __rtems__
 	BRIDGE_UNLOCK_ASSERT(sc);
+#else /* __rtems__ */
+	BRIDGE_LOCK_ASSERT(sc);
+#endif /* __rtems__ */
 
 	bzero(&ifr, sizeof(ifr));
 	ifr.ifr_reqcap = set;
@@ -960,7 +1085,11 @@ bridge_lookup_member(struct bridge_softc *sc, const char *name)
 
 	BRIDGE_LOCK_ASSERT(sc);
 
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		ifp = bif->bif_ifp;
 		if (strcmp(ifp->if_xname, name) == 0)
 			return (bif);
@@ -979,9 +1108,15 @@ bridge_lookup_member_if(struct bridge_softc *sc, struct ifnet *member_ifp)
 {
 	struct bridge_iflist *bif;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	BRIDGE_LOCK_OR_NET_EPOCH_ASSERT(sc);
+
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		if (bif->bif_ifp == member_ifp)
 			return (bif);
 	}
@@ -1007,9 +1142,13 @@ bridge_delete_member(struct bridge_softc *sc, struct bridge_iflist *bif,
 		bstp_disable(&bif->bif_stp);
 
 	ifs->if_bridge = NULL;
+#ifndef __rtems__
 	BRIDGE_XLOCK(sc);
 	LIST_REMOVE(bif, bif_next);
 	BRIDGE_XDROP(sc);
+#else /* __rtems__ */
+	CK_LIST_REMOVE(bif, bif_next);
+#endif /* __rtems__ */
 
 	/*
 	 * If removing the interface that gave the bridge its mac address, set
@@ -1017,12 +1156,20 @@ bridge_delete_member(struct bridge_softc *sc, struct bridge_iflist *bif,
 	 * to its default address if no members are left.
 	 */
 	if (V_bridge_inherit_mac && sc->sc_ifaddr == ifs) {
+#ifndef __rtems__
 		if (LIST_EMPTY(&sc->sc_iflist)) {
+#else /* __rtems__ */
+		if (CK_LIST_EMPTY(&sc->sc_iflist)) {
+#endif /* __rtems__ */
 			bcopy(sc->sc_defaddr,
 			    IF_LLADDR(sc->sc_ifp), ETHER_ADDR_LEN);
 			sc->sc_ifaddr = NULL;
 		} else {
+#ifndef __rtems__
 			fif = LIST_FIRST(&sc->sc_iflist)->bif_ifp;
+#else /* __rtems__ */
+			fif = CK_LIST_FIRST(&sc->sc_iflist)->bif_ifp;
+#endif /* __rtems__ */
 			bcopy(IF_LLADDR(fif),
 			    IF_LLADDR(sc->sc_ifp), ETHER_ADDR_LEN);
 			sc->sc_ifaddr = fif;
@@ -1032,14 +1179,22 @@ bridge_delete_member(struct bridge_softc *sc, struct bridge_iflist *bif,
 
 	bridge_linkcheck(sc);
 	bridge_mutecaps(sc);	/* recalcuate now this interface is removed */
+#ifndef __rtems__
+	bridge_rtdelete(sc, ifs, IFBF_FLUSHALL);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
 	bridge_rtdelete(sc, ifs, IFBF_FLUSHALL);
+	BRIDGE_RT_UNLOCK(sc);
+#endif /* __rtems__ */
 	KASSERT(bif->bif_addrcnt == 0,
 	    ("%s: %d bridge routes referenced", __func__, bif->bif_addrcnt));
 
 	ifs->if_bridge_output = NULL;
 	ifs->if_bridge_input = NULL;
 	ifs->if_bridge_linkstate = NULL;
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
+#endif /* __rtems__ */
 	if (!gone) {
 		switch (ifs->if_type) {
 		case IFT_ETHER:
@@ -1066,7 +1221,20 @@ bridge_delete_member(struct bridge_softc *sc, struct bridge_iflist *bif,
 		bridge_set_ifcap(sc, bif, bif->bif_savedcaps);
 	}
 	bstp_destroy(&bif->bif_stp);	/* prepare to free */
+#ifndef __rtems__
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	epoch_call(net_epoch_preempt, &bif->bif_epoch_ctx,
+	    bridge_delete_member_cb);
+}
+
+static void
+bridge_delete_member_cb(struct epoch_context *ctx)
+{
+	struct bridge_iflist *bif;
+
+	bif = __containerof(ctx, struct bridge_iflist, bif_epoch_ctx);
+#endif /* __rtems__ */
 	free(bif, M_DEVBUF);
 }
 
@@ -1083,8 +1251,14 @@ bridge_delete_span(struct bridge_softc *sc, struct bridge_iflist *bif)
 	KASSERT(bif->bif_ifp->if_bridge == NULL,
 	    ("%s: not a span interface", __func__));
 
+#ifndef __rtems__
 	LIST_REMOVE(bif, bif_next);
 	free(bif, M_DEVBUF);
+#else /* __rtems__ */
+	CK_LIST_REMOVE(bif, bif_next);
+	epoch_call(net_epoch_preempt, &bif->bif_epoch_ctx,
+	    bridge_delete_member_cb);
+#endif /* __rtems__ */
 }
 
 static int
@@ -1102,7 +1276,11 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 		return (EINVAL);
 
 	/* If it's in the span list, it can't be a member. */
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#endif /* __rtems__ */
 		if (ifs == bif->bif_ifp)
 			return (EBUSY);
 
@@ -1140,12 +1318,18 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 		 * If any, remove all inet6 addresses from the member
 		 * interfaces.
 		 */
+#ifndef __rtems__
 		BRIDGE_XLOCK(sc);
 		LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
  			if (in6ifa_llaonifp(bif->bif_ifp)) {
 				BRIDGE_UNLOCK(sc);
 				in6_ifdetach(bif->bif_ifp);
 				BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+		CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+ 			if (in6ifa_llaonifp(bif->bif_ifp)) {
+				in6_ifdetach(bif->bif_ifp);
+#endif /* __rtems__ */
 				if_printf(sc->sc_ifp,
 				    "IPv6 addresses on %s have been removed "
 				    "before adding it as a member to prevent "
@@ -1153,11 +1337,16 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 				    bif->bif_ifp->if_xname);
 			}
 		}
+#ifndef __rtems__
 		BRIDGE_XDROP(sc);
 		if (in6ifa_llaonifp(ifs)) {
 			BRIDGE_UNLOCK(sc);
 			in6_ifdetach(ifs);
 			BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+		if (in6ifa_llaonifp(ifs)) {
+			in6_ifdetach(ifs);
+#endif /* __rtems__ */
 			if_printf(sc->sc_ifp,
 			    "IPv6 addresses on %s have been removed "
 			    "before adding it as a member to prevent "
@@ -1167,7 +1356,11 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 	}
 #endif
 	/* Allow the first Ethernet member to define the MTU */
+#ifndef __rtems__
 	if (LIST_EMPTY(&sc->sc_iflist))
+#else /* __rtems__ */
+	if (CK_LIST_EMPTY(&sc->sc_iflist))
+#endif /* __rtems__ */
 		sc->sc_ifp->if_mtu = ifs->if_mtu;
 	else if (sc->sc_ifp->if_mtu != ifs->if_mtu) {
 		if_printf(sc->sc_ifp, "invalid MTU: %u(%s) != %u\n",
@@ -1188,7 +1381,11 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 	 * member and the MAC address of the bridge has not been changed from
 	 * the default randomly generated one.
 	 */
+#ifndef __rtems__
 	if (V_bridge_inherit_mac && LIST_EMPTY(&sc->sc_iflist) &&
+#else /* __rtems__ */
+	if (V_bridge_inherit_mac && CK_LIST_EMPTY(&sc->sc_iflist) &&
+#endif /* __rtems__ */
 	    !memcmp(IF_LLADDR(sc->sc_ifp), sc->sc_defaddr, ETHER_ADDR_LEN)) {
 		bcopy(IF_LLADDR(ifs), IF_LLADDR(sc->sc_ifp), ETHER_ADDR_LEN);
 		sc->sc_ifaddr = ifs;
@@ -1200,12 +1397,19 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 	ifs->if_bridge_input = bridge_input;
 	ifs->if_bridge_linkstate = bridge_linkstate;
 	bstp_create(&sc->sc_stp, &bif->bif_stp, bif->bif_ifp);
+#ifndef __rtems__
 	/*
 	 * XXX: XLOCK HERE!?!
 	 *
 	 * NOTE: insert_***HEAD*** should be safe for the traversals.
 	 */
 	LIST_INSERT_HEAD(&sc->sc_iflist, bif, bif_next);
+#else /* __rtems__ */
+	/*
+	 * NOTE: insert_***HEAD*** should be safe for the traversals.
+	 */
+	CK_LIST_INSERT_HEAD(&sc->sc_iflist, bif, bif_next);
+#endif /* __rtems__ */
 
 	/* Set interface capabilities to the intersection set of all members */
 	bridge_mutecaps(sc);
@@ -1215,9 +1419,13 @@ bridge_ioctl_add(struct bridge_softc *sc, void *arg)
 	switch (ifs->if_type) {
 		case IFT_ETHER:
 		case IFT_L2VLAN:
+#ifndef __rtems__
 			BRIDGE_UNLOCK(sc);
 			error = ifpromisc(ifs, 1);
 			BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+			error = ifpromisc(ifs, 1);
+#endif /* __rtems__ */
 			break;
 	}
 
@@ -1327,7 +1535,13 @@ bridge_ioctl_scache(struct bridge_softc *sc, void *arg)
 	struct ifbrparam *param = arg;
 
 	sc->sc_brtmax = param->ifbrp_csize;
+#ifndef __rtems__
+	bridge_rttrim(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
 	bridge_rttrim(sc);
+	BRIDGE_RT_UNLOCK(sc);
+#endif /* __rtems__ */
 
 	return (0);
 }
@@ -1352,9 +1566,15 @@ bridge_ioctl_gifs(struct bridge_softc *sc, void *arg)
 	int count, buflen, len, error = 0;
 
 	count = 0;
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next)
 		count++;
 	LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next)
+		count++;
+	CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#endif /* __rtems__ */
 		count++;
 
 	buflen = sizeof(breq) * count;
@@ -1362,15 +1582,23 @@ bridge_ioctl_gifs(struct bridge_softc *sc, void *arg)
 		bifc->ifbic_len = buflen;
 		return (0);
 	}
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
 	outbuf = malloc(buflen, M_TEMP, M_WAITOK | M_ZERO);
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	outbuf = malloc(buflen, M_TEMP, M_WAITOK | M_ZERO);
+#endif /* __rtems__ */
 
 	count = 0;
 	buf = outbuf;
 	len = min(bifc->ifbic_len, buflen);
 	bzero(&breq, sizeof(breq));
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		if (len < sizeof(breq))
 			break;
 
@@ -1385,7 +1613,11 @@ bridge_ioctl_gifs(struct bridge_softc *sc, void *arg)
 		buf += sizeof(breq);
 		len -= sizeof(breq);
 	}
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_spanlist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next) {
+#endif /* __rtems__ */
 		if (len < sizeof(breq))
 			break;
 
@@ -1399,10 +1631,15 @@ bridge_ioctl_gifs(struct bridge_softc *sc, void *arg)
 		len -= sizeof(breq);
 	}
 
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
 	bifc->ifbic_len = sizeof(breq) * count;
 	error = copyout(outbuf, bifc->ifbic_req, bifc->ifbic_len);
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	bifc->ifbic_len = sizeof(breq) * count;
+	error = copyout(outbuf, bifc->ifbic_req, bifc->ifbic_len);
+#endif /* __rtems__ */
 	free(outbuf, M_TEMP);
 	return (error);
 }
@@ -1420,6 +1657,7 @@ bridge_ioctl_rts(struct bridge_softc *sc, void *arg)
 		return (0);
 
 	count = 0;
+#ifndef __rtems__
 	LIST_FOREACH(brt, &sc->sc_rtlist, brt_list)
 		count++;
 	buflen = sizeof(bareq) * count;
@@ -1427,14 +1665,30 @@ bridge_ioctl_rts(struct bridge_softc *sc, void *arg)
 	BRIDGE_UNLOCK(sc);
 	outbuf = malloc(buflen, M_TEMP, M_WAITOK | M_ZERO);
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
+	CK_LIST_FOREACH(brt, &sc->sc_rtlist, brt_list)
+		count++;
+	BRIDGE_RT_UNLOCK(sc);
+	buflen = sizeof(bareq) * count;
+
+	outbuf = malloc(buflen, M_TEMP, M_WAITOK | M_ZERO);
+#endif /* __rtems__ */
 
 	count = 0;
 	buf = outbuf;
 	len = min(bac->ifbac_len, buflen);
 	bzero(&bareq, sizeof(bareq));
+#ifndef __rtems__
 	LIST_FOREACH(brt, &sc->sc_rtlist, brt_list) {
 		if (len < sizeof(bareq))
 			goto out;
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
+	CK_LIST_FOREACH(brt, &sc->sc_rtlist, brt_list) {
+		if (len < sizeof(bareq))
+			break;
+#endif /* __rtems__ */
 		strlcpy(bareq.ifba_ifsname, brt->brt_ifp->if_xname,
 		    sizeof(bareq.ifba_ifsname));
 		memcpy(bareq.ifba_dst, brt->brt_addr, sizeof(brt->brt_addr));
@@ -1451,11 +1705,17 @@ bridge_ioctl_rts(struct bridge_softc *sc, void *arg)
 		buf += sizeof(bareq);
 		len -= sizeof(bareq);
 	}
+#ifndef __rtems__
 out:
 	BRIDGE_UNLOCK(sc);
 	bac->ifbac_len = sizeof(bareq) * count;
 	error = copyout(outbuf, bac->ifbac_req, bac->ifbac_len);
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_UNLOCK(sc);
+	bac->ifbac_len = sizeof(bareq) * count;
+	error = copyout(outbuf, bac->ifbac_req, bac->ifbac_len);
+#endif /* __rtems__ */
 	free(outbuf, M_TEMP);
 	return (error);
 }
@@ -1471,8 +1731,15 @@ bridge_ioctl_saddr(struct bridge_softc *sc, void *arg)
 	if (bif == NULL)
 		return (ENOENT);
 
+#ifndef __rtems__
 	error = bridge_rtupdate(sc, req->ifba_dst, req->ifba_vlan, bif, 1,
 	    req->ifba_flags);
+#else /* __rtems__ */
+	BRIDGE_RLOCK();
+	error = bridge_rtupdate(sc, req->ifba_dst, req->ifba_vlan, bif, 1,
+	    req->ifba_flags);
+	BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 
 	return (error);
 }
@@ -1499,8 +1766,18 @@ static int
 bridge_ioctl_daddr(struct bridge_softc *sc, void *arg)
 {
 	struct ifbareq *req = arg;
+#ifndef __rtems__
 
 	return (bridge_rtdaddr(sc, req->ifba_dst, req->ifba_vlan));
+#else /* __rtems__ */
+	int error;
+
+	BRIDGE_RT_LOCK(sc);
+	error = bridge_rtdaddr(sc, req->ifba_dst, req->ifba_vlan);
+	BRIDGE_RT_UNLOCK(sc);
+
+	return (error);
+#endif /* __rtems__ */
 }
 
 static int
@@ -1508,7 +1785,13 @@ bridge_ioctl_flush(struct bridge_softc *sc, void *arg)
 {
 	struct ifbreq *req = arg;
 
+#ifndef __rtems__
 	bridge_rtflush(sc, req->ifbr_ifsflags);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
+	bridge_rtflush(sc, req->ifbr_ifsflags);
+	BRIDGE_RT_UNLOCK(sc);
+#endif /* __rtems__ */
 	return (0);
 }
 
@@ -1635,7 +1918,11 @@ bridge_ioctl_addspan(struct bridge_softc *sc, void *arg)
 	if (ifs == NULL)
 		return (ENOENT);
 
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#endif /* __rtems__ */
 		if (ifs == bif->bif_ifp)
 			return (EBUSY);
 
@@ -1658,7 +1945,11 @@ bridge_ioctl_addspan(struct bridge_softc *sc, void *arg)
 	bif->bif_ifp = ifs;
 	bif->bif_flags = IFBIF_SPAN;
 
+#ifndef __rtems__
 	LIST_INSERT_HEAD(&sc->sc_spanlist, bif, bif_next);
+#else /* __rtems__ */
+	CK_LIST_INSERT_HEAD(&sc->sc_spanlist, bif, bif_next);
+#endif /* __rtems__ */
 
 	return (0);
 }
@@ -1674,7 +1965,11 @@ bridge_ioctl_delspan(struct bridge_softc *sc, void *arg)
 	if (ifs == NULL)
 		return (ENOENT);
 
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#endif /* __rtems__ */
 		if (ifs == bif->bif_ifp)
 			break;
 
@@ -1736,7 +2031,11 @@ bridge_ioctl_gifsstp(struct bridge_softc *sc, void *arg)
 	int count, buflen, len, error = 0;
 
 	count = 0;
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		if ((bif->bif_flags & IFBIF_STP) != 0)
 			count++;
 	}
@@ -1747,15 +2046,23 @@ bridge_ioctl_gifsstp(struct bridge_softc *sc, void *arg)
 		return (0);
 	}
 
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
 	outbuf = malloc(buflen, M_TEMP, M_WAITOK | M_ZERO);
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	outbuf = malloc(buflen, M_TEMP, M_WAITOK | M_ZERO);
+#endif /* __rtems__ */
 
 	count = 0;
 	buf = outbuf;
 	len = min(bifstp->ifbpstp_len, buflen);
 	bzero(&bpreq, sizeof(bpreq));
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		if (len < sizeof(bpreq))
 			break;
 
@@ -1776,10 +2083,15 @@ bridge_ioctl_gifsstp(struct bridge_softc *sc, void *arg)
 		len -= sizeof(bpreq);
 	}
 
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
 	bifstp->ifbpstp_len = sizeof(bpreq) * count;
 	error = copyout(outbuf, bifstp->ifbpstp_req, bifstp->ifbpstp_len);
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	bifstp->ifbpstp_len = sizeof(bpreq) * count;
+	error = copyout(outbuf, bifstp->ifbpstp_req, bifstp->ifbpstp_len);
+#endif /* __rtems__ */
 	free(outbuf, M_TEMP);
 	return (error);
 }
@@ -1837,7 +2149,11 @@ bridge_ifdetach(void *arg __unused, struct ifnet *ifp)
 	BRIDGE_LIST_LOCK();
 	LIST_FOREACH(sc, &V_bridge_list, sc_list) {
 		BRIDGE_LOCK(sc);
+#ifndef __rtems__
 		LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#else /* __rtems__ */
+		CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next)
+#endif /* __rtems__ */
 			if (ifp == bif->bif_ifp) {
 				bridge_delete_span(sc, bif);
 				break;
@@ -1863,8 +2179,15 @@ bridge_init(void *xsc)
 		return;
 
 	BRIDGE_LOCK(sc);
+#ifndef __rtems__
+	callout_reset(&sc->sc_brcallout, bridge_rtable_prune_period * hz,
+	    bridge_timer, sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
 	callout_reset(&sc->sc_brcallout, bridge_rtable_prune_period * hz,
 	    bridge_timer, sc);
+	BRIDGE_RT_UNLOCK(sc);
+#endif /* __rtems__ */
 
 	ifp->if_drv_flags |= IFF_DRV_RUNNING;
 	bstp_init(&sc->sc_stp);		/* Initialize Spanning Tree */
@@ -1887,10 +2210,21 @@ bridge_stop(struct ifnet *ifp, int disable)
 	if ((ifp->if_drv_flags & IFF_DRV_RUNNING) == 0)
 		return;
 
+#ifndef __rtems__
+	callout_stop(&sc->sc_brcallout);
+	bstp_stop(&sc->sc_stp);
+
+	bridge_rtflush(sc, IFBF_FLUSHDYN);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
 	callout_stop(&sc->sc_brcallout);
+	BRIDGE_RT_UNLOCK(sc);
 	bstp_stop(&sc->sc_stp);
 
+	BRIDGE_RT_LOCK(sc);
 	bridge_rtflush(sc, IFBF_FLUSHDYN);
+	BRIDGE_RT_UNLOCK(sc);
+#endif /* __rtems__ */
 
 	ifp->if_drv_flags &= ~IFF_DRV_RUNNING;
 }
@@ -2015,7 +2349,11 @@ bridge_output(struct ifnet *ifp, struct mbuf *m, struct sockaddr *sa,
 	sc = ifp->if_bridge;
 	vlan = VLANTAGOF(m);
 
+#ifndef __rtems__
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	BRIDGE_RLOCK();
+#endif /* __rtems__ */
 
 	/*
 	 * If bridge is down, but the original output interface is up,
@@ -2038,6 +2376,7 @@ bridge_output(struct ifnet *ifp, struct mbuf *m, struct sockaddr *sa,
 	if (dst_if == NULL) {
 		struct bridge_iflist *bif;
 		struct mbuf *mc;
+#ifndef __rtems__
 		int error = 0, used = 0;
 
 		bridge_span(sc, m);
@@ -2049,6 +2388,13 @@ bridge_output(struct ifnet *ifp, struct mbuf *m, struct sockaddr *sa,
 		}
 
 		LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+		int used = 0;
+
+		bridge_span(sc, m);
+
+		CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 			dst_if = bif->bif_ifp;
 
 			if (dst_if->if_type == IFT_GIF)
@@ -2066,7 +2412,11 @@ bridge_output(struct ifnet *ifp, struct mbuf *m, struct sockaddr *sa,
 			    bif->bif_stp.bp_state == BSTP_IFSTATE_DISCARDING)
 				continue;
 
+#ifndef __rtems__
 			if (LIST_NEXT(bif, bif_next) == NULL) {
+#else /* __rtems__ */
+			if (CK_LIST_NEXT(bif, bif_next) == NULL) {
+#endif /* __rtems__ */
 				used = 1;
 				mc = m;
 			} else {
@@ -2081,7 +2431,11 @@ bridge_output(struct ifnet *ifp, struct mbuf *m, struct sockaddr *sa,
 		}
 		if (used == 0)
 			m_freem(m);
+#ifndef __rtems__
 		BRIDGE_UNREF(sc);
+#else /* __rtems__ */
+		BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 		return (0);
 	}
 
@@ -2093,12 +2447,21 @@ sendunicast:
 	bridge_span(sc, m);
 	if ((dst_if->if_drv_flags & IFF_DRV_RUNNING) == 0) {
 		m_freem(m);
+#ifndef __rtems__
 		BRIDGE_UNLOCK(sc);
 		return (0);
 	}
 
 	BRIDGE_UNLOCK(sc);
 	bridge_enqueue(sc, dst_if, m);
+#else /* __rtems__ */
+		BRIDGE_RUNLOCK();
+		return (0);
+	}
+
+	bridge_enqueue(sc, dst_if, m);
+	BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 	return (0);
 }
 
@@ -2122,6 +2485,7 @@ bridge_transmit(struct ifnet *ifp, struct mbuf *m)
 
 	eh = mtod(m, struct ether_header *);
 
+#ifndef __rtems__
 	BRIDGE_LOCK(sc);
 	if (((m->m_flags & (M_BCAST|M_MCAST)) == 0) &&
 	    (dst_if = bridge_rtlookup(sc, eh->ether_dhost, 1)) != NULL) {
@@ -2129,6 +2493,15 @@ bridge_transmit(struct ifnet *ifp, struct mbuf *m)
 		error = bridge_enqueue(sc, dst_if, m);
 	} else
 		bridge_broadcast(sc, ifp, m, 0);
+#else /* __rtems__ */
+	BRIDGE_RLOCK();
+	if (((m->m_flags & (M_BCAST|M_MCAST)) == 0) &&
+	    (dst_if = bridge_rtlookup(sc, eh->ether_dhost, 1)) != NULL) {
+		error = bridge_enqueue(sc, dst_if, m);
+	} else
+		bridge_broadcast(sc, ifp, m, 0);
+	BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 
 	return (error);
 }
@@ -2141,6 +2514,7 @@ bridge_qflush(struct ifnet *ifp __unused)
 {
 }
 
+#ifndef __rtems__
 /*
  * bridge_forward:
  *
@@ -2148,6 +2522,13 @@ bridge_qflush(struct ifnet *ifp __unused)
  *
  *	NOTE: Releases the lock on return.
  */
+#else /* __rtems__ */
+/*
+ * bridge_forward:
+ *
+ *	The forwarding function of the bridge.
+ */
+#endif /* __rtems__ */
 static void
 bridge_forward(struct bridge_softc *sc, struct bridge_iflist *sbif,
     struct mbuf *m)
@@ -2158,6 +2539,10 @@ bridge_forward(struct bridge_softc *sc, struct bridge_iflist *sbif,
 	uint16_t vlan;
 	uint8_t *dst;
 	int error;
+#ifdef __rtems__
+
+	BRIDGE_RLOCK_ASSERT();
+#endif /* __rtems__ */
 
 	src_if = m->m_pkthdr.rcvif;
 	ifp = sc->sc_ifp;
@@ -2237,12 +2622,16 @@ bridge_forward(struct bridge_softc *sc, struct bridge_iflist *sbif,
 	    || PFIL_HOOKED(&V_inet6_pfil_hook)
 #endif
 	    ) {
+#ifndef __rtems__
 		BRIDGE_UNLOCK(sc);
+#endif /* __rtems__ */
 		if (bridge_pfil(&m, ifp, src_if, PFIL_IN) != 0)
 			return;
 		if (m == NULL)
 			return;
+#ifndef __rtems__
 		BRIDGE_LOCK(sc);
+#endif /* __rtems__ */
 	}
 
 	if (dst_if == NULL) {
@@ -2270,8 +2659,10 @@ bridge_forward(struct bridge_softc *sc, struct bridge_iflist *sbif,
 	    dbif->bif_stp.bp_state == BSTP_IFSTATE_DISCARDING)
 		goto drop;
 
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
 
+#endif /* __rtems__ */
 	if (PFIL_HOOKED(&V_inet_pfil_hook)
 #ifdef INET6
 	    || PFIL_HOOKED(&V_inet6_pfil_hook)
@@ -2287,7 +2678,9 @@ bridge_forward(struct bridge_softc *sc, struct bridge_iflist *sbif,
 	return;
 
 drop:
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
+#endif /* __rtems__ */
 	m_freem(m);
 }
 
@@ -2328,10 +2721,17 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 		m_freem(m);
 		return (NULL);
 	}
+#ifndef __rtems__
 	BRIDGE_LOCK(sc);
 	bif = bridge_lookup_member_if(sc, ifp);
 	if (bif == NULL) {
 		BRIDGE_UNLOCK(sc);
+#else /* __rtems__ */
+	BRIDGE_RLOCK();
+	bif = bridge_lookup_member_if(sc, ifp);
+	if (bif == NULL) {
+		BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 		return (m);
 	}
 
@@ -2344,13 +2744,21 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 		if (memcmp(eh->ether_dhost, bstp_etheraddr,
 		    ETHER_ADDR_LEN) == 0) {
 			bstp_input(&bif->bif_stp, ifp, m); /* consumes mbuf */
+#ifndef __rtems__
 			BRIDGE_UNLOCK(sc);
+#else /* __rtems__ */
+			BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 			return (NULL);
 		}
 
 		if ((bif->bif_flags & IFBIF_STP) &&
 		    bif->bif_stp.bp_state == BSTP_IFSTATE_DISCARDING) {
+#ifndef __rtems__
 			BRIDGE_UNLOCK(sc);
+#else /* __rtems__ */
+			BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 			return (m);
 		}
 
@@ -2361,7 +2769,11 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 		 */
 		mc = m_dup(m, M_NOWAIT);
 		if (mc == NULL) {
+#ifndef __rtems__
 			BRIDGE_UNLOCK(sc);
+#else /* __rtems__ */
+			BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 			return (m);
 		}
 
@@ -2387,13 +2799,21 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 			(*bifp->if_input)(bifp, mc2);
 		}
 
+#ifdef __rtems__
+		BRIDGE_RUNLOCK();
+
+#endif /* __rtems__ */
 		/* Return the original packet for local processing. */
 		return (m);
 	}
 
 	if ((bif->bif_flags & IFBIF_STP) &&
 	    bif->bif_stp.bp_state == BSTP_IFSTATE_DISCARDING) {
+#ifndef __rtems__
 		BRIDGE_UNLOCK(sc);
+#else /* __rtems__ */
+		BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 		return (m);
 	}
 
@@ -2416,6 +2836,7 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 #   define OR_PFIL_HOOKED_INET6
 #endif
 
+#ifndef __rtems__
 #define GRAB_OUR_PACKETS(iface) \
 	if ((iface)->if_type == IFT_GIF) \
 		continue; \
@@ -2461,6 +2882,53 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 		m_freem(m);						\
 		return (NULL);						\
 	}
+#else /* __rtems__ */
+#define GRAB_OUR_PACKETS(iface) \
+	if ((iface)->if_type == IFT_GIF) \
+		continue; \
+	/* It is destined for us. */ \
+	if (memcmp(IF_LLADDR((iface)), eh->ether_dhost,  ETHER_ADDR_LEN) == 0 \
+	    OR_CARP_CHECK_WE_ARE_DST((iface))				\
+	    ) {								\
+		if ((iface)->if_type == IFT_BRIDGE) {			\
+			ETHER_BPF_MTAP(iface, m);			\
+			if_inc_counter(iface, IFCOUNTER_IPACKETS, 1);				\
+			if_inc_counter(iface, IFCOUNTER_IBYTES, m->m_pkthdr.len);		\
+			/* Filter on the physical interface. */		\
+			if (V_pfil_local_phys &&			\
+			    (PFIL_HOOKED(&V_inet_pfil_hook)		\
+			     OR_PFIL_HOOKED_INET6)) {			\
+				if (bridge_pfil(&m, NULL, ifp,		\
+				    PFIL_IN) != 0 || m == NULL) {	\
+					BRIDGE_RUNLOCK();		\
+					return (NULL);			\
+				}					\
+				eh = mtod(m, struct ether_header *);	\
+			}						\
+		}							\
+		if (bif->bif_flags & IFBIF_LEARNING) {			\
+			error = bridge_rtupdate(sc, eh->ether_shost,	\
+			    vlan, bif, 0, IFBAF_DYNAMIC);		\
+			if (error && bif->bif_addrmax) {		\
+				BRIDGE_RUNLOCK();			\
+				m_freem(m);				\
+				return (NULL);				\
+			}						\
+		}							\
+		m->m_pkthdr.rcvif = iface;				\
+		BRIDGE_RUNLOCK();					\
+		return (m);						\
+	}								\
+									\
+	/* We just received a packet that we sent out. */		\
+	if (memcmp(IF_LLADDR((iface)), eh->ether_shost, ETHER_ADDR_LEN) == 0 \
+	    OR_CARP_CHECK_WE_ARE_SRC((iface))			\
+	    ) {								\
+		BRIDGE_RUNLOCK();					\
+		m_freem(m);						\
+		return (NULL);						\
+	}
+#endif /* __rtems__ */
 
 	/*
 	 * Unicast.  Make sure it's not for the bridge.
@@ -2477,7 +2945,11 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 	do { GRAB_OUR_PACKETS(ifp) } while (0);
 
 	/* Now check the all bridge members. */
+#ifndef __rtems__
 	LIST_FOREACH(bif2, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif2, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		GRAB_OUR_PACKETS(bif2->bif_ifp)
 	}
 
@@ -2488,10 +2960,14 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
 
 	/* Perform the bridge forwarding function. */
 	bridge_forward(sc, bif, m);
+#ifdef __rtems__
+	BRIDGE_RUNLOCK();
+#endif /* __rtems__ */
 
 	return (NULL);
 }
 
+#ifndef __rtems__
 /*
  * bridge_broadcast:
  *
@@ -2501,6 +2977,15 @@ bridge_input(struct ifnet *ifp, struct mbuf *m)
  *
  *	NOTE: Releases the lock on return.
  */
+#else /* __rtems__ */
+/*
+ * bridge_broadcast:
+ *
+ *	Send a frame to all interfaces that are members of
+ *	the bridge, except for the one on which the packet
+ *	arrived.
+ */
+#endif /* __rtems__ */
 static void
 bridge_broadcast(struct bridge_softc *sc, struct ifnet *src_if,
     struct mbuf *m, int runfilt)
@@ -2508,6 +2993,7 @@ bridge_broadcast(struct bridge_softc *sc, struct ifnet *src_if,
 	struct bridge_iflist *dbif, *sbif;
 	struct mbuf *mc;
 	struct ifnet *dst_if;
+#ifndef __rtems__
 	int error = 0, used = 0, i;
 
 	sbif = bridge_lookup_member_if(sc, src_if);
@@ -2517,6 +3003,13 @@ bridge_broadcast(struct bridge_softc *sc, struct ifnet *src_if,
 		m_freem(m);
 		return;
 	}
+#else /* __rtems__ */
+	int used = 0, i;
+
+	BRIDGE_RLOCK_ASSERT();
+
+	sbif = bridge_lookup_member_if(sc, src_if);
+#endif /* __rtems__ */
 
 	/* Filter on the bridge interface before broadcasting */
 	if (runfilt && (PFIL_HOOKED(&V_inet_pfil_hook)
@@ -2525,12 +3018,21 @@ bridge_broadcast(struct bridge_softc *sc, struct ifnet *src_if,
 #endif
 	    )) {
 		if (bridge_pfil(&m, sc->sc_ifp, NULL, PFIL_OUT) != 0)
+#ifndef __rtems__
 			goto out;
 		if (m == NULL)
 			goto out;
 	}
 
 	LIST_FOREACH(dbif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+			return;
+		if (m == NULL)
+			return;
+	}
+
+	CK_LIST_FOREACH(dbif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		dst_if = dbif->bif_ifp;
 		if (dst_if == src_if)
 			continue;
@@ -2550,7 +3052,11 @@ bridge_broadcast(struct bridge_softc *sc, struct ifnet *src_if,
 		if ((dst_if->if_drv_flags & IFF_DRV_RUNNING) == 0)
 			continue;
 
+#ifndef __rtems__
 		if (LIST_NEXT(dbif, bif_next) == NULL) {
+#else /* __rtems__ */
+		if (CK_LIST_NEXT(dbif, bif_next) == NULL) {
+#endif /* __rtems__ */
 			mc = m;
 			used = 1;
 		} else {
@@ -2590,9 +3096,11 @@ bridge_broadcast(struct bridge_softc *sc, struct ifnet *src_if,
 	}
 	if (used == 0)
 		m_freem(m);
+#ifndef __rtems__
 
 out:
 	BRIDGE_UNREF(sc);
+#endif /* __rtems__ */
 }
 
 /*
@@ -2608,10 +3116,19 @@ bridge_span(struct bridge_softc *sc, struct mbuf *m)
 	struct ifnet *dst_if;
 	struct mbuf *mc;
 
+#ifndef __rtems__
 	if (LIST_EMPTY(&sc->sc_spanlist))
 		return;
 
 	LIST_FOREACH(bif, &sc->sc_spanlist, bif_next) {
+#else /* __rtems__ */
+	BRIDGE_RLOCK_ASSERT();
+
+	if (CK_LIST_EMPTY(&sc->sc_spanlist))
+		return;
+
+	CK_LIST_FOREACH(bif, &sc->sc_spanlist, bif_next) {
+#endif /* __rtems__ */
 		dst_if = bif->bif_ifp;
 
 		if ((dst_if->if_drv_flags & IFF_DRV_RUNNING) == 0)
@@ -2636,10 +3153,18 @@ static int
 bridge_rtupdate(struct bridge_softc *sc, const uint8_t *dst, uint16_t vlan,
     struct bridge_iflist *bif, int setflags, uint8_t flags)
 {
+#ifndef __rtems__
 	struct bridge_rtnode *brt;
 	int error;
 
 	BRIDGE_LOCK_ASSERT(sc);
+#else /* __rtems__ */
+	struct bridge_rtnode *brt, *nbrt;
+	unsigned long expire;
+	int error;
+
+	BRIDGE_RLOCK_ASSERT();
+#endif /* __rtems__ */
 
 	/* Check the source address is valid and not multicast. */
 	if (ETHER_IS_MULTICAST(dst) ||
@@ -2651,10 +3176,18 @@ bridge_rtupdate(struct bridge_softc *sc, const uint8_t *dst, uint16_t vlan,
 	if (vlan == 0)
 		vlan = 1;
 
+#ifndef __rtems__
 	/*
 	 * A route for this destination might already exist.  If so,
 	 * update it, otherwise create a new one.
 	 */
+#else /* __rtems__ */
+	/*
+	 * A route for this destination might already exist.  If so,
+	 * update it, otherwise create a new one.  The lookup is lockless,
+	 * the rt lock is only taken to insert or move a node.
+	 */
+#endif /* __rtems__ */
 	if ((brt = bridge_rtnode_lookup(sc, dst, vlan)) == NULL) {
 		if (sc->sc_brtcnt >= sc->sc_brtmax) {
 			sc->sc_brtexceeded++;
@@ -2671,6 +3204,7 @@ bridge_rtupdate(struct bridge_softc *sc, const uint8_t *dst, uint16_t vlan,
 		 * initialize the expiration time and Ethernet
 		 * address.
 		 */
+#ifndef __rtems__
 		brt = uma_zalloc(bridge_rtnode_zone, M_NOWAIT | M_ZERO);
 		if (brt == NULL)
 			return (ENOMEM);
@@ -2689,10 +3223,56 @@ bridge_rtupdate(struct bridge_softc *sc, const uint8_t *dst, uint16_t vlan,
 		}
 		brt->brt_dst = bif;
 		bif->bif_addrcnt++;
+#else /* __rtems__ */
+		nbrt = uma_zalloc(bridge_rtnode_zone, M_NOWAIT | M_ZERO);
+		if (nbrt == NULL)
+			return (ENOMEM);
+
+		if (bif->bif_flags & IFBIF_STICKY)
+			nbrt->brt_flags = IFBAF_STICKY;
+		else
+			nbrt->brt_flags = IFBAF_DYNAMIC;
+
+		memcpy(nbrt->brt_addr, dst, ETHER_ADDR_LEN);
+		nbrt->brt_vlan = vlan;
+		nbrt->brt_dst = bif;
+
+		/*
+		 * Another CPU may have learned the address or removed the
+		 * member in the meantime, so check again with the lock held.
+		 */
+		error = 0;
+		BRIDGE_RT_LOCK(sc);
+		brt = bridge_rtnode_lookup(sc, dst, vlan);
+		if (brt == NULL) {
+			if (bif->bif_ifp->if_bridge != sc)
+				error = ENOENT;
+			else if (sc->sc_brtcnt >= sc->sc_brtmax) {
+				sc->sc_brtexceeded++;
+				error = ENOSPC;
+			} else if (bif->bif_addrmax &&
+			    bif->bif_addrcnt >= bif->bif_addrmax) {
+				bif->bif_addrexceeded++;
+				error = ENOSPC;
+			} else
+				error = bridge_rtnode_insert(sc, nbrt);
+			if (error == 0) {
+				bif->bif_addrcnt++;
+				brt = nbrt;
+				nbrt = NULL;
+			}
+		}
+		BRIDGE_RT_UNLOCK(sc);
+		if (nbrt != NULL)
+			uma_zfree(bridge_rtnode_zone, nbrt);
+		if (error != 0)
+			return (error);
+#endif /* __rtems__ */
 	}
 
 	if ((brt->brt_flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC &&
 	    brt->brt_dst != bif) {
+#ifndef __rtems__
 		brt->brt_dst->bif_addrcnt--;
 		brt->brt_dst = bif;
 		brt->brt_dst->bif_addrcnt++;
@@ -2700,6 +3280,27 @@ bridge_rtupdate(struct bridge_softc *sc, const uint8_t *dst, uint16_t vlan,
 
 	if ((flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC)
 		brt->brt_expire = time_uptime + sc->sc_brttimeout;
+#else /* __rtems__ */
+		BRIDGE_RT_LOCK(sc);
+		if (bif->bif_ifp->if_bridge == sc &&
+		    bridge_rtnode_lookup(sc, dst, vlan) == brt) {
+			brt->brt_dst->bif_addrcnt--;
+			brt->brt_dst = bif;
+			brt->brt_dst->bif_addrcnt++;
+		}
+		BRIDGE_RT_UNLOCK(sc);
+	}
+
+	/*
+	 * Only store a new expiration time once per second, so that frames
+	 * from a known source on different CPUs do not write to the node.
+	 */
+	if ((flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC) {
+		expire = time_uptime + sc->sc_brttimeout;
+		if (brt->brt_expire != expire)
+			brt->brt_expire = expire;
+	}
+#endif /* __rtems__ */
 	if (setflags)
 		brt->brt_flags = flags;
 
@@ -2716,7 +3317,11 @@ bridge_rtlookup(struct bridge_softc *sc, const uint8_t *addr, uint16_t vlan)
 {
 	struct bridge_rtnode *brt;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_OR_NET_EPOCH_ASSERT(sc);
+#endif /* __rtems__ */
 
 	if ((brt = bridge_rtnode_lookup(sc, addr, vlan)) == NULL)
 		return (NULL);
@@ -2736,7 +3341,11 @@ bridge_rttrim(struct bridge_softc *sc)
 {
 	struct bridge_rtnode *brt, *nbrt;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+#endif /* __rtems__ */
 
 	/* Make sure we actually need to do this. */
 	if (sc->sc_brtcnt <= sc->sc_brtmax)
@@ -2747,7 +3356,11 @@ bridge_rttrim(struct bridge_softc *sc)
 	if (sc->sc_brtcnt <= sc->sc_brtmax)
 		return;
 
+#ifndef __rtems__
 	LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#endif /* __rtems__ */
 		if ((brt->brt_flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC) {
 			bridge_rtnode_destroy(sc, brt);
 			if (sc->sc_brtcnt <= sc->sc_brtmax)
@@ -2766,7 +3379,11 @@ bridge_timer(void *arg)
 {
 	struct bridge_softc *sc = arg;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+#endif /* __rtems__ */
 
 	bridge_rtage(sc);
 
@@ -2785,9 +3402,15 @@ bridge_rtage(struct bridge_softc *sc)
 {
 	struct bridge_rtnode *brt, *nbrt;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+
+	CK_LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#endif /* __rtems__ */
 		if ((brt->brt_flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC) {
 			if (time_uptime >= brt->brt_expire)
 				bridge_rtnode_destroy(sc, brt);
@@ -2805,9 +3428,15 @@ bridge_rtflush(struct bridge_softc *sc, int full)
 {
 	struct bridge_rtnode *brt, *nbrt;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+
+	CK_LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#endif /* __rtems__ */
 		if (full || (brt->brt_flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC)
 			bridge_rtnode_destroy(sc, brt);
 	}
@@ -2824,7 +3453,11 @@ bridge_rtdaddr(struct bridge_softc *sc, const uint8_t *addr, uint16_t vlan)
 	struct bridge_rtnode *brt;
 	int found = 0;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+#endif /* __rtems__ */
 
 	/*
 	 * If vlan is zero then we want to delete for all vlans so the lookup
@@ -2848,9 +3481,15 @@ bridge_rtdelete(struct bridge_softc *sc, struct ifnet *ifp, int full)
 {
 	struct bridge_rtnode *brt, *nbrt;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+
+	CK_LIST_FOREACH_SAFE(brt, &sc->sc_rtlist, brt_list, nbrt) {
+#endif /* __rtems__ */
 		if (brt->brt_ifp == ifp && (full ||
 			    (brt->brt_flags & IFBAF_TYPEMASK) == IFBAF_DYNAMIC))
 			bridge_rtnode_destroy(sc, brt);
@@ -2871,10 +3510,17 @@ bridge_rtable_init(struct bridge_softc *sc)
 	    M_DEVBUF, M_WAITOK);
 
 	for (i = 0; i < BRIDGE_RTHASH_SIZE; i++)
+#ifndef __rtems__
 		LIST_INIT(&sc->sc_rthash[i]);
 
 	sc->sc_rthash_key = arc4random();
 	LIST_INIT(&sc->sc_rtlist);
+#else /* __rtems__ */
+		CK_LIST_INIT(&sc->sc_rthash[i]);
+
+	sc->sc_rthash_key = arc4random();
+	CK_LIST_INIT(&sc->sc_rtlist);
+#endif /* __rtems__ */
 }
 
 /*
@@ -2952,10 +3598,17 @@ bridge_rtnode_lookup(struct bridge_softc *sc, const uint8_t *addr, uint16_t vlan
 	uint32_t hash;
 	int dir;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	hash = bridge_rthash(sc, addr);
 	LIST_FOREACH(brt, &sc->sc_rthash[hash], brt_hash) {
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_OR_NET_EPOCH_ASSERT(sc);
+
+	hash = bridge_rthash(sc, addr);
+	CK_LIST_FOREACH(brt, &sc->sc_rthash[hash], brt_hash) {
+#endif /* __rtems__ */
 		dir = bridge_rtnode_addr_cmp(addr, brt->brt_addr);
 		if (dir == 0 && (brt->brt_vlan == vlan || vlan == 0))
 			return (brt);
@@ -2979,6 +3632,7 @@ bridge_rtnode_insert(struct bridge_softc *sc, struct bridge_rtnode *brt)
 	uint32_t hash;
 	int dir;
 
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	hash = bridge_rthash(sc, brt->brt_addr);
@@ -2986,6 +3640,15 @@ bridge_rtnode_insert(struct bridge_softc *sc, struct bridge_rtnode *brt)
 	lbrt = LIST_FIRST(&sc->sc_rthash[hash]);
 	if (lbrt == NULL) {
 		LIST_INSERT_HEAD(&sc->sc_rthash[hash], brt, brt_hash);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+
+	hash = bridge_rthash(sc, brt->brt_addr);
+
+	lbrt = CK_LIST_FIRST(&sc->sc_rthash[hash]);
+	if (lbrt == NULL) {
+		CK_LIST_INSERT_HEAD(&sc->sc_rthash[hash], brt, brt_hash);
+#endif /* __rtems__ */
 		goto out;
 	}
 
@@ -2994,6 +3657,7 @@ bridge_rtnode_insert(struct bridge_softc *sc, struct bridge_rtnode *brt)
 		if (dir == 0 && brt->brt_vlan == lbrt->brt_vlan)
 			return (EEXIST);
 		if (dir > 0) {
+#ifndef __rtems__
 			LIST_INSERT_BEFORE(lbrt, brt, brt_hash);
 			goto out;
 		}
@@ -3002,6 +3666,16 @@ bridge_rtnode_insert(struct bridge_softc *sc, struct bridge_rtnode *brt)
 			goto out;
 		}
 		lbrt = LIST_NEXT(lbrt, brt_hash);
+#else /* __rtems__ */
+			CK_LIST_INSERT_BEFORE(lbrt, brt, brt_hash);
+			goto out;
+		}
+		if (CK_LIST_NEXT(lbrt, brt_hash) == NULL) {
+			CK_LIST_INSERT_AFTER(lbrt, brt, brt_hash);
+			goto out;
+		}
+		lbrt = CK_LIST_NEXT(lbrt, brt_hash);
+#endif /* __rtems__ */
 	} while (lbrt != NULL);
 
 #ifdef DIAGNOSTIC
@@ -3009,7 +3683,11 @@ bridge_rtnode_insert(struct bridge_softc *sc, struct bridge_rtnode *brt)
 #endif
 
 out:
+#ifndef __rtems__
 	LIST_INSERT_HEAD(&sc->sc_rtlist, brt, brt_list);
+#else /* __rtems__ */
+	CK_LIST_INSERT_HEAD(&sc->sc_rtlist, brt, brt_list);
+#endif /* __rtems__ */
 	sc->sc_brtcnt++;
 
 	return (0);
@@ -3023,6 +3701,7 @@ out:
 static void
 bridge_rtnode_destroy(struct bridge_softc *sc, struct bridge_rtnode *brt)
 {
+#ifndef __rtems__
 	BRIDGE_LOCK_ASSERT(sc);
 
 	LIST_REMOVE(brt, brt_hash);
@@ -3030,6 +3709,25 @@ bridge_rtnode_destroy(struct bridge_softc *sc, struct bridge_rtnode *brt)
 	LIST_REMOVE(brt, brt_list);
 	sc->sc_brtcnt--;
 	brt->brt_dst->bif_addrcnt--;
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK_ASSERT(sc);
+
+	CK_LIST_REMOVE(brt, brt_hash);
+
+	CK_LIST_REMOVE(brt, brt_list);
+	sc->sc_brtcnt--;
+	brt->brt_dst->bif_addrcnt--;
+	epoch_call(net_epoch_preempt, &brt->brt_epoch_ctx,
+	    bridge_rtnode_destroy_cb);
+}
+
+static void
+bridge_rtnode_destroy_cb(struct epoch_context *ctx)
+{
+	struct bridge_rtnode *brt;
+
+	brt = __containerof(ctx, struct bridge_rtnode, brt_epoch_ctx);
+#endif /* __rtems__ */
 	uma_zfree(bridge_rtnode_zone, brt);
 }
 
@@ -3044,7 +3742,11 @@ bridge_rtable_expire(struct ifnet *ifp, int age)
 	struct bridge_softc *sc = ifp->if_bridge;
 	struct bridge_rtnode *brt;
 
+#ifndef __rtems__
 	BRIDGE_LOCK(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_LOCK(sc);
+#endif /* __rtems__ */
 
 	/*
 	 * If the age is zero then flush, otherwise set all the expiry times to
@@ -3053,7 +3755,11 @@ bridge_rtable_expire(struct ifnet *ifp, int age)
 	if (age == 0)
 		bridge_rtdelete(sc, ifp, IFBF_FLUSHDYN);
 	else {
+#ifndef __rtems__
 		LIST_FOREACH(brt, &sc->sc_rtlist, brt_list) {
+#else /* __rtems__ */
+		CK_LIST_FOREACH(brt, &sc->sc_rtlist, brt_list) {
+#endif /* __rtems__ */
 			/* Cap the expiry time to 'age' */
 			if (brt->brt_ifp == ifp &&
 			    brt->brt_expire > time_uptime + age &&
@@ -3061,7 +3767,11 @@ bridge_rtable_expire(struct ifnet *ifp, int age)
 				brt->brt_expire = time_uptime + age;
 		}
 	}
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
+#else /* __rtems__ */
+	BRIDGE_RT_UNLOCK(sc);
+#endif /* __rtems__ */
 }
 
 /*
@@ -3581,9 +4291,14 @@ bridge_linkstate(struct ifnet *ifp)
 		return;
 	}
 	bridge_linkcheck(sc);
+#ifndef __rtems__
 	BRIDGE_UNLOCK(sc);
 
 	bstp_linkstate(&bif->bif_stp);
+#else /* __rtems__ */
+	bstp_linkstate(&bif->bif_stp);
+	BRIDGE_UNLOCK(sc);
+#endif /* __rtems__ */
 }
 
 static void
@@ -3596,7 +4311,11 @@ bridge_linkcheck(struct bridge_softc *sc)
 	new_link = LINK_STATE_DOWN;
 	hasls = 0;
 	/* Our link is considered up if at least one of our ports is active */
+#ifndef __rtems__
 	LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#else /* __rtems__ */
+	CK_LIST_FOREACH(bif, &sc->sc_iflist, bif_next) {
+#endif /* __rtems__ */
 		if (bif->bif_ifp->if_capabilities & IFCAP_LINKSTATE)
 			hasls++;
 		if (bif->bif_ifp->if_link_state == LINK_STATE_UP) {
@@ -3604,7 +4323,11 @@ bridge_linkcheck(struct bridge_softc *sc)
 			break;
 		}
 	}
+#ifndef __rtems__
 	if (!LIST_EMPTY(&sc->sc_iflist) && !hasls) {
+#else /* __rtems__ */
+	if (!CK_LIST_EMPTY(&sc->sc_iflist) && !hasls) {
+#endif /* __rtems__ */
 		/* If no interfaces support link-state then we default to up */
 		new_link = LINK_STATE_UP;
 	}
@@ -271,6 +271,7 @@ struct ifbpstpconf {
 
 #ifdef _KERNEL
 
+#ifndef __rtems__
 #define BRIDGE_LOCK_INIT(_sc)		do {			\
 	mtx_init(&(_sc)->sc_mtx, "if_bridge", NULL, MTX_DEF);	\
 	cv_init(&(_sc)->sc_cv, "if_bridge_cv");			\
@@ -309,6 +310,7 @@ struct ifbpstpconf {
 	(_sc)->sc_iflist_xcnt--;		\
 } while (0)
 
+#endif /* __rtems__ */
 #define BRIDGE_INPUT(_ifp, _m)		do {			\
 		KASSERT((_ifp)->if_bridge_input != NULL,		\
 	    ("%s: if_bridge not loaded!", __func__));	\
@@ -86,6 +86,9 @@
 #include <netinet6/nd6.h>
 #endif
 #include <security/mac/mac_framework.h>
+#ifdef __rtems__
+#include <net/if_gso.h>
+#endif /* __rtems__ */
 
 #ifdef CTASSERT
 CTASSERT(sizeof (struct ether_header) == ETHER_ADDR_LEN * 2 + 2);
@@ -118,6 +121,20 @@ static	int ether_resolvemulti(struct ifnet *, struct sockaddr **,
 static	void ether_reassign(struct ifnet *, struct vnet *, char *);
 #endif
 static	int ether_requestencap(struct ifnet *, struct if_encap_req *);
+#ifdef __rtems__
+
+/*
+ * Packets of one ether_input_batch() call collected per netisr protocol
+ * after the link layer processing.
+ */
+struct ether_batch {
+	struct mbuf	*eb_head[NETISR_MAXPROT];
+	struct mbuf	**eb_tail[NETISR_MAXPROT];
+};
+
+static	void ether_demux_batch(struct ifnet *, struct mbuf *,
+		struct ether_batch *);
+#endif /* __rtems__ */
 
 
 #define senderr(e) do { error = (e); goto bad;} while (0)
@@ -509,7 +526,11 @@ ether_output_frame(struct ifnet *ifp, struct mbuf *m)
  * mbuf chain m with the ethernet header at the front.
  */
 static void
+#ifndef __rtems__
 ether_input_internal(struct ifnet *ifp, struct mbuf *m)
+#else /* __rtems__ */
+ether_input_internal(struct ifnet *ifp, struct mbuf *m, struct ether_batch *eb)
+#endif /* __rtems__ */
 {
 	struct ether_header *eh;
 	u_short etype;
@@ -681,7 +702,11 @@ ether_input_internal(struct ifnet *ifp, struct mbuf *m)
 			m->m_flags |= M_PROMISC;
 	}
 
+#ifndef __rtems__
 	ether_demux(ifp, m);
+#else /* __rtems__ */
+	ether_demux_batch(ifp, m, eb);
+#endif /* __rtems__ */
 	CURVNET_RESTORE();
 }
 
@@ -711,7 +736,11 @@ ether_nh_input(struct mbuf *m)
 	M_ASSERTPKTHDR(m);
 	KASSERT(m->m_pkthdr.rcvif != NULL,
 	    ("%s: NULL interface pointer", __func__));
+#ifndef __rtems__
 	ether_input_internal(m->m_pkthdr.rcvif, m);
+#else /* __rtems__ */
+	ether_input_internal(m->m_pkthdr.rcvif, m, NULL);
+#endif /* __rtems__ */
 }
 
 static struct netisr_handler	ether_nh = {
@@ -806,12 +835,69 @@ ether_input(struct ifnet *ifp, struct mbuf *m)
 		m = mn;
 	}
 }
+#ifdef __rtems__
+
+/*
+ * Process a chain of packets linked with m_nextpkt.  The link layer
+ * processing is done packet by packet in the context of the interface vnet,
+ * which is entered only once.  The frames are then handed over to the upper
+ * layers grouped by protocol.  The order of frames of the same protocol is
+ * preserved.
+ *
+ * The Ethernet netisr always uses direct dispatch, so the detour through
+ * netisr_dispatch(NETISR_ETHER) is skipped here.
+ */
+static void
+ether_input_batch(struct ifnet *ifp, struct mbuf *m)
+{
+	struct ether_batch eb;
+	struct mbuf *mn;
+	u_int isr;
+
+	for (isr = 0; isr < NETISR_MAXPROT; ++isr) {
+		eb.eb_head[isr] = NULL;
+		eb.eb_tail[isr] = &eb.eb_head[isr];
+	}
+
+	CURVNET_SET_QUIET(ifp->if_vnet);
+	while (m != NULL) {
+		mn = m->m_nextpkt;
+		m->m_nextpkt = NULL;
+		KASSERT(m->m_pkthdr.rcvif == ifp, ("%s: ifnet mismatch m %p "
+		    "rcvif %p ifp %p", __func__, m, m->m_pkthdr.rcvif, ifp));
+		ether_input_internal(ifp, m, &eb);
+		m = mn;
+	}
+
+	for (isr = 0; isr < NETISR_MAXPROT; ++isr) {
+		if (eb.eb_head[isr] != NULL)
+			netisr_dispatch_batch(isr, eb.eb_head[isr]);
+	}
+	CURVNET_RESTORE();
+}
+#endif /* __rtems__ */
 
 /*
  * Upper layer processing for a received Ethernet packet.
  */
+#ifndef __rtems__
+void
+ether_demux(struct ifnet *ifp, struct mbuf *m)
+#else /* __rtems__ */
 void
 ether_demux(struct ifnet *ifp, struct mbuf *m)
+{
+
+	ether_demux_batch(ifp, m, NULL);
+}
+
+/*
+ * If a batch is given, then the frame is queued for the protocol instead of
+ * being dispatched immediately.
+ */
+static void
+ether_demux_batch(struct ifnet *ifp, struct mbuf *m, struct ether_batch *eb)
+#endif /* __rtems__ */
 {
 	struct ether_header *eh;
 	int i, isr;
@@ -893,6 +979,13 @@ ether_demux(struct ifnet *ifp, struct mbuf *m)
 	default:
 		goto discard;
 	}
+#ifdef __rtems__
+	if (eb != NULL) {
+		*eb->eb_tail[isr] = m;
+		eb->eb_tail[isr] = &m->m_nextpkt;
+		return;
+	}
+#endif /* __rtems__ */
 	netisr_dispatch(isr, m);
 	return;
 
@@ -948,6 +1041,9 @@ ether_ifattach(struct ifnet *ifp, const u_int8_t *lla)
 	ifp->if_mtu = ETHERMTU;
 	ifp->if_output = ether_output;
 	ifp->if_input = ether_input;
+#ifdef __rtems__
+	ifp->if_input_batch = ether_input_batch;
+#endif /* __rtems__ */
 	ifp->if_resolvemulti = ether_resolvemulti;
 	ifp->if_requestencap = ether_requestencap;
 #ifdef VIMAGE
@@ -970,6 +1066,9 @@ ether_ifattach(struct ifnet *ifp, const u_int8_t *lla)
 	bpfattach(ifp, DLT_EN10MB, ETHER_HDR_LEN);
 	if (ng_ether_attach_p != NULL)
 		(*ng_ether_attach_p)(ifp);
+#ifdef __rtems__
+	ether_gso_attach(ifp);
+#endif /* __rtems__ */
 
 	/* Announce Ethernet MAC address if non-zero. */
 	for (i = 0; i < ifp->if_addrlen; i++)
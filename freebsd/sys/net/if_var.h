@@ -400,6 +400,10 @@ struct ifnet {
 	int	if_ispare[4];		/* general use */
 #else /* __rtems__ */
 	void	*if_input_arg;
+	void	(*if_input_batch)	/* input of an m_nextpkt chain */
+		(struct ifnet *, struct mbuf *);
+	if_transmit_fn_t if_gso_transmit; /* driver transmit below GSO */
+	uint64_t	if_gso_assist;	/* offloads emulated by GSO */
 #endif /* __rtems__ */
 };
 #ifdef __rtems__
@@ -409,6 +413,8 @@ struct rtems_ifinputreq {
 	void	(*init)(struct ifnet *, void *);
 	void	(*new_if_input)(struct ifnet *, struct mbuf *);
 	void	(*old_if_input)(struct ifnet *, struct mbuf *);
+	void	(*new_if_input_batch)(struct ifnet *, struct mbuf *);
+	void	(*old_if_input_batch)(struct ifnet *, struct mbuf *);
 };
 #define	RTEMS_SIOSIFINPUT	_IOWR('i', 255, struct rtems_ifinputreq)
 #endif /* __rtems__ */
@@ -744,6 +750,9 @@ u_int if_gethwtsomax(if_t ifp);
 u_int if_gethwtsomaxsegcount(if_t ifp);
 u_int if_gethwtsomaxsegsize(if_t ifp);
 int if_input(if_t ifp, struct mbuf* sendmp);
+#ifdef __rtems__
+int if_input_batch(if_t ifp, struct mbuf *m);
+#endif /* __rtems__ */
 int if_sendq_prepend(if_t ifp, struct mbuf *m);
 struct mbuf *if_dequeue(if_t ifp);
 int if_setifheaderlen(if_t ifp, int len);
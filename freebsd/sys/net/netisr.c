@@ -1260,6 +1260,61 @@ netisr_dispatch(u_int proto, struct mbuf *m)
 
 	return (netisr_dispatch_src(proto, 0, m));
 }
+#ifdef __rtems__
+
+/*
+ * Dispatch a chain of packets linked with m_nextpkt for one protocol.  With
+ * direct dispatch the protocol is looked up once and its handler is called
+ * back-to-back for the whole chain, otherwise fall back to per-packet
+ * dispatch.
+ */
+int
+netisr_dispatch_batch(u_int proto, struct mbuf *m)
+{
+	struct netisr_workstream *nwsp;
+	struct netisr_proto *npp;
+	struct netisr_work *npwp;
+	struct mbuf *mn;
+	u_int n;
+	int error;
+
+	KASSERT(proto < NETISR_MAXPROT,
+	    ("%s: invalid proto %u", __func__, proto));
+	npp = &netisr_proto[proto];
+	KASSERT(npp->np_handler != NULL, ("%s: invalid proto %u", __func__,
+	    proto));
+
+	if (netisr_get_dispatch(npp) != NETISR_DISPATCH_DIRECT
+#ifdef VIMAGE
+	    || V_netisr_enable[proto] == 0
+#endif
+	    ) {
+		error = 0;
+		while (m != NULL) {
+			mn = m->m_nextpkt;
+			m->m_nextpkt = NULL;
+			error = netisr_dispatch_src(proto, 0, m);
+			m = mn;
+		}
+		return (error);
+	}
+
+	n = 0;
+	while (m != NULL) {
+		mn = m->m_nextpkt;
+		m->m_nextpkt = NULL;
+		(*npp->np_handler)(m);
+		++n;
+		m = mn;
+	}
+
+	nwsp = &rtems_bsd_nws;
+	npwp = &nwsp->nws_work[proto];
+	npwp->nw_dispatched += n;
+	npwp->nw_handled += n;
+	return (0);
+}
+#endif /* __rtems__ */
 
 #ifdef DEVICE_POLLING
 /*
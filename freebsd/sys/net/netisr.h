@@ -223,6 +223,9 @@ void	netisr_unregister_vnet(const struct netisr_handler *nhp);
  */
 int	netisr_dispatch(u_int proto, struct mbuf *m);
 int	netisr_dispatch_src(u_int proto, uintptr_t source, struct mbuf *m);
+#ifdef __rtems__
+int	netisr_dispatch_batch(u_int proto, struct mbuf *m);
+#endif /* __rtems__ */
 int	netisr_queue(u_int proto, struct mbuf *m);
 int	netisr_queue_src(u_int proto, uintptr_t source, struct mbuf *m);
 
@@ -1060,6 +1060,10 @@ struct pfr_ktable {
 	struct pf_ruleset	*pfrkt_rs;
 	long			 pfrkt_larg;
 	int			 pfrkt_nflags;
+#ifdef __rtems__
+	struct pfr_kcompiled	*pfrkt_ip4c;
+	int			 pfrkt_ip4c_stale;
+#endif /* __rtems__ */
 };
 #define pfrkt_t		pfrkt_ts.pfrts_t
 #define pfrkt_name	pfrkt_t.pfrt_name
@@ -1266,6 +1266,10 @@ rt_unlinkrte(struct rib_head *rnh, struct rt_addrinfo *info, int *perror)
 	RT_LOCK(rt);
 	RT_ADDREF(rt);
 	rt->rt_flags &= ~RTF_UP;
+#ifdef __rtems__
+	/* Invalidate compiled lookup tables */
+	rnh->rnh_gen++;
+#endif /* __rtems__ */
 
 	*perror = 0;
 
@@ -60,6 +60,9 @@ __FBSDID("$FreeBSD$");
 #include <netinet/in.h>
 #include <netinet/in_var.h>
 #include <netinet/in_fib.h>
+#ifdef __rtems__
+#include <netinet/in_fib_dxr.h>
+#endif /* __rtems__ */
 
 #ifdef INET
 static void fib4_rte_to_nh_basic(struct rtentry *rte, struct in_addr dst,
@@ -152,6 +155,26 @@ fib4_lookup_nh_basic(uint32_t fibnum, struct in_addr dst, uint32_t flags,
 	sin.sin_len = sizeof(struct sockaddr_in);
 	sin.sin_addr = dst;
 
+#ifdef __rtems__
+	{
+		struct epoch_tracker et;
+		int error;
+
+		epoch_enter_preempt(net_epoch_preempt, &et);
+		error = fib4_dxr_lookup(fibnum, dst, &rte);
+		if (error == 0) {
+			if (rte != NULL && RT_LINK_IS_UP(rte->rt_ifp)) {
+				fib4_rte_to_nh_basic(rte, dst, flags, pnh4);
+			} else {
+				error = ENOENT;
+			}
+			epoch_exit_preempt(net_epoch_preempt, &et);
+
+			return (error);
+		}
+		epoch_exit_preempt(net_epoch_preempt, &et);
+	}
+#endif /* __rtems__ */
 	RIB_RLOCK(rh);
 	rn = rh->rnh_matchaddr((void *)&sin, &rh->head);
 	if (rn != NULL && ((rn->rn_flags & RNF_ROOT) == 0)) {
@@ -201,6 +224,26 @@ fib4_lookup_nh_ext(uint32_t fibnum, struct in_addr dst, uint32_t flags,
 	sin.sin_len = sizeof(struct sockaddr_in);
 	sin.sin_addr = dst;
 
+#if defined(__rtems__) && !defined(RADIX_MPATH)
+	{
+		struct epoch_tracker et;
+		int error;
+
+		epoch_enter_preempt(net_epoch_preempt, &et);
+		error = fib4_dxr_lookup(fibnum, dst, &rte);
+		if (error == 0) {
+			if (rte != NULL && RT_LINK_IS_UP(rte->rt_ifp)) {
+				fib4_rte_to_nh_extended(rte, dst, flags, pnh4);
+			} else {
+				error = ENOENT;
+			}
+			epoch_exit_preempt(net_epoch_preempt, &et);
+
+			return (error);
+		}
+		epoch_exit_preempt(net_epoch_preempt, &et);
+	}
+#endif /* __rtems__ && !RADIX_MPATH */
 	RIB_RLOCK(rh);
 	rn = rh->rnh_matchaddr((void *)&sin, &rh->head);
 	if (rn != NULL && ((rn->rn_flags & RNF_ROOT) == 0)) {
@@ -298,6 +298,11 @@ extern int	(*ng_ipfw_input_p)(struct mbuf **, int,
 
 extern int	(*ip_dn_ctl_ptr)(struct sockopt *);
 extern int	(*ip_dn_io_ptr)(struct mbuf **, int, struct ip_fw_args *);
+#ifdef __rtems__
+/* Hands packets tagged by pf over to the pipe emulation (ip_dnpipe.c). */
+extern int	(*ip_dnpipe_pf_ptr)(struct mbuf **, struct ifnet *, int,
+		    const char *);
+#endif /* __rtems__ */
 #endif /* _KERNEL */
 
 #endif /* !_NETINET_IP_VAR_H_ */
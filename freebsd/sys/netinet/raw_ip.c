@@ -103,6 +103,9 @@ VNET_DEFINE(ip_fw_ctl_ptr_t, ip_fw_ctl_ptr) = NULL;
 
 int	(*ip_dn_ctl_ptr)(struct sockopt *);
 int	(*ip_dn_io_ptr)(struct mbuf **, int, struct ip_fw_args *);
+#ifdef __rtems__
+int	(*ip_dnpipe_pf_ptr)(struct mbuf **, struct ifnet *, int, const char *);
+#endif /* __rtems__ */
 void	(*ip_divert_ptr)(struct mbuf *, int);
 int	(*ng_ipfw_input_p)(struct mbuf **, int,
 			struct ip_fw_args *, int);
@@ -953,6 +953,83 @@ tcp_lro_rx(struct lro_ctrl *lc, struct mbuf *m, uint32_t csum)
 
 	return tcp_lro_rx2(lc, m, csum, 1);
 }
+#ifdef __rtems__
+
+#ifdef INET
+/*
+ * Verify the TCP checksum of an IPv4 frame in software.  The stack would do
+ * this anyway, so drivers without receive checksum offload can use LRO at no
+ * extra cost.
+ */
+static int
+tcp_lro_csum_ipv4(struct mbuf *m)
+{
+	struct ether_header *eh;
+	struct ip *ip4;
+	uint16_t csum;
+	int ip_len;
+
+	if (m->m_len <
+	    (int)(ETHER_HDR_LEN + sizeof(*ip4) + sizeof(struct tcphdr)))
+		return (TCP_LRO_CANNOT);
+
+	eh = mtod(m, struct ether_header *);
+	if (eh->ether_type != htons(ETHERTYPE_IP))
+		return (TCP_LRO_NOT_SUPPORTED);
+
+	ip4 = (struct ip *)(eh + 1);
+	if (ip4->ip_p != IPPROTO_TCP)
+		return (TCP_LRO_NOT_SUPPORTED);
+
+	/* Only frames which tcp_lro_rx_ipv4() accepts are worth the effort. */
+	if ((ip4->ip_hl << 2) != sizeof(*ip4) ||
+	    (ip4->ip_off & htons(IP_MF|IP_OFFMASK)) != 0)
+		return (TCP_LRO_CANNOT);
+
+	ip_len = ntohs(ip4->ip_len);
+	if (ip_len < (int)(sizeof(*ip4) + sizeof(struct tcphdr)) ||
+	    ETHER_HDR_LEN + ip_len > m->m_pkthdr.len)
+		return (TCP_LRO_CANNOT);
+
+	csum = in_cksum_skip(m, ETHER_HDR_LEN + ip_len,
+	    ETHER_HDR_LEN + sizeof(*ip4));
+	csum = in_addword(in_pseudo(ip4->ip_src.s_addr, ip4->ip_dst.s_addr,
+	    htonl(ip_len - sizeof(*ip4) + IPPROTO_TCP)), ~csum);
+	if (csum != 0xffff)
+		return (TCP_LRO_CANNOT);
+
+	m->m_pkthdr.csum_flags |= CSUM_DATA_VALID | CSUM_PSEUDO_HDR;
+	m->m_pkthdr.csum_data = 0xffff;
+	return (0);
+}
+#endif
+
+/*
+ * Like tcp_lro_rx(), but accepts frames without a TCP checksum verified by
+ * the hardware.  The checksum of such IPv4 frames is verified in software.
+ * Frames which fail the check are not queued and the caller passes them to
+ * if_input() as usual.
+ */
+int
+tcp_lro_rx_csum(struct lro_ctrl *lc, struct mbuf *m)
+{
+	const int valid = CSUM_DATA_VALID | CSUM_PSEUDO_HDR;
+
+	if ((m->m_pkthdr.csum_flags & valid) != valid) {
+#ifdef INET
+		int error;
+
+		error = tcp_lro_csum_ipv4(m);
+		if (error != 0)
+			return (error);
+#else
+		return (TCP_LRO_CANNOT);
+#endif
+	}
+
+	return (tcp_lro_rx2(lc, m, 0, 1));
+}
+#endif /* __rtems__ */
 
 void
 tcp_lro_queue_mbuf(struct lro_ctrl *lc, struct mbuf *mb)
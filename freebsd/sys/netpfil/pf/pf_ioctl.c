@@ -175,6 +175,9 @@ static int pf_check_in(void *arg, struct mbuf **m, struct ifnet *ifp,
     int dir, int flags, struct inpcb *inp);
 static int pf_check_out(void *arg, struct mbuf **m, struct ifnet *ifp,
     int dir, int flags, struct inpcb *inp);
+#ifdef __rtems__
+static int pf_dnpipe(struct mbuf **m, struct ifnet *ifp, int dir);
+#endif /* __rtems__ */
 #endif
 #ifdef INET6
 static int pf_check6_in(void *arg, struct mbuf **m, struct ifnet *ifp,
@@ -4031,6 +4034,10 @@ pf_check_in(void *arg, struct mbuf **m, struct ifnet *ifp, int dir, int flags,
 
 	if (chk != PF_PASS)
 		return (EACCES);
+#ifdef __rtems__
+	if (*m != NULL && ip_dnpipe_pf_ptr != NULL)
+		return (pf_dnpipe(m, ifp, PFIL_IN));
+#endif /* __rtems__ */
 	return (0);
 }
 
@@ -4048,8 +4055,47 @@ pf_check_out(void *arg, struct mbuf **m, struct ifnet *ifp, int dir, int flags,
 
 	if (chk != PF_PASS)
 		return (EACCES);
+#ifdef __rtems__
+	if (*m != NULL && ip_dnpipe_pf_ptr != NULL)
+		return (pf_dnpipe(m, ifp, PFIL_OUT));
+#endif /* __rtems__ */
 	return (0);
 }
+#ifdef __rtems__
+
+/*
+ * Pass packets which carry a pf tag to the pipe emulation.  The pipes are
+ * configured with tag names, since the tag identifiers change with each
+ * ruleset.
+ */
+static int
+pf_dnpipe(struct mbuf **m, struct ifnet *ifp, int dir)
+{
+	char tagname[PF_TAG_NAME_SIZE];
+	struct pf_tagname *tag;
+	struct pf_mtag *pd;
+	PF_RULES_RLOCK_TRACKER;
+
+	pd = pf_find_mtag(*m);
+	if (pd == NULL || pd->tag == 0)
+		return (0);
+
+	tagname[0] = '\0';
+	PF_RULES_RLOCK();
+	TAILQ_FOREACH(tag, &V_pf_tags, entries) {
+		if (tag->tag == pd->tag) {
+			strlcpy(tagname, tag->name, sizeof(tagname));
+			break;
+		}
+	}
+	PF_RULES_RUNLOCK();
+
+	if (tagname[0] == '\0')
+		return (0);
+
+	return ((*ip_dnpipe_pf_ptr)(m, ifp, dir, tagname));
+}
+#endif /* __rtems__ */
 #endif
 
 #ifdef INET6
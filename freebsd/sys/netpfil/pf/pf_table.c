@@ -47,6 +47,10 @@ __FBSDID("$FreeBSD$");
 #include <sys/mutex.h>
 #include <sys/refcount.h>
 #include <sys/socket.h>
+#ifdef __rtems__
+#include <sys/sysctl.h>
+#include <sys/taskqueue.h>
+#endif /* __rtems__ */
 #include <vm/uma.h>
 
 #include <net/if.h>
@@ -182,6 +186,15 @@ static int		 pfr_skip_table(struct pfr_table *,
 			    struct pfr_ktable *, int);
 static struct pfr_kentry
 			*pfr_kentry_byidx(struct pfr_ktable *, int, int);
+#ifdef __rtems__
+static void		 pfr_kcompile(struct pfr_ktable *);
+static void		 pfr_kcompile_defer(struct pfr_ktable *);
+static void		 pfr_kcompile_free(struct pfr_ktable *);
+static void		 pfr_kcompile_task(void *, int);
+static struct pfr_kentry
+			*pfr_kcompile_match(const struct pfr_kcompiled *,
+			    in_addr_t);
+#endif /* __rtems__ */
 
 static RB_PROTOTYPE(pfr_ktablehead, pfr_ktable, pfrkt_tree, pfr_ktable_compare);
 static RB_GENERATE(pfr_ktablehead, pfr_ktable, pfrkt_tree, pfr_ktable_compare);
@@ -195,6 +208,92 @@ VNET_DEFINE_STATIC(struct pfr_table, pfr_nulltable);
 VNET_DEFINE_STATIC(int, pfr_ktable_cnt);
 #define V_pfr_ktable_cnt	VNET(pfr_ktable_cnt)
 
+#ifdef __rtems__
+/*
+ * Compiled IPv4 lookup table.  The IPv4 address space is split into
+ * non-overlapping ranges, each mapped to the most specific table entry
+ * covering it (or NULL).  The range start addresses are kept in a sorted
+ * array separate from the entry pointers, so that a lookup touches only a
+ * few cache lines.  The first octet of the address selects the slice of the
+ * array which is binary searched.
+ *
+ * The compiled table is an alternative representation of the IPv4 radix
+ * tree of the table.  It is invalidated by pfr_route_kentry() and
+ * pfr_unroute_kentry() and rebuilt at the end of each batch of changes
+ * under the write lock, so the readers (holding the read lock) see either
+ * no compiled table or one which exactly matches the radix tree.  Single
+ * entries added by pfr_insert_kentry() (for example by the overload task)
+ * only mark the table stale.  Lookups use the radix tree until a task
+ * rebuilds the stale tables, so a burst of insertions costs one rebuild.
+ */
+struct pfr_kcompiled {
+	u_int			  pfrkc_cnt;
+	u_int			  pfrkc_idx[257];
+	u_int32_t		 *pfrkc_start;
+	struct pfr_kentry	**pfrkc_ke;
+};
+
+struct pfr_kcprefix {
+	u_int32_t		 pfrkp_start;
+	u_int32_t		 pfrkp_end;
+	struct pfr_kentry	*pfrkp_ke;
+};
+
+struct pfr_kcbuild {
+	struct pfr_kcprefix	*pfrkb_pfx;
+	u_int			 pfrkb_cnt;
+};
+
+SYSCTL_DECL(_net_pf);
+
+static int pfr_kcompile_enable = 1;
+
+static int pfr_kcompile_min = 32;
+SYSCTL_INT(_net_pf, OID_AUTO, table_compile_min, CTLFLAG_RWTUN,
+    &pfr_kcompile_min, 0,
+    "Minimum count of IPv4 entries to compile a table");
+
+static int pfr_kcompile_delay = 100;
+SYSCTL_INT(_net_pf, OID_AUTO, table_compile_delay, CTLFLAG_RWTUN,
+    &pfr_kcompile_delay, 0,
+    "Delay in milliseconds before a table changed by single insertions is "
+    "compiled again");
+
+static struct timeout_task pfr_kcompile_ttask;
+
+static u_long pfr_kcompile_count;
+SYSCTL_ULONG(_net_pf, OID_AUTO, table_compiles, CTLFLAG_RD,
+    &pfr_kcompile_count, 0, "Count of compiled table builds");
+
+static u_long pfr_kcompile_failures;
+SYSCTL_ULONG(_net_pf, OID_AUTO, table_compile_failures, CTLFLAG_RD,
+    &pfr_kcompile_failures, 0,
+    "Count of compiled table builds which ran out of memory");
+
+static int
+pfr_kcompile_sysctl_enable(SYSCTL_HANDLER_ARGS)
+{
+	struct pfr_ktable	*kt;
+	int			 enable, error;
+
+	enable = pfr_kcompile_enable;
+	error = sysctl_handle_int(oidp, &enable, 0, req);
+	if (error != 0 || req->newptr == NULL)
+		return (error);
+
+	PF_RULES_WLOCK();
+	pfr_kcompile_enable = enable != 0;
+	RB_FOREACH(kt, pfr_ktablehead, &V_pfr_ktables)
+		pfr_kcompile(kt);
+	PF_RULES_WUNLOCK();
+	return (0);
+}
+SYSCTL_PROC(_net_pf, OID_AUTO, table_compile,
+    CTLTYPE_INT | CTLFLAG_RW | CTLFLAG_MPSAFE, NULL, 0,
+    pfr_kcompile_sysctl_enable, "I",
+    "Use compiled lookup tables for IPv4 table entries");
+#endif /* __rtems__ */
+
 void
 pfr_initialize(void)
 {
@@ -207,12 +306,19 @@ pfr_initialize(void)
 	    UMA_ALIGN_PTR, 0);
 	V_pf_limits[PF_LIMIT_TABLE_ENTRIES].zone = V_pfr_kentry_z;
 	V_pf_limits[PF_LIMIT_TABLE_ENTRIES].limit = PFR_KENTRY_HIWAT;
+#ifdef __rtems__
+	TIMEOUT_TASK_INIT(taskqueue_thread, &pfr_kcompile_ttask, 0,
+	    pfr_kcompile_task, NULL);
+#endif /* __rtems__ */
 }
 
 void
 pfr_cleanup(void)
 {
 
+#ifdef __rtems__
+	taskqueue_drain_timeout(taskqueue_thread, &pfr_kcompile_ttask);
+#endif /* __rtems__ */
 	uma_zdestroy(V_pfr_kentry_z);
 	uma_zdestroy(V_pfr_kcounters_z);
 }
@@ -765,9 +871,18 @@ pfr_lookup_addr(struct pfr_ktable *kt, struct pfr_addr *ad, int exact)
 		if (ke && KENTRY_RNF_ROOT(ke))
 			ke = NULL;
 	} else {
+#ifdef __rtems__
+		if (ad->pfra_af == AF_INET && kt->pfrkt_ip4c != NULL)
+			ke = pfr_kcompile_match(kt->pfrkt_ip4c,
+			    ad->pfra_ip4addr.s_addr);
+		else {
+#endif /* __rtems__ */
 		ke = (struct pfr_kentry *)rn_match(&sa, head);
 		if (ke && KENTRY_RNF_ROOT(ke))
 			ke = NULL;
+#ifdef __rtems__
+		}
+#endif /* __rtems__ */
 		if (exact && ke && KENTRY_NETWORK(ke))
 			ke = NULL;
 	}
@@ -830,6 +945,9 @@ pfr_insert_kentries(struct pfr_ktable *kt,
 		n++;
 	}
 	kt->pfrkt_cnt += n;
+#ifdef __rtems__
+	pfr_kcompile(kt);
+#endif /* __rtems__ */
 }
 
 int
@@ -851,6 +969,9 @@ pfr_insert_kentry(struct pfr_ktable *kt, struct pfr_addr *ad, long tzero)
 
 	p->pfrke_tzero = tzero;
 	kt->pfrkt_cnt++;
+#ifdef __rtems__
+	pfr_kcompile_defer(kt);
+#endif /* __rtems__ */
 
 	return (0);
 }
@@ -867,6 +988,9 @@ pfr_remove_kentries(struct pfr_ktable *kt,
 		n++;
 	}
 	kt->pfrkt_cnt -= n;
+#ifdef __rtems__
+	pfr_kcompile(kt);
+#endif /* __rtems__ */
 	pfr_destroy_kentries(workq);
 }
 
@@ -941,9 +1065,12 @@ pfr_route_kentry(struct pfr_ktable *kt, struct pfr_kentry *ke)
 	PF_RULES_WASSERT();
 
 	bzero(ke->pfrke_node, sizeof(ke->pfrke_node));
-	if (ke->pfrke_af == AF_INET)
+	if (ke->pfrke_af == AF_INET) {
 		head = &kt->pfrkt_ip4->rh;
-	else if (ke->pfrke_af == AF_INET6)
+#ifdef __rtems__
+		pfr_kcompile_free(kt);
+#endif /* __rtems__ */
+	} else if (ke->pfrke_af == AF_INET6)
 		head = &kt->pfrkt_ip6->rh;
 
 	if (KENTRY_NETWORK(ke)) {
@@ -962,9 +1089,12 @@ pfr_unroute_kentry(struct pfr_ktable *kt, struct pfr_kentry *ke)
 	struct radix_node	*rn;
 	struct radix_head	*head = NULL;
 
-	if (ke->pfrke_af == AF_INET)
+	if (ke->pfrke_af == AF_INET) {
 		head = &kt->pfrkt_ip4->rh;
-	else if (ke->pfrke_af == AF_INET6)
+#ifdef __rtems__
+		pfr_kcompile_free(kt);
+#endif /* __rtems__ */
+	} else if (ke->pfrke_af == AF_INET6)
 		head = &kt->pfrkt_ip6->rh;
 
 	if (KENTRY_NETWORK(ke)) {
@@ -1628,6 +1758,11 @@ pfr_commit_ktable(struct pfr_ktable *kt, long tzero)
 		SWAP(struct radix_node_head *, kt->pfrkt_ip6,
 		    shadow->pfrkt_ip6);
 		SWAP(int, kt->pfrkt_cnt, shadow->pfrkt_cnt);
+#ifdef __rtems__
+		SWAP(struct pfr_kcompiled *, kt->pfrkt_ip4c,
+		    shadow->pfrkt_ip4c);
+		pfr_kcompile(kt);
+#endif /* __rtems__ */
 		pfr_clstats_ktable(kt, tzero, 1);
 	}
 	nflags = ((shadow->pfrkt_flags & PFR_TFLAG_USRMASK) |
@@ -1867,6 +2002,9 @@ pfr_destroy_ktable(struct pfr_ktable *kt, int flushaddr)
 		rn_detachhead((void **)&kt->pfrkt_ip4);
 	if (kt->pfrkt_ip6 != NULL)
 		rn_detachhead((void **)&kt->pfrkt_ip6);
+#ifdef __rtems__
+	pfr_kcompile_free(kt);
+#endif /* __rtems__ */
 	if (kt->pfrkt_shadow != NULL)
 		pfr_destroy_ktable(kt->pfrkt_shadow, flushaddr);
 	if (kt->pfrkt_rs != NULL) {
@@ -1916,6 +2054,12 @@ pfr_match_addr(struct pfr_ktable *kt, struct pf_addr *a, sa_family_t af)
 		bzero(&sin, sizeof(sin));
 		sin.sin_len = sizeof(sin);
 		sin.sin_family = AF_INET;
+#ifdef __rtems__
+		if (kt->pfrkt_ip4c != NULL) {
+			ke = pfr_kcompile_match(kt->pfrkt_ip4c, a->addr32[0]);
+			break;
+		}
+#endif /* __rtems__ */
 		sin.sin_addr.s_addr = a->addr32[0];
 		ke = (struct pfr_kentry *)rn_match(&sin, &kt->pfrkt_ip4->rh);
 		if (ke && KENTRY_RNF_ROOT(ke))
@@ -1967,6 +2111,12 @@ pfr_update_stats(struct pfr_ktable *kt, struct pf_addr *a, sa_family_t af,
 		bzero(&sin, sizeof(sin));
 		sin.sin_len = sizeof(sin);
 		sin.sin_family = AF_INET;
+#ifdef __rtems__
+		if (kt->pfrkt_ip4c != NULL) {
+			ke = pfr_kcompile_match(kt->pfrkt_ip4c, a->addr32[0]);
+			break;
+		}
+#endif /* __rtems__ */
 		sin.sin_addr.s_addr = a->addr32[0];
 		ke = (struct pfr_kentry *)rn_match(&sin, &kt->pfrkt_ip4->rh);
 		if (ke && KENTRY_RNF_ROOT(ke))
@@ -2201,3 +2351,219 @@ pfr_dynaddr_update(struct pfr_ktable *kt, struct pfi_dynaddr *dyn)
 	if (!dyn->pfid_af || dyn->pfid_af == AF_INET6)
 		kt->pfrkt_ip6->rnh_walktree(&kt->pfrkt_ip6->rh, pfr_walktree, &w);
 }
+#ifdef __rtems__
+
+static int
+pfr_kcompile_walk(struct radix_node *rn, void *arg)
+{
+	struct pfr_kcbuild	*b = arg;
+	struct pfr_kentry	*ke = (struct pfr_kentry *)rn;
+	struct pfr_kcprefix	*pfx;
+	u_int32_t		 mask;
+
+	if (b->pfrkb_pfx != NULL) {
+		pfx = &b->pfrkb_pfx[b->pfrkb_cnt];
+		mask = ke->pfrke_net > 0 ? 0xffffffffU << (32 - ke->pfrke_net) :
+		    0;
+		pfx->pfrkp_start = ntohl(ke->pfrke_sa.sin.sin_addr.s_addr) &
+		    mask;
+		pfx->pfrkp_end = pfx->pfrkp_start | ~mask;
+		pfx->pfrkp_ke = ke;
+	}
+	++b->pfrkb_cnt;
+	return (0);
+}
+
+static int
+pfr_kcompile_cmp(const void *a, const void *b)
+{
+	const struct pfr_kcprefix *pa = a;
+	const struct pfr_kcprefix *pb = b;
+
+	/* Order nested prefixes from the widest to the most specific */
+	if (pa->pfrkp_start != pb->pfrkp_start)
+		return (pa->pfrkp_start < pb->pfrkp_start ? -1 : 1);
+	if (pa->pfrkp_end != pb->pfrkp_end)
+		return (pa->pfrkp_end > pb->pfrkp_end ? -1 : 1);
+	return (0);
+}
+
+static void
+pfr_kcompile_emit(struct pfr_kcompiled *kc, u_int64_t start,
+    struct pfr_kentry *ke)
+{
+	u_int n;
+
+	n = kc->pfrkc_cnt;
+	if (n > 0 && kc->pfrkc_ke[n - 1] == ke)
+		return;
+	kc->pfrkc_start[n] = (u_int32_t)start;
+	kc->pfrkc_ke[n] = ke;
+	kc->pfrkc_cnt = n + 1;
+}
+
+static void
+pfr_kcompile_free(struct pfr_ktable *kt)
+{
+
+	if (kt->pfrkt_ip4c != NULL) {
+		free(kt->pfrkt_ip4c, M_PFTABLE);
+		kt->pfrkt_ip4c = NULL;
+	}
+}
+
+/*
+ * Rebuilds the compiled IPv4 lookup table of the table from its radix tree.
+ * If the table is too small or no memory is available, the lookups use the
+ * radix tree.
+ */
+static void
+pfr_kcompile(struct pfr_ktable *kt)
+{
+	struct pfr_kcprefix	 stack[33];
+	struct pfr_kcbuild	 b;
+	struct pfr_kcompiled	*kc;
+	u_int64_t		 cur;
+	u_int			 i, j, max, sp;
+
+	pfr_kcompile_free(kt);
+	kt->pfrkt_ip4c_stale = 0;
+
+	if (!pfr_kcompile_enable || kt->pfrkt_ip4 == NULL)
+		return;
+
+	bzero(&b, sizeof(b));
+	kt->pfrkt_ip4->rnh_walktree(&kt->pfrkt_ip4->rh, pfr_kcompile_walk,
+	    &b);
+	if (b.pfrkb_cnt == 0 || b.pfrkb_cnt < (u_int)pfr_kcompile_min)
+		return;
+
+	b.pfrkb_pfx = mallocarray(b.pfrkb_cnt, sizeof(*b.pfrkb_pfx),
+	    M_TEMP, M_NOWAIT);
+	if (b.pfrkb_pfx == NULL) {
+		++pfr_kcompile_failures;
+		return;
+	}
+	max = b.pfrkb_cnt;
+	b.pfrkb_cnt = 0;
+	kt->pfrkt_ip4->rnh_walktree(&kt->pfrkt_ip4->rh, pfr_kcompile_walk,
+	    &b);
+	KASSERT(b.pfrkb_cnt == max, ("%s: table changed", __func__));
+	qsort(b.pfrkb_pfx, max, sizeof(*b.pfrkb_pfx), pfr_kcompile_cmp);
+
+	/* Each prefix adds at most two ranges */
+	max = 2 * max + 1;
+	kc = malloc(sizeof(*kc) + max * (sizeof(*kc->pfrkc_start) +
+	    sizeof(*kc->pfrkc_ke)), M_PFTABLE, M_NOWAIT);
+	if (kc == NULL) {
+		free(b.pfrkb_pfx, M_TEMP);
+		++pfr_kcompile_failures;
+		return;
+	}
+	kc->pfrkc_cnt = 0;
+	kc->pfrkc_ke = (struct pfr_kentry **)(kc + 1);
+	kc->pfrkc_start = (u_int32_t *)(kc->pfrkc_ke + max);
+
+	/*
+	 * Sweep the prefixes in address order.  The stack contains the
+	 * prefixes covering the current address, the most specific one is on
+	 * top.
+	 */
+	cur = 0;
+	sp = 0;
+	for (i = 0; i < b.pfrkb_cnt; ++i) {
+		struct pfr_kcprefix *pfx = &b.pfrkb_pfx[i];
+
+		while (sp > 0 && stack[sp - 1].pfrkp_end < pfx->pfrkp_start) {
+			--sp;
+			if (cur <= stack[sp].pfrkp_end) {
+				pfr_kcompile_emit(kc, cur, stack[sp].pfrkp_ke);
+				cur = (u_int64_t)stack[sp].pfrkp_end + 1;
+			}
+		}
+		if (cur < pfx->pfrkp_start) {
+			pfr_kcompile_emit(kc, cur,
+			    sp > 0 ? stack[sp - 1].pfrkp_ke : NULL);
+			cur = pfx->pfrkp_start;
+		}
+		KASSERT(sp < nitems(stack), ("%s: stack overflow", __func__));
+		stack[sp] = *pfx;
+		++sp;
+	}
+	while (sp > 0) {
+		--sp;
+		if (cur <= stack[sp].pfrkp_end) {
+			pfr_kcompile_emit(kc, cur, stack[sp].pfrkp_ke);
+			cur = (u_int64_t)stack[sp].pfrkp_end + 1;
+		}
+	}
+	if (cur <= 0xffffffffU)
+		pfr_kcompile_emit(kc, cur, NULL);
+	free(b.pfrkb_pfx, M_TEMP);
+
+	/* Index the ranges by the first octet */
+	for (i = 0, j = 0; i < 256; ++i) {
+		while (j + 1 < kc->pfrkc_cnt &&
+		    kc->pfrkc_start[j + 1] <= (i << 24))
+			++j;
+		kc->pfrkc_idx[i] = j;
+	}
+	kc->pfrkc_idx[256] = kc->pfrkc_cnt - 1;
+
+	kt->pfrkt_ip4c = kc;
+	++pfr_kcompile_count;
+}
+
+/*
+ * Marks the table for a rebuild of its compiled IPv4 lookup table by the
+ * compile task.  The compiled table was already dropped by
+ * pfr_route_kentry().
+ */
+static void
+pfr_kcompile_defer(struct pfr_ktable *kt)
+{
+
+	PF_RULES_WASSERT();
+
+	if (!pfr_kcompile_enable || kt->pfrkt_ip4c_stale)
+		return;
+
+	kt->pfrkt_ip4c_stale = 1;
+	taskqueue_enqueue_timeout(taskqueue_thread, &pfr_kcompile_ttask,
+	    -max(1, pfr_kcompile_delay * hz / 1000));
+}
+
+static void
+pfr_kcompile_task(void *arg, int pending)
+{
+	struct pfr_ktable	*kt;
+
+	PF_RULES_WLOCK();
+	RB_FOREACH(kt, pfr_ktablehead, &V_pfr_ktables) {
+		if (kt->pfrkt_ip4c_stale)
+			pfr_kcompile(kt);
+	}
+	PF_RULES_WUNLOCK();
+}
+
+static struct pfr_kentry *
+pfr_kcompile_match(const struct pfr_kcompiled *kc, in_addr_t addr)
+{
+	const u_int32_t	*start;
+	u_int32_t	 a;
+	u_int		 lo, hi, mid;
+
+	a = ntohl(addr);
+	lo = kc->pfrkc_idx[a >> 24];
+	hi = kc->pfrkc_idx[(a >> 24) + 1];
+	start = kc->pfrkc_start;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (start[mid] <= a)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return (kc->pfrkc_ke[lo]);
+}
+#endif /* __rtems__ */
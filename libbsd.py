@@ -172,10 +172,14 @@ class rtems(builder.Module):
                 'rtems/rtems-bsd-init-dhcp.c',
                 'rtems/rtems-bsd-rc-conf-net.c',
                 'rtems/rtems-bsd-rc-conf-pf.c',
+                'rtems/rtems-bsd-rc-conf-syslogd.c',
                 'rtems/rtems-bsd-rc-conf.c',
                 'rtems/rtems-bsd-set-if-input.c',
                 'rtems/rtems-bsd-shell-arp.c',
+                'rtems/rtems-bsd-shell-bootprof.c',
+                'rtems/rtems-bsd-shell-dnscache.c',
                 'rtems/rtems-bsd-shell-ifconfig.c',
+                'rtems/rtems-bsd-shell-klog.c',
                 'rtems/rtems-bsd-shell-netstat.c',
                 'rtems/rtems-bsd-shell-pfctl.c',
                 'rtems/rtems-bsd-shell-ping.c',
@@ -186,14 +190,17 @@ class rtems(builder.Module):
                 'rtems/rtems-bsd-shell-vmstat.c',
                 'rtems/rtems-bsd-shell-wlanstats.c',
                 'rtems/rtems-bsd-syscall-api.c',
+                'rtems/rtems-bsd-syslog-remote.c',
                 'rtems/rtems-kernel-assert.c',
                 'rtems/rtems-kernel-autoconf.c',
+                'rtems/rtems-kernel-boot-profile.c',
                 'rtems/rtems-kernel-bus-dma.c',
                 'rtems/rtems-kernel-bus-dma-mbuf.c',
                 'rtems/rtems-kernel-bus-root.c',
                 'rtems/rtems-kernel-cam.c',
                 'rtems/rtems-kernel-chunk.c',
                 'rtems/rtems-kernel-delay.c',
+                'rtems/rtems-kernel-dns-cache.c',
                 'rtems/rtems-kernel-epoch.c',
                 'rtems/rtems-kernel-get-file.c',
                 'rtems/rtems-kernel-init.c',
@@ -220,6 +227,7 @@ class rtems(builder.Module):
                 'rtems/rtems-kernel-termioskqueuepoll.c',
                 'rtems/rtems-kernel-thread.c',
                 'rtems/rtems-kernel-vprintf.c',
+                'rtems/rtems-kernel-vprintf-deferred.c',
                 'rtems/rtems-kernel-wpa-supplicant.c',
                 'rtems/rtems-legacy-rtrequest.c',
                 'rtems/rtems-legacy-newproc.c',
@@ -234,6 +242,7 @@ class rtems(builder.Module):
                 'nfsclient/nfs.c',
                 'nfsclient/nfs_prot_xdr.c',
                 'nfsclient/rpcio.c',
+                'nfsclient/xdr_mbuf.c',
                 'pppd/auth.c',
                 'pppd/ccp.c',
                 'pppd/chap.c',
@@ -1725,6 +1734,14 @@ class net(builder.Module):
             ],
             mm.generator['source']()
         )
+        self.addRTEMSSourceFiles(
+            [
+                'sys/net/bpf_zerocopy.c',
+                'sys/net/if_gso.c',
+                'sys/net/if_poll.c',
+            ],
+            mm.generator['source']()
+        )
 
 #
 # Internet Networking
@@ -1739,6 +1756,7 @@ class netinet(builder.Module):
         self.addKernelSpaceHeaderFiles(
             [
                 'sys/netinet/cc/cc.h',
+                'sys/netinet/cc/cc_cubic.h',
                 'sys/netinet/cc/cc_module.h',
                 'sys/netinet/cc/cc_newreno.h',
                 'sys/netinet/in_fib.h',
@@ -1820,6 +1838,8 @@ class netinet(builder.Module):
                 'sys/netinet/accf_dns.c',
                 'sys/netinet/accf_http.c',
                 'sys/netinet/cc/cc.c',
+                'sys/netinet/cc/cc_cubic.c',
+                'sys/netinet/cc/cc_htcp.c',
                 'sys/netinet/cc/cc_newreno.c',
                 'sys/netinet/if_ether.c',
                 'sys/netinet/igmp.c',
@@ -1889,6 +1909,13 @@ class netinet(builder.Module):
             ],
             mm.generator['source']()
         )
+        self.addRTEMSSourceFiles(
+            [
+                'sys/netinet/in_fib_dxr.c',
+                'sys/netinet/ip_dnpipe.c',
+            ],
+            mm.generator['source']()
+        )
 
 #
 # IPv6
@@ -4874,6 +4901,7 @@ class tests(builder.Module):
     def generate(self):
         mm = self.manager
         self.addTest(mm.generator['test']('epoch01', ['test_main']))
+        self.addTest(mm.generator['test']('route01', ['test_main']))
         self.addTest(mm.generator['test']('nfs01', ['test_main'], netTest = True))
         self.addTest(mm.generator['test']('foobarclient', ['test_main'],
                                           runTest = False, netTest = True))
@@ -4902,11 +4930,18 @@ class tests(builder.Module):
         self.addTest(mm.generator['test']('program01', ['test_main']))
         self.addTest(mm.generator['test']('commands01', ['test_main']))
         self.addTest(mm.generator['test']('usb01', ['init'], False))
+        self.addTest(mm.generator['test']('umass01', ['test_main'], False))
         self.addTest(mm.generator['test']('usbserial01', ['init'], False))
         self.addTest(mm.generator['test']('usbkbd01', ['init'], False))
         self.addTest(mm.generator['test']('usbmouse01', ['init'], False))
         self.addTest(mm.generator['test']('evdev01', ['init'], False))
         self.addTest(mm.generator['test']('loopback01', ['test_main']))
+        self.addTest(mm.generator['test']('tcpcc01', ['test_main']))
+        self.addTest(mm.generator['test']('dnpipe01', ['test_main']))
+        self.addTest(mm.generator['test']('bridge01', ['test_main']))
+        self.addTest(mm.generator['test']('bpfzbuf01', ['test_main']))
+        self.addTest(mm.generator['test']('gso01', ['test_main']))
+        self.addTest(mm.generator['test']('dnscache01', ['test_main']))
         self.addTest(mm.generator['test']('netshell01', ['test_main', 'shellconfig'], False))
         self.addTest(mm.generator['test']('swi01', ['init', 'swi_test']))
         self.addTest(mm.generator['test']('timeout01', ['init', 'timeout_test']))
@@ -4926,6 +4961,9 @@ class tests(builder.Module):
         self.addTest(mm.generator['test']('vlan01', ['test_main'], netTest = True))
         self.addTest(mm.generator['test']('lagg01', ['test_main'], netTest = True))
         self.addTest(mm.generator['test']('log01', ['test_main']))
+        self.addTest(mm.generator['test']('log02', ['test_main']))
+        self.addTest(mm.generator['test']('bootprof01', ['test_main', 'test_bus']))
+        self.addTest(mm.generator['test']('syslog01', ['test_main']))
         self.addTest(mm.generator['test']('rcconf01', ['test_main']))
         self.addTest(mm.generator['test']('rcconf02', ['test_main'],
                                           extraLibs = ['ftpd', 'telnetd']))
@@ -4935,6 +4973,8 @@ class tests(builder.Module):
         self.addTest(mm.generator['test']('pf02', ['test_main'],
                                           runTest = False,
                                           extraLibs = ['ftpd', 'telnetd']))
+        self.addTest(mm.generator['test']('pf03', ['test_main']))
+        self.addTest(mm.generator['test']('program02', ['test_main']))
         self.addTest(mm.generator['test']('termios', ['test_main',
                                                       'test_termios_driver',
                                                       'test_termios_utilities']))
@@ -98,6 +98,11 @@ extern "C" {
  */
 extern rtems_task_priority rpciodPriority;
 
+/** Number of worker tasks servicing the RPC servers; may be setup prior
+ * to calling rpcUdpInit(); otherwise two workers are started.
+ */
+extern int rpciodWorkers;
+
 #ifdef RTEMS_SMP
 /** CPU affinity of daemon; may be setup prior to calling rpcUdpInit();
  * otherwise the network task CPU affinity from the rtems_bsdnet_config
@@ -190,6 +195,9 @@ nfsMountsShow(FILE *f);
  * @brief Filesystem mount table mount handler.
  *
  * Filesystem mount table mount handler. Do not call, use the mount call.
+ *
+ * The mount options may contain "-v" to be verbose and "proto=tcp" to
+ * talk to the NFS server over TCP instead of UDP.
  */
 int
 rtems_nfs_initialize(rtems_filesystem_mount_table_entry_t *mt_entry,
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _RTEMS_BSD_MACHINE_RTEMS_BSD_BOOT_PROFILE_H_
+#define _RTEMS_BSD_MACHINE_RTEMS_BSD_BOOT_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+struct _device;
+struct sysinit;
+
+/*
+ * Hooks of the boot profiler, see rtems_bsd_boot_profile_enable().  They are
+ * called with Giant held.  If the boot profiler is disabled, then
+ * rtems_bsd_boot_profile_begin() returns zero and the end hooks do nothing.
+ */
+uint64_t rtems_bsd_boot_profile_begin(void);
+
+void rtems_bsd_boot_profile_sysinit(const struct sysinit *sip,
+    uint64_t begin);
+
+void rtems_bsd_boot_profile_attach(struct _device *dev, uint64_t begin,
+    int error);
+
+/*
+ * Returns true, if the attach of the probed device is deferred to a
+ * background task, see rtems_bsd_boot_defer_attach().  Called with Giant
+ * held.
+ */
+bool rtems_bsd_boot_defer_attach_check(struct _device *dev);
+
+/*
+ * Wakes up the threads waiting in rtems_bsd_wait_device().  Called by
+ * device_attach() with Giant held after a successful attach.
+ */
+void rtems_bsd_boot_attach_done(struct _device *dev);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _RTEMS_BSD_MACHINE_RTEMS_BSD_BOOT_PROFILE_H_ */
@@ -33,9 +33,13 @@
  *  RTEMS_BSD_CONFIG_NET_PF_UNIX            : Packet Filter.
  *  RTEMS_BSD_CONFIG_NET_IF_LAGG            : Link Aggregetion and Failover.
  *  RTEMS_BSD_CONFIG_NET_IF_VLAN            : Virtual LAN.
+ *  RTEMS_BSD_CONFIG_NET_DNPIPE             : Network emulation pipes.
+ *  RTEMS_BSD_CONFIG_NET_TCP_CC_CUBIC       : CUBIC TCP congestion control.
+ *  RTEMS_BSD_CONFIG_NET_TCP_CC_HTCP        : H-TCP congestion control.
  *  RTEMS_BSD_CONFIG_SERVICE_TELNETD        : Telnet Protocol (TELNET).
  *   RTEMS_BSD_CONFIG_TELNETD_STACK_SIZE    : Telnet shell task stack size.
  *  RTEMS_BSD_CONFIG_SERVICE_FTPD           : File Transfer Protocol (FTP).
+ *  RTEMS_BSD_CONFIG_SERVICE_SYSLOGD        : Remote syslog forwarding.
  *  RTEMS_BSD_CONFIG_BSP_CONFIG             : Configure default BSP devices.
  *  RTEMS_BSD_CONFIG_INIT                   : Configure the LibBSD support.
  *
@@ -111,6 +115,31 @@ extern "C" {
   #define RTEMS_BSD_CFGDECL_NET_IP6_MROUTE
 #endif /* RTEMS_BSD_CONFIG_NET_IP6_MROUTE */
 
+/*
+ * Network emulation pipes (delay, bandwidth, loss) for IPv4.
+ */
+#if defined(RTEMS_BSD_CONFIG_NET_DNPIPE)
+  #define RTEMS_BSD_CFGDECL_NET_DNPIPE SYSINIT_NEED_NET_DNPIPE
+#else
+  #define RTEMS_BSD_CFGDECL_NET_DNPIPE
+#endif /* RTEMS_BSD_CONFIG_NET_DNPIPE */
+
+/*
+ * TCP congestion control algorithms in addition to the default NewReno.
+ *  https://www.freebsd.org/cgi/man.cgi?query=mod_cc
+ */
+#if defined(RTEMS_BSD_CONFIG_NET_TCP_CC_CUBIC)
+  #define RTEMS_BSD_CFGDECL_NET_TCP_CC_CUBIC SYSINIT_NEED_NET_TCP_CC_CUBIC
+#else
+  #define RTEMS_BSD_CFGDECL_NET_TCP_CC_CUBIC
+#endif /* RTEMS_BSD_CONFIG_NET_TCP_CC_CUBIC */
+
+#if defined(RTEMS_BSD_CONFIG_NET_TCP_CC_HTCP)
+  #define RTEMS_BSD_CFGDECL_NET_TCP_CC_HTCP SYSINIT_NEED_NET_TCP_CC_HTCP
+#else
+  #define RTEMS_BSD_CFGDECL_NET_TCP_CC_HTCP
+#endif /* RTEMS_BSD_CONFIG_NET_TCP_CC_HTCP */
+
 /*
  * Bridging.
  *  https://www.freebsd.org/doc/handbook/network-bridging.html
@@ -188,6 +217,15 @@ extern "C" {
   #define RTEMS_BSD_CFGDECL_FTPD
 #endif /* RTEMS_BSD_CONFIG_SERVICE_FTPD */
 
+/*
+ * Syslogd
+ */
+#if defined(RTEMS_BSD_CONFIG_SERVICE_SYSLOGD)
+  #define RTEMS_BSD_CFGDECL_SYSLOGD RTEMS_BSD_RC_CONF_SYSINT(rc_conf_syslogd)
+#else
+  #define RTEMS_BSD_CFGDECL_SYSLOGD
+#endif /* RTEMS_BSD_CONFIG_SERVICE_SYSLOGD */
+
 /*
  * Telnetd
  */
@@ -236,6 +274,9 @@ extern "C" {
   RTEMS_BSD_CFGDECL_NET_PF_UNIX;
   RTEMS_BSD_CFGDECL_NET_IP_MROUTE;
   RTEMS_BSD_CFGDECL_NET_IP6_MROUTE;
+  RTEMS_BSD_CFGDECL_NET_DNPIPE;
+  RTEMS_BSD_CFGDECL_NET_TCP_CC_CUBIC;
+  RTEMS_BSD_CFGDECL_NET_TCP_CC_HTCP;
   RTEMS_BSD_CFGDECL_NET_IF_BRIDGE;
   RTEMS_BSD_CFGDECL_NET_IF_LAGG;
   RTEMS_BSD_CFGDECL_NET_IF_VLAN;
@@ -260,6 +301,7 @@ extern "C" {
   RTEMS_BSD_CFGDECL_TELNETD;
   RTEMS_BSD_CFGDECL_TELNETD_STACK_SIZE;
   RTEMS_BSD_CFGDECL_FTPD;
+  RTEMS_BSD_CFGDECL_SYSLOGD;
 
   RTEMS_BSD_CFGDECL_TERMIOS_KQUEUE_AND_POLL;
 #endif /* RTEMS_BSD_CONFIG_INIT */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _RTEMS_BSD_MACHINE_RTEMS_BSD_DNS_CACHE_H_
+#define _RTEMS_BSD_MACHINE_RTEMS_BSD_DNS_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * The answer cache of the name service sources.  It is shared by the unicast
+ * DNS resolver (res_nsend()) and the mDNS source.  An answer is cached for
+ * the time to live reported by the source.  Failures are cached for the
+ * net.dnscache.negative_ttl seconds.
+ */
+#define	RTEMS_BSD_DNS_CACHE_DNS		0
+#define	RTEMS_BSD_DNS_CACHE_MDNS	1
+
+/* Return values of rtems_bsd_dns_cache_lookup() */
+#define	RTEMS_BSD_DNS_CACHE_HIT		0
+#define	RTEMS_BSD_DNS_CACHE_MISS	1
+#define	RTEMS_BSD_DNS_CACHE_BYPASS	2
+
+struct rtems_bsd_dns_cache_entry;
+
+/*
+ * Looks up the answer for the question (name, qclass, qtype) of the source.
+ *
+ * RTEMS_BSD_DNS_CACHE_HIT: If *error is zero, then the answer was copied to
+ * the buffer and *len is the answer length, otherwise the cached failure is
+ * in *error.
+ *
+ * RTEMS_BSD_DNS_CACHE_MISS: The caller must resolve the question and must
+ * hand over the result with rtems_bsd_dns_cache_enter() and *entry.  Other
+ * threads asking the same question wait for this result.
+ *
+ * RTEMS_BSD_DNS_CACHE_BYPASS: The cache is disabled or cannot be used.  The
+ * caller must resolve the question on its own.
+ *
+ * The name is compared case-insensitive.  On entry, *len is the buffer size.
+ */
+int rtems_bsd_dns_cache_lookup(int source, const char *name, int qclass,
+    int qtype, void *answer, size_t *len, int *error,
+    struct rtems_bsd_dns_cache_entry **entry);
+
+/*
+ * Hands over the result of a cache miss.  If error is zero, the answer is
+ * cached for ttl seconds, otherwise the failure is cached for at most
+ * net.dnscache.negative_ttl seconds.  A ttl of zero passes an answer to the
+ * waiting threads without caching it.  A failure with a ttl of zero is not
+ * passed to the waiting threads, they get RTEMS_BSD_DNS_CACHE_BYPASS and
+ * resolve the question on their own.
+ */
+void rtems_bsd_dns_cache_enter(struct rtems_bsd_dns_cache_entry *entry,
+    const void *answer, size_t len, uint32_t ttl, int error);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _RTEMS_BSD_MACHINE_RTEMS_BSD_DNS_CACHE_H_ */
@@ -624,6 +624,7 @@
 #define	crypto_verify_64 _bsd_crypto_verify_64
 #define	crypto_verify_64_bytes _bsd_crypto_verify_64_bytes
 #define	ctl_subtype_name _bsd_ctl_subtype_name
+#define	cubic_cc_algo _bsd_cubic_cc_algo
 #define	cuio_apply _bsd_cuio_apply
 #define	cuio_copyback _bsd_cuio_copyback
 #define	cuio_copydata _bsd_cuio_copydata
@@ -1132,6 +1133,8 @@
 #define	ether_crc32_be _bsd_ether_crc32_be
 #define	ether_crc32_le _bsd_ether_crc32_le
 #define	ether_demux _bsd_ether_demux
+#define	ether_gso_attach _bsd_ether_gso_attach
+#define	ether_gso_setcap _bsd_ether_gso_setcap
 #define	ether_ifattach _bsd_ether_ifattach
 #define	ether_ifdetach _bsd_ether_ifdetach
 #define	ether_ioctl _bsd_ether_ioctl
@@ -1374,6 +1377,7 @@
 #define	hmac_ipad_buffer _bsd_hmac_ipad_buffer
 #define	hmac_opad_buffer _bsd_hmac_opad_buffer
 #define	HouseKeeping _bsd_HouseKeeping
+#define	htcp_cc_algo _bsd_htcp_cc_algo
 #define	hz _bsd_hz
 #define	icmp6_ctloutput _bsd_icmp6_ctloutput
 #define	icmp6_error _bsd_icmp6_error
@@ -1908,6 +1912,7 @@
 #define	ifindex_table _bsd_ifindex_table
 #define	if_initname _bsd_if_initname
 #define	if_input _bsd_if_input
+#define	if_input_batch _bsd_if_input_batch
 #define	ifioctl _bsd_ifioctl
 #define	if_link_state_change _bsd_if_link_state_change
 #define	ifma6_restart _bsd_ifma6_restart
@@ -1930,6 +1935,9 @@
 #define	ifnet_byindex_ref _bsd_ifnet_byindex_ref
 #define	ifnet_rwlock _bsd_ifnet_rwlock
 #define	ifnet_sxlock _bsd_ifnet_sxlock
+#define	if_poll_attach _bsd_if_poll_attach
+#define	if_poll_detach _bsd_if_poll_detach
+#define	if_poll_intr _bsd_if_poll_intr
 #define	if_printf _bsd_if_printf
 #define	ifpromisc _bsd_ifpromisc
 #define	if_purgeaddrs _bsd_if_purgeaddrs
@@ -2328,6 +2336,7 @@
 #define	ip_divert_ptr _bsd_ip_divert_ptr
 #define	ip_dn_ctl_ptr _bsd_ip_dn_ctl_ptr
 #define	ip_dn_io_ptr _bsd_ip_dn_io_ptr
+#define	ip_dnpipe_pf_ptr _bsd_ip_dnpipe_pf_ptr
 #define	ip_dooptions _bsd_ip_dooptions
 #define	ip_doopts _bsd_ip_doopts
 #define	ip_drain _bsd_ip_drain
@@ -2922,6 +2931,7 @@
 #define	nd_prefix _bsd_nd_prefix
 #define	netisr_clearqdrops _bsd_netisr_clearqdrops
 #define	netisr_dispatch _bsd_netisr_dispatch
+#define	netisr_dispatch_batch _bsd_netisr_dispatch_batch
 #define	netisr_dispatch_src _bsd_netisr_dispatch_src
 #define	netisr_getqdrops _bsd_netisr_getqdrops
 #define	netisr_getqlimit _bsd_netisr_getqlimit
@@ -4756,6 +4766,7 @@
 #define	sysctl___net_inet_raw _bsd_sysctl___net_inet_raw
 #define	sysctl___net_inet_tcp _bsd_sysctl___net_inet_tcp
 #define	sysctl___net_inet_tcp_cc _bsd_sysctl___net_inet_tcp_cc
+#define	sysctl___net_inet_tcp_cc_htcp _bsd_sysctl___net_inet_tcp_cc_htcp
 #define	sysctl___net_inet_tcp_cc_newreno _bsd_sysctl___net_inet_tcp_cc_newreno
 #define	sysctl___net_inet_tcp_lro _bsd_sysctl___net_inet_tcp_lro
 #define	sysctl___net_inet_tcp_sack _bsd_sysctl___net_inet_tcp_sack
@@ -4871,6 +4882,7 @@
 #define	tcp_lro_init_args _bsd_tcp_lro_init_args
 #define	tcp_lro_queue_mbuf _bsd_tcp_lro_queue_mbuf
 #define	tcp_lro_rx _bsd_tcp_lro_rx
+#define	tcp_lro_rx_csum _bsd_tcp_lro_rx_csum
 #define	tcp_maxmtu _bsd_tcp_maxmtu
 #define	tcp_maxmtu6 _bsd_tcp_maxmtu6
 #define	tcp_maxpersistidle _bsd_tcp_maxpersistidle
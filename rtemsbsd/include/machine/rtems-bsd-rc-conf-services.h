@@ -72,9 +72,29 @@ typedef int (*rtems_bsd_rc_conf_service)(rtems_bsd_rc_conf* rc_conf);
  *  before
  *  after
  *  require
+ *  start
+ *  wait
  *
  * For example "before:telnet;after:net;require:net"
  *
+ * The 'start' key is 'sequential' (the default) or 'concurrent'. A concurrent
+ * service runs in its own task and the following services are started without
+ * waiting for it to finish. A service waits for any running service it names
+ * in 'after' or 'require' or that names it in 'before'. All services have
+ * finished when the rc.conf run completes.
+ *
+ * The 'wait' key lists the conditions a service needs before it is started:
+ *
+ *  defaultroute   A default route is installed.
+ *  ifaddr         Any interface other than the loopback has an address.
+ *  ifaddr=<name>  The interface <name> has an address.
+ *
+ * The conditions are detected using routing socket events. The wait is
+ * limited by the rc.conf 'defaultroute_delay' setting, 30 seconds by default,
+ * and the service is started with a warning if it expires.
+ *
+ * For example "after:network;start:concurrent;wait:defaultroute;"
+ *
  * Notes
  *
  *  1. The parsing of this string is simple and will not handle any
@@ -92,6 +112,26 @@ extern int rtems_bsd_rc_conf_service_add(const char*               name,
  */
 extern int rtems_bsd_rc_conf_service_remove(const char* name);
 
+/*
+ * The timing of a service from the last rc.conf run. The times are from the
+ * monotonic clock in nanoseconds. The service was queued when its position in
+ * the service order was reached, started once the services it depends on had
+ * finished and its wait conditions were met, and ended when it returned.
+ */
+typedef struct rtems_bsd_rc_conf_service_profile {
+  uint64_t queued;
+  uint64_t start;
+  uint64_t end;
+  int      result;
+} rtems_bsd_rc_conf_service_profile;
+
+/*
+ * Get the profile of a service. Returns -1 with errno set to ENOENT if the
+ * service is not registered.
+ */
+extern int rtems_bsd_rc_conf_service_profile_get(const char*                        name,
+                                                 rtems_bsd_rc_conf_service_profile* profile);
+
 /*
  * Return the name of the file being processed.
  */
@@ -160,6 +200,7 @@ void rc_conf_telnetd_init(void* arg);       /* telnetd_enabled="YES" */
 void rc_conf_ftpd_init(void* arg);          /* ftpd_enabled="YES" */
 void rc_conf_ipsec_init(void* arg);         /* ipsec_enabled="YES"
                                                and ike_enabled="YES" */
+void rc_conf_syslogd_init(void* arg);       /* syslogd_remote_enable="YES" */
 
 /*
  * Added services.
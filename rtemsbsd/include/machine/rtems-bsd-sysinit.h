@@ -93,6 +93,15 @@
 #define SYSINIT_NEED_NET_IP6_MROUTE \
 	SYSINIT_MODULE_REFERENCE(ip6_mroute)
 
+#define SYSINIT_NEED_NET_DNPIPE \
+	SYSINIT_REFERENCE(dnpipe)
+
+#define SYSINIT_NEED_NET_TCP_CC_CUBIC \
+	SYSINIT_MODULE_REFERENCE(cubic)
+
+#define SYSINIT_NEED_NET_TCP_CC_HTCP \
+	SYSINIT_MODULE_REFERENCE(htcp)
+
 #define SYSINIT_NEED_NET_IF_BFE \
 	SYSINIT_DRIVER_REFERENCE(bfe, pci)
 
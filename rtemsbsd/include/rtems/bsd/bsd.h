@@ -45,6 +45,7 @@
 #include <sys/kernel.h>
 
 #include <stdarg.h>
+#include <stdio.h>
 
 #include <rtems.h>
 
@@ -257,6 +258,103 @@ int rtems_bsd_bus_root_resume(void);
  */
 int rtems_bsd_bus_root_detach(void);
 
+/**
+ * @brief Enables the boot profiler.
+ *
+ * The duration of each SYSINIT function and each device attach is recorded.
+ * This function must be called before rtems_bsd_initialize().
+ *
+ * @param max_records The maximum count of records.  Further events are counted
+ * as lost.
+ *
+ * @retval RTEMS_SUCCESSFUL Successful operation.
+ * @retval RTEMS_INCORRECT_STATE The boot profiler is already enabled or the
+ * initialization is done.
+ * @retval RTEMS_INVALID_NUMBER The record count is invalid.
+ * @retval RTEMS_NO_MEMORY Not enough memory for the records.
+ *
+ * @see rtems_bsd_boot_profile_report() and the debug.boot_profile sysctl.
+ */
+rtems_status_code rtems_bsd_boot_profile_enable(size_t max_records);
+
+/**
+ * @brief Prints the boot profile sorted by the time spent in each SYSINIT
+ * function or device attach without the nested events.
+ *
+ * @param file The output file.
+ * @param max_lines The maximum count of records to print.  Zero prints all
+ * records.
+ */
+void rtems_bsd_boot_profile_report(FILE *file, size_t max_lines);
+
+/**
+ * @brief Defers the attach of devices of a driver during the initialization.
+ *
+ * Devices of this driver are probed during rtems_bsd_initialize() as usual,
+ * however, each device is attached by its own background task.  If the driver
+ * is a bus, then the attach of the complete subtree is done by this task.  The
+ * tasks run while the initialization sleeps and after rtems_bsd_initialize()
+ * returned.  Use this for slow devices which are not needed to bring up the
+ * network.  Use rtems_bsd_wait_device() to wait for a device.  This function
+ * must be called before rtems_bsd_initialize().
+ *
+ * The PHY bus "miibus" cannot be deferred.  The network interface drivers
+ * expect the PHYs to be attached when mii_attach() returns.  The PHY attach
+ * does not wait for a link, the auto-negotiation completes in the background
+ * and the link state is reported to the interface through mii_tick().
+ *
+ * @param driver The driver name, e.g. "mmcsd".
+ *
+ * @retval RTEMS_SUCCESSFUL Successful operation.
+ * @retval RTEMS_INCORRECT_STATE The initialization is done.
+ * @retval RTEMS_INVALID_NAME The driver name is invalid or "miibus".
+ * @retval RTEMS_TOO_MANY Too many deferred drivers.
+ */
+rtems_status_code rtems_bsd_boot_defer_attach(const char *driver);
+
+/**
+ * @brief Defers the attach of the buses which are slow to initialize.
+ *
+ * These are the USB buses (hub port power-on and device enumeration) and the
+ * MMC/SD buses (card identification).
+ *
+ * @see rtems_bsd_boot_defer_attach().
+ */
+rtems_status_code rtems_bsd_boot_defer_slow_buses(void);
+
+/**
+ * @brief Waits for the attach of a device.
+ *
+ * @param name The device name without the unit, e.g. "mmcsd".
+ * @param unit The device unit.
+ * @param timeout The timeout in clock ticks.  Use RTEMS_NO_TIMEOUT to wait
+ * forever.
+ *
+ * @retval RTEMS_SUCCESSFUL The device is attached.
+ * @retval RTEMS_INVALID_NAME The name is NULL.
+ * @retval RTEMS_TIMEOUT The device was not attached within the timeout.
+ */
+rtems_status_code rtems_bsd_wait_device(const char *name, int unit,
+    rtems_interval timeout);
+
+/**
+ * @brief Prints the statistics and the entries of the answer cache of the DNS
+ * and mDNS name service sources.
+ *
+ * @param file The output file.
+ *
+ * @see The net.dnscache sysctls.
+ */
+void rtems_bsd_dns_cache_report(FILE *file);
+
+/**
+ * @brief Removes all answers from the answer cache of the DNS and mDNS name
+ * service sources.
+ *
+ * Lookups in progress are not affected.
+ */
+void rtems_bsd_dns_cache_flush(void);
+
 /**
  * @brief The output back-end for logging functions.
  */
@@ -303,6 +401,151 @@ int rtems_bsd_setlogpriority(const char* priority);
  */
 int rtems_bsd_vprintf_handler_mute(int level, const char *fmt, va_list ap);
 
+/**
+ * @brief Deferred output back-end for logging functions.
+ *
+ * Copies the format string and the arguments into a ring buffer of the
+ * current processor without formatting the message.  The messages are
+ * formatted and passed to the previous output back-end by a task of low
+ * priority.  Messages with a priority of LOG_CRIT or higher are passed to the
+ * previous output back-end immediately.  If a ring buffer is full, then the
+ * message is dropped and counted.
+ *
+ * String arguments are truncated to 200 characters.
+ *
+ * @retval Always 0.
+ *
+ * @see rtems_bsd_vprintf() for the parameters and
+ * rtems_bsd_vprintf_deferred_start().
+ */
+int rtems_bsd_vprintf_deferred(int level, const char *fmt, va_list ap);
+
+/**
+ * @brief Starts the deferred output of logging functions.
+ *
+ * Allocates one ring buffer for each configured processor, starts the output
+ * task and installs rtems_bsd_vprintf_deferred() as the output back-end.  The
+ * previous output back-end is used to output the formatted messages.
+ *
+ * @param ring_size The ring buffer size in bytes.  It is rounded up to a power
+ * of two of at least 1024 bytes.
+ * @param priority The output task priority.
+ *
+ * @retval RTEMS_SUCCESSFUL Successful operation.
+ * @retval RTEMS_INCORRECT_STATE The deferred output is already started.
+ * @retval other Creation of the output task failed.
+ */
+rtems_status_code rtems_bsd_vprintf_deferred_start(size_t ring_size,
+    rtems_task_priority priority);
+
+/**
+ * @brief Prints the ring buffer statistics and the pending messages of the
+ * deferred output.
+ *
+ * The pending messages are not consumed.
+ *
+ * @param file The output file.
+ */
+void rtems_bsd_vprintf_deferred_dump(FILE *file);
+
+/**
+ * @brief Configuration of the remote syslog forwarding.
+ *
+ * @see rtems_bsd_syslog_remote_start().
+ */
+typedef struct {
+	/**
+	 * @brief The host name or address of the remote syslog server.
+	 */
+	const char *host;
+
+	/**
+	 * @brief The service name or port of the remote syslog server.
+	 *
+	 * If NULL, then "514" is used.
+	 */
+	const char *port;
+
+	/**
+	 * @brief If true, then use a persistent TCP connection with octet
+	 * counting framing (RFC 6587), otherwise use UDP.
+	 */
+	bool tcp;
+
+	/**
+	 * @brief The message queue size in bytes.
+	 *
+	 * If zero, then 16KiB are used.
+	 */
+	size_t queue_size;
+
+	/**
+	 * @brief The maximum size of a batch of messages in bytes.
+	 *
+	 * For UDP, this is the maximum datagram size.  Messages of one datagram
+	 * are separated by a newline character.  If zero, then each datagram
+	 * contains exactly one message as defined by RFC 5426.
+	 */
+	size_t batch_size;
+
+	/**
+	 * @brief The time in clock ticks to wait for more messages before a
+	 * partial batch is sent.
+	 */
+	rtems_interval flush_interval;
+
+	/**
+	 * @brief If true, then drop the oldest queued messages on a queue
+	 * overflow, otherwise drop the new message.
+	 */
+	bool drop_oldest;
+
+	/**
+	 * @brief The priority of the forwarding task.
+	 */
+	rtems_task_priority priority;
+} rtems_bsd_syslog_remote_config;
+
+/**
+ * @brief Statistics of the remote syslog forwarding.
+ */
+typedef struct {
+	uint32_t queued;
+	uint32_t sent;
+	uint32_t batches;
+	uint32_t dropped;
+	uint32_t send_errors;
+} rtems_bsd_syslog_remote_stats;
+
+/**
+ * @brief Starts the remote syslog forwarding.
+ *
+ * Messages passed to syslog() and vsyslog() which pass the syslog mask are
+ * formatted according to RFC 5424 and placed in a bounded queue.  A task sends
+ * the queued messages in batches to the remote syslog server.  The local
+ * output via rtems_bsd_vprintf() is not affected.
+ *
+ * The host name is resolved by the forwarding task.  Messages are queued
+ * until the host name can be resolved or the TCP connection is established.
+ *
+ * @param config The forwarding configuration.  The strings are copied.
+ *
+ * @retval RTEMS_SUCCESSFUL Successful operation.
+ * @retval RTEMS_INVALID_ADDRESS The host is NULL.
+ * @retval RTEMS_INCORRECT_STATE The forwarding is already started.
+ * @retval RTEMS_NO_MEMORY Not enough memory.
+ * @retval other Creation of the forwarding task failed.
+ */
+rtems_status_code rtems_bsd_syslog_remote_start(
+    const rtems_bsd_syslog_remote_config *config);
+
+/**
+ * @brief Gets the statistics of the remote syslog forwarding.
+ *
+ * @param stats The statistics.
+ */
+void rtems_bsd_syslog_remote_get_stats(rtems_bsd_syslog_remote_stats *stats);
+
 /** @} */
 
 #ifdef __cplusplus
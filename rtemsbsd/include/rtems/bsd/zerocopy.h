@@ -58,9 +58,30 @@ void rtems_bsd_m_extaddref(struct mbuf *m, void *buf, size_t size,
 
 void rtems_bsd_m_free(struct mbuf *m);
 
+void rtems_bsd_m_freem(struct mbuf *m);
+
 int rtems_bsd_sendto(int socket, struct mbuf *m, int flags,
     const struct sockaddr *dest_addr);
 
+/**
+ * @brief Receives a message as an mbuf chain without copying the data.
+ *
+ * @param socket The socket.
+ * @param mp The received mbuf chain.  The caller must free it with
+ *   rtems_bsd_m_freem().
+ * @param len On entry, the maximum number of bytes to receive.  On exit, the
+ *   number of bytes received.
+ * @param flags The receive flags, see recvfrom().
+ * @param from The source address or NULL.
+ * @param fromlen The length of the source address buffer, updated to the
+ *   actual length of the source address.
+ *
+ * @retval 0 Successful operation.
+ * @retval other An error number.
+ */
+int rtems_bsd_recvfrom(int socket, struct mbuf **mp, size_t *len, int flags,
+    struct sockaddr *from, socklen_t *fromlen);
+
 struct ifnet;
 
 typedef void (*rtems_bsd_if_input_init)(struct ifnet *, void *);
@@ -84,6 +105,35 @@ rtems_bsd_if_input rtems_bsd_set_if_input(const char *ifname,
     rtems_bsd_if_input_init init, rtems_bsd_if_input if_input,
     void *arg);
 
+/**
+ * @brief Interface input handler for a chain of packets linked via
+ * struct mbuf::m_nextpkt.
+ */
+typedef void (*rtems_bsd_if_input_batch)(struct ifnet *, struct mbuf *);
+
+/**
+ * @brief Sets the batched interface input handler of the specified network
+ * interface.
+ *
+ * Drivers pass all packets received in one run of their receive loop to this
+ * handler.  It is also used as the per-packet interface input handler, so it
+ * must accept chains of length one.  The old batched handler accepts chains
+ * of any length.
+ *
+ * @param ifname The network interface name.
+ * @param init Initialization routine called right before the new interface
+ *   input handler is registered in the context of the executing thread.
+ * @param if_input_batch The new batched interface input handler.
+ * @param arg The interface input handler argument available via struct
+ * ifnet::if_input_arg.
+ *
+ * @retval NULL An error occurred.
+ * @retval other The old batched interface input handler.
+ */
+rtems_bsd_if_input_batch rtems_bsd_set_if_input_batch(const char *ifname,
+    rtems_bsd_if_input_init init, rtems_bsd_if_input_batch if_input_batch,
+    void *arg);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -54,6 +54,10 @@ extern rtems_shell_cmd_t rtems_shell_STTY_Command;
 extern rtems_shell_cmd_t rtems_shell_RACOON_Command;
 extern rtems_shell_cmd_t rtems_shell_SETKEY_Command;
 
+extern rtems_shell_cmd_t rtems_shell_KLOG_Command;
+extern rtems_shell_cmd_t rtems_shell_BOOTPROF_Command;
+extern rtems_shell_cmd_t rtems_shell_DNSCACHE_Command;
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
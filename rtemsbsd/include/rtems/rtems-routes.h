@@ -41,6 +41,21 @@ extern "C" {
  */
 int rtems_get_route(const struct sockaddr_in* sin, struct sockaddr** rti_info);
 
+/*
+ * Wait for an IPv4 default route with a gateway. The wait is driven by the
+ * messages of a routing socket. The timeout is in milliseconds. Returns 0 if
+ * the route is present and -1 with errno set to ETIMEDOUT if not.
+ */
+int rtems_wait_default_route(int timeout_ms);
+
+/*
+ * Wait for an IPv4 or a not link-local IPv6 address on an interface. If the
+ * interface name is NULL any interface except loopback interfaces is
+ * checked. The timeout is in milliseconds. Returns 0 if an address is present
+ * and -1 with errno set to ETIMEDOUT if not.
+ */
+int rtems_wait_ifaddr(const char* ifname, int timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -108,6 +108,7 @@ void	epoch_wait_preempt(epoch_t epoch);
 
 void	epoch_call(epoch_t epoch, epoch_context_t ctx,
 	    void (*callback) (epoch_context_t));
+void	epoch_drain_callbacks(epoch_t epoch);
 
 int	in_epoch(epoch_t epoch);
 int	in_epoch_verbose(epoch_t epoch, int dump_onfail);
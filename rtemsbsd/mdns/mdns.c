@@ -52,6 +52,8 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <machine/rtems-bsd-dns-cache.h>
+
 #include <rtems/bsd/util.h>
 #include <rtems/mdns.h>
 
@@ -63,6 +65,7 @@ static mDNS_PlatformSupport PlatformStorage;
 
 typedef struct {
 	mDNSu16 rrtype;
+	mDNSu32 ttl;
 	struct hostent *he;
 	rtems_id task_id;
 } query_context;
@@ -83,12 +86,14 @@ query_callback(mDNS *m, DNSQuestion *q, const ResourceRecord *answer,
 		const mDNSv4Addr *ipv4 = &answer->rdata->u.ipv4;
 
 		memcpy(he->h_addr_list[0], ipv4, sizeof(*ipv4));
+		ctx->ttl = answer->rroriginalttl;
 		stop = true;
 	} else if (ctx->rrtype == kDNSType_AAAA
 	    && answer->rrtype == kDNSType_AAAA) {
 		const mDNSv6Addr *ipv6 = &answer->rdata->u.ipv6;
 
 		memcpy(he->h_addr_list[0], ipv6, sizeof(*ipv6));
+		ctx->ttl = answer->rroriginalttl;
 		stop = true;
 	}
 
@@ -140,6 +145,9 @@ mdns_gethostbyname(void *rval, void *cb_data, va_list ap)
 	query_context ctx;
 	mDNSu8 *qname;
 	rtems_status_code sc;
+	struct rtems_bsd_dns_cache_entry *entry;
+	size_t addrlen;
+	int error;
 
 	memset(&q, 0, sizeof(q));
 	memset(&ctx, 0, sizeof(ctx));
@@ -211,6 +219,26 @@ mdns_gethostbyname(void *rval, void *cb_data, va_list ap)
 		return (NS_UNAVAIL);
 	}
 
+	addrlen = (size_t)hep->h_length;
+	switch (rtems_bsd_dns_cache_lookup(RTEMS_BSD_DNS_CACHE_MDNS, name,
+	    kDNSClass_IN, ctx.rrtype, hep->h_addr_list[0], &addrlen, &error,
+	    &entry)) {
+	case RTEMS_BSD_DNS_CACHE_HIT:
+		if (error != 0) {
+			*h_errnop = NETDB_INTERNAL;
+			*errnop = error;
+			return (NS_NOTFOUND);
+		}
+
+		*resultp = hep;
+		return (NS_SUCCESS);
+	case RTEMS_BSD_DNS_CACHE_MISS:
+		break;
+	default:
+		entry = NULL;
+		break;
+	}
+
 	q.TargetPort = MulticastDNSPort;
 	q.qtype = kDNSQType_ANY;
 	q.qclass = kDNSClass_IN;
@@ -219,7 +247,6 @@ mdns_gethostbyname(void *rval, void *cb_data, va_list ap)
 	q.QuestionCallback = query_callback;
 	q.QuestionContext = &ctx;
 
-	ctx.rrtype = kDNSType_A;
 	ctx.he = hep;
 	ctx.task_id = rtems_task_self();
 
@@ -232,11 +259,21 @@ mdns_gethostbyname(void *rval, void *cb_data, va_list ap)
 	mDNS_StopQuery(&mDNSStorage, &q);
 
 	if (sc != RTEMS_SUCCESSFUL) {
+		if (entry != NULL) {
+			rtems_bsd_dns_cache_enter(entry, NULL, 0, UINT32_MAX,
+			    ETIMEDOUT);
+		}
+
 		*h_errnop = NETDB_INTERNAL;
 		*errnop = ETIMEDOUT;
 		return (NS_NOTFOUND);
 	}
 
+	if (entry != NULL) {
+		rtems_bsd_dns_cache_enter(entry, hep->h_addr_list[0],
+		    (size_t)hep->h_length, ctx.ttl, 0);
+	}
+
 	*resultp = hep;
 	return (NS_SUCCESS);
 }
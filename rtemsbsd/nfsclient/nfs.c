@@ -1810,9 +1810,13 @@ int					e         = -1;
 char				*path     = mt_entry->dev;
 const char          *options = (const char*) data;
 bool                verbose = false;
+int                 proto = IPPROTO_UDP;
 
-	if (options != NULL)
+	if (options != NULL) {
 		verbose = strstr(options, "-v") != NULL;
+		if (strstr(options, "proto=tcp") != NULL)
+			proto = IPPROTO_TCP;
+	}
 
 	if (rpcUdpInit (verbose) < 0) {
 		fprintf (stderr, "error: initialising RPC\n");
@@ -1837,12 +1841,13 @@ bool                verbose = false;
 		 retry >= 0 && stat;
 		 stat && (saddr.sin_port = htons(NFS_V2_PORT)), retry-- )
 #endif
-		stat = rpcUdpServerCreate(
+		stat = rpcUdpServerCreateProto(
 					&saddr,
 					NFS_PROGRAM,
 					NFS_VERSION_2,
 					uid,
 					gid,
+					proto,
 					&nfsServer
 					);
 
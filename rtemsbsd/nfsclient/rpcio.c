@@ -4,16 +4,17 @@
  * @brief RPC Multiplexor for a Multitasking Environment
  * @ingroup libfs
  *
- * This code funnels arbitrary task's UDP/RPC requests
- * through one socket to arbitrary servers.
- * The replies are gathered and dispatched to the
- * requestors.
- * One task handles all the sending and receiving
- * work including retries.
+ * This code funnels arbitrary task's RPC requests
+ * over UDP or TCP to arbitrary servers. Each server
+ * has its own socket and retransmission timer.
+ * The requestors send their requests themselves;
+ * the replies are gathered and dispatched to the
+ * requestors by a pool of worker tasks which also
+ * take care of retries.
  * It is up to the requestor, however, to do
  * the XDR encoding of the arguments / decoding
  * of the results (except for the RPC header which
- * is handled by the daemon).
+ * is handled here).
  */
 
 /*
@@ -71,7 +72,9 @@
 
 #include <rtems.h>
 #include <rtems/error.h>
+#include <rtems/thread.h>
 #include <rtems/bsd/bsd.h>
+#include <rtems/bsd/zerocopy.h>
 #include <stdlib.h>
 #include <time.h>
 #include <rpc/rpc.h>
@@ -83,6 +86,7 @@
 #include <errno.h>
 #include <string.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/cpuset.h>
 #include <sys/event.h>
@@ -94,17 +98,18 @@
 /* CONFIGURABLE PARAMETERS                                      */
 /****************************************************************/
 
-#undef MBUF_RX			/* If defined: use mbuf XDR stream for
+#define MBUF_RX			/* If defined: use mbuf XDR stream for
 						 *  decoding directly out of mbufs
+						 *  received by 'rtems_bsd_recvfrom()'.
 						 *  Otherwise, the regular 'recvfrom()'
 						 *  interface will be used involving an
 						 *  extra buffer allocation + copy step.
 						 */
 
-#undef MBUF_TX			/* If defined: avoid copying data when
-						 *  sending. Instead, use a wrapper to
-						 *  'sosend()' which will point an MBUF
-						 *  directly to our buffer space.
+#define MBUF_TX			/* If defined: avoid copying data when
+						 *  sending. Instead, use
+						 *  'rtems_bsd_sendto()' with an MBUF
+						 *  pointing directly to our buffer space.
 						 *  Note that the BSD stack does not copy
 						 *  data when fragmenting packets - it
 						 *  merely uses an mbuf chain pointing
@@ -114,6 +119,14 @@
 						 *  interface is used.
 						 */
 
+#if defined(MBUF_RX) && defined(MBUF_TX)
+#define RPCIOD_TCP				/* The TCP transport (RFC 5531 record
+						 *  marking) passes mbuf chains in both
+						 *  directions. It is only available if
+						 *  both MBUF_RX and MBUF_TX are defined.
+						 */
+#endif
+
 #undef REJECT_SERVERIP_MISMATCH
 						/* If defined, RPC replies must come from the server
 						 * that was queried. Eric Norum has reported problems
@@ -124,13 +137,37 @@
 /* daemon task parameters */
 #define RPCIOD_NAME		"RPCD"
 
-/* depth of the message queue for sending
- * RPC requests to the daemon
+/* default number of worker tasks servicing the
+ * sockets and retransmission timers of the servers
+ * (see rpciodWorkers)
+ */
+#define RPCIOD_WORKERS		2
+
+/* Retransmission timeout (RTO) of a server; it is
+ * estimated from the round trip times (Jacobson/Karels,
+ * RFC 6298) within these limits
+ */
+#define RPCIOD_RTO_INIT_MS	1000
+#define RPCIOD_RTO_MIN_MS	20
+#define RPCIOD_RTO_MAX_S	60 /* seconds */
+
+/* Round trip time histogram of a server; bucket 'i' counts
+ * round trip times below 2^(i + RPCIOD_HIST_SHIFT) us, the
+ * last bucket counts all others
  */
-#define RPCIOD_QDEPTH		20
+#define RPCIOD_HIST_BUCKETS	16
+#define RPCIOD_HIST_SHIFT	7
 
-/* Maximum retry limit for retransmission */
-#define RPCIOD_RETX_CAP_S	3 /* seconds */
+/* Minimum interval between two connection attempts
+ * to a TCP server
+ */
+#define RPCIOD_TCP_HOLDOFF_S	1 /* seconds */
+
+/* Maximum size of a RPC record received over TCP */
+#define RPCIOD_TCP_MAXREC	(64*1024)
+
+/* Maximum number of kqueue events processed at once */
+#define RPCIOD_MAX_EVENTS	8
 
 /* Default timeout for RPC calls */
 #define RPCIOD_DEFAULT_TIMEOUT	(&_rpc_default_timeout)
@@ -149,10 +186,9 @@ static struct timeval _rpc_default_timeout = { 10 /* secs */, 0 /* usecs */ };
 											 * RPC IO will receive this - hence it is
 											 * RESERVED
 											 */
-#define RPCIOD_KQ_IDENT		0xeb
-#define RPCIOD_RX_EVENT		0x1	/* Events the RPCIOD is using/waiting for */
-#define RPCIOD_TX_EVENT		0x2
-#define RPCIOD_KILL_EVENT	0x4	/* send to the daemon to kill it          */
+#define RPCIOD_KQ_IDENT		0xeb	/* ident of the user event of the workers     */
+#define RPCIOD_SRV_IDENT	0x100	/* first kqueue ident (and udata) of a server */
+#define RPCIOD_KILL_EVENT	0x4	/* send to the workers to kill them           */
 
 #define LD_XACT_HASH		8				/* ld of the size of the transaction hash table  */
 
@@ -178,13 +214,6 @@ static struct timeval _rpc_default_timeout = { 10 /* secs */, 0 /* usecs */ };
 /* END OF CONFIGURABLE SECTION                                  */
 /****************************************************************/
 
-/* prevent rollover of our timers by readjusting the epoch on the fly */
-#if	(DEBUG) & DEBUG_TIMEOUT
-#define RPCIOD_EPOCH_SECS	10
-#else
-#define RPCIOD_EPOCH_SECS	10000
-#endif
-
 #ifdef	DEBUG
 #define ASSERT(arg)			assert(arg)
 #else
@@ -245,17 +274,15 @@ static struct timeval _rpc_default_timeout = { 10 /* secs */, 0 /* usecs */ };
 			   				RTEMS_INHERIT_PRIORITY | 		\
 						   	RTEMS_BINARY_SEMAPHORE)
 
-#define FIRST_ATTEMPT		0x88888888 /* some time that is never reached */
-
 /****************************************************************/
 /* TYPE DEFINITIONS                                             */
 /****************************************************************/
 
-typedef	rtems_interval		TimeoutT;
+typedef	int64_t				TimeoutT;	/* microseconds, see rpcNow() */
 
 /* 100000th implementation of a doubly linked list;
- * since only one thread is looking at these,
- * we need no locking
+ * the lists are protected by the lock of
+ * their server
  */
 typedef struct ListNodeRec_ {
 	struct ListNodeRec_ *next, *prev;
@@ -264,7 +291,11 @@ typedef struct ListNodeRec_ {
 
 /* Structure representing an RPC server */
 typedef struct RpcUdpServerRec_ {
-		RpcUdpServer		next;			/* linked list of all servers; protected by hlock */
+		RpcUdpServer		next;			/* linked list of all servers; protected by llock */
+		uintptr_t			ident;			/* kqueue ident and udata of this server          */
+		int					refs;			/* references; protected by llock                 */
+		rtems_id			lock;			/* MUTEX protecting the transmission state below  */
+		int					dead;			/* destroyed; waits for the last reference        */
 		union {
 		struct sockaddr_in	sin;
 		struct sockaddr     sa;
@@ -283,14 +314,33 @@ typedef struct RpcUdpServerRec_ {
 											 * experience will show if the current (1)
 											 * approach has to be changed.
 											 */
-		TimeoutT			retry_period;	/* dynamically adjusted retry period
-											 * (based on packet roundtrip time)
-											 */
+		int					proto;			/* IPPROTO_UDP or IPPROTO_TCP */
+		int					sock;			/* UDP socket or TCP connection or -1 */
+		ListNodeRec			xacts;			/* outstanding transactions sorted by age */
+		TimeoutT			timer;			/* expiration of the armed timer or 0 */
+		/* retransmission timeout estimation */
+		TimeoutT			srtt;			/* smoothed round trip time; 0 if not yet measured */
+		TimeoutT			rttvar;			/* round trip time variation                       */
+		TimeoutT			rto;			/* current retransmission timeout                  */
+#ifdef RPCIOD_TCP
+		/* TCP connection */
+		int					state;			/* TCP_IDLE, TCP_CONNECTING or TCP_CONNECTED           */
+		unsigned long		gen;			/* incremented for every established connection        */
+		TimeoutT			holdoff;		/* no connection attempt before this time              */
+		uint32_t			rmark;			/* record mark of the fragment being received          */
+		int					rmarklen;		/* bytes of the record mark received so far            */
+		uint32_t			fresid;			/* bytes missing from the current fragment             */
+		uint32_t			reclen;			/* bytes of the record received so far                 */
+		struct mbuf			*rec;			/* the record being received                           */
+		struct mbuf			*rectail;		/* the last mbuf of the record being received          */
+		unsigned long		connects;		/* how many connections were established               */
+#endif
 		/* STATISTICS */
 		unsigned long		retrans;		/* how many retries were issued by this server         */
 		unsigned long		requests;		/* how many requests have been sent                    */
 		unsigned long       timeouts;		/* how many requests have timed out                    */
 		unsigned long       errors;         /* how many errors have occurred (other than timeouts) */
+		unsigned long		rtthist[RPCIOD_HIST_BUCKETS];	/* histogram of the round trip times   */
 		char				name[20];		/* server's address in IP 'dot' notation               */
 } RpcUdpServerRec;
 
@@ -308,8 +358,8 @@ typedef union  RpcBufU_ {
  */
 #ifdef MBUF_RX
 typedef	struct mbuf *		RxBuf;	/* an MBUF chain */
-static  void   				bufFree(struct mbuf **m);
-#define XID(ibuf) 			(*(mtod((ibuf), u_long *)))
+#define	bufFree(b)			do { rtems_bsd_m_freem(*(b)); *(b)=0; } while(0)
+static  uint32_t			XID(struct mbuf *m);
 #else
 typedef RpcBuf				RxBuf;
 #define	bufFree(b)			do { MY_FREE(*(b)); *(b)=0; } while(0)
@@ -324,13 +374,17 @@ typedef RpcBuf				RxBuf;
 typedef struct RpcUdpXactRec_ {
 		ListNodeRec			node;		/* so we can put XACTs on a list                */
 		RpcUdpServer		server;		/* server this XACT goes to                     */
-		long				lifetime;	/* during the lifetime, retry attempts are made */
-		long				tolive;		/* lifetime timer                               */
+		TimeoutT			lifetime;	/* during the lifetime, retry attempts are made */
+		TimeoutT			tolive;		/* lifetime timer                               */
 		struct rpc_err		status;		/* RPC reply error status                       */
-		long				age;		/* age info; needed to manage retransmission    */
-		long				trip;		/* record round trip time in ticks              */
+		TimeoutT			age;		/* age info; needed to manage retransmission    */
+		TimeoutT			trip;		/* record round trip time                       */
+		int					sent;		/* how often the request was sent               */
 		rtems_id			requestor;	/* the task waiting for this XACT to complete   */
 		RpcUdpXactPool		pool;		/* if this XACT belong to a pool, this is it    */
+#ifdef  RPCIOD_TCP
+		unsigned long		gen;		/* TCP connection this XACT was sent on         */
+#endif
 		XDR					xdrs;		/* argument encoder stream                      */
 		int					xdrpos;     /* stream position after the (permanent) header */
 		xdrproc_t			xres;		/* reply decoder proc - TODO needn't be here    */
@@ -339,10 +393,11 @@ typedef struct RpcUdpXactRec_ {
 		int					ibufsize;	/* size of the ibuf (bytes)                     */
 #endif
 #ifdef  MBUF_TX
-		int					refcnt;		/* mbuf external storage reference count        */
+		volatile u_int		refcnt;		/* mbuf external storage reference count        */
+		rtems_binary_semaphore	bufdone;	/* posted when the stack released the obuf      */
 #endif
 		int					obufsize;	/* size of the obuf (bytes)                     */
-		RxBuf				ibuf;		/* pointer to input buffer assigned by daemon   */
+		RxBuf				ibuf;		/* pointer to input buffer assigned by a worker */
 		RpcBufU				obuf;       /* output buffer (encoded args) APPENDED HERE   */
 } RpcUdpXactRec;
 
@@ -367,37 +422,62 @@ static unsigned   xidHashSeed            = 0 ;
 
 /* forward declarations */
 static RpcUdpXact
-sockRcv(void);
+sockRcv(RpcUdpServer srv);
+
+static RpcUdpXact
+xactMatch(uint32_t xid, RpcUdpServer srv, struct sockaddr_in *from);
+
+static enum clnt_stat
+xactSubmit(RpcUdpXact xact);
 
 static void
-rpcio_daemon(rtems_task_argument);
+rpcio_worker(rtems_task_argument);
+
+static ssize_t
+sockSnd(RpcUdpXact xact, int len);
 
 #ifdef MBUF_TX
-ssize_t
-sendto_nocpy (
-		int s,
-		const void *buf, size_t buflen,
-		int flags,
-		const struct sockaddr *toaddr, int tolen,
-		void *closure,
-		void (*freeproc)(caddr_t, u_int),
-		void (*refproc)(caddr_t, u_int)
-);
-static void paranoia_free(caddr_t closure, u_int size);
-static void paranoia_ref (caddr_t closure, u_int size);
-#define SENDTO	sendto_nocpy
+static void
+xactBufWait(RpcUdpXact xact);
 #else
-#define SENDTO	sendto
+#define xactBufWait(xact)	do { } while (0)
 #endif
 
 static RpcUdpServer		rpcUdpServers = 0;	/* linked list of all servers; protected by llock */
+static uintptr_t		rpcUdpServerIdent = RPCIOD_SRV_IDENT;
+											/* ident of the next server; protected by llock */
+#ifdef RPCIOD_TCP
+#define TCP_IDLE		0
+#define TCP_CONNECTING	1
+#define TCP_CONNECTED	2
+
+#define TCP_LAST_FRAG	0x80000000U
+
+static ssize_t
+tcpSnd(RpcUdpXact xact, int len);
 
-static int				ourSock = -1;		/* the socket we are using for communication */
-static rtems_id			rpciod  = 0;		/* task id of the RPC daemon                 */
-static int	  		rpcKq = -1;		/* the kqueue of the RPC daemon */
-static rtems_id			msgQ    = 0;		/* message queue where the daemon picks up
-											 * requests
+static void
+tcpConnect(RpcUdpServer srv);
+
+static RpcUdpXact
+tcpRcv(RpcUdpServer srv);
+
+static void
+tcpConnected(RpcUdpServer srv, TimeoutT now);
+
+static void
+tcpDisconnect(RpcUdpServer srv);
+#endif
+
+int						rpciodWorkers = RPCIOD_WORKERS;
+											/* number of worker tasks; see librtemsNfs.h */
+static rtems_id			*rpciods = 0;		/* task ids of the RPC workers                */
+static int				rpciodCount = 0;	/* number of RPC workers created              */
+static int				rpciodNum = 0;		/* number of RPC workers still running;
+											 * protected by hlock
 											 */
+static int				rpciodUp = 0;		/* transactions are accepted; protected by hlock */
+static int	  		rpcKq = -1;		/* the kqueue of the RPC workers */
 #ifndef NDEBUG
 static rtems_id			llock	= 0;		/* MUTEX protecting the server list */
 static rtems_id			hlock	= 0;		/* MUTEX protecting the hash table and the list of servers */
@@ -505,6 +585,100 @@ int		s;
 	assert(s == 0);
 }
 
+/* the time base of all timeouts; it does not roll over */
+static inline TimeoutT
+rpcNow(void)
+{
+	return (TimeoutT)(rtems_clock_get_uptime_nanoseconds() / 1000);
+}
+
+/* Find a server by its kqueue ident and obtain a reference
+ * to it; the caller must release it by srvRelease()
+ */
+static RpcUdpServer
+srvLookup(uintptr_t ident)
+{
+RpcUdpServer s;
+
+	MU_LOCK(llock);
+	for (s = rpcUdpServers; s && s->ident != ident; s = s->next)
+		/* nothing else to do */;
+	if (s)
+		s->refs++;
+	MU_UNLOCK(llock);
+	return s;
+}
+
+static void
+srvRelease(RpcUdpServer s)
+{
+int refs;
+
+	MU_LOCK(llock);
+	refs = --s->refs;
+	MU_UNLOCK(llock);
+
+	if (0 == refs) {
+		MU_DESTROY(s->lock);
+		MY_FREE(s);
+	}
+}
+
+/* Open the socket of a UDP server */
+static int
+udpOpen(RpcUdpServer srv)
+{
+int				s;
+int				noblock = 1;
+struct kevent	change;
+
+	s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if ( s < 0 ) {
+		fprintf(stderr,"RPCIO: unable to create UDP socket (%s)\n", strerror(errno));
+		return -1;
+	}
+
+	bindresvport(s, (struct sockaddr_in*)0);
+
+	EV_SET(&change, s, EVFILT_READ, EV_ADD | EV_ENABLE | EV_CLEAR, 0, 0,
+		   (void *)srv->ident);
+
+	if ( ioctl(s, FIONBIO, (char*)&noblock) ||
+	     kevent(rpcKq, &change, 1, NULL, 0, NULL) ) {
+		fprintf(stderr,"RPCIO: unable to setup UDP socket (%s)\n", strerror(errno));
+		close(s);
+		return -1;
+	}
+
+	srv->sock = s;
+	return 0;
+}
+
+/* Close the socket and stop the timer of a server;
+ * the caller holds the server lock
+ */
+static void
+srvClose(RpcUdpServer srv)
+{
+struct kevent	change;
+
+	EV_SET(&change, srv->ident, EVFILT_TIMER, EV_DELETE, 0, 0, 0);
+	(void)kevent(rpcKq, &change, 1, NULL, 0, NULL);
+	srv->timer = 0;
+
+#ifdef RPCIOD_TCP
+	if ( IPPROTO_TCP == srv->proto ) {
+		tcpDisconnect(srv);
+		return;
+	}
+#endif
+	if ( srv->sock >= 0 ) {
+		/* this also removes the kqueue filter */
+		close(srv->sock);
+		srv->sock = -1;
+	}
+}
+
 /* Create a server object
  *
  */
@@ -517,6 +691,21 @@ rpcUdpServerCreate(
 	u_long			gid,
 	RpcUdpServer		*psrv
 	)
+{
+	return rpcUdpServerCreateProto(paddr, prog, vers, uid, gid,
+								   IPPROTO_UDP, psrv);
+}
+
+enum clnt_stat
+rpcUdpServerCreateProto(
+	struct sockaddr_in	*paddr,
+	rpcprog_t		prog,
+	rpcvers_t		vers,
+	u_long			uid,
+	u_long			gid,
+	int				proto,
+	RpcUdpServer		*psrv
+	)
 {
 RpcUdpServer	rval;
 u_short			port;
@@ -529,6 +718,13 @@ AUTH			*auth;
 enum clnt_stat	pmap_err;
 struct pmap		pmaparg;
 
+#ifdef RPCIOD_TCP
+	if ( IPPROTO_UDP != proto && IPPROTO_TCP != proto )
+#else
+	if ( IPPROTO_UDP != proto )
+#endif
+		return RPC_UNKNOWNPROTO;
+
 	if ( gethostname(hname, MAX_MACHINE_NAME) ) {
 		fprintf(stderr,
 				"RPCIO - error: I have no hostname ?? (%s)\n",
@@ -565,7 +761,7 @@ struct pmap		pmaparg;
 
         pmaparg.pm_prog = prog;
         pmaparg.pm_vers = vers;
-        pmaparg.pm_prot = IPPROTO_UDP;
+        pmaparg.pm_prot = proto;
         pmaparg.pm_port = 0;  /* not needed or used */
 
 
@@ -603,14 +799,35 @@ struct pmap		pmaparg;
 		sprintf(rval->name,"?.?.?.?");
 	rval->addr.sin		= *paddr;
 
-	/* start with a long retransmission interval - it
+	/* start with a long retransmission timeout - it
 	 * will be adapted dynamically
 	 */
-	rval->retry_period  = RPCIOD_RETX_CAP_S * ticksPerSec;
+	rval->rto			= RPCIOD_RTO_INIT_MS * 1000;
 
 	rval->auth 			= auth;
+	rval->proto			= proto;
+	rval->sock			= -1;
+	rval->refs			= 1;
+#ifdef RPCIOD_TCP
+	rval->state			= TCP_IDLE;
+	rval->holdoff		= rpcNow();
+#endif
 
 	MU_CREAT( &rval->authlock );
+	MU_CREAT( &rval->lock );
+
+	MU_LOCK( llock );
+	rval->ident			= rpcUdpServerIdent++;
+	MU_UNLOCK( llock );
+
+	/* a TCP connection is established on demand */
+	if ( IPPROTO_UDP == proto && udpOpen(rval) ) {
+		MU_DESTROY( rval->lock );
+		MU_DESTROY( rval->authlock );
+		auth_destroy( auth );
+		MY_FREE( rval );
+		return RPC_SYSTEMERROR;
+	}
 
 	/* link into list */
 	MU_LOCK( llock );
@@ -654,27 +871,55 @@ RpcUdpServer prev;
 	auth_destroy(s->auth);
 
 	MU_DESTROY(s->authlock);
-	MY_FREE(s);
+
+	/* a worker may still hold a reference; the
+	 * server is freed once it is released
+	 */
+	MU_LOCK(s->lock);
+	s->dead = 1;
+	srvClose(s);
+	MU_UNLOCK(s->lock);
+
+	srvRelease(s);
 }
 
 int
 rpcUdpStats(FILE *f)
 {
 RpcUdpServer s;
+int          i;
 
 	if (!f) f = stdout;
 
-	fprintf(f,"RPCIOD statistics:\n");
+	fprintf(f,"RPCIOD statistics (%d workers):\n", rpciodCount);
 
 	MU_LOCK(llock);
 	for (s = rpcUdpServers; s; s=s->next) {
-		fprintf(f,"\nServer -- %s:\n", s->name);
+		fprintf(f,"\nServer -- %s (%s):\n", s->name,
+						IPPROTO_TCP == s->proto ? "tcp" : "udp");
 		fprintf(f,"  requests    sent: %10ld, retransmitted: %10ld\n",
 						s->requests, s->retrans);
 		fprintf(f,"         timed out: %10ld,   send errors: %10ld\n",
 						s->timeouts, s->errors);
-		fprintf(f,"  current retransmission interval: %dms\n",
-						(unsigned)(s->retry_period * 1000 / ticksPerSec) );
+		fprintf(f,"  current retransmission timeout: %ldms\n",
+						(long)(s->rto / 1000));
+		fprintf(f,"  smoothed round trip time: %ldus, variation: %ldus\n",
+						(long)s->srtt, (long)s->rttvar);
+#ifdef RPCIOD_TCP
+		if ( IPPROTO_TCP == s->proto )
+			fprintf(f,"  connections established: %10ld\n", s->connects);
+#endif
+		fprintf(f,"  round trip times:\n");
+		for (i = 0; i < RPCIOD_HIST_BUCKETS; i++) {
+			if ( !s->rtthist[i] )
+				continue;
+			if ( i < RPCIOD_HIST_BUCKETS - 1 )
+				fprintf(f,"    <  %8luus: %10lu\n",
+						1UL << (i + RPCIOD_HIST_SHIFT), s->rtthist[i]);
+			else
+				fprintf(f,"    >= %8luus: %10lu\n",
+						1UL << (i - 1 + RPCIOD_HIST_SHIFT), s->rtthist[i]);
+		}
 	}
 	MU_UNLOCK(llock);
 
@@ -716,10 +961,9 @@ register int	i,j;
 		MU_LOCK(hlock);
 		rval->obuf.xid = (xidHashSeed++ ^ ((uintptr_t)rval>>10)) & XACT_HASH_MSK;
 		i=j=(rval->obuf.xid & XACT_HASH_MSK);
-		if (msgQ) {
-			/* if there's no message queue, refuse to
-			 * give them transactions; we might be in the process to
-			 * go away...
+		if (rpciodUp) {
+			/* if the workers are going away, refuse to
+			 * give them transactions
 			 */
 			do {
 				i=(i+1) & XACT_HASH_MSK; /* cheap modulo */
@@ -742,6 +986,9 @@ register int	i,j;
 		rval->obuf.xid  = xidUpper[i] | i;
 		rval->xdrpos    = XDR_GETPOS(&(rval->xdrs));
 		rval->obufsize  = size;
+#ifdef MBUF_TX
+		rtems_binary_semaphore_init(&rval->bufdone, "RPCIO buf");
+#endif
 	}
 	return rval;
 }
@@ -766,6 +1013,10 @@ int i = xact->obuf.xid & XACT_HASH_MSK;
 		MU_UNLOCK(hlock);
 
 		bufFree(&xact->ibuf);
+		xactBufWait(xact);
+#ifdef MBUF_TX
+		rtems_binary_semaphore_destroy(&xact->bufdone);
+#endif
 
 		XDR_DESTROY(&xact->xdrs);
 		MY_FREE(xact);
@@ -773,8 +1024,9 @@ int i = xact->obuf.xid & XACT_HASH_MSK;
 
 
 
-/* Send a transaction, i.e. enqueue it to the
- * RPC daemon who will actually send it.
+/* Send a transaction. The first attempt is made
+ * right away, the RPC workers take care of the
+ * retransmissions.
  */
 enum clnt_stat
 rpcUdpSend(
@@ -788,7 +1040,6 @@ rpcUdpSend(
    )
 {
 register XDR	*xdrs;
-unsigned long	ms;
 va_list			ap;
 
 	va_start(ap,pargs);
@@ -796,11 +1047,8 @@ va_list			ap;
 	if (!timeout)
 		timeout = RPCIOD_DEFAULT_TIMEOUT;
 
-	ms = 1000 * timeout->tv_sec + timeout->tv_usec/1000;
-
-	/* round lifetime to closest # of ticks */
-	xact->lifetime  = (ms * ticksPerSec + 500) / 1000;
-	if ( 0 == xact->lifetime )
+	xact->lifetime  = (TimeoutT)timeout->tv_sec * 1000000 + timeout->tv_usec;
+	if ( xact->lifetime <= 0 )
 		xact->lifetime = 1;
 
 #if (DEBUG) & DEBUG_TIMEOUT
@@ -808,7 +1056,7 @@ va_list			ap;
 	static int once=0;
 	if (!once++) {
 		fprintf(stderr,
-				"Initial lifetime: %i (ticks)\n",
+				"Initial lifetime: %" PRId64 " (us)\n",
 				xact->lifetime);
 	}
 	}
@@ -820,6 +1068,9 @@ va_list			ap;
 	xact->pres      = pres;
 	xact->server    = srvr;
 
+	/* the stack may still reference the previous request */
+	xactBufWait(xact);
+
 	xdrs            = &xact->xdrs;
 	xdrs->x_op      = XDR_ENCODE;
 	/* increment transaction ID */
@@ -839,18 +1090,12 @@ va_list			ap;
 	va_end(ap);
 
 	rtems_task_ident(RTEMS_SELF, RTEMS_WHO_AM_I, &xact->requestor);
-	if ( rtems_message_queue_send( msgQ, &xact, sizeof(xact)) ) {
-		return RPC_CANTSEND;
-	}
-	/* wakeup the rpciod */
-	sendEventToRpcServer(RPCIOD_TX_EVENT);
-
-	return RPC_SUCCESS;
+	return xactSubmit(xact);
 }
 
 /* Block for the RPC reply to an outstanding
  * transaction.
- * The caller is woken by the RPC daemon either
+ * The caller is woken by an RPC worker either
  * upon reception of the reply or on timeout.
  */
 enum clnt_stat
@@ -928,12 +1173,10 @@ rtems_event_set		gotEvents;
 
 	if (refresh && locked_refresh(xact->server, &reply_msg)) {
 		rtems_task_ident(RTEMS_SELF, RTEMS_WHO_AM_I, &xact->requestor);
-		if ( rtems_message_queue_send(msgQ, &xact, sizeof(xact)) ) {
+		fprintf(stderr,"RPCIO INFO: refreshing my AUTH\n");
+		if ( xactSubmit(xact) ) {
 			return RPC_CANTSEND;
 		}
-		/* wakeup the rpciod */
-		fprintf(stderr,"RPCIO INFO: refreshing my AUTH\n");
-		sendEventToRpcServer(RPCIOD_TX_EVENT);
 	}
 
 	} while ( 0 &&  refresh-- > 0 );
@@ -956,75 +1199,55 @@ rpcSetXIDs(uint32_t xid)
 int
 rpcUdpInit(bool verbose)
 {
-int			s;
+int			s, i;
 rtems_status_code	status;
-int			noblock = 1;
 struct kevent		change;
 
-	if (ourSock < 0) {
+	if (rpcKq < 0) {
 
 		if (verbose)
 			fprintf(stderr,"RTEMS-RPCIOD, "				\
 					"Till Straumann, Stanford/SLAC/SSRL 2002, " \
 					"See LICENSE for licensing info.\n");
 
-		ourSock=socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-		if (ourSock>=0) {
-			bindresvport(ourSock,(struct sockaddr_in*)0);
-			s = ioctl(ourSock, FIONBIO, (char*)&noblock);
-			assert( s == 0 );
-			/* assume nobody tampers with the clock !! */
-			ticksPerSec = rtems_clock_get_ticks_per_second();
-			MU_CREAT( &hlock );
-			MU_CREAT( &llock );
-
-			rpcKq = kqueue();
-			assert( rpcKq >= 0 );
-
-			EV_SET(
-				&change,
-				RPCIOD_KQ_IDENT,
-				EVFILT_USER, EV_ADD | EV_ENABLE | EV_CLEAR,
-				NOTE_FFNOP,
-				0,
-				0);
-
-			s = kevent( rpcKq, &change, 1, NULL, 0, NULL );
-			assert( s == 0 );
-
-			EV_SET(
-				&change,
-				ourSock,
-				EVFILT_READ, EV_ADD | EV_ENABLE,
-				0,
-				0,
-				0);
-
-			s = kevent( rpcKq, &change, 1, NULL, 0, NULL );
-			assert( s == 0 );
+		/* assume nobody tampers with the clock !! */
+		ticksPerSec = rtems_clock_get_ticks_per_second();
+		MU_CREAT( &hlock );
+		MU_CREAT( &llock );
+
+		rpcKq = kqueue();
+		assert( rpcKq >= 0 );
 
+		EV_SET(
+			&change,
+			RPCIOD_KQ_IDENT,
+			EVFILT_USER, EV_ADD | EV_ENABLE | EV_CLEAR,
+			NOTE_FFNOP,
+			0,
+			0);
+
+		s = kevent( rpcKq, &change, 1, NULL, 0, NULL );
+		assert( s == 0 );
+
+		rpciodCount = rpciodWorkers > 0 ? rpciodWorkers : RPCIOD_WORKERS;
+		rpciods     = (rtems_id*)calloc(rpciodCount, sizeof(*rpciods));
+		assert( rpciods );
+		rpciodNum   = rpciodCount;
+		rpciodUp    = 1;
+
+		for (i = 0; i < rpciodCount; i++) {
 			status = rtems_task_create(
-											rtems_build_name('R','P','C','d'),
+											rtems_build_name('R','P','C','0' + i % 10),
 											rtems_bsd_get_task_priority(RPCIOD_NAME),
 											rtems_bsd_get_task_stack_size(RPCIOD_NAME),
 											RTEMS_DEFAULT_MODES,
 											/* fprintf saves/restores FP registers on PPC :-( */
 											RTEMS_DEFAULT_ATTRIBUTES | RTEMS_FLOATING_POINT,
-											&rpciod);
+											&rpciods[i]);
 			assert( status == RTEMS_SUCCESSFUL );
 
-			status = rtems_message_queue_create(
-											rtems_build_name('R','P','C','q'),
-											RPCIOD_QDEPTH,
-											sizeof(RpcUdpXact),
-											RTEMS_DEFAULT_ATTRIBUTES,
-											&msgQ);
-			assert( status == RTEMS_SUCCESSFUL );
-			status = rtems_task_start( rpciod, rpcio_daemon, 0 );
+			status = rtems_task_start( rpciods[i], rpcio_worker, i );
 			assert( status == RTEMS_SUCCESSFUL );
-
-		} else {
-			return -1;
 		}
 	}
 	return 0;
@@ -1033,6 +1256,8 @@ struct kevent		change;
 int
 rpcUdpCleanup(void)
 {
+int i;
+
 	rtems_semaphore_create(
 			rtems_build_name('R','P','C','f'),
 			0,
@@ -1040,14 +1265,18 @@ rpcUdpCleanup(void)
 			0,
 			&fini);
 	sendEventToRpcServer(RPCIOD_KILL_EVENT);
-	/* synchronize with daemon */
+	/* synchronize with the workers */
 	rtems_semaphore_obtain(fini, RTEMS_WAIT, 5*ticksPerSec);
-	/* if the message queue is still there, something went wrong */
-	if (!msgQ) {
-		rtems_task_delete(rpciod);
+	/* if transactions are still accepted, something went wrong */
+	if (!rpciodUp) {
+		for (i = 0; i < rpciodCount; i++)
+			rtems_task_delete(rpciods[i]);
+		free(rpciods);
+		rpciods     = 0;
+		rpciodCount = 0;
 	}
 	rtems_semaphore_delete(fini);
-	return (msgQ !=0);
+	return (rpciodUp != 0);
 }
 
 /* Another API - simpler but less efficient.
@@ -1184,377 +1413,438 @@ nodeAppend(ListNode l, ListNode n)
 
 }
 
-/* this code does the work */
+/* Update the retransmission timeout of a server with a
+ * round trip time sample (Jacobson/Karels, see RFC 6298)
+ */
 static void
-rpcio_daemon(rtems_task_argument arg)
+srvRtt(RpcUdpServer srv, TimeoutT rtt)
 {
-RpcUdpXact        xact;
-RpcUdpServer      srv;
-rtems_interval    next_retrans, then, unow;
-long			  			now;	/* need to do signed comparison with age! */
-u_int             events;
-ListNode          newList;
-size_t            size;
-rtems_id          q          =  0;
-ListNodeRec       listHead   = {0, 0};
-unsigned long     epoch      = RPCIOD_EPOCH_SECS * ticksPerSec;
-unsigned long			max_period = RPCIOD_RETX_CAP_S * ticksPerSec;
-rtems_status_code	status;
+TimeoutT	delta;
+int			i;
 
+	ASSERT( rtt >= 0 );
 
-        then = rtems_clock_get_ticks_since_boot();
+	if ( 0 == rtt )
+		rtt = 1;
 
-	for (next_retrans = epoch;;) {
-		{
-			struct timespec timeout = {
-				.tv_sec = (next_retrans + ticksPerSec - 1) / ticksPerSec,
-				.tv_nsec = 0
-			};
-			struct kevent event[2];
-			int i;
-			int n;
-
-			n = kevent(rpcKq, NULL, 0, &event[0], 2, &timeout);
-			assert(n >= 0);
+	for (i = 0; i < RPCIOD_HIST_BUCKETS - 1; i++) {
+		if ( rtt < ((TimeoutT)1 << (i + RPCIOD_HIST_SHIFT)) )
+			break;
+	}
+	srv->rtthist[i]++;
 
-			events = 0;
+	if ( 0 == srv->srtt ) {
+		/* first measurement */
+		srv->srtt   = rtt;
+		srv->rttvar = rtt / 2;
+	} else {
+		delta       = srv->srtt - rtt;
+		if ( delta < 0 )
+			delta = -delta;
+		/* rttvar = 3/4 rttvar + 1/4 |srtt - rtt|, srtt = 7/8 srtt + 1/8 rtt */
+		srv->rttvar = (3 * srv->rttvar + delta) / 4;
+		srv->srtt   = (7 * srv->srtt + rtt) / 8;
+	}
 
-			for (i = 0; i < n; ++i) {
-				if (event[i].filter == EVFILT_USER) {
-					events |= event[i].fflags;
-				} else {
-					events |= RPCIOD_RX_EVENT;
-				}
-			}
-		}
+	srv->rto = srv->srtt + 4 * srv->rttvar;
+	if ( srv->rto < RPCIOD_RTO_MIN_MS * 1000 )
+		srv->rto = RPCIOD_RTO_MIN_MS * 1000;
+	if ( srv->rto > (TimeoutT)RPCIOD_RTO_MAX_S * 1000000 )
+		srv->rto = (TimeoutT)RPCIOD_RTO_MAX_S * 1000000;
+}
 
-		if (events & RPCIOD_KILL_EVENT) {
-			int i;
+/* a reply for this transaction was received */
+static void
+xactReplied(RpcUdpServer srv, RpcUdpXact xact, TimeoutT now)
+{
+	/* extract from the retransmission list */
+	nodeXtract(&xact->node);
 
-#if (DEBUG) & DEBUG_EVENTS
-			fprintf(stderr,"RPCIO: got KILL event\n");
-#endif
+	/* change the ID - there might already be
+	 * a retransmission on the way. When it's
+	 * reply arrives we must not find it's ID
+	 * in the hashtable
+	 */
+	xact->obuf.xid        += XACT_HASHS;
 
-			MU_LOCK(hlock);
-			for (i=XACT_HASHS-1; i>=0; i--) {
-				if (xactHashTbl[i]) {
-					break;
-				}
-			}
-			if (i<0) {
-				/* prevent them from creating and enqueueing more messages */
-				q=msgQ;
-				/* messages queued after we executed this assignment will fail */
-				msgQ=0;
-			}
-			MU_UNLOCK(hlock);
-			if (i>=0) {
-				fprintf(stderr,"RPCIO There are still transactions circulating; I refuse to go away\n");
-				fprintf(stderr,"(1st in slot %i)\n",i);
-				rtems_semaphore_release(fini);
-			} else {
-				break;
-			}
-		}
+	xact->status.re_status = RPC_SUCCESS;
 
-        	unow = rtems_clock_get_ticks_since_boot();
+	/* calculate roundtrip time */
+	xact->trip             = now - xact->trip;
 
-		/* measure everything relative to then to protect against
-		 * rollover
-		 */
-		now = unow - then;
+	/* adjust the server's retransmission timeout; the
+	 * reply to a retransmitted request cannot be related
+	 * to a particular transmission (Karn's algorithm)
+	 */
+	if ( 1 == xact->sent )
+		srvRtt(srv, xact->trip);
 
-		/* NOTE: we don't lock the hash table while we are operating
-		 * on transactions; the paradigm is that we 'own' a particular
-		 * transaction (and hence it's hash table slot) from the
-		 * time the xact was put into the message queue until we
-		 * wake up the requestor.
-		 */
+	/* wakeup requestor */
+	rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
+}
 
-		if (RPCIOD_RX_EVENT & events) {
+/* insert into the sorted retransmission list of the server */
+static void
+xactInsert(RpcUdpServer srv, RpcUdpXact xact)
+{
+register ListNode p,n;
 
-#if (DEBUG) & DEBUG_EVENTS
-			fprintf(stderr,"RPCIO: got RX event\n");
-#endif
+	for ( p=&srv->xacts; (n=p->next) && xact->age >= ((RpcUdpXact)n)->age; p=n )
+		/* nothing else to do */;
+	nodeAppend(p, &xact->node);
+}
 
-			while ((xact=sockRcv())) {
+/* (Re-)arm the timer of the server for the first
+ * transaction of its retransmission list
+ */
+static void
+srvArmTimer(RpcUdpServer srv, TimeoutT now)
+{
+RpcUdpXact		xact = (RpcUdpXact)srv->xacts.next;
+TimeoutT		delay;
+struct kevent	change;
 
-				/* extract from the retransmission list */
-				nodeXtract(&xact->node);
+	if ( !xact || xact->age == srv->timer )
+		return;
 
-				/* change the ID - there might already be
-				 * a retransmission on the way. When it's
-				 * reply arrives we must not find it's ID
-				 * in the hashtable
-				 */
-				xact->obuf.xid        += XACT_HASHS;
+	delay = xact->age - now;
+	if ( delay < 1 )
+		delay = 1;
+	/* a timer expiring early is just re-armed */
+	if ( delay > INT32_MAX )
+		delay = INT32_MAX;
 
-				xact->status.re_status = RPC_SUCCESS;
+	EV_SET(&change, srv->ident, EVFILT_TIMER,
+		   EV_ADD | EV_ENABLE | EV_ONESHOT, NOTE_USECONDS, (intptr_t)delay,
+		   (void *)srv->ident);
 
-				/* calculate roundtrip ticks */
-				xact->trip             = now - xact->trip;
+	if ( kevent(rpcKq, &change, 1, NULL, 0, NULL) ) {
+		fprintf(stderr,"RPCIO: unable to arm timer (%s)\n", strerror(errno));
+		return;
+	}
+	srv->timer = xact->age;
+}
 
-				srv                    = xact->server;
+/* (Re-)transmit a transaction; this is done by the requestor
+ * for the first attempt and by the workers for the retries.
+ * The caller holds the server lock and the transaction is on
+ * no list.
+ */
+static void
+xactTransmit(RpcUdpServer srv, RpcUdpXact xact, TimeoutT now)
+{
+rtems_status_code	status;
+TimeoutT			delay;
+ssize_t				rv;
+int					len;
+
+	if (xact->tolive < 0) {
+		/* this one timed out */
+		xact->status.re_errno  = ETIMEDOUT;
+		xact->status.re_status = RPC_TIMEDOUT;
+
+		srv->timeouts++;
+
+		/* Change the ID - there might still be
+		 * a reply on the way. When it arrives we
+		 * must not find it's ID in the hash table
+		 *
+		 * Thanks to Steven Johnson for hunting this
+		 * one down.
+		 */
+		xact->obuf.xid        += XACT_HASHS;
 
-				/* adjust the server's retry period */
-				{
-					register TimeoutT rtry = srv->retry_period;
-					register TimeoutT trip = xact->trip;
+#if (DEBUG) & DEBUG_TIMEOUT
+		fprintf(stderr,"RPCIO XACT timed out; waking up requestor\n");
+#endif
+		if ( rtems_event_send(xact->requestor, RTEMS_RPC_EVENT) ) {
+			rtems_panic("RPCIO PANIC: requestor id was 0x%08x",
+						xact->requestor);
+		}
+		return;
+	}
 
-					ASSERT( trip >= 0 );
+	len = (int)XDR_GETPOS(&xact->xdrs);
 
-					if ( 0==trip )
-						trip = 1;
+#ifdef RPCIOD_TCP
+	if ( IPPROTO_TCP == srv->proto )
+		rv = tcpSnd(xact, len);
+	else
+#endif
+		rv = sockSnd(xact, len);
+
+	if ( rv <= 0 && ( 0 == rv || EWOULDBLOCK == errno ) ) {
+		/* Nothing was sent. Either the request is still
+		 * in flight on the current TCP connection, the
+		 * connection is not (yet) established, or the
+		 * socket buffer is full; in the latter case
+		 * retry soon.
+		 */
+		delay = rv ? RPCIOD_RTO_MIN_MS * 1000 : srv->rto;
+	} else if ( len != rv ) {
 
-					/* retry_new = 0.75*retry_old + 0.25 * 8 * roundrip */
-					rtry   = (3*rtry + (trip << 3)) >> 2;
+		xact->status.re_errno  = errno;
+		xact->status.re_status = RPC_CANTSEND;
+		srv->errors++;
 
-					if ( rtry > max_period )
-						rtry = max_period;
+		/* wakeup requestor */
+		fprintf(stderr,"RPCIO: SEND failure\n");
+		status = rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
+		assert( status == RTEMS_SUCCESSFUL );
+		return;
 
-					srv->retry_period = rtry;
-				}
+	} else {
+		if ( xact->sent++ ) {
+#if (DEBUG) & DEBUG_TIMEOUT
+			fprintf(stderr,
+				"timed out; tolive is %" PRId64 " (us), retransmission timeout is %" PRId64 " (us)\n",
+					xact->tolive,
+					srv->rto);
+#endif
+			/* this is a real retry; we back off
+			 * the server's retransmission timeout
+			 */
+			if ( srv->rto < (TimeoutT)RPCIOD_RTO_MAX_S * 1000000 ) {
+
+				/* If multiple transactions for this server
+				 * fail (e.g. because it died) this will
+				 * back-off very agressively (doubling
+				 * the retransmission timeout for every
+				 * timed out transaction up to the limit)
+				 * which is desirable - the next valid round
+				 * trip time measurement restores it.
+				 */
 
-				/* wakeup requestor */
-				rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
+				srv->rto <<= 1;
+				if ( srv->rto > (TimeoutT)RPCIOD_RTO_MAX_S * 1000000 )
+					srv->rto = (TimeoutT)RPCIOD_RTO_MAX_S * 1000000;
+			} else {
+				/* never wait longer than RPCIOD_RTO_MAX_S seconds */
+				fprintf(stderr,
+						"RPCIO: server '%s' not responding - still trying\n",
+						srv->name);
 			}
+			if ( 0 == ++srv->retrans % 1000) {
+				fprintf(stderr,
+						"RPCIO - statistics: already %li retries to server %s\n",
+						srv->retrans,
+						srv->name);
+			}
+		} else {
+			srv->requests++;
 		}
+		xact->trip = now;
+		delay      = srv->rto;
+	}
 
-		if (RPCIOD_TX_EVENT & events) {
+	if ( xact->lifetime < delay )
+		delay = xact->lifetime;
+	xact->age     = now + delay;
+	xact->tolive -= delay;
+	xactInsert(srv, xact);
+}
 
-#if (DEBUG) & DEBUG_EVENTS
-			fprintf(stderr,"RPCIO: got TX event\n");
-#endif
+/* Send a new transaction right away; the workers take
+ * care of the retransmissions
+ */
+static enum clnt_stat
+xactSubmit(RpcUdpXact xact)
+{
+RpcUdpServer	srv = xact->server;
+TimeoutT		now;
 
-			while (RTEMS_SUCCESSFUL == rtems_message_queue_receive(
-											msgQ,
-											&xact,
-											&size,
-											RTEMS_NO_WAIT,
-											RTEMS_NO_TIMEOUT)) {
-				/* put to the head of timeout q */
-				nodeAppend(&listHead, &xact->node);
-
-				xact->age  = now;
-				xact->trip = FIRST_ATTEMPT;
-			}
-		}
+	if ( !rpciodUp ) {
+		/* we might be in the process to go away... */
+		return RPC_CANTSEND;
+	}
 
+	xact->sent = 0;
+#ifdef RPCIOD_TCP
+	xact->gen  = 0;	/* not sent on any connection */
+#endif
 
-		/* work the timeout q */
-		newList = 0;
-		for ( xact=(RpcUdpXact)listHead.next;
-			  xact && xact->age <= now;
-			  xact=(RpcUdpXact)listHead.next ) {
+	MU_LOCK(srv->lock);
+	if ( srv->dead ) {
+		MU_UNLOCK(srv->lock);
+		return RPC_CANTSEND;
+	}
+	now = rpcNow();
+	xactTransmit(srv, xact, now);
+	srvArmTimer(srv, now);
+	MU_UNLOCK(srv->lock);
 
-				/* extract from the list */
-				nodeXtract(&xact->node);
+	return RPC_SUCCESS;
+}
 
-				srv = xact->server;
+/* work the timeout q of a server; the caller holds the server lock */
+static void
+srvTimeouts(RpcUdpServer srv, TimeoutT now)
+{
+RpcUdpXact	xact;
+ListNode	n;
+ListNodeRec	due = {0, 0};
+
+	/* xactTransmit() inserts into the list again */
+	while ( (xact = (RpcUdpXact)srv->xacts.next) && xact->age <= now ) {
+		nodeXtract(&xact->node);
+		nodeAppend(&due, &xact->node);
+	}
 
-				if (xact->tolive < 0) {
-					/* this one timed out */
-					xact->status.re_errno  = ETIMEDOUT;
-					xact->status.re_status = RPC_TIMEDOUT;
+	while ( (n = due.next) ) {
+		nodeXtract(n);
+		xactTransmit(srv, (RpcUdpXact)n, now);
+	}
+}
 
-					srv->timeouts++;
+/* handle a kqueue event of a server */
+static void
+srvService(RpcUdpServer srv, struct kevent *ev)
+{
+RpcUdpXact	xact;
+TimeoutT	now;
 
-					/* Change the ID - there might still be
-					 * a reply on the way. When it arrives we
-					 * must not find it's ID in the hash table
-					 *
-					 * Thanks to Steven Johnson for hunting this
-					 * one down.
-					 */
-					xact->obuf.xid        += XACT_HASHS;
+	MU_LOCK(srv->lock);
 
-#if (DEBUG) & DEBUG_TIMEOUT
-					fprintf(stderr,"RPCIO XACT timed out; waking up requestor\n");
-#endif
-					if ( rtems_event_send(xact->requestor, RTEMS_RPC_EVENT) ) {
-						rtems_panic("RPCIO PANIC: requestor id was 0x%08x",
-									xact->requestor);
-					}
+	if ( srv->dead ) {
+		MU_UNLOCK(srv->lock);
+		return;
+	}
 
-				} else {
-					int len;
+	now = rpcNow();
 
-					len = (int)XDR_GETPOS(&xact->xdrs);
+	switch ( ev->filter ) {
+		case EVFILT_READ:
+#if (DEBUG) & DEBUG_EVENTS
+			fprintf(stderr,"RPCIO: got RX event\n");
+#endif
+#ifdef RPCIOD_TCP
+			if ( IPPROTO_TCP == srv->proto ) {
+				while ((xact=tcpRcv(srv))) {
+					xactReplied(srv, xact, now);
+				}
+				break;
+			}
+#endif
+			while ((xact=sockRcv(srv))) {
+				xactReplied(srv, xact, now);
+			}
+			break;
 
-#ifdef MBUF_TX
-					xact->refcnt = 1;	/* sendto itself */
+#ifdef RPCIOD_TCP
+		case EVFILT_WRITE:
+			tcpConnected(srv, now);
+			break;
 #endif
-					if ( len != SENDTO( ourSock,
-										xact->obuf.buf,
-										len,
-										0,
-										&srv->addr.sa,
-										sizeof(srv->addr.sin)
-#ifdef MBUF_TX
-										, xact,
-										paranoia_free,
-										paranoia_ref
+
+		case EVFILT_TIMER:
+#if (DEBUG) & DEBUG_EVENTS
+			fprintf(stderr,"RPCIO: got timer event\n");
 #endif
-										) ) {
+			srv->timer = 0;
+			break;
 
-						xact->status.re_errno  = errno;
-						xact->status.re_status = RPC_CANTSEND;
-						srv->errors++;
+		default:
+			break;
+	}
 
-						/* wakeup requestor */
-						fprintf(stderr,"RPCIO: SEND failure\n");
-						status = rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
-						assert( status == RTEMS_SUCCESSFUL );
+	srvTimeouts(srv, now);
+	srvArmTimer(srv, now);
 
-					} else {
-						/* send successful; calculate retransmission time
-						 * and enqueue to temporary list
-						 */
-						if (FIRST_ATTEMPT != xact->trip) {
-#if (DEBUG) & DEBUG_TIMEOUT
-							fprintf(stderr,
-								"timed out; tolive is %i (ticks), retry period is %i (ticks)\n",
-									xact->tolive,
-									srv->retry_period);
-#endif
-							/* this is a real retry; we backup
-							 * the server's retry interval
-							 */
-							if ( srv->retry_period < max_period ) {
-
-								/* If multiple transactions for this server
-								 * fail (e.g. because it died) this will
-								 * back-off very agressively (doubling
-								 * the retransmission period for every
-								 * timed out transaction up to the CAP limit)
-								 * which is desirable - single packet failure
-								 * is treated more gracefully by this algorithm.
-								 */
-
-								srv->retry_period<<=1;
-#if (DEBUG) & DEBUG_TIMEOUT
-								fprintf(stderr,
-										"adjusted to; retry period %i\n",
-										srv->retry_period);
-#endif
-							} else {
-								/* never wait longer than RPCIOD_RETX_CAP_S seconds */
-								fprintf(stderr,
-										"RPCIO: server '%s' not responding - still trying\n",
-										srv->name);
-							}
-							if ( 0 == ++srv->retrans % 1000) {
-								fprintf(stderr,
-										"RPCIO - statistics: already %li retries to server %s\n",
-										srv->retrans,
-										srv->name);
-							}
-						} else {
-							srv->requests++;
-						}
-						xact->trip      = now;
-						{
-						long capped_period = srv->retry_period;
-							if ( xact->lifetime < capped_period )
-								capped_period = xact->lifetime;
-						xact->age       = now + capped_period;
-						xact->tolive   -= capped_period;
-						}
-						/* enqueue to the list of newly sent transactions */
-						xact->node.next = newList;
-						newList         = &xact->node;
-#if (DEBUG) & DEBUG_TIMEOUT
-						fprintf(stderr,
-								"XACT (0x%08x) age is 0x%x, now: 0x%x\n",
-								xact,
-								xact->age,
-								now);
-#endif
-					}
-				}
-	    }
+	MU_UNLOCK(srv->lock);
+}
 
-		/* insert the newly sent transactions into the
-		 * sorted retransmission list
-		 */
-		for (; (xact = (RpcUdpXact)newList); ) {
-			register ListNode p,n;
-			newList = newList->next;
-			for ( p=&listHead; (n=p->next) && xact->age > ((RpcUdpXact)n)->age; p=n )
-				/* nothing else to do */;
-			nodeAppend(p, &xact->node);
-		}
+/* Returns non-zero if the workers may go away */
+static int
+rpcioKill(void)
+{
+int i = -1;
 
-		if (now > epoch) {
-			/* every now and then, readjust the epoch */
-			register ListNode n;
-			then += now;
-			for (n=listHead.next; n; n=n->next) {
-				/* readjust outstanding time intervals subject to the
-				 * condition that the 'absolute' time must remain
-				 * the same. 'age' and 'trip' are measured with
-				 * respect to 'then' - hence:
-				 *
-				 * abs_age == old_age + old_then == new_age + new_then
-				 *
-				 * ==> new_age = old_age + old_then - new_then == old_age - 'now'
-				 */
-				((RpcUdpXact)n)->age  -= now;
-				((RpcUdpXact)n)->trip -= now;
-#if (DEBUG) & DEBUG_TIMEOUT
-				fprintf(stderr,
-						"readjusted XACT (0x%08x); age is 0x%x, trip: 0x%x now: 0x%x\n",
-						(RpcUdpXact)n,
-						((RpcUdpXact)n)->trip,
-						((RpcUdpXact)n)->age,
-						now);
+#if (DEBUG) & DEBUG_EVENTS
+	fprintf(stderr,"RPCIO: got KILL event\n");
 #endif
+
+	MU_LOCK(hlock);
+	if ( rpciodUp ) {
+		for (i=XACT_HASHS-1; i>=0; i--) {
+			if (xactHashTbl[i]) {
+				break;
 			}
-			now = 0;
 		}
-
-		next_retrans = listHead.next ?
-							((RpcUdpXact)listHead.next)->age - now :
-							epoch;	/* make sure we don't miss updating the epoch */
-#if (DEBUG) & DEBUG_TIMEOUT
-		fprintf(stderr,"RPCIO: next timeout is %x\n",next_retrans);
-#endif
+		if (i<0) {
+			/* prevent them from creating and sending more transactions */
+			rpciodUp = 0;
+		}
 	}
-	/* close our socket; shut down the receiver */
-	close(ourSock);
-	close(rpcKq);
+	MU_UNLOCK(hlock);
 
-#if 0 /* if we get here, no transactions exist, hence there can be none
-	   * in the queue whatsoever
-	   */
-	/* flush the message queue */
-	while (RTEMS_SUCCESSFUL == rtems_message_queue_receive(
-										q,
-										&xact,
-										&size,
-										RTEMS_NO_WAIT,
-										RTEMS_NO_TIMEOUT)) {
-			/* TODO enque xact */
+	if (i>=0) {
+		fprintf(stderr,"RPCIO There are still transactions circulating; I refuse to go away\n");
+		fprintf(stderr,"(1st in slot %i)\n",i);
+		rtems_semaphore_release(fini);
+		return 0;
 	}
+	return 1;
+}
 
-	/* flush all outstanding transactions */
+static void
+rpcioExit(void)
+{
+int last;
 
-	for (xact=((RpcUdpXact)listHead.next); xact; xact=((RpcUdpXact)xact->node.next)) {
-			xact->status.re_status = RPC_TIMEDOUT;
-			rtems_event_send(xact->requestor, RTEMS_RPC_EVENT);
-	}
-#endif
+	MU_LOCK(hlock);
+	last = ( 0 == --rpciodNum );
+	MU_UNLOCK(hlock);
 
-	rtems_message_queue_delete(q);
+	if ( !last ) {
+		/* pass it on to the next worker */
+		sendEventToRpcServer(RPCIOD_KILL_EVENT);
+	} else {
+		/* no transactions exist; the sockets of the remaining
+		 * servers are closed when they are destroyed
+		 */
+		close(rpcKq);
+		rpcKq = -1;
 
-	MU_DESTROY(hlock);
+		MU_DESTROY(hlock);
 
-	fprintf(stderr,"RPC daemon exited...\n");
+		fprintf(stderr,"RPC daemon exited...\n");
 
-	rtems_semaphore_release(fini);
+		rtems_semaphore_release(fini);
+	}
 	rtems_task_suspend(RTEMS_SELF);
 }
 
+/* this code does the work; any number of workers may
+ * run it. The events of a server are serialized by its
+ * lock.
+ */
+static void
+rpcio_worker(rtems_task_argument arg)
+{
+RpcUdpServer		srv;
+struct kevent		event[RPCIOD_MAX_EVENTS];
+int					nevents;
+int					i;
+
+	for (;;) {
+		nevents = kevent(rpcKq, NULL, 0, &event[0], RPCIOD_MAX_EVENTS, NULL);
+		assert(nevents >= 0);
+
+		for (i = 0; i < nevents; ++i) {
+			if (event[i].udata == NULL) {
+				if ((event[i].fflags & RPCIOD_KILL_EVENT) && rpcioKill())
+					rpcioExit();
+				continue;
+			}
+
+			/* the server might have been destroyed meanwhile */
+			if ((srv = srvLookup((uintptr_t)event[i].udata))) {
+				srvService(srv, &event[i]);
+				srvRelease(srv);
+			}
+		}
+	}
+}
 
 /* support for transaction 'pools'. A number of XACT objects
  * is always kept around. The initial number is 0 but it
@@ -1644,51 +1934,113 @@ RpcUdpXactPool pool;
 }
 
 #ifdef MBUF_RX
-
-/* WORKAROUND: include sys/mbuf.h (or other bsdnet headers) only
- *             _after_ using malloc()/free() & friends because
- *             the RTEMS/BSDNET headers redefine those :-(
+/* The caller makes sure the chain holds at least an XID;
+ * it may be spread across mbufs (TCP) and need not be aligned.
  */
-
-#include <machine/rtems-bsd-kernel-space.h>
-#include <sys/mbuf.h>
-
-static void
-bufFree(struct mbuf **m)
+static uint32_t
+XID(struct mbuf *m)
 {
-	if (*m) {
-		rtems_bsdnet_semaphore_obtain();
-		m_freem(*m);
-		rtems_bsdnet_semaphore_release();
-		*m = 0;
+uint32_t	xid;
+char		*p = (char*)&xid;
+int			n, len = sizeof(xid);
+
+	for ( ; len > 0; m = m->m_next ) {
+		n = m->m_len < len ? m->m_len : len;
+		memcpy(p, mtod(m, void *), n);
+		p   += n;
+		len -= n;
 	}
+	return xid;
 }
 #endif
 
 #ifdef MBUF_TX
+/* Called by the stack once the last mbuf referencing
+ * the transaction buffer is freed. Note that the mbuf
+ * is passed, see mb_free_ext().
+ */
 static void
-paranoia_free(caddr_t closure, u_int size)
+xactBufFree(struct mbuf *m)
 {
-#if (DEBUG)
-RpcUdpXact xact = (RpcUdpXact)closure;
-int        len  = (int)XDR_GETPOS(&xact->xdrs);
+RpcUdpXact xact = (RpcUdpXact)m->m_ext.ext_arg1;
 
-	ASSERT( --xact->refcnt >= 0 && size == len );
-#endif
+	xact->refcnt = 0;
+	rtems_binary_semaphore_post(&xact->bufdone);
 }
 
+/* Wait until the stack released the transaction buffer;
+ * usually it is long gone when the reply arrives.
+ * A post left over from a previous release only causes
+ * another check of the reference count.
+ */
 static void
-paranoia_ref (caddr_t closure, u_int size)
+xactBufWait(RpcUdpXact xact)
 {
-#if (DEBUG)
-RpcUdpXact xact = (RpcUdpXact)closure;
-int        len  = (int)XDR_GETPOS(&xact->xdrs);
-	ASSERT( size == len );
-	xact->refcnt++;
-#endif
+	while (xact->refcnt != 0)
+		rtems_binary_semaphore_wait(&xact->bufdone);
 }
 #endif
 
+/* Send the encoded transaction to its server.
+ *
+ * MBUF_TX:
+ * The XID is copied into the packet header mbuf because it
+ * is changed while a (re-)transmission may still be
+ * queued. The rest of the message is handed to the stack as
+ * external storage. As long as it is referenced, the workers
+ * do not retransmit (the queued copy is as good as a new
+ * one) and the requestor does not encode a new request into
+ * the buffer.
+ */
+static ssize_t
+sockSnd(RpcUdpXact xact, int len)
+{
+RpcUdpServer	srv = xact->server;
+#ifdef MBUF_TX
+struct mbuf		*m, *n;
+int				error;
+
+	if (xact->refcnt != 0)
+		return len;
+
+	m = rtems_bsd_m_gethdr(M_NOWAIT, MT_DATA);
+	n = rtems_bsd_m_get(M_NOWAIT, MT_DATA);
+	if ( !m || !n ) {
+		if (m)
+			rtems_bsd_m_free(m);
+		if (n)
+			rtems_bsd_m_free(n);
+		errno = ENOBUFS;
+		return -1;
+	}
+
+	memcpy(mtod(m, void *), &xact->obuf.xid, sizeof(xact->obuf.xid));
+	m->m_len        = sizeof(xact->obuf.xid);
+	m->m_pkthdr.len = len;
+	m->m_next       = n;
+
+	rtems_bsd_m_extaddref(n, xact->obuf.buf, xact->obufsize,
+		__DECONST(u_int *, &xact->refcnt),
+		(void (*)(void *, void *))xactBufFree, xact, NULL);
+	n->m_data      += sizeof(xact->obuf.xid);
+	n->m_len        = len - sizeof(xact->obuf.xid);
+
+	error = rtems_bsd_sendto(srv->sock, m, 0, &srv->addr.sa);
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return len;
+#else
+	return sendto(srv->sock,
+				  xact->obuf.buf,
+				  len,
+				  0,
+				  &srv->addr.sa,
+				  sizeof(srv->addr.sin));
+#endif
+}
+
 /* receive from a socket and find
  * the transaction corresponding to the
  * transaction ID received in the server
@@ -1704,9 +2056,9 @@ int        len  = (int)XDR_GETPOS(&xact->xdrs);
 #define RPCIOD_RXBUFSZ	UDPMSGSIZE
 
 static RpcUdpXact
-sockRcv(void)
+sockRcv(RpcUdpServer srv)
 {
-int					len,i;
+int					len;
 uint32_t				xid;
 union {
 	struct sockaddr_in	sin;
@@ -1731,19 +2083,32 @@ RpcUdpXact			xact     = 0;
 	if (ibuf)
 		bufFree(&ibuf);
 
-	len  = recv_mbuf_from(
-					ourSock,
+	{
+	size_t	rxlen = RPCIOD_RXBUFSZ;
+	int		error;
+
+	fromLen = sizeof(fromAddr.sin);
+	error = rtems_bsd_recvfrom(
+					srv->sock,
 					&ibuf,
-					RPCIOD_RXBUFSZ,
+					&rxlen,
+					0,
 				    &fromAddr.sa,
 				    &fromLen);
+	if (error) {
+		errno = error;
+		len   = -1;
+	} else {
+		len   = (int)rxlen;
+	}
+	}
 #else
 	if ( !ibuf )
 		ibuf = (RpcBuf)MY_MALLOC(RPCIOD_RXBUFSZ);
 	if ( !ibuf )
 		goto cleanup; /* no memory - drop this message */
 
-	len  = recvfrom(ourSock,
+	len  = recvfrom(srv->sock,
 				    ibuf->buf,
 				    RPCIOD_RXBUFSZ,
 				    0,
@@ -1757,6 +2122,11 @@ RpcUdpXact			xact     = 0;
 		goto cleanup;
 	}
 
+	if ( len < (int)sizeof(xid) ) {
+		fprintf(stderr,"RPCIO WARNING sockRcv(): dropping runt packet\n");
+		continue;
+	}
+
 #if (DEBUG) & DEBUG_PACKLOSS
 	if ( (unsigned)rand() < DEBUG_PACKLOSS_FRACT ) {
 		/* lose packets once in a while */
@@ -1769,59 +2139,369 @@ RpcUdpXact			xact     = 0;
 	}
 #endif
 
-	i = (xid=XID(ibuf)) & XACT_HASH_MSK;
+	xid  = XID(ibuf);
+	xact = xactMatch(xid, srv, &fromAddr.sin);
 
-	if ( !(xact=xactHashTbl[i])                                             ||
-		   xact->obuf.xid                     != xid                        ||
-#ifdef REJECT_SERVERIP_MISMATCH
-		   xact->server->addr.sin.sin_addr.s_addr != fromAddr.sin.sin_addr.s_addr	||
+	} while ( !xact );
+
+	xact->ibuf     = ibuf;
+#ifndef MBUF_RX
+	xact->ibufsize = RPCIOD_RXBUFSZ;
 #endif
-		   xact->server->addr.sin.sin_port        != fromAddr.sin.sin_port ) {
 
-		if (xact) {
-			if (
+	return xact;
+
+cleanup:
+
+	bufFree(&ibuf);
+
+	return 0;
+}
+
+/* Find the transaction a reply from 'srv' belongs to; for
+ * UDP, the reply was sent from 'from'. The caller holds the
+ * server lock.
+ */
+static RpcUdpXact
+xactMatch(uint32_t xid, RpcUdpServer srv, struct sockaddr_in *from)
+{
+RpcUdpXact	xact;
+int			peer;
+
+	MU_LOCK(hlock);
+
+	xact = xactHashTbl[xid & XACT_HASH_MSK];
+
+	if ( !xact ) {
+		MU_UNLOCK(hlock);
+		fprintf(stderr,
+				"RPCIO WARNING sockRcv(): got xid 0x%08" PRIx32 " but its slot is empty\n",
+				xid);
+		return 0;
+	}
+
+	peer = xact->server == srv && ( !from || (
 #ifdef REJECT_SERVERIP_MISMATCH
-			    xact->server->addr.sin.sin_addr.s_addr == fromAddr.sin.sin_addr.s_addr &&
+	       srv->addr.sin.sin_addr.s_addr == from->sin_addr.s_addr &&
 #endif
-		        xact->server->addr.sin.sin_port        == fromAddr.sin.sin_port        &&
-			    ( xact->obuf.xid                   == xid + XACT_HASHS   ||
-				  xact->obuf.xid                   == xid + 2*XACT_HASHS    )
-				) {
+	       srv->addr.sin.sin_port        == from->sin_port ) );
+
+	/* only transactions on the retransmission list of the
+	 * server are waiting for a reply
+	 */
+	if ( peer && xact->obuf.xid == xid && xact->node.prev ) {
+		MU_UNLOCK(hlock);
+		return xact;
+	}
+
+	if ( peer &&
+	     ( xact->obuf.xid == xid + XACT_HASHS   ||
+	       xact->obuf.xid == xid + 2*XACT_HASHS    ) ) {
 #ifndef DEBUG /* don't complain if it's just a late arrival of a retry */
-			fprintf(stderr,"RPCIO - FYI sockRcv(): dropping late/redundant retry answer\n");
+		fprintf(stderr,"RPCIO - FYI sockRcv(): dropping late/redundant retry answer\n");
 #endif
-			} else {
-			fprintf(stderr,"RPCIO WARNING sockRcv(): transaction mismatch\n");
-			fprintf(stderr,"xact: xid  0x%08" PRIx32 "  -- got 0x%08" PRIx32 "\n",
-							xact->obuf.xid, xid);
+	} else {
+		fprintf(stderr,"RPCIO WARNING sockRcv(): transaction mismatch\n");
+		fprintf(stderr,"xact: xid  0x%08" PRIx32 "  -- got 0x%08" PRIx32 "\n",
+						xact->obuf.xid, xid);
+		fprintf(stderr,"xact: server %s (%s) -- got %s (%s)\n",
+						xact->server ? xact->server->name : "none",
+						xact->server && IPPROTO_TCP == xact->server->proto ? "tcp" : "udp",
+						srv->name,
+						IPPROTO_TCP == srv->proto ? "tcp" : "udp");
+		if ( from ) {
 			fprintf(stderr,"xact: addr 0x%08" PRIx32 "  -- got 0x%08" PRIx32 "\n",
-							xact->server->addr.sin.sin_addr.s_addr,
-							fromAddr.sin.sin_addr.s_addr);
+							srv->addr.sin.sin_addr.s_addr,
+							from->sin_addr.s_addr);
 			fprintf(stderr,"xact: port 0x%08x  -- got 0x%08x\n",
-							xact->server->addr.sin.sin_port,
-							fromAddr.sin.sin_port);
-			}
-		} else {
+							srv->addr.sin.sin_port,
+							from->sin_port);
+		}
+	}
+
+	MU_UNLOCK(hlock);
+
+	return 0;
+}
+
+#ifdef RPCIOD_TCP
+/* TCP transport
+ *
+ * Each TCP server has its own connection which is
+ * established on demand by the workers. Requests are
+ * sent as single fragment records (RFC 5531); any
+ * number of them may be outstanding on a connection
+ * and the replies are matched by XID just like for UDP.
+ * A request is sent once per connection; TCP takes
+ * care of retransmissions. If the connection breaks,
+ * a new one is established and all outstanding requests
+ * are sent again.
+ */
+
+static ssize_t
+tcpSnd(RpcUdpXact xact, int len)
+{
+RpcUdpServer	srv = xact->server;
+struct mbuf		*m, *n;
+uint32_t		*hdr;
+int				error;
+
+	if ( TCP_CONNECTED != srv->state ) {
+		if ( TCP_IDLE == srv->state &&
+		     rpcNow() >= srv->holdoff ) {
+			tcpConnect(srv);
+		}
+		return 0;
+	}
+
+	if ( xact->gen == srv->gen )
+		return 0;
+
+	if ( xact->refcnt != 0 ) {
+		/* still referenced by the previous connection */
+		errno = EWOULDBLOCK;
+		return -1;
+	}
+
+	m = rtems_bsd_m_gethdr(M_NOWAIT, MT_DATA);
+	n = rtems_bsd_m_get(M_NOWAIT, MT_DATA);
+	if ( !m || !n ) {
+		if (m)
+			rtems_bsd_m_free(m);
+		if (n)
+			rtems_bsd_m_free(n);
+		errno = EWOULDBLOCK;
+		return -1;
+	}
+
+	/* record mark and XID; see sockSnd() */
+	hdr             = mtod(m, uint32_t *);
+	hdr[0]          = htonl(TCP_LAST_FRAG | (uint32_t)len);
+	hdr[1]          = xact->obuf.xid;
+	m->m_len        = 2 * sizeof(uint32_t);
+	m->m_pkthdr.len = len + sizeof(uint32_t);
+	m->m_next       = n;
+
+	rtems_bsd_m_extaddref(n, xact->obuf.buf, xact->obufsize,
+		__DECONST(u_int *, &xact->refcnt),
+		(void (*)(void *, void *))xactBufFree, xact, NULL);
+	n->m_data      += sizeof(xact->obuf.xid);
+	n->m_len        = len - sizeof(xact->obuf.xid);
+
+	error = rtems_bsd_sendto(srv->sock, m, 0, NULL);
+	if ( error ) {
+		if ( EWOULDBLOCK != error ) {
 			fprintf(stderr,
-					"RPCIO WARNING sockRcv(): got xid 0x%08" PRIx32 " but its slot is empty\n",
-					xid);
+					"RPCIO: send to server '%s' failed (%s); reconnecting\n",
+					srv->name, strerror(error));
+			tcpDisconnect(srv);
+			return 0;
 		}
-		/* forget about this one and try again */
-		xact = 0;
+		errno = error;
+		return -1;
 	}
 
-	} while ( !xact );
+	xact->gen = srv->gen;
+	return len;
+}
 
-	xact->ibuf     = ibuf;
-#ifndef MBUF_RX
-	xact->ibufsize = RPCIOD_RXBUFSZ;
-#endif
+static void
+tcpConnect(RpcUdpServer srv)
+{
+int				s;
+int				noblock = 1;
+int				nodelay = 1;
+struct kevent	change[2];
 
-	return xact;
+	srv->holdoff = rpcNow() + (TimeoutT)RPCIOD_TCP_HOLDOFF_S * 1000000;
 
-cleanup:
+	s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if ( s < 0 ) {
+		fprintf(stderr,"RPCIO: unable to create TCP socket (%s)\n", strerror(errno));
+		return;
+	}
 
-	bufFree(&ibuf);
+	/* servers may insist on a reserved port */
+	bindresvport(s, (struct sockaddr_in*)0);
+
+	if ( ioctl(s, FIONBIO, (char*)&noblock) ||
+	     setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) ||
+	     ( connect(s, &srv->addr.sa, sizeof(srv->addr.sin)) && EINPROGRESS != errno ) ) {
+		fprintf(stderr,
+				"RPCIO: unable to connect to server '%s' (%s)\n",
+				srv->name, strerror(errno));
+		close(s);
+		return;
+	}
+
+	/* the write filter signals the end of the connection setup */
+	EV_SET(&change[0], s, EVFILT_READ, EV_ADD | EV_ENABLE | EV_CLEAR, 0, 0,
+		   (void *)srv->ident);
+	EV_SET(&change[1], s, EVFILT_WRITE, EV_ADD | EV_ENABLE | EV_ONESHOT, 0, 0,
+		   (void *)srv->ident);
+
+	if ( kevent(rpcKq, change, 2, NULL, 0, NULL) ) {
+		fprintf(stderr,"RPCIO: kevent() failed (%s)\n", strerror(errno));
+		close(s);
+		return;
+	}
+
+	srv->sock  = s;
+	srv->state = TCP_CONNECTING;
+}
+
+static void
+tcpConnected(RpcUdpServer srv, TimeoutT now)
+{
+int				error = 0;
+socklen_t		len   = sizeof(error);
+ListNode		n;
+
+	if ( TCP_CONNECTING != srv->state )
+		return;
+
+	if ( getsockopt(srv->sock, SOL_SOCKET, SO_ERROR, &error, &len) )
+		error = errno;
+
+	if ( error ) {
+		fprintf(stderr,
+				"RPCIO: unable to connect to server '%s' (%s)\n",
+				srv->name, strerror(error));
+		tcpDisconnect(srv);
+		return;
+	}
+
+	srv->state = TCP_CONNECTED;
+	srv->gen++;
+	srv->connects++;
+
+	/* send the requests waiting for this connection right
+	 * away; the list remains sorted
+	 */
+	for ( n = srv->xacts.next; n; n = n->next )
+		((RpcUdpXact)n)->age = now;
+}
+
+static void
+tcpDisconnect(RpcUdpServer srv)
+{
+	if ( srv->sock >= 0 ) {
+		/* this also removes the kqueue filters */
+		close(srv->sock);
+		srv->sock = -1;
+	}
+
+	srv->state    = TCP_IDLE;
+	srv->rmarklen = 0;
+	srv->fresid   = 0;
+	srv->reclen   = 0;
+	bufFree(&srv->rec);
+	srv->rectail  = 0;
+}
+
+/* Receive from the TCP connection and return the
+ * transaction corresponding to the next complete
+ * record, or NULL if no complete record is available.
+ */
+static RpcUdpXact
+tcpRcv(RpcUdpServer srv)
+{
+RxBuf		ibuf;
+RpcUdpXact	xact;
+uint32_t	rmark;
+uint32_t	reclen;
+
+	while ( TCP_CONNECTED == srv->state ) {
+
+		if ( srv->rmarklen < (int)sizeof(srv->rmark) ) {
+			ssize_t n;
+
+			n = recv(srv->sock,
+					 (char*)&srv->rmark + srv->rmarklen,
+					 sizeof(srv->rmark) - srv->rmarklen,
+					 0);
+			if ( n <= 0 ) {
+				if ( n < 0 && EWOULDBLOCK == errno )
+					return 0;
+				fprintf(stderr,
+						"RPCIO: connection to server '%s' lost (%s); reconnecting\n",
+						srv->name, n ? strerror(errno) : "closed by peer");
+				tcpDisconnect(srv);
+				return 0;
+			}
+
+			srv->rmarklen += n;
+			if ( srv->rmarklen < (int)sizeof(srv->rmark) )
+				continue;
+
+			srv->fresid = ntohl(srv->rmark) & ~TCP_LAST_FRAG;
+			if ( srv->fresid > RPCIOD_TCP_MAXREC - srv->reclen ) {
+				fprintf(stderr,
+						"RPCIO: record from server '%s' too long; reconnecting\n",
+						srv->name);
+				tcpDisconnect(srv);
+				return 0;
+			}
+		}
+
+		if ( srv->fresid > 0 ) {
+			struct mbuf *m;
+			size_t      len = srv->fresid;
+			int         error;
+
+			error = rtems_bsd_recvfrom(srv->sock, &m, &len, 0, NULL, NULL);
+			if ( error || 0 == len ) {
+				if ( EWOULDBLOCK == error )
+					return 0;
+				bufFree(&m);
+				fprintf(stderr,
+						"RPCIO: connection to server '%s' lost (%s); reconnecting\n",
+						srv->name, error ? strerror(error) : "closed by peer");
+				tcpDisconnect(srv);
+				return 0;
+			}
+
+			if ( srv->rec )
+				srv->rectail->m_next = m;
+			else
+				srv->rec = m;
+			for ( srv->rectail = m; srv->rectail->m_next; srv->rectail = srv->rectail->m_next )
+				/* nothing else to do */;
+
+			srv->reclen += len;
+			srv->fresid -= len;
+			if ( srv->fresid > 0 )
+				continue;
+		}
+
+		/* fragment complete */
+		rmark         = ntohl(srv->rmark);
+		srv->rmarklen = 0;
+		if ( !(rmark & TCP_LAST_FRAG) )
+			continue;
+
+		/* record complete */
+		ibuf          = srv->rec;
+		reclen        = srv->reclen;
+		srv->rec      = 0;
+		srv->rectail  = 0;
+		srv->reclen   = 0;
+
+		if ( reclen < sizeof(uint32_t) ) {
+			fprintf(stderr,"RPCIO WARNING tcpRcv(): dropping runt record\n");
+			bufFree(&ibuf);
+			continue;
+		}
+
+		if ( (xact = xactMatch(XID(ibuf), srv, 0)) ) {
+			xact->ibuf = ibuf;
+			return xact;
+		}
+
+		bufFree(&ibuf);
+	}
 
 	return 0;
 }
+
+#endif
@@ -88,6 +88,24 @@ rpcUdpServerCreate(
 	RpcUdpServer		*pclnt		/* new server is returned here    */
 	);
 
+/**
+ * @brief Create a server object using the specified transport.
+ *
+ * Like rpcUdpServerCreate() but the server is reached by the
+ * transport protocol @a proto (IPPROTO_UDP or IPPROTO_TCP).
+ * The TCP connection is established on demand and
+ * re-established if it breaks.
+ */
+enum clnt_stat
+rpcUdpServerCreateProto(
+	struct sockaddr_in	*paddr,
+	rpcprog_t		prog,
+	rpcvers_t		vers,
+	u_long			uid,		/* RPCIO_DEFAULT_ID picks default */
+	u_long			gid,		/* RPCIO_DEFAULT_ID picks default */
+	int				proto,		/* IPPROTO_UDP or IPPROTO_TCP     */
+	RpcUdpServer		*pclnt		/* new server is returned here    */
+	);
 
 void
 rpcUdpServerDestroy(RpcUdpServer s);
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * XDR decoding stream operating directly on a received mbuf chain.  Opaque
+ * data (for example the payload of a NFS READ reply) is copied straight from
+ * the mbufs into the destination buffer without an intermediate flat receive
+ * buffer.
+ *
+ * The stream state is kept in the XDR handle:
+ *
+ *   x_base	- the head of the mbuf chain
+ *   x_private	- the current mbuf
+ *   x_handy	- the offset into the current mbuf
+ */
+
+#include <sys/param.h>
+#include <sys/mbuf.h>
+
+#include <netinet/in.h>
+
+#include <rpc/types.h>
+#include <rpc/xdr.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "nfsclient-private.h"
+
+static bool_t
+xdrmbuf_getbytes(XDR *xdrs, char *addr, u_int len)
+{
+	struct mbuf *m = xdrs->x_private;
+	u_int off = xdrs->x_handy;
+
+	while (len > 0) {
+		u_int n;
+
+		if (m == NULL)
+			return (FALSE);
+
+		n = MIN(len, (u_int)m->m_len - off);
+		memcpy(addr, mtod(m, char *) + off, n);
+		addr += n;
+		len -= n;
+		off += n;
+
+		if (off == (u_int)m->m_len) {
+			m = m->m_next;
+			off = 0;
+		}
+	}
+
+	xdrs->x_private = m;
+	xdrs->x_handy = off;
+	return (TRUE);
+}
+
+static bool_t
+xdrmbuf_getlong(XDR *xdrs, long *lp)
+{
+	int32_t v;
+
+	if (!xdrmbuf_getbytes(xdrs, (char *)&v, sizeof(v)))
+		return (FALSE);
+
+	*lp = (int32_t)ntohl((uint32_t)v);
+	return (TRUE);
+}
+
+static bool_t
+xdrmbuf_putlong(XDR *xdrs, const long *lp)
+{
+
+	return (FALSE);
+}
+
+static bool_t
+xdrmbuf_putbytes(XDR *xdrs, const char *addr, u_int len)
+{
+
+	return (FALSE);
+}
+
+static u_int
+xdrmbuf_getpos(XDR *xdrs)
+{
+	struct mbuf *m = (struct mbuf *)xdrs->x_base;
+	u_int pos = 0;
+
+	while (m != NULL && m != xdrs->x_private) {
+		pos += m->m_len;
+		m = m->m_next;
+	}
+
+	return (pos + xdrs->x_handy);
+}
+
+static bool_t
+xdrmbuf_setpos(XDR *xdrs, u_int pos)
+{
+	struct mbuf *m = (struct mbuf *)xdrs->x_base;
+
+	while (m != NULL && pos > (u_int)m->m_len) {
+		pos -= m->m_len;
+		m = m->m_next;
+	}
+
+	if (m == NULL)
+		return (pos == 0);
+
+	xdrs->x_private = m;
+	xdrs->x_handy = pos;
+	return (TRUE);
+}
+
+static int32_t *
+xdrmbuf_inline(XDR *xdrs, u_int len)
+{
+	struct mbuf *m = xdrs->x_private;
+	char *p;
+
+	if (m == NULL || len > (u_int)m->m_len - xdrs->x_handy)
+		return (NULL);
+
+	p = mtod(m, char *) + xdrs->x_handy;
+	if (((uintptr_t)p & (sizeof(int32_t) - 1)) != 0)
+		return (NULL);
+
+	xdrs->x_handy += len;
+	if (xdrs->x_handy == (u_int)m->m_len) {
+		xdrs->x_private = m->m_next;
+		xdrs->x_handy = 0;
+	}
+
+	return ((int32_t *)p);
+}
+
+static void
+xdrmbuf_destroy(XDR *xdrs)
+{
+
+	/* The owner of the mbuf chain frees it */
+}
+
+static bool_t
+xdrmbuf_control(XDR *xdrs, int request, void *info)
+{
+
+	return (FALSE);
+}
+
+static const struct xdr_ops xdrmbuf_ops = {
+	.x_getlong = xdrmbuf_getlong,
+	.x_putlong = xdrmbuf_putlong,
+	.x_getbytes = xdrmbuf_getbytes,
+	.x_putbytes = xdrmbuf_putbytes,
+	.x_getpostn = xdrmbuf_getpos,
+	.x_setpostn = xdrmbuf_setpos,
+	.x_inline = xdrmbuf_inline,
+	.x_destroy = xdrmbuf_destroy,
+	.x_control = xdrmbuf_control
+};
+
+/*
+ * Only XDR_DECODE and XDR_FREE are supported.  Requests are encoded into the
+ * transaction buffer which is then handed to the stack as external mbuf
+ * storage.
+ */
+void
+xdrmbuf_create(XDR *xdrs, struct mbuf *m, enum xdr_op op)
+{
+
+	xdrs->x_op = op;
+	xdrs->x_ops = &xdrmbuf_ops;
+	xdrs->x_public = NULL;
+	xdrs->x_base = (char *)m;
+	xdrs->x_private = m;
+	xdrs->x_handy = 0;
+}
@@ -55,8 +55,13 @@ struct program_file_item {
 	LIST_ENTRY(program_file_item) entries;
 };
 
+/*
+ * Header in front of each block allocated by a program.  The magic value
+ * depends on the address of the header, so that blocks of other origin are
+ * recognized even outside of the program context.
+ */
 struct program_allocmem_item {
-	void	*ptr;
+	uintptr_t	magic;
 	LIST_ENTRY(program_allocmem_item) entries;
 };
 
@@ -47,17 +47,29 @@
 #include <net/if_dl.h>
 #include <arpa/inet.h>
 
+#include <machine/atomic.h>
+
 #include <errno.h>
 #include <fcntl.h>
 #include <ifaddrs.h>
+#include <poll.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
+/*
+ * In zero-copy mode the buffer holds the two zero-copy buffers of the BPF
+ * descriptor, each of them buf_size bytes including the struct
+ * bpf_zbuf_header.  Otherwise, it is the read(2) buffer.
+ */
 struct rtems_bsd_arp_processor_context {
 	int fd;
 	uint8_t eaddr[ETHER_ADDR_LEN];
+	bool zerocopy;
+	u_int zbuf_next;
+	struct bpf_zbuf_header *zbuf[2];
 	size_t buf_size;
-	uint8_t buf[];
+	uint8_t buf[] __aligned(BPF_ALIGNMENT);
 };
 
 #ifndef BPF_ETHCOOK
@@ -134,6 +146,92 @@ process_arp_packet(const uint8_t *pkt, size_t pkt_size, int fd,
 	(*processor)(arg, fd, eaddr, &ar, spa, tpa, sha, tha);
 }
 
+static void
+process_bpf_buffer(rtems_bsd_arp_processor_context *ctx,
+    const uint8_t *buf, size_t buf_avail, rtems_bsd_arp_processor processor)
+{
+	size_t buf_pos;
+
+	buf_pos = 0;
+
+	while (buf_pos < buf_avail) {
+		const uint8_t *pkt = buf + buf_pos;
+		struct bpf_hdr bp;
+
+		memcpy(&bp, pkt, sizeof(bp));
+
+		if (bp.bh_caplen == bp.bh_datalen &&
+		    buf_pos + bp.bh_caplen + bp.bh_hdrlen <= buf_avail) {
+			const uint8_t *payload = pkt + bp.bh_hdrlen +
+			    ETHER_HDR_LEN;
+			size_t payload_size = bp.bh_caplen - ETHER_HDR_LEN;
+
+			process_arp_packet(payload, payload_size, ctx->fd, ctx->eaddr,
+			    processor, NULL);
+		}
+
+		buf_pos += BPF_WORDALIGN(bp.bh_hdrlen + bp.bh_caplen);
+	}
+}
+
+static int
+setup_zerocopy(int fd, size_t *buf_size)
+{
+	u_int bufmode;
+	size_t zmax;
+	int buf_len;
+	int rv;
+
+	bufmode = BPF_BUFMODE_ZBUF;
+	rv = ioctl(fd, BIOCSETBUFMODE, &bufmode);
+	if (rv != 0) {
+		return rv;
+	}
+
+	buf_len = 0;
+	rv = ioctl(fd, BIOCGETZMAX, &zmax);
+	if (rv == 0) {
+		rv = ioctl(fd, BIOCGBLEN, &buf_len);
+	}
+	if (rv != 0 || buf_len <= 0) {
+		bufmode = BPF_BUFMODE_BUFFER;
+		(void) ioctl(fd, BIOCSETBUFMODE, &bufmode);
+		return -1;
+	}
+
+	*buf_size = BPF_WORDALIGN(sizeof(struct bpf_zbuf_header) +
+	    (size_t) buf_len);
+	if (*buf_size > zmax) {
+		*buf_size = zmax & ~(BPF_ALIGNMENT - 1);
+	}
+
+	return 0;
+}
+
+/*
+ * Returns the next zero-copy buffer owned by us or NULL.  The kernel fills
+ * the buffers alternately, so check the one after the last processed buffer
+ * first.
+ */
+static struct bpf_zbuf_header *
+get_zbuf(rtems_bsd_arp_processor_context *ctx)
+{
+	u_int i;
+
+	for (i = 0; i < 2; ++i) {
+		u_int j = (ctx->zbuf_next + i) % 2;
+		struct bpf_zbuf_header *bzh = ctx->zbuf[j];
+
+		if (atomic_load_acq_int((volatile int *)&bzh->bzh_kernel_gen) !=
+		    (int) bzh->bzh_user_gen) {
+			ctx->zbuf_next = (j + 1) % 2;
+			return bzh;
+		}
+	}
+
+	return NULL;
+}
+
 rtems_bsd_arp_processor_context *
 rtems_bsd_arp_processor_create(const char *ifname)
 {
@@ -144,6 +242,8 @@ rtems_bsd_arp_processor_create(const char *ifname)
 	size_t buf_size;
 	struct bpf_version pv;
 	struct bpf_program pf;
+	struct bpf_zbuf bz;
+	bool zerocopy;
 	int flags;
 	int rv;
 
@@ -158,6 +258,30 @@ rtems_bsd_arp_processor_create(const char *ifname)
 		goto error;
 	}
 
+	/*
+	 * Prefer the zero-copy buffer mode.  It saves the copy of each buffer
+	 * in read(2).  The buffers must be set before the interface.
+	 */
+	zerocopy = setup_zerocopy(fd, &buf_size) == 0;
+	if (zerocopy) {
+		ctx = malloc(sizeof(*ctx) + 2 * buf_size);
+		if (ctx == NULL) {
+			goto error;
+		}
+
+		memset(&bz, 0, sizeof(bz));
+		bz.bz_bufa = &ctx->buf[0];
+		bz.bz_bufb = &ctx->buf[buf_size];
+		bz.bz_buflen = buf_size;
+		rv = ioctl(fd, BIOCSETZBUF, &bz);
+		if (rv != 0) {
+			goto error;
+		}
+
+		ctx->zbuf[0] = bz.bz_bufa;
+		ctx->zbuf[1] = bz.bz_bufb;
+	}
+
 	memset(&ifr, 0, sizeof(ifr));
 	strlcpy(ifr.ifr_name, ifname, sizeof(ifr.ifr_name));
 	rv = ioctl(fd, BIOCSETIF, &ifr);
@@ -165,11 +289,13 @@ rtems_bsd_arp_processor_create(const char *ifname)
 		goto error;
 	}
 
-	rv = ioctl(fd, BIOCGBLEN, &buf_len);
-	if (rv != 0 || buf_len <= 0) {
-		goto error;
+	if (!zerocopy) {
+		rv = ioctl(fd, BIOCGBLEN, &buf_len);
+		if (rv != 0 || buf_len <= 0) {
+			goto error;
+		}
+		buf_size = (size_t) buf_len;
 	}
-	buf_size = (size_t) buf_len;
 
 	flags = 1;
 	rv = ioctl(fd, BIOCIMMEDIATE, &flags);
@@ -184,9 +310,11 @@ rtems_bsd_arp_processor_create(const char *ifname)
 		goto error;
 	}
 
-	ctx = malloc(sizeof(*ctx) + buf_size);
-	if (ctx == NULL) {
-		goto error;
+	if (!zerocopy) {
+		ctx = malloc(sizeof(*ctx) + buf_size);
+		if (ctx == NULL) {
+			goto error;
+		}
 	}
 
 	rv = rtems_bsd_get_ethernet_addr(ifname, &ctx->eaddr[0]);
@@ -195,6 +323,8 @@ rtems_bsd_arp_processor_create(const char *ifname)
 	}
 
 	ctx->fd = fd;
+	ctx->zerocopy = zerocopy;
+	ctx->zbuf_next = 0;
 	ctx->buf_size = buf_size;
 
 	return ctx;
@@ -213,41 +343,72 @@ rtems_bsd_arp_processor_get_file_descriptor(
 	return ctx->fd;
 }
 
+static int
+process_zerocopy(rtems_bsd_arp_processor_context *ctx,
+    rtems_bsd_arp_processor processor)
+{
+	struct bpf_zbuf_header *bzh;
+
+	bzh = get_zbuf(ctx);
+
+	if (bzh == NULL) {
+		struct pollfd pfd;
+		int rv;
+
+		pfd.fd = ctx->fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		rv = poll(&pfd, 1, -1);
+		if (rv < 0) {
+			return -1;
+		}
+
+		bzh = get_zbuf(ctx);
+	}
+
+	if (bzh == NULL) {
+		struct bpf_zbuf bz;
+		int rv;
+
+		/*
+		 * In immediate mode, the descriptor is readable as soon as the
+		 * store buffer contains a packet.  Hand it over to us.
+		 */
+		rv = ioctl(ctx->fd, BIOCROTZBUF, &bz);
+		if (rv != 0) {
+			return -1;
+		}
+
+		bzh = get_zbuf(ctx);
+	}
+
+	if (bzh != NULL) {
+		process_bpf_buffer(ctx, (const uint8_t *)(bzh + 1),
+		    bzh->bzh_kernel_len, processor);
+		atomic_store_rel_int((volatile int *)&bzh->bzh_user_gen,
+		    (int) bzh->bzh_kernel_gen);
+	}
+
+	return 0;
+}
+
 int
 rtems_bsd_arp_processor_process(
     rtems_bsd_arp_processor_context *ctx,
     rtems_bsd_arp_processor processor, void *arg)
 {
 	ssize_t n;
-	size_t buf_avail;
-	size_t buf_pos;
+
+	if (ctx->zerocopy) {
+		return process_zerocopy(ctx, processor);
+	}
 
 	n = read(ctx->fd, &ctx->buf[0], ctx->buf_size);
 	if (n < 0) {
 		return -1;
 	}
 
-	buf_avail = (size_t) n;
-	buf_pos = 0;
-
-	while (buf_pos < buf_avail) {
-		const uint8_t *pkt = &ctx->buf[0] + buf_pos;
-		struct bpf_hdr bp;
-
-		memcpy(&bp, pkt, sizeof(bp));
-
-		if (bp.bh_caplen == bp.bh_datalen &&
-		    buf_pos + bp.bh_caplen + bp.bh_hdrlen <= buf_avail) {
-			const uint8_t *payload = pkt + bp.bh_hdrlen +
-			    ETHER_HDR_LEN;
-			size_t payload_size = bp.bh_caplen - ETHER_HDR_LEN;
-
-			process_arp_packet(payload, payload_size, ctx->fd, ctx->eaddr,
-			    processor, NULL);
-		}
-
-		buf_pos += BPF_WORDALIGN(bp.bh_hdrlen + bp.bh_caplen);
-	}
+	process_bpf_buffer(ctx, &ctx->buf[0], (size_t) n, processor);
 
 	return 0;
 }
@@ -368,34 +368,17 @@ defaultrouter(rtems_bsd_rc_conf* rc_conf, rtems_bsd_rc_conf_argc_argv* aa, bool
     printf("Waiting %ds for default route interface: ", delay);
     fflush(stdout);
 
-    while (delay > 0) {
-      struct sockaddr_in sin;
-      struct sockaddr*   rti_info[RTAX_MAX];
-
-      --delay;
-
-      memset(&sin, 0, sizeof(sin));
-      memset(&rti_info[0], 0, sizeof(rti_info));
-      sin.sin_family = AF_INET;
-      inet_pton(AF_INET, "0.0.0.0", &sin.sin_addr);
-
-      r = rtems_get_route(&sin, rti_info);
-      if (r == 0 && rti_info[RTAX_GATEWAY] != NULL) {
-        break;
-      }
-      else if (r < 0 && errno != ESRCH) {
-        fprintf(stderr,
-                "error: get routes %d: %d %s\n", r, errno, strerror(errno));
-      }
-
-      sleep(1);
+    r = rtems_wait_default_route(delay * 1000);
+    if (r < 0 && errno != ETIMEDOUT) {
+      fprintf(stderr,
+              "error: get routes %d: %d %s\n", r, errno, strerror(errno));
     }
 
     /*
      * We should print the interface but I cannot see how to get the interface
      * with the default route without a lot of code.
      */
-    if (delay > 0) {
+    if (r == 0) {
       printf("found.\n");
       return 0;
     }
@@ -731,11 +714,6 @@ run_dhcp(rtems_bsd_rc_conf* rc_conf, rtems_bsd_rc_conf_argc_argv* aa)
     return -1;
   }
 
-  /*
-   * Let it run before moving on.
-   */
-  sleep(1);
-
   return 0;
 }
 
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Handle the remote syslog forwarding directives found in rc.conf.
+ * - syslogd_remote_enable
+ * - syslogd_remote_host
+ * - syslogd_remote_port
+ * - syslogd_remote_protocol ("udp" or "tcp")
+ * - syslogd_remote_queue_size
+ * - syslogd_remote_batch_size
+ * - syslogd_remote_drop ("newest" or "oldest")
+ * - syslogd_remote_priority
+ *
+ * Note: FreeBSD configures the forwarding in syslog.conf.  RTEMS has no
+ * syslogd, so the remote host is given directly in rc.conf.
+ */
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <machine/rtems-bsd-rc-conf-services.h>
+
+static int
+syslogd_find_ulong(rtems_bsd_rc_conf* rc_conf,
+                   rtems_bsd_rc_conf_argc_argv* aa,
+                   const char* name,
+                   unsigned long* value)
+{
+  int r;
+
+  r = rtems_bsd_rc_conf_find(rc_conf, name, aa);
+  if (r == 0) {
+    char* end;
+
+    if (aa->argc != 2) {
+      fprintf(stderr, "error: syslogd: syntax error in %s\n", name);
+      return -1;
+    }
+
+    *value = strtoul(aa->argv[1], &end, 10);
+    if (*end != '\0') {
+      fprintf(stderr, "error: syslogd: syntax error in %s\n", name);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int
+syslogd_service(rtems_bsd_rc_conf* rc_conf)
+{
+  rtems_bsd_syslog_remote_config config;
+  rtems_bsd_rc_conf_argc_argv* aa;
+  rtems_status_code sc;
+  unsigned long value;
+  char* host = NULL;
+  char* port = NULL;
+  int r;
+  int erroroccured = 0;
+
+  aa = rtems_bsd_rc_conf_argc_argv_create();
+  if (aa == NULL)
+    return -1;
+
+  r = rtems_bsd_rc_conf_find(rc_conf, "syslogd_remote_enable", aa);
+  if (r != 0 || aa->argc != 2 || strcasecmp("YES", aa->argv[1]) != 0) {
+    rtems_bsd_rc_conf_argc_argv_destroy(aa);
+    return 0;
+  }
+
+  memset(&config, 0, sizeof(config));
+  config.batch_size = 1024;
+  config.flush_interval = rtems_clock_get_ticks_per_second() / 10;
+  config.priority = RTEMS_MAXIMUM_PRIORITY - 1;
+
+  r = rtems_bsd_rc_conf_find(rc_conf, "syslogd_remote_host", aa);
+  if (r == 0 && aa->argc == 2) {
+    host = strdup(aa->argv[1]);
+    if (host == NULL) {
+      fprintf(stderr, "error: syslogd: no memory\n");
+      erroroccured = -1;
+    }
+  } else {
+    fprintf(stderr, "error: syslogd: no syslogd_remote_host given\n");
+    erroroccured = -1;
+  }
+
+  if (erroroccured == 0) {
+    r = rtems_bsd_rc_conf_find(rc_conf, "syslogd_remote_port", aa);
+    if (r == 0 && aa->argc == 2) {
+      port = strdup(aa->argv[1]);
+      if (port == NULL) {
+        fprintf(stderr, "error: syslogd: no memory\n");
+        erroroccured = -1;
+      }
+    }
+  }
+
+  if (erroroccured == 0) {
+    r = rtems_bsd_rc_conf_find(rc_conf, "syslogd_remote_protocol", aa);
+    if (r == 0) {
+      if (aa->argc == 2 && strcasecmp("tcp", aa->argv[1]) == 0) {
+        config.tcp = true;
+      } else if (aa->argc != 2 || strcasecmp("udp", aa->argv[1]) != 0) {
+        fprintf(stderr,
+            "error: syslogd: syslogd_remote_protocol is \"udp\" or \"tcp\"\n");
+        erroroccured = -1;
+      }
+    }
+  }
+
+  if (erroroccured == 0) {
+    r = rtems_bsd_rc_conf_find(rc_conf, "syslogd_remote_drop", aa);
+    if (r == 0) {
+      if (aa->argc == 2 && strcasecmp("oldest", aa->argv[1]) == 0) {
+        config.drop_oldest = true;
+      } else if (aa->argc != 2 || strcasecmp("newest", aa->argv[1]) != 0) {
+        fprintf(stderr,
+            "error: syslogd: syslogd_remote_drop is \"newest\" or \"oldest\"\n");
+        erroroccured = -1;
+      }
+    }
+  }
+
+  if (erroroccured == 0) {
+    value = config.batch_size;
+    erroroccured = syslogd_find_ulong(rc_conf, aa,
+                                      "syslogd_remote_batch_size", &value);
+    config.batch_size = value;
+  }
+
+  if (erroroccured == 0) {
+    value = 0;
+    erroroccured = syslogd_find_ulong(rc_conf, aa,
+                                      "syslogd_remote_queue_size", &value);
+    config.queue_size = value;
+  }
+
+  if (erroroccured == 0) {
+    value = config.priority;
+    erroroccured = syslogd_find_ulong(rc_conf, aa,
+                                      "syslogd_remote_priority", &value);
+    config.priority = value;
+  }
+
+  if (erroroccured == 0) {
+    config.host = host;
+    config.port = port;
+
+    if (rtems_bsd_rc_conf_verbose(rc_conf))
+      printf("syslogd: forward to %s port %s (%s)\n", host,
+             port != NULL ? port : "514", config.tcp ? "tcp" : "udp");
+
+    sc = rtems_bsd_syslog_remote_start(&config);
+    if (sc != RTEMS_SUCCESSFUL) {
+      fprintf(stderr, "error: syslogd: could not start forwarding: %s\n",
+              rtems_status_text(sc));
+      erroroccured = -1;
+    }
+  }
+
+  free(host);
+  free(port);
+  rtems_bsd_rc_conf_argc_argv_destroy(aa);
+
+  return erroroccured;
+}
+
+void
+rc_conf_syslogd_init(void* arg)
+{
+  int r;
+  r = rtems_bsd_rc_conf_service_add("syslogd",
+                                    "after:network;before:telnetd;",
+                                    syslogd_service);
+  if (r < 0)
+    fprintf(stderr,
+            "error: syslogd service add failed: %s\n", strerror(errno));
+}
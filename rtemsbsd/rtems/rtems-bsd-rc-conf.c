@@ -31,16 +31,22 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <net/if.h>
 #include <regex.h>
+#include <time.h>
 
 #include <syslog.h>
 
 #include <rtems.h>
 #include <rtems/chain.h>
+#include <rtems/rtems-routes.h>
+#include <rtems/thread.h>
 
 #include <machine/rtems-bsd-rc-conf.h>
 #include <machine/rtems-bsd-rc-conf-services.h>
@@ -70,6 +76,7 @@ struct rtems_bsd_rc_conf_ {
   int          error_code;    /**< The error code returned to the caller. */
   rtems_id     lock;          /**< Threading lock for this data. */
   rtems_id     waiter;        /**< The waiting thread, 0 if no one waiting */
+  int          wait_timeout;  /**< The readiness wait timeout in seconds. */
 };
 
 /*
@@ -82,14 +89,40 @@ typedef struct {
   const char*               before;
   const char*               after;
   const char*               require;
+  const char*               wait;
+  bool                      concurrent;
   rtems_bsd_rc_conf_service entry;
+  /*
+   * The state of the last run.
+   */
+  int                       state;
+  int                       result;
+  int                       error;
+  rtems_bsd_rc_conf_service_profile profile;
 } service;
 
+#define SERVICE_IDLE    (0)
+#define SERVICE_RUNNING (1)
+#define SERVICE_DONE    (2)
+
 /*
  * The chain of services.
  */
 static RTEMS_CHAIN_DEFINE_EMPTY(services);
 
+/*
+ * Protects the run state of the services and signals the completion of a
+ * service.
+ */
+static rtems_mutex services_lock = RTEMS_MUTEX_INITIALIZER("rc.conf");
+static rtems_condition_variable services_done =
+  RTEMS_CONDITION_VARIABLE_INITIALIZER("rc.conf");
+
+/*
+ * Default readiness wait timeout, the same as FreeBSD's defaultroute_delay.
+ */
+#define WAIT_TIMEOUT_DEFAULT (30)
+
 #define ARGC_ARGV_MARKER (0x20010928)
 
 static int
@@ -458,6 +491,85 @@ int rtems_bsd_rc_conf_find(rtems_bsd_rc_conf*           rc_conf,
   return rtems_bsd_rc_conf_find_next(rc_conf, argc_argv);
 }
 
+/*
+ * Get the next item of a comma separated list. Returns NULL if there are no
+ * more items.
+ */
+static const char*
+list_next(const char* list, size_t* length)
+{
+  const char* item;
+
+  if (list == NULL || *list == '\0')
+    return NULL;
+
+  item = list;
+  while (*list != ',' && *list != '\0')
+    ++list;
+
+  *length = list - item;
+
+  return item;
+}
+
+static const char*
+list_skip(const char* item, size_t length)
+{
+  item += length;
+  if (*item == ',')
+    ++item;
+  return item;
+}
+
+static bool
+list_contains(const char* list, const char* name)
+{
+  const char* item;
+  size_t      length;
+
+  while ((item = list_next(list, &length)) != NULL) {
+    if (strlen(name) == length && strncasecmp(item, name, length) == 0)
+      return true;
+    list = list_skip(item, length);
+  }
+
+  return false;
+}
+
+static bool
+wait_condition_valid(const char* item, size_t length)
+{
+  if (length == sizeof("defaultroute") - 1 &&
+      strncasecmp(item, "defaultroute", length) == 0)
+    return true;
+  if (length >= sizeof("ifaddr") - 1 &&
+      strncasecmp(item, "ifaddr", sizeof("ifaddr") - 1) == 0 &&
+      (length == sizeof("ifaddr") - 1 ||
+       (item[sizeof("ifaddr") - 1] == '=' && length > sizeof("ifaddr") &&
+        length - sizeof("ifaddr") < IFNAMSIZ)))
+    return true;
+  return false;
+}
+
+static bool
+wait_conditions_valid(const char* list)
+{
+  const char* item;
+  size_t      length;
+
+  while ((item = list_next(list, &length)) != NULL) {
+    if (!wait_condition_valid(item, length)) {
+      fprintf(stderr,
+              "error: rc.conf: add service: unknown wait condition: %.*s\n",
+              (int) length, item);
+      return false;
+    }
+    list = list_skip(item, length);
+  }
+
+  return true;
+}
+
 int
 rtems_bsd_rc_conf_service_add(const char*               name,
                               const char*               control,
@@ -529,6 +641,33 @@ rtems_bsd_rc_conf_service_add(const char*               name,
             c = NULL;
           }
         }
+        else if (strncasecmp("wait:", s, sizeof("wait:") - 1) == 0) {
+          if (srv->wait == NULL) {
+            srv->wait = s + sizeof("wait:") - 1;
+            if (!wait_conditions_valid(srv->wait))
+              c = NULL;
+            s = NULL;
+          }
+          else {
+            fprintf(stderr, "error: rc.conf: add service: repeated 'wait'\n");
+            c = NULL;
+          }
+        }
+        else if (strncasecmp("start:", s, sizeof("start:") - 1) == 0) {
+          const char* mode = s + sizeof("start:") - 1;
+          if (strcasecmp(mode, "concurrent") == 0) {
+            srv->concurrent = true;
+            s = NULL;
+          }
+          else if (strcasecmp(mode, "sequential") == 0) {
+            srv->concurrent = false;
+            s = NULL;
+          }
+          else {
+            fprintf(stderr, "error: rc.conf: add service: unknown start: %s\n", mode);
+            c = NULL;
+          }
+        }
         else {
           fprintf(stderr, "error: rc.conf: add service: unknown keyword: %s\n", s);
           c = NULL;
@@ -684,6 +823,30 @@ rtems_bsd_rc_conf_service_remove(const char* name)
   return -1;
 }
 
+int
+rtems_bsd_rc_conf_service_profile_get(const char*                        name,
+                                      rtems_bsd_rc_conf_service_profile* profile)
+{
+  rtems_chain_node*       node = rtems_chain_first(&services);
+  const rtems_chain_node* tail = rtems_chain_tail(&services);
+
+  while (node != tail) {
+    service* srv = (service*) node;
+
+    if (strcasecmp(name, srv->name) == 0) {
+      rtems_mutex_lock(&services_lock);
+      *profile = srv->profile;
+      rtems_mutex_unlock(&services_lock);
+      return 0;
+    }
+
+    node = rtems_chain_next(node);
+  }
+
+  errno = ENOENT;
+  return -1;
+}
+
 static void
 rc_conf_syslog(rtems_bsd_rc_conf* rc_conf)
 {
@@ -707,11 +870,208 @@ rc_conf_syslog(rtems_bsd_rc_conf* rc_conf)
   }
 }
 
+static void
+rc_conf_wait_timeout(rtems_bsd_rc_conf* rc_conf)
+{
+  rtems_bsd_rc_conf_argc_argv* aa;
+  int                          r;
+  rc_conf->wait_timeout = WAIT_TIMEOUT_DEFAULT;
+  aa = rtems_bsd_rc_conf_argc_argv_create();
+  if (aa != NULL) {
+    r = rtems_bsd_rc_conf_find(rc_conf, "defaultroute_delay", aa);
+    if (r == 0 && aa->argc == 2) {
+      char* end = NULL;
+      long  delay = strtol(aa->argv[1], &end, 10);
+      if (*end == '\0' && delay >= 0 && delay <= INT_MAX / 1000)
+        rc_conf->wait_timeout = (int) delay;
+      else
+        fprintf(stderr,
+                "error: rc.conf: invalid defaultroute_delay: %s\n", aa->argv[1]);
+    }
+    rtems_bsd_rc_conf_argc_argv_destroy(aa);
+  }
+}
+
+static uint64_t
+service_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/*
+ * Does the service have to wait for the other service to finish?
+ */
+static bool
+service_depends_on(const service* srv, const service* other)
+{
+  return (srv->after != NULL && list_contains(srv->after, other->name)) ||
+    (srv->require != NULL && list_contains(srv->require, other->name)) ||
+    (other->before != NULL && list_contains(other->before, srv->name));
+}
+
+/*
+ * Wait for the running services this service depends on. The services lock
+ * is held.
+ */
+static void
+service_wait_dependencies(const service* srv)
+{
+  rtems_chain_node* node = rtems_chain_first(&services);
+  while (node != &srv->node) {
+    const service* other = (const service*) node;
+    if (service_depends_on(srv, other)) {
+      while (other->state == SERVICE_RUNNING)
+        rtems_condition_variable_wait(&services_done, &services_lock);
+    }
+    node = rtems_chain_next(node);
+  }
+}
+
+/*
+ * Wait for the conditions the service needs to start. A condition that is not
+ * met is reported and the service is started anyway.
+ */
+static void
+service_wait_ready(rtems_bsd_rc_conf* rc_conf, const service* srv)
+{
+  const char* list = srv->wait;
+  const char* item;
+  size_t      length;
+  int         timeout = rc_conf->wait_timeout * 1000;
+
+  while ((item = list_next(list, &length)) != NULL) {
+    int r;
+    if (strncasecmp(item, "defaultroute", length) == 0) {
+      if (rc_conf->verbose)
+        printf("rc.conf: %s: waiting for default route\n", srv->name);
+      r = rtems_wait_default_route(timeout);
+    }
+    else if (length > sizeof("ifaddr") - 1) {
+      char ifname[IFNAMSIZ];
+      size_t len = length - sizeof("ifaddr");
+      memcpy(ifname, item + sizeof("ifaddr"), len);
+      ifname[len] = '\0';
+      if (rc_conf->verbose)
+        printf("rc.conf: %s: waiting for %s address\n", srv->name, ifname);
+      r = rtems_wait_ifaddr(ifname, timeout);
+    }
+    else {
+      if (rc_conf->verbose)
+        printf("rc.conf: %s: waiting for an interface address\n", srv->name);
+      r = rtems_wait_ifaddr(NULL, timeout);
+    }
+    if (r < 0)
+      fprintf(stderr, "warning: bsd service: %s: wait: %.*s: %s\n",
+              srv->name, (int) length, item, strerror(errno));
+    list = list_skip(item, length);
+  }
+}
+
+static void
+service_run(rtems_bsd_rc_conf* rc_conf, service* srv)
+{
+  uint64_t queued;
+  uint64_t start;
+  uint64_t end;
+  int      r;
+  int      error = 0;
+
+  if (srv->wait != NULL)
+    service_wait_ready(rc_conf, srv);
+
+  if (strcmp("network", srv->name) != 0)
+    printf("Starting %s.\n", srv->name);
+
+  start = service_now();
+  r = srv->entry(rc_conf);
+  if (r < 0)
+    error = errno;
+  end = service_now();
+
+  rtems_mutex_lock(&services_lock);
+  queued = srv->profile.queued;
+  srv->profile.start = start;
+  srv->profile.end = end;
+  srv->profile.result = r;
+  srv->result = r;
+  srv->error = error;
+  srv->state = SERVICE_DONE;
+  rtems_condition_variable_broadcast(&services_done);
+  rtems_mutex_unlock(&services_lock);
+
+  if (rc_conf->verbose)
+    printf("rc.conf: %s: queued:%" PRIu64 "us run:%" PRIu64 "us\n",
+           srv->name, (start - queued) / 1000, (end - start) / 1000);
+}
+
+/*
+ * A concurrent service runs on a copy of the rc.conf handle because the find
+ * state is held in the handle.
+ */
+typedef struct {
+  rtems_bsd_rc_conf rc_conf;
+  service*          srv;
+} service_context;
+
+static rtems_task
+service_task(rtems_task_argument task_argument)
+{
+  service_context* ctx = (service_context*) task_argument;
+  service_run(&ctx->rc_conf, ctx->srv);
+  free(ctx->rc_conf.find_regex);
+  free(ctx);
+  rtems_task_delete(RTEMS_SELF);
+}
+
+static int
+service_start(rtems_bsd_rc_conf* rc_conf, service* srv)
+{
+  service_context*    ctx;
+  rtems_task_priority priority;
+  rtems_id            task;
+  rtems_status_code   sc;
+
+  ctx = malloc(sizeof(*ctx));
+  if (ctx == NULL) {
+    fprintf(stderr, "error: bsd service: %s: no memory, running\n", srv->name);
+    return -1;
+  }
+
+  ctx->rc_conf = *rc_conf;
+  ctx->rc_conf.line = 0;
+  ctx->rc_conf.find_regex = NULL;
+  ctx->srv = srv;
+
+  sc = rtems_task_set_priority(RTEMS_SELF, RTEMS_CURRENT_PRIORITY, &priority);
+  if (sc == RTEMS_SUCCESSFUL)
+    sc = rtems_task_create(rtems_build_name('B', 'S', 'D', 's' ),
+                           priority,
+                           32 * 1024,
+                           RTEMS_PREEMPT | RTEMS_NO_TIMESLICE | RTEMS_NO_ASR,
+                           RTEMS_LOCAL | RTEMS_FLOATING_POINT,
+                           &task);
+  if (sc == RTEMS_SUCCESSFUL) {
+    sc = rtems_task_start(task, service_task, (rtems_task_argument) ctx);
+    if (sc != RTEMS_SUCCESSFUL)
+      rtems_task_delete(task);
+  }
+  if (sc != RTEMS_SUCCESSFUL) {
+    fprintf(stderr, "error: bsd service: %s: task: %s, running\n",
+            srv->name, rtems_status_text(sc));
+    free(ctx);
+    return -1;
+  }
+
+  return 0;
+}
+
 static rtems_task
 rc_conf_worker(rtems_task_argument task_argument)
 {
   rtems_bsd_rc_conf* rc_conf = (rtems_bsd_rc_conf*) task_argument;
-  rtems_chain_node*  node = rtems_chain_first(&services);
+  rtems_chain_node*  node;
   int                r = 0;
   int                error;
 
@@ -719,26 +1079,55 @@ rc_conf_worker(rtems_task_argument task_argument)
    * Check for a syslog priority before any services are run.
    */
   rc_conf_syslog(rc_conf);
+  rc_conf_wait_timeout(rc_conf);
 
   if (rc_conf->verbose)
     printf("rc.conf: running\n");
 
+  rtems_mutex_lock(&services_lock);
+  node = rtems_chain_first(&services);
+  while (!rtems_chain_is_tail(&services, node)) {
+    service* srv = (service*) node;
+    srv->state = SERVICE_IDLE;
+    memset(&srv->profile, 0, sizeof(srv->profile));
+    node = rtems_chain_next(node);
+  }
+  rtems_mutex_unlock(&services_lock);
+
+  node = rtems_chain_first(&services);
+  while (!rtems_chain_is_tail(&services, node)) {
+    service* srv = (service*) node;
+    rtems_mutex_lock(&services_lock);
+    srv->profile.queued = service_now();
+    service_wait_dependencies(srv);
+    srv->state = SERVICE_RUNNING;
+    rtems_mutex_unlock(&services_lock);
+    if (!srv->concurrent || service_start(rc_conf, srv) < 0)
+      service_run(rc_conf, srv);
+    node = rtems_chain_next(node);
+  }
+
+  /*
+   * Wait for the concurrent services and collect the errors in the service
+   * order.
+   */
+  rtems_mutex_lock(&services_lock);
+  node = rtems_chain_first(&services);
   while (!rtems_chain_is_tail(&services, node)) {
     service* srv = (service*) node;
-    int      rr;
-    if (strcmp("network", srv->name) != 0)
-      printf("Starting %s.\n", srv->name);
-    rr = srv->entry(rc_conf);
-    if (rr < 0) {
+    while (srv->state == SERVICE_RUNNING)
+      rtems_condition_variable_wait(&services_done, &services_lock);
+    if (srv->result < 0) {
       fprintf(stderr,
-              "error: bsd service: %s: %s\n", srv->name, strerror(errno));
+              "error: bsd service: %s: %s\n", srv->name, strerror(srv->error));
       if (r == 0) {
-        r = rr;
-        error = errno;
+        r = srv->result;
+        error = srv->error;
       }
     }
     node = rtems_chain_next(node);
   }
+  rtems_mutex_unlock(&services_lock);
 
   if (rc_conf->verbose)
     printf("rc.conf: services done\n");
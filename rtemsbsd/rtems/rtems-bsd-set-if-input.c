@@ -41,31 +41,57 @@
 
 #include <rtems/bsd/zerocopy.h>
 
-rtems_bsd_if_input
-rtems_bsd_set_if_input(const char *ifname,
-    rtems_bsd_if_input_init init, rtems_bsd_if_input if_input, void *arg)
+static int
+set_if_input(const char *ifname, struct rtems_ifinputreq *ifr)
 {
-	struct rtems_ifinputreq ifr;
 	int s;
 	int rv;
 
 	s = socket(AF_INET, SOCK_DGRAM, 0);
 	if (s < 0) {
-		return (NULL);
+		return (-1);
 	}
 
+	strlcpy(ifr->ifr_name, ifname, sizeof(ifr->ifr_name));
+	rv = ioctl(s, RTEMS_SIOSIFINPUT, (caddr_t)ifr);
+	close(s);
+
+	return (rv);
+}
+
+rtems_bsd_if_input
+rtems_bsd_set_if_input(const char *ifname,
+    rtems_bsd_if_input_init init, rtems_bsd_if_input if_input, void *arg)
+{
+	struct rtems_ifinputreq ifr;
+
 	memset(&ifr, 0, sizeof(ifr));
-	strlcpy(ifr.ifr_name, ifname, sizeof(ifr.ifr_name));
 	ifr.arg = arg;
 	ifr.init = init;
 	ifr.new_if_input = if_input;
 
-	rv = ioctl(s, RTEMS_SIOSIFINPUT, (caddr_t)&ifr);
-	close(s);
-
-	if (rv != 0) {
+	if (set_if_input(ifname, &ifr) != 0) {
 		return (NULL);
 	}
 
 	return (ifr.old_if_input);
 }
+
+rtems_bsd_if_input_batch
+rtems_bsd_set_if_input_batch(const char *ifname,
+    rtems_bsd_if_input_init init, rtems_bsd_if_input_batch if_input_batch,
+    void *arg)
+{
+	struct rtems_ifinputreq ifr;
+
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.arg = arg;
+	ifr.init = init;
+	ifr.new_if_input_batch = if_input_batch;
+
+	if (set_if_input(ifname, &ifr) != 0) {
+		return (NULL);
+	}
+
+	return (ifr.old_if_input_batch);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <rtems/netcmds-config.h>
+
+#include <rtems/bsd/bsd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int
+bootprof_command(int argc, char **argv)
+{
+	size_t max_lines;
+
+	max_lines = 0;
+
+	if (argc == 2) {
+		char *end;
+		long n;
+
+		n = strtol(argv[1], &end, 10);
+		if (*end != '\0' || n < 0) {
+			fprintf(stderr, "bootprof: invalid line count: %s\n",
+			    argv[1]);
+			return 1;
+		}
+
+		max_lines = (size_t)n;
+	} else if (argc > 2) {
+		fprintf(stderr, "usage: %s\n",
+		    rtems_shell_BOOTPROF_Command.usage);
+		return 1;
+	}
+
+	rtems_bsd_boot_profile_report(stdout, max_lines);
+	return 0;
+}
+
+rtems_shell_cmd_t rtems_shell_BOOTPROF_Command = {
+  .name = "bootprof",
+  .usage = "bootprof [max-lines]",
+  .topic = "misc",
+  .command = bootprof_command
+};
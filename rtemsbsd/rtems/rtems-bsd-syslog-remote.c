@@ -0,0 +1,550 @@
+/**
+ * @file
+ *
+ * @ingroup rtems_bsd_rtems
+ *
+ * @brief Remote syslog forwarding.
+ */
+
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The syslog() caller formats the message according to RFC 5424 and appends
+ * it to a bounded byte queue.  The caller never performs a socket operation.
+ * A task removes batches of messages from the queue and sends them to the
+ * remote syslog server, either as UDP datagrams or through a persistent TCP
+ * connection using the octet counting framing of RFC 6587.
+ */
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/thread.h>
+#include <rtems/bsd/bsd.h>
+
+#include <machine/rtems-bsd-syslog.h>
+
+#define SYSLOG_REMOTE_MSG_MAX 1024
+
+#define SYSLOG_REMOTE_FMT_MAX 512
+
+#define SYSLOG_REMOTE_QUEUE_SIZE (16 * 1024)
+
+#define SYSLOG_REMOTE_TASK_STACK_SIZE (16 * 1024)
+
+typedef enum {
+	SYSLOG_REMOTE_BUSY,
+	SYSLOG_REMOTE_WAIT_FOR_MESSAGE,
+	SYSLOG_REMOTE_WAIT_FOR_BATCH
+} syslog_remote_state;
+
+typedef struct {
+	rtems_bsd_syslog_remote_config config;
+	rtems_mutex mtx;
+	uint8_t *queue;
+	size_t queue_size;
+	size_t head;
+	size_t tail;
+	syslog_remote_state state;
+	rtems_id task;
+	int sd;
+	char *batch;
+	size_t batch_max;
+	char hostname[MAXHOSTNAMELEN];
+	rtems_bsd_syslog_remote_stats stats;
+} syslog_remote_context;
+
+static syslog_remote_context *syslog_remote;
+
+static void
+syslog_remote_copy_in(syslog_remote_context *ctx, size_t pos,
+    const void *data, size_t n)
+{
+	size_t off;
+	size_t first;
+
+	off = pos % ctx->queue_size;
+	first = MIN(n, ctx->queue_size - off);
+	memcpy(&ctx->queue[off], data, first);
+	memcpy(&ctx->queue[0], (const uint8_t *)data + first, n - first);
+}
+
+static void
+syslog_remote_copy_out(const syslog_remote_context *ctx, size_t pos,
+    void *data, size_t n)
+{
+	size_t off;
+	size_t first;
+
+	off = pos % ctx->queue_size;
+	first = MIN(n, ctx->queue_size - off);
+	memcpy(data, &ctx->queue[off], first);
+	memcpy((uint8_t *)data + first, &ctx->queue[0], n - first);
+}
+
+static uint16_t
+syslog_remote_peek_len(const syslog_remote_context *ctx)
+{
+	uint16_t len;
+
+	syslog_remote_copy_out(ctx, ctx->tail, &len, sizeof(len));
+	return (len);
+}
+
+static void
+syslog_remote_enqueue(syslog_remote_context *ctx, const char *msg,
+    uint16_t len)
+{
+	size_t need;
+	bool wake;
+
+	need = sizeof(len) + len;
+	wake = false;
+
+	rtems_mutex_lock(&ctx->mtx);
+
+	if (need > ctx->queue_size) {
+		++ctx->stats.dropped;
+		rtems_mutex_unlock(&ctx->mtx);
+		return;
+	}
+
+	while (ctx->queue_size - (ctx->head - ctx->tail) < need) {
+		if (!ctx->config.drop_oldest || ctx->head == ctx->tail) {
+			++ctx->stats.dropped;
+			rtems_mutex_unlock(&ctx->mtx);
+			return;
+		}
+
+		ctx->tail += sizeof(len) + syslog_remote_peek_len(ctx);
+		++ctx->stats.dropped;
+	}
+
+	syslog_remote_copy_in(ctx, ctx->head, &len, sizeof(len));
+	syslog_remote_copy_in(ctx, ctx->head + sizeof(len), msg, len);
+	ctx->head += need;
+	++ctx->stats.queued;
+
+	if (ctx->state == SYSLOG_REMOTE_WAIT_FOR_MESSAGE ||
+	    (ctx->state == SYSLOG_REMOTE_WAIT_FOR_BATCH &&
+	    ctx->head - ctx->tail >= ctx->config.batch_size)) {
+		ctx->state = SYSLOG_REMOTE_BUSY;
+		wake = true;
+	}
+
+	rtems_mutex_unlock(&ctx->mtx);
+
+	if (wake) {
+		(void)rtems_event_transient_send(ctx->task);
+	}
+}
+
+/*
+ * Replaces %m with the error message like the FreeBSD libc does, since the
+ * message is formatted with vsnprintf().
+ */
+static const char *
+syslog_remote_expand_errno(char *buf, size_t size, const char *fmt, int error)
+{
+	const char *p;
+	size_t len;
+
+	len = 0;
+
+	for (p = fmt; *p != '\0'; ++p) {
+		if (p[0] == '%' && p[1] == 'm') {
+			const char *s;
+
+			for (s = strerror(error); *s != '\0'; ++s) {
+				if (*s == '%') {
+					if (len + 1 >= size) {
+						return (fmt);
+					}
+
+					buf[len] = '%';
+					++len;
+				}
+
+				if (len + 1 >= size) {
+					return (fmt);
+				}
+
+				buf[len] = *s;
+				++len;
+			}
+
+			++p;
+			continue;
+		}
+
+		if (len + 2 >= size) {
+			return (fmt);
+		}
+
+		buf[len] = *p;
+		++len;
+
+		if (p[0] == '%' && p[1] == '%') {
+			++p;
+			buf[len] = *p;
+			++len;
+		}
+	}
+
+	buf[len] = '\0';
+	return (buf);
+}
+
+static void
+syslog_remote_forward(int priority, const char *ident, int error,
+    const char *fmt, va_list ap)
+{
+	syslog_remote_context *ctx;
+	char xfmt[SYSLOG_REMOTE_FMT_MAX];
+	char msg[SYSLOG_REMOTE_MSG_MAX];
+	struct timespec now;
+	struct tm tm;
+	size_t len;
+	int n;
+
+	ctx = syslog_remote;
+	(void)clock_gettime(CLOCK_REALTIME, &now);
+	(void)gmtime_r(&now.tv_sec, &tm);
+
+	n = snprintf(msg, sizeof(msg),
+	    "<%d>1 %04d-%02d-%02dT%02d:%02d:%02d.%06ldZ %s %s - - - ",
+	    priority & (LOG_FACMASK | LOG_PRIMASK), tm.tm_year + 1900,
+	    tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+	    now.tv_nsec / 1000, ctx->hostname,
+	    ident != NULL && *ident != '\0' ? ident : "-");
+	len = MIN((size_t)n, sizeof(msg) - 1);
+
+	fmt = syslog_remote_expand_errno(xfmt, sizeof(xfmt), fmt, error);
+	errno = error;
+	n = vsnprintf(&msg[len], sizeof(msg) - len, fmt, ap);
+
+	if (n > 0) {
+		len = MIN(len + (size_t)n, sizeof(msg) - 1);
+	}
+
+	/* Newlines separate the messages of a batch */
+	while (len > 0 && msg[len - 1] == '\n') {
+		--len;
+	}
+
+	syslog_remote_enqueue(ctx, msg, (uint16_t)len);
+}
+
+static bool
+syslog_remote_open(syslog_remote_context *ctx)
+{
+	struct addrinfo hints;
+	struct addrinfo *res;
+	struct addrinfo *ai;
+	int sd;
+
+	if (ctx->sd >= 0) {
+		return (true);
+	}
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = ctx->config.tcp ? SOCK_STREAM : SOCK_DGRAM;
+
+	if (getaddrinfo(ctx->config.host, ctx->config.port, &hints, &res) !=
+	    0) {
+		return (false);
+	}
+
+	sd = -1;
+
+	for (ai = res; ai != NULL; ai = ai->ai_next) {
+		sd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (sd < 0) {
+			continue;
+		}
+
+		if (connect(sd, ai->ai_addr, ai->ai_addrlen) == 0) {
+			break;
+		}
+
+		(void)close(sd);
+		sd = -1;
+	}
+
+	freeaddrinfo(res);
+	ctx->sd = sd;
+	return (sd >= 0);
+}
+
+/*
+ * Moves as many queued messages as fit into the batch buffer.  The caller
+ * must own the mutex.
+ */
+static size_t
+syslog_remote_dequeue(syslog_remote_context *ctx, uint32_t *count)
+{
+	size_t len;
+
+	len = 0;
+	*count = 0;
+
+	while (ctx->head != ctx->tail) {
+		uint16_t n;
+		char frame[16];
+		size_t frame_len;
+
+		n = syslog_remote_peek_len(ctx);
+
+		if (ctx->config.tcp) {
+			frame_len = (size_t)snprintf(frame, sizeof(frame),
+			    "%u ", n);
+		} else if (len > 0) {
+			frame[0] = '\n';
+			frame_len = 1;
+		} else {
+			frame_len = 0;
+		}
+
+		if (len > 0 && len + frame_len + n > ctx->batch_max) {
+			break;
+		}
+
+		memcpy(&ctx->batch[len], frame, frame_len);
+		len += frame_len;
+		syslog_remote_copy_out(ctx, ctx->tail + sizeof(n),
+		    &ctx->batch[len], n);
+		len += n;
+		ctx->tail += sizeof(n) + n;
+		++(*count);
+
+		if (ctx->config.batch_size == 0) {
+			break;
+		}
+	}
+
+	return (len);
+}
+
+static void
+syslog_remote_send(syslog_remote_context *ctx, size_t len, uint32_t count)
+{
+	const char *p;
+	bool ok;
+
+	p = ctx->batch;
+	ok = true;
+
+	while (len > 0) {
+		ssize_t n;
+
+		n = send(ctx->sd, p, len, 0);
+
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			ok = false;
+			break;
+		}
+
+		p += n;
+		len -= (size_t)n;
+	}
+
+	if (!ok) {
+		(void)close(ctx->sd);
+		ctx->sd = -1;
+	}
+
+	rtems_mutex_lock(&ctx->mtx);
+
+	if (ok) {
+		ctx->stats.sent += count;
+		++ctx->stats.batches;
+	} else {
+		ctx->stats.dropped += count;
+		++ctx->stats.send_errors;
+	}
+
+	rtems_mutex_unlock(&ctx->mtx);
+}
+
+static void
+syslog_remote_task(rtems_task_argument arg)
+{
+	syslog_remote_context *ctx;
+
+	ctx = (syslog_remote_context *)arg;
+
+	while (true) {
+		uint32_t count;
+		size_t len;
+
+		rtems_mutex_lock(&ctx->mtx);
+
+		while (ctx->head == ctx->tail) {
+			ctx->state = SYSLOG_REMOTE_WAIT_FOR_MESSAGE;
+			rtems_mutex_unlock(&ctx->mtx);
+			(void)rtems_event_transient_receive(RTEMS_WAIT,
+			    RTEMS_NO_TIMEOUT);
+			rtems_mutex_lock(&ctx->mtx);
+		}
+
+		if (ctx->config.batch_size > 0 &&
+		    ctx->config.flush_interval > 0 &&
+		    ctx->head - ctx->tail < ctx->config.batch_size) {
+			ctx->state = SYSLOG_REMOTE_WAIT_FOR_BATCH;
+			rtems_mutex_unlock(&ctx->mtx);
+			(void)rtems_event_transient_receive(RTEMS_WAIT,
+			    ctx->config.flush_interval);
+			rtems_mutex_lock(&ctx->mtx);
+		}
+
+		ctx->state = SYSLOG_REMOTE_BUSY;
+		rtems_mutex_unlock(&ctx->mtx);
+
+		/*
+		 * Do not remove messages from the queue while the server is
+		 * unreachable.  The drop policy applies to new messages.
+		 */
+		if (!syslog_remote_open(ctx)) {
+			(void)rtems_task_wake_after(
+			    rtems_clock_get_ticks_per_second());
+			continue;
+		}
+
+		rtems_mutex_lock(&ctx->mtx);
+		len = syslog_remote_dequeue(ctx, &count);
+		rtems_mutex_unlock(&ctx->mtx);
+
+		syslog_remote_send(ctx, len, count);
+	}
+}
+
+rtems_status_code
+rtems_bsd_syslog_remote_start(const rtems_bsd_syslog_remote_config *config)
+{
+	syslog_remote_context *ctx;
+	rtems_status_code sc;
+
+	if (config->host == NULL) {
+		return (RTEMS_INVALID_ADDRESS);
+	}
+
+	if (syslog_remote != NULL) {
+		return (RTEMS_INCORRECT_STATE);
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return (RTEMS_NO_MEMORY);
+	}
+
+	ctx->config = *config;
+	ctx->config.host = strdup(config->host);
+	ctx->config.port = strdup(config->port != NULL ? config->port : "514");
+	ctx->queue_size = config->queue_size != 0 ?
+	    config->queue_size : SYSLOG_REMOTE_QUEUE_SIZE;
+	ctx->queue = malloc(ctx->queue_size);
+	ctx->batch_max = MAX(config->batch_size, SYSLOG_REMOTE_MSG_MAX + 8);
+	ctx->batch = malloc(ctx->batch_max);
+	ctx->sd = -1;
+	rtems_mutex_init(&ctx->mtx, "syslog");
+
+	if (ctx->config.host == NULL || ctx->config.port == NULL ||
+	    ctx->queue == NULL || ctx->batch == NULL) {
+		sc = RTEMS_NO_MEMORY;
+		goto error;
+	}
+
+	if (gethostname(ctx->hostname, sizeof(ctx->hostname)) != 0 ||
+	    ctx->hostname[0] == '\0') {
+		strlcpy(ctx->hostname, "-", sizeof(ctx->hostname));
+	}
+
+	sc = rtems_task_create(rtems_build_name('S', 'L', 'O', 'G'),
+	    config->priority, SYSLOG_REMOTE_TASK_STACK_SIZE,
+	    RTEMS_DEFAULT_MODES, RTEMS_DEFAULT_ATTRIBUTES, &ctx->task);
+	if (sc != RTEMS_SUCCESSFUL) {
+		goto error;
+	}
+
+	syslog_remote = ctx;
+	rtems_bsd_syslog_forward = syslog_remote_forward;
+
+	sc = rtems_task_start(ctx->task, syslog_remote_task,
+	    (rtems_task_argument)ctx);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	return (RTEMS_SUCCESSFUL);
+
+error:
+
+	rtems_mutex_destroy(&ctx->mtx);
+	free(ctx->batch);
+	free(ctx->queue);
+	free(RTEMS_DECONST(char *, ctx->config.port));
+	free(RTEMS_DECONST(char *, ctx->config.host));
+	free(ctx);
+	return (sc);
+}
+
+void
+rtems_bsd_syslog_remote_get_stats(rtems_bsd_syslog_remote_stats *stats)
+{
+	syslog_remote_context *ctx;
+
+	ctx = syslog_remote;
+
+	if (ctx == NULL) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	rtems_mutex_lock(&ctx->mtx);
+	*stats = ctx->stats;
+	rtems_mutex_unlock(&ctx->mtx);
+}
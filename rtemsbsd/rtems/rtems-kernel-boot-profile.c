@@ -0,0 +1,609 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The boot profiler records the duration of each SYSINIT function and each
+ * device attach.  The hooks in mi_startup() and device_attach() run with
+ * Giant held, so the profiler state needs no further protection.  Since Giant
+ * is released while a thread sleeps, the attaches of the deferred attach
+ * tasks may interleave with the main initialization.  Each thread has its own
+ * nesting state for this reason.  The records are published to the readers
+ * through the release store of the record count.
+ *
+ * The time stamps are the uptime in nanoseconds.  The uptime is derived from
+ * the timecounter of the clock driver and has a 64-bit range, so long
+ * attaches, e.g. a PHY auto-negotiation or a USB enumeration, do not wrap
+ * like differences of the 32-bit CPU counter.
+ *
+ * Nested events are charged to the enclosing event, for example the attach
+ * of a bus includes the attach of its children.  The report shows the total
+ * time and the self time without the nested events and is sorted by the self
+ * time.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/systm.h>
+#include <sys/bus.h>
+#include <sys/kernel.h>
+#include <sys/kthread.h>
+#include <sys/lock.h>
+#include <sys/malloc.h>
+#include <sys/module.h>
+#include <sys/mutex.h>
+#include <sys/sbuf.h>
+#include <sys/sysctl.h>
+
+#include <net/vnet.h>
+
+#include <machine/atomic.h>
+#include <machine/rtems-bsd-boot-profile.h>
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+static MALLOC_DEFINE(M_BOOTPROF, "bootprof", "boot profiler");
+
+#define	BOOT_PROFILE_NAME_MAX		32
+#define	BOOT_PROFILE_DEPTH_MAX		32
+#define	BOOT_PROFILE_THREADS_MAX	8
+#define	BOOT_DEFER_DRIVERS_MAX		8
+
+enum boot_profile_kind {
+	BOOT_PROFILE_SYSINIT,
+	BOOT_PROFILE_ATTACH
+};
+
+struct boot_profile_record {
+	uint64_t	begin;
+	uint64_t	total;
+	uint64_t	self;
+	const void	*func;
+	const void	*udata;
+	uint32_t	subsystem;
+	uint32_t	order;
+	int		error;
+	uint16_t	depth;
+	uint8_t		kind;
+	char		name[BOOT_PROFILE_NAME_MAX];
+};
+
+struct boot_profile_stack {
+	rtems_id	thread;
+	int		depth;
+	uint64_t	nested[BOOT_PROFILE_DEPTH_MAX];
+};
+
+static struct {
+	struct boot_profile_record *records;
+	u_int		max;
+	u_int		count;
+	u_int		lost;
+	uint64_t	boot_end;
+	struct boot_profile_stack stacks[BOOT_PROFILE_THREADS_MAX];
+} boot_profile;
+
+/* Wake up channel for threads waiting for a device attach */
+static int boot_attach_event;
+
+static char boot_defer_drivers[BOOT_DEFER_DRIVERS_MAX][BOOT_PROFILE_NAME_MAX];
+
+static bool boot_defer_open = true;
+
+rtems_status_code
+rtems_bsd_boot_profile_enable(size_t max_records)
+{
+	struct boot_profile_record *records;
+
+	if (boot_profile.records != NULL || !boot_defer_open) {
+		return (RTEMS_INCORRECT_STATE);
+	}
+
+	if (max_records == 0 || max_records > UINT_MAX) {
+		return (RTEMS_INVALID_NUMBER);
+	}
+
+	records = malloc(max_records * sizeof(*records), M_BOOTPROF,
+	    M_NOWAIT | M_ZERO);
+	if (records == NULL) {
+		return (RTEMS_NO_MEMORY);
+	}
+
+	boot_profile.max = (u_int)max_records;
+	boot_profile.records = records;
+	return (RTEMS_SUCCESSFUL);
+}
+
+static struct boot_profile_stack *
+boot_profile_stack(bool allocate)
+{
+	struct boot_profile_stack *unused;
+	rtems_id self;
+	size_t i;
+
+	self = rtems_task_self();
+	unused = NULL;
+
+	for (i = 0; i < BOOT_PROFILE_THREADS_MAX; ++i) {
+		struct boot_profile_stack *stack;
+
+		stack = &boot_profile.stacks[i];
+		if (stack->depth == 0) {
+			if (unused == NULL) {
+				unused = stack;
+			}
+		} else if (stack->thread == self) {
+			return (stack);
+		}
+	}
+
+	if (allocate && unused != NULL) {
+		unused->thread = self;
+		return (unused);
+	}
+
+	return (NULL);
+}
+
+uint64_t
+rtems_bsd_boot_profile_begin(void)
+{
+	struct boot_profile_stack *stack;
+	uint64_t now;
+
+	if (boot_profile.records == NULL) {
+		return (0);
+	}
+
+	stack = boot_profile_stack(true);
+	if (stack == NULL) {
+		return (0);
+	}
+
+	if (stack->depth < BOOT_PROFILE_DEPTH_MAX) {
+		stack->nested[stack->depth] = 0;
+	}
+
+	++stack->depth;
+	now = rtems_clock_get_uptime_nanoseconds();
+	return (now != 0 ? now : 1);
+}
+
+static struct boot_profile_record *
+boot_profile_end(uint64_t begin, enum boot_profile_kind kind)
+{
+	struct boot_profile_stack *stack;
+	struct boot_profile_record *rec;
+	uint64_t total;
+	uint64_t nested;
+	u_int count;
+	int depth;
+
+	total = rtems_clock_get_uptime_nanoseconds() - begin;
+	stack = boot_profile_stack(false);
+	KASSERT(stack != NULL, ("boot profile: no stack"));
+	depth = --stack->depth;
+
+	if (depth < BOOT_PROFILE_DEPTH_MAX) {
+		nested = stack->nested[depth];
+	} else {
+		nested = 0;
+	}
+
+	if (depth > 0 && depth <= BOOT_PROFILE_DEPTH_MAX) {
+		stack->nested[depth - 1] += total;
+	}
+
+	count = boot_profile.count;
+	if (count >= boot_profile.max) {
+		++boot_profile.lost;
+		return (NULL);
+	}
+
+	rec = &boot_profile.records[count];
+	memset(rec, 0, sizeof(*rec));
+	rec->begin = begin;
+	rec->total = total;
+	rec->self = total > nested ? total - nested : 0;
+	rec->depth = (uint16_t)depth;
+	rec->kind = (uint8_t)kind;
+	return (rec);
+}
+
+static void
+boot_profile_publish(void)
+{
+
+	atomic_store_rel_int(&boot_profile.count, boot_profile.count + 1);
+}
+
+void
+rtems_bsd_boot_profile_sysinit(const struct sysinit *sip, uint64_t begin)
+{
+	struct boot_profile_record *rec;
+
+	if (begin == 0) {
+		return;
+	}
+
+	rec = boot_profile_end(begin, BOOT_PROFILE_SYSINIT);
+	if (rec == NULL) {
+		return;
+	}
+
+	rec->func = sip->func;
+	rec->udata = sip->udata;
+	rec->subsystem = sip->subsystem;
+	rec->order = sip->order;
+
+	if (sip->func == module_register_init) {
+		const moduledata_t *data = sip->udata;
+
+		strlcpy(rec->name, data->name, sizeof(rec->name));
+	}
+
+	boot_profile_publish();
+}
+
+void
+rtems_bsd_boot_profile_attach(device_t dev, uint64_t begin, int error)
+{
+	struct boot_profile_record *rec;
+
+	if (begin == 0) {
+		return;
+	}
+
+	rec = boot_profile_end(begin, BOOT_PROFILE_ATTACH);
+	if (rec == NULL) {
+		return;
+	}
+
+	rec->error = error;
+	snprintf(rec->name, sizeof(rec->name), "%s%d", device_get_name(dev),
+	    device_get_unit(dev));
+	boot_profile_publish();
+}
+
+static int
+boot_profile_compare(const void *a, const void *b)
+{
+	const struct boot_profile_record *ra;
+	const struct boot_profile_record *rb;
+
+	ra = &boot_profile.records[*(const u_int *)a];
+	rb = &boot_profile.records[*(const u_int *)b];
+
+	if (ra->self != rb->self) {
+		return (ra->self < rb->self ? 1 : -1);
+	}
+
+	return (ra->begin < rb->begin ? -1 : ra->begin > rb->begin);
+}
+
+static void
+boot_profile_report(struct sbuf *sb, size_t max_lines)
+{
+	const struct boot_profile_record *records;
+	u_int *order;
+	u_int count;
+	u_int i;
+
+	records = boot_profile.records;
+	if (records == NULL) {
+		sbuf_printf(sb, "boot profile: disabled\n");
+		return;
+	}
+
+	count = atomic_load_acq_int(&boot_profile.count);
+	sbuf_printf(sb, "boot profile: %u records, %u lost, boot done at "
+	    "%" PRIu64 "us\n", count, boot_profile.lost,
+	    boot_profile.boot_end / 1000);
+
+	if (count == 0) {
+		return;
+	}
+
+	order = malloc(count * sizeof(*order), M_BOOTPROF, M_WAITOK);
+	for (i = 0; i < count; ++i) {
+		order[i] = i;
+	}
+
+	qsort(order, count, sizeof(*order), boot_profile_compare);
+
+	if (max_lines == 0 || max_lines > count) {
+		max_lines = count;
+	}
+
+	sbuf_printf(sb, "    self us   total us   begin us depth  what\n");
+
+	for (i = 0; i < max_lines; ++i) {
+		const struct boot_profile_record *rec;
+
+		rec = &records[order[i]];
+		sbuf_printf(sb, "%11" PRIu64 "%11" PRIu64 "%11" PRIu64 "%6u  ",
+		    rec->self / 1000, rec->total / 1000, rec->begin / 1000,
+		    rec->depth);
+
+		if (rec->kind == BOOT_PROFILE_ATTACH) {
+			sbuf_printf(sb, "attach %s", rec->name);
+			if (rec->error != 0) {
+				sbuf_printf(sb, " (error %d)", rec->error);
+			}
+		} else {
+			sbuf_printf(sb, "sysinit %08" PRIx32 ":%08" PRIx32 " ",
+			    rec->subsystem, rec->order);
+			if (rec->name[0] != '\0') {
+				sbuf_printf(sb, "%s", rec->name);
+			} else {
+				sbuf_printf(sb, "%p(%p)", rec->func,
+				    rec->udata);
+			}
+		}
+
+		sbuf_putc(sb, '\n');
+	}
+
+	free(order, M_BOOTPROF);
+}
+
+void
+rtems_bsd_boot_profile_report(FILE *file, size_t max_lines)
+{
+	struct sbuf *sb;
+
+	sb = sbuf_new_auto();
+	if (sb == NULL) {
+		return;
+	}
+
+	boot_profile_report(sb, max_lines);
+
+	if (sbuf_finish(sb) == 0) {
+		fputs(sbuf_data(sb), file);
+	}
+
+	sbuf_delete(sb);
+}
+
+static int
+boot_profile_sysctl(SYSCTL_HANDLER_ARGS)
+{
+	struct sbuf sb;
+	int error;
+
+	error = sysctl_wire_old_buffer(req, 0);
+	if (error != 0) {
+		return (error);
+	}
+
+	sbuf_new_for_sysctl(&sb, NULL, 256, req);
+	boot_profile_report(&sb, 0);
+	error = sbuf_finish(&sb);
+	sbuf_delete(&sb);
+	return (error);
+}
+
+SYSCTL_PROC(_debug, OID_AUTO, boot_profile,
+    CTLTYPE_STRING | CTLFLAG_RD | CTLFLAG_MPSAFE, NULL, 0,
+    boot_profile_sysctl, "A", "Boot profile sorted by self time");
+
+rtems_status_code
+rtems_bsd_boot_defer_attach(const char *driver)
+{
+	size_t i;
+
+	if (!boot_defer_open) {
+		return (RTEMS_INCORRECT_STATE);
+	}
+
+	if (driver == NULL || driver[0] == '\0' ||
+	    strlen(driver) >= BOOT_PROFILE_NAME_MAX) {
+		return (RTEMS_INVALID_NAME);
+	}
+
+	/* The caller of mii_attach() needs the PHYs attached on return */
+	if (strcmp(driver, "miibus") == 0) {
+		return (RTEMS_INVALID_NAME);
+	}
+
+	for (i = 0; i < BOOT_DEFER_DRIVERS_MAX; ++i) {
+		if (boot_defer_drivers[i][0] == '\0') {
+			strlcpy(boot_defer_drivers[i], driver,
+			    sizeof(boot_defer_drivers[i]));
+			return (RTEMS_SUCCESSFUL);
+		}
+
+		if (strcmp(boot_defer_drivers[i], driver) == 0) {
+			return (RTEMS_SUCCESSFUL);
+		}
+	}
+
+	return (RTEMS_TOO_MANY);
+}
+
+/*
+ * Each deferred device is attached by its own task, so a slow bus does not
+ * delay the attach of other deferred buses.  The tasks wait for Giant, which
+ * is released at the end of rtems_bsd_initialize() or while the main
+ * initialization sleeps.
+ */
+static void
+boot_defer_worker(void *arg)
+{
+	device_t dev;
+
+	dev = arg;
+
+	mtx_lock(&Giant);
+
+	if (device_get_state(dev) == DS_ALIVE) {
+		CURVNET_SET_QUIET(vnet0);
+		(void)device_attach(dev);
+		CURVNET_RESTORE();
+	}
+
+	mtx_unlock(&Giant);
+	kproc_exit(0);
+}
+
+rtems_status_code
+rtems_bsd_boot_defer_slow_buses(void)
+{
+	static const char * const slow_buses[] = { "usbus", "mmc" };
+	rtems_status_code sc;
+	size_t i;
+
+	for (i = 0; i < nitems(slow_buses); ++i) {
+		sc = rtems_bsd_boot_defer_attach(slow_buses[i]);
+		if (sc != RTEMS_SUCCESSFUL) {
+			return (sc);
+		}
+	}
+
+	return (RTEMS_SUCCESSFUL);
+}
+
+bool
+rtems_bsd_boot_defer_attach_check(device_t dev)
+{
+	const char *name;
+	int error;
+	size_t i;
+
+	if (!boot_defer_open || boot_defer_drivers[0][0] == '\0') {
+		return (false);
+	}
+
+	name = device_get_name(dev);
+	if (name == NULL) {
+		return (false);
+	}
+
+	for (i = 0; i < BOOT_DEFER_DRIVERS_MAX; ++i) {
+		if (strcmp(boot_defer_drivers[i], name) == 0) {
+			break;
+		}
+	}
+
+	if (i == BOOT_DEFER_DRIVERS_MAX) {
+		return (false);
+	}
+
+	error = kproc_create(boot_defer_worker, dev, NULL, 0, 0, "attach %s",
+	    device_get_nameunit(dev));
+	if (error != 0) {
+		device_printf(dev, "cannot defer attach: %d\n", error);
+		return (false);
+	}
+
+	if (bootverbose) {
+		device_printf(dev, "attach deferred\n");
+	}
+
+	return (true);
+}
+
+void
+rtems_bsd_boot_attach_done(device_t dev)
+{
+
+	(void)dev;
+	wakeup(&boot_attach_event);
+}
+
+rtems_status_code
+rtems_bsd_wait_device(const char *name, int unit, rtems_interval timeout)
+{
+	rtems_status_code sc;
+	rtems_interval start;
+
+	if (name == NULL) {
+		return (RTEMS_INVALID_NAME);
+	}
+
+	start = rtems_clock_get_ticks_since_boot();
+	mtx_lock(&Giant);
+
+	while (true) {
+		devclass_t dc;
+		device_t dev;
+		int timo;
+
+		dc = devclass_find(name);
+		dev = dc != NULL ? devclass_get_device(dc, unit) : NULL;
+		if (dev != NULL && device_is_attached(dev)) {
+			sc = RTEMS_SUCCESSFUL;
+			break;
+		}
+
+		if (timeout != RTEMS_NO_TIMEOUT) {
+			rtems_interval elapsed;
+
+			elapsed = rtems_clock_get_ticks_since_boot() - start;
+			if (elapsed >= timeout) {
+				sc = RTEMS_TIMEOUT;
+				break;
+			}
+
+			timo = (int)MIN(timeout - elapsed, INT_MAX);
+		} else {
+			timo = 0;
+		}
+
+		(void)msleep(&boot_attach_event, &Giant, 0, "devwait", timo);
+	}
+
+	mtx_unlock(&Giant);
+	return (sc);
+}
+
+static void
+boot_defer_done(void *arg)
+{
+
+	(void)arg;
+
+	boot_defer_open = false;
+
+	if (boot_profile.records != NULL) {
+		boot_profile.boot_end = rtems_clock_get_uptime_nanoseconds();
+	}
+}
+SYSINIT(boot_defer, SI_SUB_LAST, SI_ORDER_ANY, boot_defer_done, NULL);
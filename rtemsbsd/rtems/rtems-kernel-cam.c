@@ -72,8 +72,16 @@
 
 #define BSD_SCSI_MIN_COMMAND_SIZE 10
 
+#define BSD_SCSI_SIMPLE_Q_TAG 0x20
+
+#define BSD_SIM_CCB_COUNT 4
+
+#define BSD_SIM_DEFAULT_MAXIO (64 * 1024)
+
 MALLOC_DEFINE(M_CAMSIM, "CAM SIM", "CAM SIM buffers");
 
+static void rtems_bsd_csio_callback(struct cam_periph *periph, union ccb *ccb);
+
 static void
 rtems_bsd_sim_set_state(struct cam_sim *sim, enum bsd_sim_state state)
 {
@@ -95,6 +103,23 @@ rtems_bsd_sim_wait_for_state(struct cam_sim *sim, enum bsd_sim_state state)
 	}
 }
 
+/*
+ * Moves the CCBs which were not handed over to the SIM yet to the active list.
+ * This prevents the completion callback from dispatching them while the
+ * active CCBs are canceled.
+ */
+static void
+rtems_bsd_sim_cancel_pending_ccbs(struct cam_sim *sim)
+{
+	struct ccb_hdr *ccb_h;
+
+	while ((ccb_h = TAILQ_FIRST(&sim->pending_ccbs)) != NULL) {
+		TAILQ_REMOVE(&sim->pending_ccbs, ccb_h, sim_links);
+		TAILQ_INSERT_TAIL(&sim->active_ccbs, ccb_h, sim_links);
+		++sim->openings;
+	}
+}
+
 static void
 rtems_bsd_sim_wait_for_state_and_cancel_ccb(struct cam_sim *sim, enum bsd_sim_state state)
 {
@@ -102,8 +127,15 @@ rtems_bsd_sim_wait_for_state_and_cancel_ccb(struct cam_sim *sim, enum bsd_sim_st
 		if (sim->state != BSD_SIM_BUSY) {
 			cv_wait(&sim->state_changed, sim->mtx);
 		} else {
-			sim->ccb.ccb_h.status = CAM_SEL_TIMEOUT;
-			(*sim->ccb.ccb_h.cbfcnp)(NULL, &sim->ccb);
+			struct ccb_hdr *ccb_h;
+
+			rtems_bsd_sim_cancel_pending_ccbs(sim);
+
+			ccb_h = TAILQ_FIRST(&sim->active_ccbs);
+			if (ccb_h != NULL) {
+				ccb_h->status = CAM_SEL_TIMEOUT;
+				(*ccb_h->cbfcnp)(NULL, (union ccb *) ccb_h);
+			}
 		}
 	}
 }
@@ -205,6 +237,111 @@ rtems_bsd_scsi_read_capacity(union ccb *ccb, uint32_t *block_count, uint32_t *bl
 	return RTEMS_SUCCESSFUL;
 }
 
+static rtems_status_code
+rtems_bsd_scsi_path_inquiry(union ccb *ccb, uint32_t *maxio,
+    uint32_t *hba_misc)
+{
+	rtems_status_code sc = RTEMS_SUCCESSFUL;
+	struct ccb_pathinq *cpi = &ccb->cpi;
+	struct cam_sim *sim = ccb->ccb_h.sim;
+
+	memset(cpi, 0, sizeof(*cpi));
+	cpi->ccb_h.sim = sim;
+	cpi->ccb_h.func_code = XPT_PATH_INQ;
+	cpi->ccb_h.cbfcnp = rtems_bsd_ccb_callback;
+	cpi->ccb_h.status = CAM_REQ_INPROG;
+
+	sc = rtems_bsd_ccb_action(ccb);
+	if (sc != RTEMS_SUCCESSFUL) {
+		return RTEMS_IO_ERROR;
+	}
+
+	*maxio = cpi->maxio;
+	*hba_misc = cpi->hba_misc;
+
+	return RTEMS_SUCCESSFUL;
+}
+
+static void
+rtems_bsd_sim_dispatch_ccbs(struct cam_sim *sim)
+{
+	struct ccb_hdr *ccb_h;
+
+	while (sim->openings < sim->max_openings
+	    && (ccb_h = TAILQ_FIRST(&sim->pending_ccbs)) != NULL) {
+		TAILQ_REMOVE(&sim->pending_ccbs, ccb_h, sim_links);
+		TAILQ_INSERT_TAIL(&sim->active_ccbs, ccb_h, sim_links);
+		++sim->openings;
+		(*sim->sim_action)(sim, (union ccb *) ccb_h);
+	}
+}
+
+/*
+ * Issues one READ or WRITE command for the next scatter/gather buffers of the
+ * request.  Buffers which are contiguous on the medium are merged into a
+ * single command of at most maxio bytes.  Buffers which are not contiguous in
+ * memory need a new entry in the iovec list of the CCB, so they are merged
+ * only if the SIM accepts iovec lists.  The SCSI helper uses a
+ * READ(16)/WRITE(16) command if the LBA does not fit into a 10 byte CDB.
+ */
+static void
+rtems_bsd_csio_start(struct cam_sim *sim, union ccb *ccb)
+{
+	struct ccb_scsiio *csio = &ccb->csio;
+	rtems_blkdev_sg_buffer *sg = csio->sg_current;
+	rtems_blkdev_sg_buffer *next = sg + 1;
+	struct iovec *iov = &csio->sg_iov[0];
+	uint32_t block_size = sim->block_size;
+	uint32_t length = sg->length;
+
+	iov->iov_base = sg->buffer;
+	iov->iov_len = sg->length;
+
+	while (next != csio->sg_end
+	    && next->block == sg->block + length / block_size
+	    && length + next->length <= sim->maxio) {
+		if ((char *) next->buffer
+		    == (char *) iov->iov_base + iov->iov_len) {
+			iov->iov_len += next->length;
+		} else if (iov + 1 < &csio->sg_iov[sim->iov_max]) {
+			++iov;
+			iov->iov_base = next->buffer;
+			iov->iov_len = next->length;
+		} else {
+			break;
+		}
+
+		length += next->length;
+		++next;
+	}
+
+	scsi_read_write(
+		csio,
+		BSD_SCSI_RETRIES,
+		rtems_bsd_csio_callback,
+		sim->max_openings > 1 ? BSD_SCSI_SIMPLE_Q_TAG : BSD_SCSI_TAG,
+		csio->readop,
+		0,
+		BSD_SCSI_MIN_COMMAND_SIZE,
+		sg->block,
+		length / block_size,
+		sg->buffer,
+		length,
+		SSD_FULL_SIZE,
+		BSD_SCSI_TIMEOUT
+	);
+	csio->sg_current = next;
+
+	if (iov != &csio->sg_iov[0]) {
+		csio->data_ptr = (u_int8_t *) &csio->sg_iov[0];
+		csio->sglist_cnt = (u_int16_t) (iov - &csio->sg_iov[0] + 1);
+		csio->ccb_h.flags |= CAM_DATA_SG;
+		csio->ccb_h.xflags |= CAM_SG_FORMAT_IOVEC;
+	}
+
+	TAILQ_INSERT_TAIL(&sim->pending_ccbs, &ccb->ccb_h, sim_links);
+}
+
 static void
 rtems_bsd_csio_callback(struct cam_periph *periph, union ccb *ccb)
 {
@@ -214,27 +351,12 @@ rtems_bsd_csio_callback(struct cam_periph *periph, union ccb *ccb)
 
 	BSD_ASSERT(periph == NULL && sim->state == BSD_SIM_BUSY);
 
+	TAILQ_REMOVE(&sim->active_ccbs, &ccb->ccb_h, sim_links);
+	--sim->openings;
+
 	if (ccb->ccb_h.status == CAM_REQ_CMP) {
-		rtems_blkdev_sg_buffer *sg = ccb->csio.sg_current;
-
-		if (sg != ccb->csio.sg_end) {
-			scsi_read_write(
-				&ccb->csio,
-				BSD_SCSI_RETRIES,
-				rtems_bsd_csio_callback,
-				BSD_SCSI_TAG,
-				ccb->csio.readop,
-				0,
-				BSD_SCSI_MIN_COMMAND_SIZE,
-				sg->block,
-				sg->length / 512, /* FIXME */
-				sg->buffer,
-				sg->length,
-				SSD_FULL_SIZE,
-				BSD_SCSI_TIMEOUT
-			);
-			ccb->csio.sg_current = sg + 1;
-			(*sim->sim_action)(sim, ccb);
+		if (ccb->csio.sg_current != ccb->csio.sg_end) {
+			rtems_bsd_csio_start(sim, ccb);
 		} else {
 			done = true;
 		}
@@ -248,36 +370,68 @@ rtems_bsd_csio_callback(struct cam_periph *periph, union ccb *ccb)
 
 	if (done) {
 		rtems_blkdev_request_done(ccb->csio.req, sc);
-		rtems_bsd_sim_set_state_and_notify(sim, BSD_SIM_IDLE);
+		TAILQ_INSERT_TAIL(&sim->free_ccbs, &ccb->ccb_h, sim_links);
+
+		if (TAILQ_EMPTY(&sim->active_ccbs)
+		    && TAILQ_EMPTY(&sim->pending_ccbs)) {
+			rtems_bsd_sim_set_state(sim, BSD_SIM_IDLE);
+		}
+
+		cv_broadcast(&sim->state_changed);
+	}
+
+	if (sim->state == BSD_SIM_BUSY) {
+		rtems_bsd_sim_dispatch_ccbs(sim);
 	}
 }
 
+/*
+ * Queues the request on a CCB of the SIM pool and returns without waiting for
+ * its completion.  The caller blocks only if all CCBs of the pool are in use.
+ */
 static int rtems_bsd_sim_disk_read_write(struct cam_sim *sim, rtems_blkdev_request *req)
 {
-	mtx_lock(sim->mtx);
-
-	rtems_bsd_sim_wait_for_state(sim, BSD_SIM_IDLE);
-	rtems_bsd_sim_set_state(sim, BSD_SIM_BUSY);
+	struct ccb_hdr *ccb_h;
+	union ccb *ccb;
+	int readop;
 
 	switch (req->req) {
 		case RTEMS_BLKDEV_REQ_READ:
-			sim->ccb.csio.readop = TRUE;
+			readop = TRUE;
 			break;
 		case RTEMS_BLKDEV_REQ_WRITE:
-			sim->ccb.csio.readop = FALSE;
+			readop = FALSE;
 			break;
 		default:
-			mtx_unlock(sim->mtx);
 			return -1;
 	}
 
-	sim->ccb.csio.sg_current = req->bufs;
-	sim->ccb.csio.sg_end = req->bufs + req->bufnum;
-	sim->ccb.csio.req = req;
+	mtx_lock(sim->mtx);
 
-	sim->ccb.ccb_h.status = CAM_REQ_CMP;
+	while ((sim->state != BSD_SIM_IDLE && sim->state != BSD_SIM_BUSY)
+	    || (ccb_h = TAILQ_FIRST(&sim->free_ccbs)) == NULL) {
+		cv_wait(&sim->state_changed, sim->mtx);
+	}
+
+	TAILQ_REMOVE(&sim->free_ccbs, ccb_h, sim_links);
+	ccb = (union ccb *) ccb_h;
+
+	ccb->csio.readop = readop;
+	ccb->csio.sg_current = req->bufs;
+	ccb->csio.sg_end = req->bufs + req->bufnum;
+	ccb->csio.req = req;
 
-	rtems_bsd_csio_callback(NULL, &sim->ccb);
+	rtems_bsd_sim_set_state(sim, BSD_SIM_BUSY);
+
+	if (req->bufnum > 0) {
+		rtems_bsd_csio_start(sim, ccb);
+		rtems_bsd_sim_dispatch_ccbs(sim);
+	} else {
+		TAILQ_INSERT_TAIL(&sim->active_ccbs, ccb_h, sim_links);
+		++sim->openings;
+		ccb_h->status = CAM_REQ_CMP;
+		rtems_bsd_csio_callback(NULL, ccb);
+	}
 
 	mtx_unlock(sim->mtx);
 
@@ -308,11 +462,15 @@ static int rtems_bsd_sim_disk_ioctl(rtems_disk_device *dd, uint32_t req, void *a
 }
 
 static void
-rtems_bsd_sim_disk_initialized(struct cam_sim *sim, char *disk)
+rtems_bsd_sim_disk_initialized(struct cam_sim *sim, char *disk,
+    uint32_t block_size, uint32_t maxio, int iov_max)
 {
 	mtx_lock(sim->mtx);
 
 	sim->disk = disk;
+	sim->block_size = block_size;
+	sim->maxio = maxio;
+	sim->iov_max = iov_max;
 	rtems_bsd_sim_set_state_and_notify(sim, BSD_SIM_IDLE);
 
 	mtx_unlock(sim->mtx);
@@ -331,6 +489,9 @@ rtems_bsd_sim_attach_worker(rtems_media_state state, const char *src, char **des
 		struct scsi_inquiry_data inq_data;
 		uint32_t block_count = 0;
 		uint32_t block_size = 0;
+		uint32_t maxio = 0;
+		uint32_t hba_misc = 0;
+		int iov_max = 1;
 
 		disk = rtems_media_create_path("/dev", src, cam_sim_unit(sim));
 		if (disk == NULL) {
@@ -368,6 +529,23 @@ rtems_bsd_sim_attach_worker(rtems_media_state state, const char *src, char **des
 
 		BSD_PRINTF("read capacity: block count %u, block size %u\n", block_count, block_size);
 
+		if (block_size == 0) {
+			BSD_PRINTF("OOPS: invalid block size\n");
+			goto error;
+		}
+
+		sc = rtems_bsd_scsi_path_inquiry(&sim->ccb, &maxio, &hba_misc);
+		if (sc != RTEMS_SUCCESSFUL || maxio == 0) {
+			maxio = BSD_SIM_DEFAULT_MAXIO;
+		}
+		if (sc == RTEMS_SUCCESSFUL && (hba_misc & PIM_IOVEC_SG) != 0) {
+			iov_max = CAM_RTEMS_IOV_MAX;
+		}
+		maxio -= maxio % block_size;
+		if (maxio == 0) {
+			maxio = block_size;
+		}
+
 		sc = rtems_blkdev_create(disk, block_size, block_count, rtems_bsd_sim_disk_ioctl, sim);
 		if (sc != RTEMS_SUCCESSFUL) {
 			goto error;
@@ -380,7 +558,8 @@ rtems_bsd_sim_attach_worker(rtems_media_state state, const char *src, char **des
 		rtems_disk_release(dd);
 #endif
 
-		rtems_bsd_sim_disk_initialized(sim, disk);
+		rtems_bsd_sim_disk_initialized(sim, disk, block_size, maxio,
+		    iov_max);
 
 		*dest = strdup(disk, M_RTEMS_HEAP);
 	}
@@ -391,7 +570,7 @@ error:
 
 	free(disk, M_RTEMS_HEAP);
 
-	rtems_bsd_sim_disk_initialized(sim, NULL);
+	rtems_bsd_sim_disk_initialized(sim, NULL, 0, 0, 1);
 
 	return RTEMS_IO_ERROR;
 }
@@ -411,6 +590,7 @@ cam_sim_alloc(
 {
 	rtems_status_code sc = RTEMS_SUCCESSFUL;
 	struct cam_sim *sim = NULL;
+	int i;
 
 	if (mtx == NULL) {
 		return NULL;
@@ -428,6 +608,30 @@ cam_sim_alloc(
 	sim->mtx = mtx;
 	sim->unit_number = unit;
 	sim->ccb.ccb_h.sim = sim;
+	sim->max_openings = max(max_dev_transactions,
+	    max_tagged_dev_transactions);
+	if (sim->max_openings <= 0) {
+		sim->max_openings = 1;
+	}
+
+	sim->ccb_pool = malloc(BSD_SIM_CCB_COUNT * sizeof(*sim->ccb_pool),
+	    M_CAMSIM, M_NOWAIT | M_ZERO);
+	if (sim->ccb_pool == NULL) {
+		free(sim, M_CAMSIM);
+		return NULL;
+	}
+
+	TAILQ_INIT(&sim->free_ccbs);
+	TAILQ_INIT(&sim->pending_ccbs);
+	TAILQ_INIT(&sim->active_ccbs);
+
+	for (i = 0; i < BSD_SIM_CCB_COUNT; ++i) {
+		union ccb *ccb = &sim->ccb_pool[i];
+
+		ccb->ccb_h.sim = sim;
+		ccb->csio.tag_id = (u_int) i;
+		TAILQ_INSERT_TAIL(&sim->free_ccbs, &ccb->ccb_h, sim_links);
+	}
 
 	cv_init(&sim->state_changed, "SIM state changed");
 
@@ -460,6 +664,7 @@ cam_sim_free(struct cam_sim *sim, int free_devq)
 	}
 
 	cv_destroy(&sim->state_changed);
+	free(sim->ccb_pool, M_CAMSIM);
 	free(sim, M_CAMSIM);
 }
 
@@ -0,0 +1,566 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Answer cache for the name service sources, see
+ * <machine/rtems-bsd-dns-cache.h>.
+ *
+ * The unicast DNS resolver caches the complete answer messages of
+ * res_nsend() keyed by the question.  The time to live is the minimum time to
+ * live of the answer records, or for negative answers the one of the SOA
+ * record (RFC 2308).  The mDNS source caches the address of the first answer
+ * record.  Failures of a source, for example timeouts while the network is
+ * down, are cached for net.dnscache.negative_ttl seconds, so that a
+ * reconnecting application does not stall on each attempt.
+ *
+ * A cache miss creates a pending entry.  Threads asking the same question
+ * while the entry is pending wait for the result of the first thread instead
+ * of sending their own query.  A failure which is not cached, for example
+ * an answer too large for the buffer of the first thread, is not passed to
+ * them.  They send their own query instead.
+ *
+ * The cache is protected by a sx lock, since the waiting threads sleep on the
+ * entries and the report is generated with the lock held.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/lock.h>
+#include <sys/malloc.h>
+#include <sys/queue.h>
+#include <sys/sbuf.h>
+#include <sys/sx.h>
+#include <sys/sysctl.h>
+
+#include <machine/rtems-bsd-dns-cache.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtems/bsd/bsd.h>
+
+static MALLOC_DEFINE(M_DNSCACHE, "dnscache", "DNS answer cache");
+
+#define	DNS_CACHE_HASH_SIZE	64
+
+#define	DNS_CACHE_NAME_MAX	256
+
+/* Time in seconds a thread waits for the result of a pending entry */
+#define	DNS_CACHE_WAIT_TIMEOUT	60
+
+/* The result is not yet available */
+#define	DCE_PENDING	0x1
+
+/* The entry is in the hash table and the LRU list */
+#define	DCE_LINKED	0x2
+
+/* The result is specific to the resolving thread and is not shared */
+#define	DCE_BYPASS	0x4
+
+struct rtems_bsd_dns_cache_entry {
+	LIST_ENTRY(rtems_bsd_dns_cache_entry) dce_hash;
+	TAILQ_ENTRY(rtems_bsd_dns_cache_entry) dce_lru;
+	uint32_t	dce_hashval;
+	int		dce_source;
+	int		dce_class;
+	int		dce_type;
+	u_int		dce_flags;
+	u_int		dce_refs;
+	int		dce_error;
+	time_t		dce_expire;
+	size_t		dce_len;
+	void		*dce_data;
+	char		dce_name[];
+};
+
+LIST_HEAD(dns_cache_bucket, rtems_bsd_dns_cache_entry);
+
+static struct {
+	struct sx	lock;
+	struct dns_cache_bucket hash[DNS_CACHE_HASH_SIZE];
+	TAILQ_HEAD(, rtems_bsd_dns_cache_entry) lru;
+	u_int		entries;
+	u_long		lookups;
+	u_long		hits;
+	u_long		negative_hits;
+	u_long		misses;
+	u_long		coalesced;
+	u_long		bypassed;
+	u_long		evictions;
+} dns_cache = {
+	.lru = TAILQ_HEAD_INITIALIZER(dns_cache.lru)
+};
+
+SX_SYSINIT(dns_cache, &dns_cache.lock, "dnscache");
+
+static int dns_cache_enable = 1;
+static u_int dns_cache_max_entries = 128;
+static u_int dns_cache_max_ttl = 3600;
+static u_int dns_cache_negative_ttl = 5;
+
+static SYSCTL_NODE(_net, OID_AUTO, dnscache, CTLFLAG_RW, 0,
+    "Answer cache of the DNS and mDNS name service sources");
+
+SYSCTL_INT(_net_dnscache, OID_AUTO, enable, CTLFLAG_RW,
+    &dns_cache_enable, 0, "Enable the answer cache");
+SYSCTL_UINT(_net_dnscache, OID_AUTO, max_entries, CTLFLAG_RW,
+    &dns_cache_max_entries, 0, "Maximum count of cached answers");
+SYSCTL_UINT(_net_dnscache, OID_AUTO, max_ttl, CTLFLAG_RW,
+    &dns_cache_max_ttl, 0, "Maximum time to live of an answer in seconds");
+SYSCTL_UINT(_net_dnscache, OID_AUTO, negative_ttl, CTLFLAG_RW,
+    &dns_cache_negative_ttl, 0, "Time to live of a failure in seconds");
+SYSCTL_UINT(_net_dnscache, OID_AUTO, entries, CTLFLAG_RD,
+    &dns_cache.entries, 0, "Count of cached answers");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, lookups, CTLFLAG_RD,
+    &dns_cache.lookups, 0, "Count of lookups");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, hits, CTLFLAG_RD,
+    &dns_cache.hits, 0, "Count of lookups answered by the cache");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, negative_hits, CTLFLAG_RD,
+    &dns_cache.negative_hits, 0, "Count of lookups answered by a failure");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, misses, CTLFLAG_RD,
+    &dns_cache.misses, 0, "Count of lookups sent to the source");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, coalesced, CTLFLAG_RD,
+    &dns_cache.coalesced, 0,
+    "Count of lookups which waited for a concurrent lookup");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, bypassed, CTLFLAG_RD,
+    &dns_cache.bypassed, 0, "Count of lookups which bypassed the cache");
+SYSCTL_ULONG(_net_dnscache, OID_AUTO, evictions, CTLFLAG_RD,
+    &dns_cache.evictions, 0, "Count of answers evicted before expiry");
+
+static uint32_t
+dns_cache_hash(int source, const char *name, int qclass, int qtype)
+{
+	uint32_t h;
+
+	h = 2166136261U;
+	while (*name != '\0') {
+		h ^= (uint8_t)tolower((unsigned char)*name);
+		h *= 16777619U;
+		++name;
+	}
+
+	h ^= (uint32_t)source;
+	h *= 16777619U;
+	h ^= (uint32_t)qclass << 16 | (uint32_t)qtype;
+	h *= 16777619U;
+	return (h);
+}
+
+static void
+dns_cache_free(struct rtems_bsd_dns_cache_entry *dce)
+{
+
+	free(dce->dce_data, M_DNSCACHE);
+	free(dce, M_DNSCACHE);
+}
+
+static void
+dns_cache_release(struct rtems_bsd_dns_cache_entry *dce)
+{
+
+	sx_assert(&dns_cache.lock, SA_XLOCKED);
+	KASSERT(dce->dce_refs > 0, ("dns_cache_release: no reference"));
+
+	--dce->dce_refs;
+	if (dce->dce_refs == 0 && (dce->dce_flags & DCE_LINKED) == 0) {
+		dns_cache_free(dce);
+	}
+}
+
+/*
+ * Removes the entry from the cache.  It is freed once the last waiting
+ * thread has its result.
+ */
+static void
+dns_cache_unlink(struct rtems_bsd_dns_cache_entry *dce)
+{
+
+	sx_assert(&dns_cache.lock, SA_XLOCKED);
+	KASSERT((dce->dce_flags & DCE_LINKED) != 0,
+	    ("dns_cache_unlink: not linked"));
+
+	LIST_REMOVE(dce, dce_hash);
+	TAILQ_REMOVE(&dns_cache.lru, dce, dce_lru);
+	dce->dce_flags &= ~DCE_LINKED;
+	--dns_cache.entries;
+
+	if (dce->dce_refs == 0) {
+		dns_cache_free(dce);
+	}
+}
+
+static bool
+dns_cache_expired(const struct rtems_bsd_dns_cache_entry *dce)
+{
+
+	return ((dce->dce_flags & DCE_PENDING) == 0 &&
+	    dce->dce_expire <= time_uptime);
+}
+
+static struct rtems_bsd_dns_cache_entry *
+dns_cache_find(uint32_t h, int source, const char *name, int qclass,
+    int qtype)
+{
+	struct rtems_bsd_dns_cache_entry *dce, *tmp;
+
+	LIST_FOREACH_SAFE(dce, &dns_cache.hash[h % DNS_CACHE_HASH_SIZE],
+	    dce_hash, tmp) {
+		if (dce->dce_hashval != h || dce->dce_source != source ||
+		    dce->dce_class != qclass || dce->dce_type != qtype ||
+		    strcasecmp(dce->dce_name, name) != 0) {
+			continue;
+		}
+
+		if (dns_cache_expired(dce)) {
+			dns_cache_unlink(dce);
+			return (NULL);
+		}
+
+		return (dce);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Evicts expired entries and the least recently used entries which exceed
+ * the maximum entry count.  Pending entries are kept.
+ */
+static void
+dns_cache_trim(void)
+{
+	struct rtems_bsd_dns_cache_entry *dce, *tmp;
+
+	sx_assert(&dns_cache.lock, SA_XLOCKED);
+
+	TAILQ_FOREACH_SAFE(dce, &dns_cache.lru, dce_lru, tmp) {
+		if ((dce->dce_flags & DCE_PENDING) != 0) {
+			continue;
+		}
+
+		if (dns_cache_expired(dce)) {
+			dns_cache_unlink(dce);
+		} else if (dns_cache.entries > dns_cache_max_entries) {
+			++dns_cache.evictions;
+			dns_cache_unlink(dce);
+		}
+	}
+}
+
+static int
+dns_cache_copy(const struct rtems_bsd_dns_cache_entry *dce, void *answer,
+    size_t *len, int *error)
+{
+
+	if ((dce->dce_flags & (DCE_PENDING | DCE_BYPASS)) != 0) {
+		return (RTEMS_BSD_DNS_CACHE_BYPASS);
+	}
+
+	if (dce->dce_error != 0) {
+		*error = dce->dce_error;
+		return (RTEMS_BSD_DNS_CACHE_HIT);
+	}
+
+	if (dce->dce_len > *len) {
+		return (RTEMS_BSD_DNS_CACHE_BYPASS);
+	}
+
+	memcpy(answer, dce->dce_data, dce->dce_len);
+	*len = dce->dce_len;
+	*error = 0;
+	return (RTEMS_BSD_DNS_CACHE_HIT);
+}
+
+int
+rtems_bsd_dns_cache_lookup(int source, const char *name, int qclass,
+    int qtype, void *answer, size_t *len, int *error,
+    struct rtems_bsd_dns_cache_entry **entry)
+{
+	struct rtems_bsd_dns_cache_entry *dce;
+	size_t namelen;
+	uint32_t h;
+	int rv;
+
+	*entry = NULL;
+	namelen = strlen(name);
+	h = dns_cache_hash(source, name, qclass, qtype);
+
+	sx_xlock(&dns_cache.lock);
+	++dns_cache.lookups;
+
+	if (!dns_cache_enable || namelen >= DNS_CACHE_NAME_MAX) {
+		++dns_cache.bypassed;
+		sx_xunlock(&dns_cache.lock);
+		return (RTEMS_BSD_DNS_CACHE_BYPASS);
+	}
+
+	dce = dns_cache_find(h, source, name, qclass, qtype);
+	if (dce == NULL) {
+		dce = malloc(sizeof(*dce) + namelen + 1, M_DNSCACHE,
+		    M_WAITOK | M_ZERO);
+		dce->dce_hashval = h;
+		dce->dce_source = source;
+		dce->dce_class = qclass;
+		dce->dce_type = qtype;
+		dce->dce_flags = DCE_PENDING | DCE_LINKED;
+		dce->dce_refs = 1;
+		memcpy(dce->dce_name, name, namelen + 1);
+		LIST_INSERT_HEAD(&dns_cache.hash[h % DNS_CACHE_HASH_SIZE], dce,
+		    dce_hash);
+		TAILQ_INSERT_TAIL(&dns_cache.lru, dce, dce_lru);
+		++dns_cache.entries;
+		++dns_cache.misses;
+		sx_xunlock(&dns_cache.lock);
+		*entry = dce;
+		return (RTEMS_BSD_DNS_CACHE_MISS);
+	}
+
+	if ((dce->dce_flags & DCE_PENDING) != 0) {
+		++dns_cache.coalesced;
+		++dce->dce_refs;
+
+		while ((dce->dce_flags & DCE_PENDING) != 0) {
+			if (sx_sleep(dce, &dns_cache.lock, 0, "dnscache",
+			    DNS_CACHE_WAIT_TIMEOUT * hz) == EWOULDBLOCK) {
+				break;
+			}
+		}
+
+		rv = dns_cache_copy(dce, answer, len, error);
+		dns_cache_release(dce);
+	} else {
+		rv = dns_cache_copy(dce, answer, len, error);
+		TAILQ_REMOVE(&dns_cache.lru, dce, dce_lru);
+		TAILQ_INSERT_TAIL(&dns_cache.lru, dce, dce_lru);
+	}
+
+	if (rv == RTEMS_BSD_DNS_CACHE_HIT) {
+		++dns_cache.hits;
+		if (*error != 0) {
+			++dns_cache.negative_hits;
+		}
+	} else {
+		++dns_cache.bypassed;
+	}
+
+	sx_xunlock(&dns_cache.lock);
+	return (rv);
+}
+
+void
+rtems_bsd_dns_cache_enter(struct rtems_bsd_dns_cache_entry *dce,
+    const void *answer, size_t len, uint32_t ttl, int error)
+{
+	void *data;
+
+	data = NULL;
+	if (error == 0 && len > 0) {
+		data = malloc(len, M_DNSCACHE, M_WAITOK);
+		memcpy(data, answer, len);
+	}
+
+	sx_xlock(&dns_cache.lock);
+	KASSERT((dce->dce_flags & DCE_PENDING) != 0,
+	    ("rtems_bsd_dns_cache_enter: not pending"));
+
+	if (error != 0 && ttl > dns_cache_negative_ttl) {
+		ttl = dns_cache_negative_ttl;
+	}
+
+	if (ttl > dns_cache_max_ttl) {
+		ttl = dns_cache_max_ttl;
+	}
+
+	dce->dce_data = data;
+	dce->dce_len = error == 0 ? len : 0;
+	dce->dce_error = error;
+	dce->dce_expire = time_uptime + ttl;
+	dce->dce_flags &= ~DCE_PENDING;
+	if (error != 0 && ttl == 0) {
+		dce->dce_flags |= DCE_BYPASS;
+	}
+	wakeup(dce);
+
+	if ((dce->dce_flags & DCE_LINKED) != 0 &&
+	    (ttl == 0 || !dns_cache_enable)) {
+		dns_cache_unlink(dce);
+	}
+
+	dns_cache_release(dce);
+	dns_cache_trim();
+	sx_xunlock(&dns_cache.lock);
+}
+
+static const char *
+dns_cache_source_name(int source)
+{
+
+	switch (source) {
+	case RTEMS_BSD_DNS_CACHE_DNS:
+		return ("dns");
+	case RTEMS_BSD_DNS_CACHE_MDNS:
+		return ("mdns");
+	default:
+		return ("?");
+	}
+}
+
+static void
+dns_cache_report(struct sbuf *sb)
+{
+	struct rtems_bsd_dns_cache_entry *dce;
+
+	sx_xlock(&dns_cache.lock);
+
+	sbuf_printf(sb,
+	    "entries %u, lookups %lu, hits %lu (negative %lu), misses %lu, "
+	    "coalesced %lu, bypassed %lu, evictions %lu\n",
+	    dns_cache.entries, dns_cache.lookups, dns_cache.hits,
+	    dns_cache.negative_hits, dns_cache.misses, dns_cache.coalesced,
+	    dns_cache.bypassed, dns_cache.evictions);
+
+	if (!TAILQ_EMPTY(&dns_cache.lru)) {
+		sbuf_printf(sb, "%-6s %5s %5s %6s %7s %s\n", "SOURCE",
+		    "CLASS", "TYPE", "TTL", "ANSWER", "NAME");
+	}
+
+	TAILQ_FOREACH(dce, &dns_cache.lru, dce_lru) {
+		sbuf_printf(sb, "%-6s %5d %5d ",
+		    dns_cache_source_name(dce->dce_source), dce->dce_class,
+		    dce->dce_type);
+
+		if ((dce->dce_flags & DCE_PENDING) != 0) {
+			sbuf_printf(sb, "%6s %7s ", "-", "pending");
+		} else {
+			time_t ttl;
+
+			ttl = dce->dce_expire > time_uptime ?
+			    dce->dce_expire - time_uptime : 0;
+
+			if (dce->dce_error != 0) {
+				sbuf_printf(sb, "%6jd %7s ", (intmax_t)ttl,
+				    "error");
+			} else {
+				sbuf_printf(sb, "%6jd %7zu ", (intmax_t)ttl,
+				    dce->dce_len);
+			}
+		}
+
+		sbuf_printf(sb, "%s\n", dce->dce_name);
+	}
+
+	sx_xunlock(&dns_cache.lock);
+}
+
+void
+rtems_bsd_dns_cache_report(FILE *file)
+{
+	struct sbuf *sb;
+
+	sb = sbuf_new_auto();
+	if (sb == NULL) {
+		return;
+	}
+
+	dns_cache_report(sb);
+
+	if (sbuf_finish(sb) == 0) {
+		fputs(sbuf_data(sb), file);
+	}
+
+	sbuf_delete(sb);
+}
+
+void
+rtems_bsd_dns_cache_flush(void)
+{
+	struct rtems_bsd_dns_cache_entry *dce, *tmp;
+
+	sx_xlock(&dns_cache.lock);
+
+	TAILQ_FOREACH_SAFE(dce, &dns_cache.lru, dce_lru, tmp) {
+		if ((dce->dce_flags & DCE_PENDING) == 0) {
+			dns_cache_unlink(dce);
+		}
+	}
+
+	sx_xunlock(&dns_cache.lock);
+}
+
+static int
+dns_cache_list_sysctl(SYSCTL_HANDLER_ARGS)
+{
+	struct sbuf sb;
+	int error;
+
+	error = sysctl_wire_old_buffer(req, 0);
+	if (error != 0) {
+		return (error);
+	}
+
+	sbuf_new_for_sysctl(&sb, NULL, 256, req);
+	dns_cache_report(&sb);
+	error = sbuf_finish(&sb);
+	sbuf_delete(&sb);
+	return (error);
+}
+
+SYSCTL_PROC(_net_dnscache, OID_AUTO, list,
+    CTLTYPE_STRING | CTLFLAG_RD | CTLFLAG_MPSAFE, NULL, 0,
+    dns_cache_list_sysctl, "A", "Statistics and cached answers");
+
+static int
+dns_cache_flush_sysctl(SYSCTL_HANDLER_ARGS)
+{
+	int error;
+	int flush;
+
+	flush = 0;
+	error = sysctl_handle_int(oidp, &flush, 0, req);
+	if (error != 0 || req->newptr == NULL) {
+		return (error);
+	}
+
+	if (flush != 0) {
+		rtems_bsd_dns_cache_flush();
+	}
+
+	return (0);
+}
+
+SYSCTL_PROC(_net_dnscache, OID_AUTO, flush,
+    CTLTYPE_INT | CTLFLAG_RW | CTLFLAG_MPSAFE, NULL, 0,
+    dns_cache_flush_sysctl, "I", "Write a non-zero value to flush the cache");
@@ -31,8 +31,13 @@
 #include <machine/rtems-bsd-kernel-space.h>
 
 #include <sys/types.h>
+#include <sys/param.h>
 #include <sys/kernel.h>
 #include <sys/epoch.h>
+#include <sys/sysctl.h>
+#include <sys/malloc.h>
+
+#include <machine/atomic.h>
 
 #include <machine/cpu.h>
 
@@ -48,6 +53,13 @@ EPOCH_DEFINE(_bsd_global_epoch, 0);
 
 struct epoch_pcpu {
 	int cb_count;
+	bool wdg_armed;
+	rtems_interval cb_first_tick;
+	uint64_t cb_calls;
+	uint64_t cb_reclaimed;
+	uint64_t cb_batches;
+	uint64_t cb_latency_ticks;
+	uint64_t cb_max_latency_ticks;
 	Watchdog_Control wdg;
 	rtems_interrupt_server_request irq_srv_req;
 };
@@ -56,9 +68,91 @@ static PER_CPU_DATA_ITEM(struct epoch_pcpu, epoch);
 
 static SLIST_HEAD(, epoch) epoch_list = SLIST_HEAD_INITIALIZER(epoch_list);
 
+static rtems_mutex epoch_drain_mtx = RTEMS_MUTEX_INITIALIZER("epoch drain");
+
 CK_STACK_CONTAINER(struct ck_epoch_entry, stack_entry,
     ck_epoch_entry_container)
 
+static void epoch_drain_cb(epoch_context_t ctx);
+
+static SYSCTL_NODE(_kern, OID_AUTO, epoch, CTLFLAG_RW, 0, "epoch information");
+
+static int epoch_cb_batch = 64;
+SYSCTL_INT(_kern_epoch, OID_AUTO, cb_batch, CTLFLAG_RWTUN, &epoch_cb_batch, 0,
+    "Count of pending callbacks which triggers an immediate reclamation");
+
+static int epoch_cb_delay = 1;
+SYSCTL_INT(_kern_epoch, OID_AUTO, cb_delay, CTLFLAG_RWTUN, &epoch_cb_delay, 0,
+    "Maximum age in clock ticks of pending callbacks");
+
+/*
+ * Returns the sum or the maximum of the per-processor statistics at the offset
+ * of struct epoch_pcpu.
+ */
+static uint64_t
+epoch_stat_collect(intmax_t offset, bool max)
+{
+	uint32_t cpu_count;
+	uint32_t cpu_index;
+	uint64_t val;
+
+	cpu_count = rtems_get_processor_count();
+	val = 0;
+
+	for (cpu_index = 0; cpu_index < cpu_count; ++cpu_index) {
+		struct epoch_pcpu *epcpu;
+		uint64_t cpu_val;
+
+		epcpu = PER_CPU_DATA_GET(_Per_CPU_Get_by_index(cpu_index),
+		    struct epoch_pcpu, epoch);
+		cpu_val = *(uint64_t *)((char *)epcpu + offset);
+
+		if (max) {
+			val = MAX(val, cpu_val);
+		} else {
+			val += cpu_val;
+		}
+	}
+
+	return (val);
+}
+
+/* Sums up the per-processor statistics at offset arg2 */
+static int
+epoch_sysctl_sum(SYSCTL_HANDLER_ARGS)
+{
+	uint64_t val;
+
+	val = epoch_stat_collect(arg2, false);
+	return (sysctl_handle_64(oidp, &val, 0, req));
+}
+
+/* Yields the maximum of the per-processor statistics at offset arg2 */
+static int
+epoch_sysctl_max(SYSCTL_HANDLER_ARGS)
+{
+	uint64_t val;
+
+	val = epoch_stat_collect(arg2, true);
+	return (sysctl_handle_64(oidp, &val, 0, req));
+}
+
+SYSCTL_PROC(_kern_epoch, OID_AUTO, calls, CTLTYPE_U64 | CTLFLAG_RD, NULL,
+    offsetof(struct epoch_pcpu, cb_calls), epoch_sysctl_sum, "QU",
+    "Count of deferred callbacks");
+SYSCTL_PROC(_kern_epoch, OID_AUTO, reclaimed, CTLTYPE_U64 | CTLFLAG_RD, NULL,
+    offsetof(struct epoch_pcpu, cb_reclaimed), epoch_sysctl_sum, "QU",
+    "Count of invoked callbacks");
+SYSCTL_PROC(_kern_epoch, OID_AUTO, batches, CTLTYPE_U64 | CTLFLAG_RD, NULL,
+    offsetof(struct epoch_pcpu, cb_batches), epoch_sysctl_sum, "QU",
+    "Count of callback batches");
+SYSCTL_PROC(_kern_epoch, OID_AUTO, latency_ticks, CTLTYPE_U64 | CTLFLAG_RD,
+    NULL, offsetof(struct epoch_pcpu, cb_latency_ticks), epoch_sysctl_sum,
+    "QU", "Sum of batch latencies in clock ticks");
+SYSCTL_PROC(_kern_epoch, OID_AUTO, max_latency_ticks, CTLTYPE_U64 |
+    CTLFLAG_RD, NULL, offsetof(struct epoch_pcpu, cb_max_latency_ticks),
+    epoch_sysctl_max, "QU", "Maximum batch latency in clock ticks");
+
 void
 _bsd_epoch_init(epoch_t epoch, uintptr_t pcpu_record_offset, int flags)
 {
@@ -87,20 +181,31 @@ _bsd_epoch_init(epoch_t epoch, uintptr_t pcpu_record_offset, int flags)
 	SLIST_INSERT_HEAD(&epoch_list, epoch, e_link);
 }
 
+/*
+ * The watchdog is armed only while callbacks are pending on the processor.
+ * It must be called with interrupts disabled on the owner processor of the
+ * watchdog.
+ */
+static void
+epoch_arm_watchdog(struct epoch_pcpu *epcpu)
+{
+
+	if (!epcpu->wdg_armed) {
+		epcpu->wdg_armed = true;
+		_Watchdog_Per_CPU_insert_ticks(&epcpu->wdg,
+		    _Watchdog_Get_CPU(&epcpu->wdg), MAX(epoch_cb_delay, 1));
+	}
+}
+
 static void
 epoch_watchdog(Watchdog_Control *wdg)
 {
 	struct epoch_pcpu *epcpu;
-	ISR_Level level;
 
 	epcpu = __containerof(wdg, struct epoch_pcpu, wdg);
+	epcpu->wdg_armed = false;
 
-	_ISR_Local_disable(level);
-	_Watchdog_Per_CPU_insert_ticks(&epcpu->wdg,
-	    _Watchdog_Get_CPU(&epcpu->wdg), 1);
-	_ISR_Local_enable(level);
-
-	if (RTEMS_PREDICT_FALSE(epcpu->cb_count != 0)) {
+	if (RTEMS_PREDICT_TRUE(epcpu->cb_count != 0)) {
 		rtems_interrupt_server_request_submit(&epcpu->irq_srv_req);
 	}
 }
@@ -110,14 +215,18 @@ epoch_call_handler(void *arg)
 {
 	struct epoch_pcpu *epcpu;
 	struct epoch *epoch;
-	ck_stack_entry_t *cursor, *head, *next;
+	ck_stack_entry_t *cursor, *head, *next, *drain;
 	ck_stack_t cb_stack;
+	Per_CPU_Control *cpu_self;
+	ISR_Level level;
+	rtems_interval latency;
+	int reclaimed;
 
 	epcpu = arg;
 	ck_stack_init(&cb_stack);
+	reclaimed = 0;
 
 	SLIST_FOREACH(epoch, &epoch_list, e_link) {
-		Per_CPU_Control *cpu_self;
 		struct epoch_record *er;
 		int npending;
 
@@ -127,18 +236,64 @@ epoch_call_handler(void *arg)
 
 		if (npending != 0) {
 			ck_epoch_poll_deferred(&er->er_record, &cb_stack);
-			epcpu->cb_count -= npending - er->er_record.n_pending;
+			reclaimed += npending - er->er_record.n_pending;
 		}
 
 		_Thread_Dispatch_enable(cpu_self);
 	}
 
+	cpu_self = _Thread_Dispatch_disable();
+	latency = rtems_clock_get_ticks_since_boot() - epcpu->cb_first_tick;
+	epcpu->cb_count -= reclaimed;
+	epcpu->cb_reclaimed += reclaimed;
+	++epcpu->cb_batches;
+
+	if (reclaimed != 0) {
+		epcpu->cb_latency_ticks += latency;
+		epcpu->cb_max_latency_ticks = MAX(epcpu->cb_max_latency_ticks,
+		    (uint64_t)latency);
+	}
+
+	if (epcpu->cb_count != 0) {
+		/*
+		 * The grace period of the remaining callbacks did not expire
+		 * yet.  Try again later.
+		 */
+		if (reclaimed != 0) {
+			epcpu->cb_first_tick = rtems_clock_get_ticks_since_boot();
+		}
+
+		_ISR_Local_disable(level);
+		epoch_arm_watchdog(epcpu);
+		_ISR_Local_enable(level);
+	}
+
+	_Thread_Dispatch_enable(cpu_self);
+
+	drain = NULL;
 	head = ck_stack_batch_pop_npsc(&cb_stack);
 	for (cursor = head; cursor != NULL; cursor = next) {
 		struct ck_epoch_entry *entry;
 
 		entry = ck_epoch_entry_container(cursor);
 
+		next = CK_STACK_NEXT(cursor);
+
+		if (entry->function == epoch_drain_cb) {
+			/* Complete the drain after the whole batch */
+			cursor->next = drain;
+			drain = cursor;
+			continue;
+		}
+
+		(*entry->function)(entry);
+	}
+
+	for (cursor = drain; cursor != NULL; cursor = next) {
+		struct ck_epoch_entry *entry;
+
+		entry = ck_epoch_entry_container(cursor);
+
 		next = CK_STACK_NEXT(cursor);
 		(*entry->function)(entry);
 	}
@@ -155,16 +310,12 @@ epoch_sysinit(void)
 	for (cpu_index = 0; cpu_index < cpu_count; ++cpu_index) {
 		Per_CPU_Control *cpu;
 		struct epoch_pcpu *epcpu;
-		ISR_Level level;
 
 		cpu = _Per_CPU_Get_by_index(cpu_index);
 		epcpu = PER_CPU_DATA_GET(cpu, struct epoch_pcpu, epoch);
 
 		_Watchdog_Preinitialize(&epcpu->wdg, cpu);
 		_Watchdog_Initialize(&epcpu->wdg, epoch_watchdog);
-		_ISR_Local_disable(level);
-		_Watchdog_Per_CPU_insert_ticks(&epcpu->wdg, cpu, 1);
-		_ISR_Local_enable(level);
 
 		rtems_interrupt_server_request_initialize(cpu_index,
 		    &epcpu->irq_srv_req, epoch_call_handler, epcpu);
@@ -314,11 +465,158 @@ epoch_call(epoch_t epoch, epoch_context_t ctx,
 	Per_CPU_Control *cpu_self;
 	struct epoch_record *er;
 	struct epoch_pcpu *epcpu;
+	ISR_Level level;
 
 	cpu_self = _Thread_Dispatch_disable();
 	epcpu = PER_CPU_DATA_GET(cpu_self, struct epoch_pcpu, epoch);
-	epcpu->cb_count += 1;
 	er = EPOCH_GET_RECORD(cpu_self, epoch);
 	ck_epoch_call(&er->er_record, ctx, callback);
+	++epcpu->cb_calls;
+
+	if (epcpu->cb_count == 0) {
+		epcpu->cb_first_tick = rtems_clock_get_ticks_since_boot();
+	}
+
+	epcpu->cb_count += 1;
+
+	if (RTEMS_PREDICT_FALSE(epcpu->cb_count == epoch_cb_batch)) {
+		rtems_interrupt_server_request_submit(&epcpu->irq_srv_req);
+	} else {
+		_ISR_Local_disable(level);
+		epoch_arm_watchdog(epcpu);
+		_ISR_Local_enable(level);
+	}
+
+	_Thread_Dispatch_enable(cpu_self);
+}
+
+struct epoch_drain {
+	epoch_t ed_epoch;
+	rtems_binary_semaphore ed_done;
+	volatile u_int ed_count;
+};
+
+struct epoch_drain_pcpu {
+	struct epoch_drain *edp_drain;
+	struct epoch_context edp_ctx;
+	rtems_interrupt_server_request edp_req;
+};
+
+/*
+ * Invoked by epoch_call_handler() after all other callbacks of the batch.
+ */
+static void
+epoch_drain_cb(epoch_context_t ctx)
+{
+	struct epoch_drain_pcpu *edp;
+	struct epoch_drain *ed;
+
+	edp = __containerof(ctx, struct epoch_drain_pcpu, edp_ctx);
+	ed = edp->edp_drain;
+
+	if (atomic_fetchadd_int(&ed->ed_count, -1) == 1) {
+		rtems_binary_semaphore_post(&ed->ed_done);
+	}
+}
+
+static void
+epoch_drain_enqueue(void *arg)
+{
+	struct epoch_drain_pcpu *edp;
+	Per_CPU_Control *cpu_self;
+	struct epoch_pcpu *epcpu;
+	struct epoch_record *er;
+	ck_epoch_record_t *record;
+	ck_stack_entry_t *cursor, *head, *next;
+	unsigned int offset;
+	unsigned int i;
+
+	edp = arg;
+	cpu_self = _Thread_Dispatch_disable();
+	epcpu = PER_CPU_DATA_GET(cpu_self, struct epoch_pcpu, epoch);
+	er = EPOCH_GET_RECORD(cpu_self, edp->edp_drain->ed_epoch);
+	record = &er->er_record;
+
+	/*
+	 * The buckets of the record are dispatched in index order and not in
+	 * the order of their epochs.  Move the pending callbacks into the
+	 * bucket of the current epoch, which only delays them.  A bucket is
+	 * invoked in the order its callbacks were added, so the drain callback
+	 * added last is invoked after all of them.
+	 */
+	offset = ck_pr_load_uint(&record->global->epoch) &
+	    (CK_EPOCH_LENGTH - 1);
+
+	for (i = 0; i < CK_EPOCH_LENGTH; ++i) {
+		if (i == offset) {
+			continue;
+		}
+
+		head = ck_stack_batch_pop_upmc(&record->pending[i]);
+		for (cursor = head; cursor != NULL; cursor = next) {
+			next = CK_STACK_NEXT(cursor);
+			ck_stack_push_spnc(&record->pending[offset], cursor);
+		}
+	}
+
+	++record->n_pending;
+	edp->edp_ctx.function = epoch_drain_cb;
+	ck_stack_push_spnc(&record->pending[offset],
+	    &edp->edp_ctx.stack_entry);
+	++epcpu->cb_calls;
+
+	if (epcpu->cb_count == 0) {
+		epcpu->cb_first_tick = rtems_clock_get_ticks_since_boot();
+	}
+
+	epcpu->cb_count += 1;
+
+	/* Do not wait for the age threshold */
+	rtems_interrupt_server_request_submit(&epcpu->irq_srv_req);
 	_Thread_Dispatch_enable(cpu_self);
 }
+
+/*
+ * Waits until all callbacks registered with epoch_call() for this epoch
+ * before the call of this function were invoked.  A drain callback is
+ * enqueued on each processor by the interrupt server of the processor behind
+ * the callbacks pending there.
+ */
+void
+epoch_drain_callbacks(epoch_t epoch)
+{
+	struct epoch_drain ed;
+	struct epoch_drain_pcpu *edp;
+	uint32_t cpu_count;
+	uint32_t cpu_index;
+
+	cpu_count = rtems_get_processor_count();
+	edp = malloc(cpu_count * sizeof(*edp), M_TEMP, M_WAITOK | M_ZERO);
+
+	rtems_mutex_lock(&epoch_drain_mtx);
+
+	ed.ed_epoch = epoch;
+	ed.ed_count = cpu_count;
+	rtems_binary_semaphore_init(&ed.ed_done, "epoch drain");
+
+	for (cpu_index = 0; cpu_index < cpu_count; ++cpu_index) {
+		edp[cpu_index].edp_drain = &ed;
+		rtems_interrupt_server_request_initialize(cpu_index,
+		    &edp[cpu_index].edp_req, epoch_drain_enqueue,
+		    &edp[cpu_index]);
+		rtems_interrupt_server_request_submit(&edp[cpu_index].edp_req);
+	}
+
+	rtems_binary_semaphore_wait(&ed.ed_done);
+
+	for (cpu_index = 0; cpu_index < cpu_count; ++cpu_index) {
+		rtems_interrupt_server_request_destroy(
+		    &edp[cpu_index].edp_req);
+	}
+
+	rtems_binary_semaphore_destroy(&ed.ed_done);
+
+	rtems_mutex_unlock(&epoch_drain_mtx);
+
+	free(edp, M_TEMP);
+}
@@ -66,3 +66,9 @@ rtems_bsd_m_free(struct mbuf *m)
 {
 	m_free(m);
 }
+
+void
+rtems_bsd_m_freem(struct mbuf *m)
+{
+	m_freem(m);
+}
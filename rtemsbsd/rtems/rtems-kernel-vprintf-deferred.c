@@ -0,0 +1,1023 @@
+/**
+ * @file
+ *
+ * @ingroup rtems_bsd_rtems
+ *
+ * @brief Deferred output back-end for logging functions.
+ */
+
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The deferred handler does not format messages in the context of the
+ * caller.  It copies the format string and the raw arguments into a ring
+ * buffer owned by the current processor and returns.  A low priority task
+ * merges the ring buffers in the order of a global sequence number, formats
+ * the messages and passes them to the previous handler.
+ *
+ * Each ring buffer has exactly one producer at a time, since the producers
+ * disable interrupts on the owning processor while they reserve and fill a
+ * record.  The consumer side (the output task and the klog shell command) is
+ * serialized by a mutex.  Producers never wait.  A message which does not fit
+ * into the ring buffer is dropped and counted.
+ *
+ * Messages with a priority of LOG_CRIT or higher are output immediately, since
+ * the system may not live long enough for the output task to run.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/lock.h>
+#include <sys/malloc.h>
+#include <sys/syslog.h>
+
+#include <machine/atomic.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+static MALLOC_DEFINE(M_KLOG, "klog", "deferred log ring buffers");
+
+#define	KLOG_RECORD_MAX		512
+#define	KLOG_STRING_MAX		200
+#define	KLOG_HEXDUMP_MAX	32
+#define	KLOG_LINE_MAX		512
+#define	KLOG_ALIGN		8
+#define	KLOG_TASK_STACK_SIZE	(16 * 1024)
+
+/* Record level of the padding at the end of a ring buffer */
+#define	KLOG_PAD		INT16_MIN
+
+/* The record contains already formatted text instead of arguments */
+#define	KLOG_TEXT		0x1
+
+/* Marks a NULL string argument */
+#define	KLOG_NULL		UINT8_MAX
+
+#define	KLOG_LOCK() _Mutex_Acquire(&klog.consumer_mtx)
+#define	KLOG_UNLOCK() _Mutex_Release(&klog.consumer_mtx)
+
+struct klog_record {
+	uint16_t	size;
+	int16_t		level;
+	uint16_t	flags;
+	uint16_t	fmt_len;
+	uint32_t	seq;
+	int32_t		error;
+	/* Format string including the NUL and serialized arguments follow */
+};
+
+struct klog_ring {
+	uint8_t		*buf;
+	u_int		mask;
+	volatile u_int	head;
+	volatile u_int	tail;
+	/* Only changed on the owning processor with interrupts disabled */
+	u_int		lost;
+};
+
+static struct {
+	struct klog_ring	*rings;
+	uint32_t		ring_count;
+	volatile u_int		seq;
+	volatile u_int		waiting;
+	rtems_id		task;
+	rtems_bsd_vprintf_handler output;
+	/* Use a <sys/lock.h> mutex due to the static initialization capability */
+	struct _Mutex_Control	consumer_mtx;
+	u_int			reported_lost;
+} klog = {
+	.consumer_mtx = _MUTEX_INITIALIZER
+};
+
+enum klog_kind {
+	KLOG_LITERAL,
+	KLOG_INT,
+	KLOG_LONG,
+	KLOG_QUAD,
+	KLOG_INTMAX,
+	KLOG_SIZE,
+	KLOG_PTRDIFF,
+	KLOG_PTR,
+	KLOG_STRING,
+	KLOG_ERRNO,
+	KLOG_HEXDUMP,
+	KLOG_COUNT,
+	KLOG_STOP
+};
+
+struct klog_spec {
+	const char	*begin;
+	const char	*end;
+	enum klog_kind	kind;
+	int		stars;
+	bool		star_is_width[2];
+	int		width;
+	bool		bits;
+};
+
+struct klog_writer {
+	uint8_t		*p;
+	uint8_t		*end;
+	bool		overflow;
+};
+
+struct klog_reader {
+	const uint8_t	*p;
+};
+
+struct klog_line {
+	char		*buf;
+	size_t		len;
+	size_t		max;
+};
+
+static enum klog_kind
+klog_int_kind(int lflag, int qflag, int jflag, int tflag, int zflag)
+{
+
+	if (jflag)
+		return (KLOG_INTMAX);
+	if (qflag)
+		return (KLOG_QUAD);
+	if (tflag)
+		return (KLOG_PTRDIFF);
+	if (lflag)
+		return (KLOG_LONG);
+	if (zflag)
+		return (KLOG_SIZE);
+	return (KLOG_INT);
+}
+
+/*
+ * Scans the conversion specification beginning at the percent sign at p and
+ * classifies its arguments in the same way as kvprintf() does.
+ */
+static void
+klog_scan(const char *p, struct klog_spec *spec)
+{
+	int lflag, qflag, jflag, tflag, zflag, dot;
+
+	memset(spec, 0, sizeof(*spec));
+	lflag = qflag = jflag = tflag = zflag = dot = 0;
+	spec->begin = p++;
+
+	for (;;) {
+		int ch;
+		int n;
+
+		ch = (u_char)*p++;
+
+		switch (ch) {
+		case '.':
+			dot = 1;
+			continue;
+		case '#':
+		case '+':
+		case '-':
+		case 'h':
+			continue;
+		case '*':
+			if (spec->stars < 2)
+				spec->star_is_width[spec->stars] = !dot;
+			++spec->stars;
+			continue;
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9':
+			for (n = ch - '0'; *p >= '0' && *p <= '9'; ++p)
+				n = n * 10 + *p - '0';
+			if (!dot)
+				spec->width = n;
+			continue;
+		case 'j':
+			jflag = 1;
+			continue;
+		case 'l':
+			if (lflag) {
+				lflag = 0;
+				qflag = 1;
+			} else
+				lflag = 1;
+			continue;
+		case 'q':
+			qflag = 1;
+			continue;
+		case 't':
+			tflag = 1;
+			continue;
+		case 'z':
+			zflag = 1;
+			continue;
+		case '%':
+			spec->kind = KLOG_LITERAL;
+			break;
+		case 'c':
+			spec->kind = KLOG_INT;
+			break;
+		case 'b':
+			spec->kind = KLOG_INT;
+			spec->bits = true;
+			break;
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'r':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'y':
+			spec->kind = klog_int_kind(lflag, qflag, jflag, tflag,
+			    zflag);
+			break;
+		case 'D':
+			spec->kind = KLOG_HEXDUMP;
+			break;
+		case 'm':
+			spec->kind = KLOG_ERRNO;
+			break;
+		case 'n':
+			spec->kind = KLOG_COUNT;
+			break;
+		case 'p':
+			spec->kind = KLOG_PTR;
+			break;
+		case 's':
+			spec->kind = KLOG_STRING;
+			break;
+		default:
+			spec->kind = KLOG_STOP;
+			if (ch == '\0')
+				--p;
+			break;
+		}
+
+		break;
+	}
+
+	if (spec->stars > 2)
+		spec->kind = KLOG_STOP;
+
+	spec->end = p;
+}
+
+static void
+klog_put(struct klog_writer *w, const void *data, size_t n)
+{
+
+	if ((size_t)(w->end - w->p) < n) {
+		w->overflow = true;
+		return;
+	}
+
+	memcpy(w->p, data, n);
+	w->p += n;
+}
+
+static void
+klog_put_string(struct klog_writer *w, const char *s, size_t max)
+{
+	uint8_t n;
+
+	if (s == NULL) {
+		n = KLOG_NULL;
+		klog_put(w, &n, sizeof(n));
+		return;
+	}
+
+	n = (uint8_t)strnlen(s, max);
+	klog_put(w, &n, sizeof(n));
+	klog_put(w, s, n);
+}
+
+#define	KLOG_PUT_ARG(w, ap, type) do {		\
+	type v_ = va_arg(ap, type);		\
+	klog_put(w, &v_, sizeof(v_));		\
+} while (0)
+
+/*
+ * Copies the arguments referenced by the format string.  Strings are copied
+ * since the caller may reuse the storage right after the call.
+ */
+static void
+klog_serialize(struct klog_writer *w, const char *fmt, va_list ap)
+{
+	const char *p;
+
+	p = fmt;
+
+	while (!w->overflow && (p = strchr(p, '%')) != NULL) {
+		struct klog_spec spec;
+		int width;
+		int i;
+
+		klog_scan(p, &spec);
+
+		if (spec.kind == KLOG_STOP)
+			break;
+
+		width = spec.width;
+
+		for (i = 0; i < spec.stars; ++i) {
+			int star;
+
+			star = va_arg(ap, int);
+			klog_put(w, &star, sizeof(star));
+
+			if (spec.star_is_width[i])
+				width = star < 0 ? -star : star;
+		}
+
+		switch (spec.kind) {
+		case KLOG_INT:
+			KLOG_PUT_ARG(w, ap, int);
+			break;
+		case KLOG_LONG:
+			KLOG_PUT_ARG(w, ap, long);
+			break;
+		case KLOG_QUAD:
+			KLOG_PUT_ARG(w, ap, quad_t);
+			break;
+		case KLOG_INTMAX:
+			KLOG_PUT_ARG(w, ap, intmax_t);
+			break;
+		case KLOG_SIZE:
+			KLOG_PUT_ARG(w, ap, size_t);
+			break;
+		case KLOG_PTRDIFF:
+			KLOG_PUT_ARG(w, ap, ptrdiff_t);
+			break;
+		case KLOG_PTR:
+			KLOG_PUT_ARG(w, ap, void *);
+			break;
+		case KLOG_STRING:
+			klog_put_string(w, va_arg(ap, const char *),
+			    KLOG_STRING_MAX);
+			break;
+		case KLOG_HEXDUMP: {
+			const u_char *up;
+			const char *sep;
+			uint8_t n;
+
+			up = va_arg(ap, const u_char *);
+			sep = va_arg(ap, const char *);
+			n = (uint8_t)MIN(width != 0 ? width : 16,
+			    KLOG_HEXDUMP_MAX);
+			klog_put(w, &n, sizeof(n));
+			klog_put(w, up, n);
+			klog_put_string(w, sep, KLOG_STRING_MAX);
+			break;
+		}
+		case KLOG_COUNT:
+			(void)va_arg(ap, void *);
+			break;
+		default:
+			break;
+		}
+
+		if (spec.bits)
+			klog_put_string(w, va_arg(ap, const char *),
+			    KLOG_STRING_MAX);
+
+		p = spec.end;
+	}
+}
+
+static void
+klog_get(struct klog_reader *r, void *data, size_t n)
+{
+
+	memcpy(data, r->p, n);
+	r->p += n;
+}
+
+static const char *
+klog_get_string(struct klog_reader *r, char *buf)
+{
+	uint8_t n;
+
+	klog_get(r, &n, sizeof(n));
+
+	if (n == KLOG_NULL)
+		return (NULL);
+
+	klog_get(r, buf, n);
+	buf[n] = '\0';
+	return (buf);
+}
+
+static void
+klog_putc(int c, void *arg)
+{
+	struct klog_line *line;
+
+	line = arg;
+
+	if (line->len + 1 < line->max) {
+		line->buf[line->len] = (char)c;
+		++line->len;
+	}
+}
+
+static void
+klog_append(struct klog_line *line, const char *s, size_t n)
+{
+
+	while (n > 0) {
+		klog_putc((u_char)*s, line);
+		++s;
+		--n;
+	}
+}
+
+static void
+klog_format_arg(struct klog_line *line, const char *spec, ...)
+{
+	va_list ap;
+
+	va_start(ap, spec);
+	kvprintf(spec, klog_putc, line, 10, ap);
+	va_end(ap);
+}
+
+/*
+ * Rebuilds a conversion specification with the asterisks replaced by the
+ * recorded values.  The conversion character is replaced by conv.
+ */
+static bool
+klog_rebuild_spec(char *buf, size_t size, const struct klog_spec *spec,
+    const int *stars, char conv)
+{
+	const char *p;
+	size_t len;
+	int i;
+
+	len = 0;
+	i = 0;
+
+	for (p = spec->begin; p < spec->end - 1; ++p) {
+		int n;
+
+		if (*p == '*')
+			n = snprintf(&buf[len], size - len, "%d", stars[i++]);
+		else
+			n = snprintf(&buf[len], size - len, "%c", *p);
+
+		len += (size_t)n;
+
+		if (len >= size)
+			return (false);
+	}
+
+	if (len + 2 > size)
+		return (false);
+
+	buf[len] = conv;
+	buf[len + 1] = '\0';
+	return (true);
+}
+
+#define	KLOG_FORMAT_ARG(line, r, spec, type) do {	\
+	type v_;					\
+	klog_get(r, &v_, sizeof(v_));			\
+	klog_format_arg(line, spec, v_);		\
+} while (0)
+
+static void
+klog_format(const struct klog_record *rec, struct klog_line *line)
+{
+	const char *fmt;
+	const char *p;
+	struct klog_reader r;
+
+	fmt = (const char *)(rec + 1);
+
+	if ((rec->flags & KLOG_TEXT) != 0) {
+		klog_append(line, fmt, strlen(fmt));
+		return;
+	}
+
+	r.p = (const uint8_t *)fmt + rec->fmt_len;
+	p = fmt;
+
+	for (;;) {
+		struct klog_spec spec;
+		char sbuf[48];
+		char abuf[MAX(KLOG_STRING_MAX, KLOG_HEXDUMP_MAX) + 1];
+		char bbuf[KLOG_STRING_MAX + 1];
+		int stars[2];
+		const char *q;
+		const char *s;
+		int i;
+
+		q = strchr(p, '%');
+
+		if (q == NULL) {
+			klog_append(line, p, strlen(p));
+			break;
+		}
+
+		klog_append(line, p, (size_t)(q - p));
+		klog_scan(q, &spec);
+
+		if (spec.kind == KLOG_STOP) {
+			klog_append(line, q, strlen(q));
+			break;
+		}
+
+		for (i = 0; i < spec.stars; ++i)
+			klog_get(&r, &stars[i], sizeof(stars[i]));
+
+		if (spec.kind == KLOG_LITERAL) {
+			klog_putc('%', line);
+			p = spec.end;
+			continue;
+		}
+
+		if (spec.kind == KLOG_COUNT) {
+			p = spec.end;
+			continue;
+		}
+
+		if (!klog_rebuild_spec(sbuf, sizeof(sbuf), &spec, stars,
+		    spec.kind == KLOG_ERRNO ? 's' : spec.end[-1])) {
+			klog_append(line, q, strlen(q));
+			break;
+		}
+
+		switch (spec.kind) {
+		case KLOG_INT:
+			if (spec.bits) {
+				int v;
+
+				klog_get(&r, &v, sizeof(v));
+				klog_format_arg(line, sbuf, v,
+				    klog_get_string(&r, bbuf));
+			} else
+				KLOG_FORMAT_ARG(line, &r, sbuf, int);
+			break;
+		case KLOG_LONG:
+			KLOG_FORMAT_ARG(line, &r, sbuf, long);
+			break;
+		case KLOG_QUAD:
+			KLOG_FORMAT_ARG(line, &r, sbuf, quad_t);
+			break;
+		case KLOG_INTMAX:
+			KLOG_FORMAT_ARG(line, &r, sbuf, intmax_t);
+			break;
+		case KLOG_SIZE:
+			KLOG_FORMAT_ARG(line, &r, sbuf, size_t);
+			break;
+		case KLOG_PTRDIFF:
+			KLOG_FORMAT_ARG(line, &r, sbuf, ptrdiff_t);
+			break;
+		case KLOG_PTR:
+			KLOG_FORMAT_ARG(line, &r, sbuf, void *);
+			break;
+		case KLOG_STRING:
+			klog_format_arg(line, sbuf, klog_get_string(&r, abuf));
+			break;
+		case KLOG_ERRNO:
+			klog_format_arg(line, sbuf, strerror(rec->error));
+			break;
+		case KLOG_HEXDUMP: {
+			uint8_t n;
+
+			klog_get(&r, &n, sizeof(n));
+			klog_get(&r, abuf, n);
+			s = klog_get_string(&r, bbuf);
+			snprintf(sbuf, sizeof(sbuf), "%%%uD", n);
+			klog_format_arg(line, sbuf, abuf, s);
+			break;
+		}
+		default:
+			break;
+		}
+
+		p = spec.end;
+	}
+}
+
+static int
+klog_output(rtems_bsd_vprintf_handler output, int level, const char *fmt,
+    ...)
+{
+	va_list ap;
+	int n;
+
+	va_start(ap, fmt);
+	n = (*output)(level, fmt, ap);
+	va_end(ap);
+	return (n);
+}
+
+static void
+klog_commit(struct klog_record *rec, u_int size)
+{
+	rtems_interrupt_level level;
+	struct klog_ring *ring;
+	u_int head;
+	u_int tail;
+	u_int off;
+	u_int gap;
+
+	rtems_interrupt_local_disable(level);
+
+	ring = &klog.rings[rtems_scheduler_get_processor()];
+	head = ring->head;
+	tail = (u_int)atomic_load_acq_int((volatile int *)&ring->tail);
+	off = head & ring->mask;
+	gap = ring->mask + 1 - off;
+
+	if (gap >= size)
+		gap = 0;
+
+	if (head + gap + size - tail > ring->mask + 1) {
+		++ring->lost;
+		rtems_interrupt_local_enable(level);
+		return;
+	}
+
+	if (gap != 0) {
+		struct klog_record *pad;
+
+		pad = (struct klog_record *)&ring->buf[off];
+		pad->size = (uint16_t)gap;
+		pad->level = KLOG_PAD;
+		head += gap;
+		off = 0;
+	}
+
+	rec->seq = (uint32_t)atomic_fetchadd_int((volatile int *)&klog.seq, 1);
+	memcpy(&ring->buf[off], rec, size);
+	atomic_store_rel_int((volatile int *)&ring->head, (int)(head + size));
+
+	rtems_interrupt_local_enable(level);
+
+	if (klog.waiting != 0 &&
+	    atomic_cmpset_int((volatile int *)&klog.waiting, 1, 0)) {
+		(void)rtems_event_transient_send(klog.task);
+	}
+}
+
+int
+rtems_bsd_vprintf_deferred(int level, const char *fmt, va_list ap)
+{
+	uint64_t data[KLOG_RECORD_MAX / sizeof(uint64_t)];
+	struct klog_record *rec;
+	struct klog_writer w;
+	rtems_bsd_vprintf_handler output;
+	size_t fmt_len;
+	va_list aq;
+	int error;
+
+	error = errno;
+	output = klog.output;
+
+	if (output != NULL && level != LOG_PRINTF &&
+	    LOG_PRI(level) <= LOG_CRIT)
+		return ((*output)(level, fmt, ap));
+
+	rec = (struct klog_record *)&data[0];
+	w.p = (uint8_t *)(rec + 1);
+	w.end = (uint8_t *)&data[nitems(data)];
+	w.overflow = false;
+
+	fmt_len = strlen(fmt) + 1;
+	klog_put(&w, fmt, fmt_len);
+	va_copy(aq, ap);
+	klog_serialize(&w, fmt, aq);
+	va_end(aq);
+
+	if (w.overflow) {
+		struct klog_line line;
+
+		/* Fall back to a truncated text record */
+		line.buf = (char *)(rec + 1);
+		line.len = 0;
+		line.max = (size_t)(w.end - (uint8_t *)line.buf);
+		errno = error;
+		kvprintf(fmt, klog_putc, &line, 10, ap);
+		line.buf[line.len] = '\0';
+		fmt_len = line.len + 1;
+		w.p = (uint8_t *)line.buf + fmt_len;
+		rec->flags = KLOG_TEXT;
+	} else
+		rec->flags = 0;
+
+	rec->level = (int16_t)level;
+	rec->fmt_len = (uint16_t)fmt_len;
+	rec->error = error;
+	rec->size = (uint16_t)roundup2(w.p - (uint8_t *)rec, KLOG_ALIGN);
+	klog_commit(rec, rec->size);
+	return (0);
+}
+
+/*
+ * Returns the next record of the ring buffer starting at *tail and skips the
+ * padding at the end of the ring buffer.
+ */
+static const struct klog_record *
+klog_peek(const struct klog_ring *ring, u_int *tail, u_int head)
+{
+
+	while (*tail != head) {
+		const struct klog_record *rec;
+
+		rec = (const struct klog_record *)&ring->buf[*tail & ring->mask];
+
+		if (rec->level != KLOG_PAD)
+			return (rec);
+
+		*tail += rec->size;
+	}
+
+	return (NULL);
+}
+
+/*
+ * Selects the record with the lowest sequence number of all ring buffers.
+ * The caller must own the consumer lock.
+ */
+static const struct klog_record *
+klog_select(u_int *tails, const u_int *heads, uint32_t *which)
+{
+	const struct klog_record *best;
+	uint32_t i;
+
+	best = NULL;
+
+	for (i = 0; i < klog.ring_count; ++i) {
+		const struct klog_record *rec;
+
+		rec = klog_peek(&klog.rings[i], &tails[i], heads[i]);
+
+		if (rec != NULL && (best == NULL ||
+		    (int32_t)(rec->seq - best->seq) < 0)) {
+			best = rec;
+			*which = i;
+		}
+	}
+
+	return (best);
+}
+
+static u_int
+klog_lost(void)
+{
+	u_int lost;
+	uint32_t i;
+
+	lost = 0;
+
+	for (i = 0; i < klog.ring_count; ++i)
+		lost += klog.rings[i].lost;
+
+	return (lost);
+}
+
+static bool
+klog_pending(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < klog.ring_count; ++i) {
+		struct klog_ring *ring;
+
+		ring = &klog.rings[i];
+
+		if (ring->tail !=
+		    (u_int)atomic_load_acq_int((volatile int *)&ring->head))
+			return (true);
+	}
+
+	return (false);
+}
+
+static void
+klog_snapshot(u_int *tails, u_int *heads)
+{
+	uint32_t i;
+
+	for (i = 0; i < klog.ring_count; ++i) {
+		struct klog_ring *ring;
+
+		ring = &klog.rings[i];
+		tails[i] = ring->tail;
+		heads[i] = (u_int)atomic_load_acq_int(
+		    (volatile int *)&ring->head);
+	}
+}
+
+/*
+ * Formats and consumes the oldest record.  Returns false, if no record is
+ * available.
+ */
+static bool
+klog_drain_one(char *buf, size_t size, int *level, u_int *tails,
+    u_int *heads)
+{
+	const struct klog_record *rec;
+	struct klog_line line;
+	struct klog_ring *ring;
+	uint32_t which;
+
+	KLOG_LOCK();
+	klog_snapshot(tails, heads);
+	rec = klog_select(tails, heads, &which);
+
+	if (rec == NULL) {
+		KLOG_UNLOCK();
+		return (false);
+	}
+
+	line.buf = buf;
+	line.len = 0;
+	line.max = size;
+	klog_format(rec, &line);
+	buf[line.len] = '\0';
+	*level = rec->level;
+
+	ring = &klog.rings[which];
+	atomic_store_rel_int((volatile int *)&ring->tail,
+	    (int)(tails[which] + rec->size));
+	KLOG_UNLOCK();
+	return (true);
+}
+
+static void
+klog_task(rtems_task_argument arg)
+{
+	char buf[KLOG_LINE_MAX];
+	u_int *tails;
+	u_int *heads;
+
+	(void)arg;
+	tails = malloc(2 * klog.ring_count * sizeof(*tails), M_KLOG,
+	    M_WAITOK);
+	heads = &tails[klog.ring_count];
+
+	for (;;) {
+		int level;
+		u_int lost;
+
+		while (klog_drain_one(buf, sizeof(buf), &level, tails, heads))
+			klog_output(klog.output, level, "%s", buf);
+
+		lost = klog_lost();
+
+		if (lost != klog.reported_lost) {
+			klog_output(klog.output, LOG_WARNING,
+			    "klog: %u messages lost\n", lost - klog.reported_lost);
+			klog.reported_lost = lost;
+		}
+
+		atomic_store_rel_int((volatile int *)&klog.waiting, 1);
+
+		if (klog_pending() &&
+		    atomic_cmpset_int((volatile int *)&klog.waiting, 1, 0))
+			continue;
+
+		(void)rtems_event_transient_receive(RTEMS_WAIT,
+		    RTEMS_NO_TIMEOUT);
+	}
+}
+
+rtems_status_code
+rtems_bsd_vprintf_deferred_start(size_t ring_size,
+    rtems_task_priority priority)
+{
+	struct klog_ring *rings;
+	rtems_status_code sc;
+	uint32_t count;
+	uint32_t i;
+	size_t size;
+
+	if (klog.rings != NULL)
+		return (RTEMS_INCORRECT_STATE);
+
+	size = 2 * KLOG_RECORD_MAX;
+
+	while (size < ring_size)
+		size <<= 1;
+
+	count = rtems_scheduler_get_processor_maximum();
+	rings = malloc(count * sizeof(*rings), M_KLOG, M_WAITOK | M_ZERO);
+
+	for (i = 0; i < count; ++i) {
+		rings[i].buf = malloc(size, M_KLOG, M_WAITOK);
+		rings[i].mask = (u_int)(size - 1);
+	}
+
+	sc = rtems_task_create(rtems_build_name('K', 'L', 'O', 'G'), priority,
+	    KLOG_TASK_STACK_SIZE, RTEMS_DEFAULT_MODES,
+	    RTEMS_DEFAULT_ATTRIBUTES, &klog.task);
+
+	if (sc != RTEMS_SUCCESSFUL) {
+		for (i = 0; i < count; ++i)
+			free(rings[i].buf, M_KLOG);
+
+		free(rings, M_KLOG);
+		return (sc);
+	}
+
+	klog.ring_count = count;
+	klog.rings = rings;
+	klog.output = rtems_bsd_set_vprintf_handler(
+	    rtems_bsd_vprintf_deferred);
+
+	sc = rtems_task_start(klog.task, klog_task, 0);
+	BSD_ASSERT(sc == RTEMS_SUCCESSFUL);
+
+	return (RTEMS_SUCCESSFUL);
+}
+
+void
+rtems_bsd_vprintf_deferred_dump(FILE *file)
+{
+	char buf[KLOG_LINE_MAX];
+	u_int *tails;
+	u_int *heads;
+	uint32_t i;
+
+	if (klog.rings == NULL) {
+		fprintf(file, "deferred logging is not active\n");
+		return;
+	}
+
+	tails = malloc(2 * klog.ring_count * sizeof(*tails), M_KLOG,
+	    M_WAITOK);
+	heads = &tails[klog.ring_count];
+
+	KLOG_LOCK();
+	klog_snapshot(tails, heads);
+
+	for (i = 0; i < klog.ring_count; ++i) {
+		const struct klog_ring *ring;
+
+		ring = &klog.rings[i];
+		fprintf(file, "cpu %" PRIu32 ": %u of %u bytes used, "
+		    "%u messages lost\n", i, heads[i] - tails[i],
+		    ring->mask + 1, ring->lost);
+	}
+
+	for (;;) {
+		const struct klog_record *rec;
+		struct klog_line line;
+		uint32_t which;
+
+		rec = klog_select(tails, heads, &which);
+
+		if (rec == NULL)
+			break;
+
+		line.buf = buf;
+		line.len = 0;
+		line.max = sizeof(buf);
+		klog_format(rec, &line);
+		buf[line.len] = '\0';
+		fprintf(file, "%" PRIu32 " %i: %s%s", rec->seq, rec->level,
+		    buf, line.len > 0 && buf[line.len - 1] == '\n' ? "" : "\n");
+		tails[which] += rec->size;
+	}
+
+	KLOG_UNLOCK();
+	free(tails, M_KLOG);
+}
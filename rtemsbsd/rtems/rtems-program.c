@@ -37,17 +37,21 @@
  * SUCH DAMAGE.
  */
 
+#include <sys/param.h>
 #include <sys/types.h>
 
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
 #include <unistd.h>
 
+#include <rtems.h>
+
 #define RTEMS_BSD_PROGRAM_NO_OPEN_WRAP
 #define RTEMS_BSD_PROGRAM_NO_CLOSE_WRAP
 #define RTEMS_BSD_PROGRAM_NO_FOPEN_WRAP
@@ -63,6 +67,11 @@
 
 #include "program-internal.h"
 
+#define	ALLOCMEM_HEADER_SIZE \
+	roundup2(sizeof(struct program_allocmem_item), CPU_HEAP_ALIGNMENT)
+
+#define	ALLOCMEM_MAGIC ((uintptr_t)0x5a3c96e1)
+
 static int
 fd_remove(struct rtems_bsd_program_control *prog_ctrl, int fd)
 {
@@ -169,58 +178,75 @@ file_close_all(struct rtems_bsd_program_control *prog_ctrl)
 	}
 }
 
-static int
-allocmem_remove(struct rtems_bsd_program_control *prog_ctrl, void *ptr)
+static uintptr_t
+allocmem_magic(const struct program_allocmem_item *item)
 {
-	struct program_allocmem_item *current;
-	int rv = -1;
+	return ((uintptr_t)item ^ ALLOCMEM_MAGIC);
+}
 
-	for (current = prog_ctrl->allocated_mem.lh_first;
-	    current != NULL;
-	    current = current->entries.le_next) {
-		if (current->ptr == ptr) {
-			LIST_REMOVE(current, entries);
-			rv = 0;
-			break;
-		}
+static void *
+allocmem_ptr(struct program_allocmem_item *item)
+{
+	return ((char *)item + ALLOCMEM_HEADER_SIZE);
+}
+
+/*
+ * Returns the header of a block allocated by the program or NULL, if the
+ * memory was not allocated by the program.
+ */
+static struct program_allocmem_item *
+allocmem_item(void *ptr)
+{
+	struct program_allocmem_item *item;
+
+	item = (struct program_allocmem_item *)
+	    ((char *)ptr - ALLOCMEM_HEADER_SIZE);
+
+	if (item->magic != allocmem_magic(item)) {
+		return NULL;
 	}
 
-	return rv;
+	return item;
+}
+
+static void
+allocmem_insert(struct rtems_bsd_program_control *prog_ctrl,
+    struct program_allocmem_item *item)
+{
+	item->magic = allocmem_magic(item);
+	LIST_INSERT_HEAD(&prog_ctrl->allocated_mem, item, entries);
+}
+
+static void
+allocmem_remove(struct program_allocmem_item *item)
+{
+	LIST_REMOVE(item, entries);
+	item->magic = 0;
 }
 
 static int
-allocmem_free_remove(struct rtems_bsd_program_control *prog_ctrl, void *ptr)
+allocmem_free_remove(void *ptr)
 {
-	int rv = -1;
+	struct program_allocmem_item *item;
 
-	rv = allocmem_remove(prog_ctrl, ptr);
-	if (rv == 0) {
-		free(ptr);
+	item = allocmem_item(ptr);
+	if (item == NULL) {
+		return -1;
 	}
 
-	return rv;
+	allocmem_remove(item);
+	free(item);
+	return 0;
 }
 
 static void
 allocmem_free_all(struct rtems_bsd_program_control *prog_ctrl)
 {
-	while(prog_ctrl->allocated_mem.lh_first != NULL) {
-		struct program_allocmem_item *current;
-		void *ptr;
-		int rv;
+	struct program_allocmem_item *item;
 
-		current = prog_ctrl->allocated_mem.lh_first;
-		ptr = current->ptr;
-
-		rv = allocmem_free_remove(prog_ctrl, ptr);
-		if (rv != 0) {
-			/* This should never happen. It would mean that someone
-			 * changed the allocmem list while we are removing the
-			 * element. */
-			syslog(LOG_ERR,
-			    "BSD Program: Could not remove %p from list of allocated memory",
-			    ptr);
-		}
+	while ((item = LIST_FIRST(&prog_ctrl->allocated_mem)) != NULL) {
+		allocmem_remove(item);
+		free(item);
 	}
 }
 
@@ -476,37 +502,41 @@ rtems_bsd_program_alloc(size_t size, void *org_ptr)
 {
 	struct rtems_bsd_program_control *prog_ctrl =
 	    rtems_bsd_program_get_control_or_null();
-	void *ptr = NULL;
-	size_t size_with_list;
-	size_t size_alligned;
+	struct program_allocmem_item *org_item = NULL;
+	struct program_allocmem_item *item;
 
-	if (prog_ctrl != NULL) {
-		/* align the end to the next word address */
-		size_alligned = size;
-		if ((size_alligned & 0x3) != 0) {
-			size_alligned = (size_alligned | 0x03) + 1;
-		}
-		size_with_list = size_alligned +
-		    sizeof(struct program_allocmem_item);
+	if (prog_ctrl == NULL) {
+		return NULL;
+	}
+
+	if (size > SIZE_MAX - ALLOCMEM_HEADER_SIZE) {
+		errno = ENOMEM;
+		return NULL;
+	}
 
-		if (org_ptr != NULL) {
-			/* It's a reallocation. So first remove the old pointer
-			 * from the list */
-			allocmem_remove(prog_ctrl, org_ptr);
+	if (org_ptr != NULL) {
+		org_item = allocmem_item(org_ptr);
+		if (org_item == NULL) {
+			/* Not allocated by the program, so it is not tracked */
+			return realloc(org_ptr, size);
 		}
 
-		ptr = realloc(org_ptr, size_with_list);
+		/* The block may move, so remove it from the list first */
+		allocmem_remove(org_item);
+	}
+
+	item = realloc(org_item, size + ALLOCMEM_HEADER_SIZE);
 
-		if (ptr != NULL) {
-			struct program_allocmem_item *item;
-			item = ptr + size_alligned;
-			item->ptr = ptr;
-			LIST_INSERT_HEAD(&(prog_ctrl->allocated_mem),
-			    item, entries);
+	if (item == NULL) {
+		if (org_item != NULL) {
+			allocmem_insert(prog_ctrl, org_item);
 		}
+
+		return NULL;
 	}
 
-	return ptr;
+	allocmem_insert(prog_ctrl, item);
+	return allocmem_ptr(item);
 }
 
 void *
@@ -540,7 +570,7 @@ rtems_bsd_program_reallocf(void *ptr, size_t size)
 {
 	void *ret = rtems_bsd_program_alloc(size, ptr);
 	if (ret == NULL) {
-		free(ptr);
+		rtems_bsd_program_free(ptr);
 	}
 	return ret;
 }
@@ -599,16 +629,12 @@ rtems_bsd_program_asprintf(char **strp, const char *fmt, ...)
 void
 rtems_bsd_program_free(void *ptr)
 {
-	if (ptr != NULL) {
-		struct rtems_bsd_program_control *prog_ctrl =
-		    rtems_bsd_program_get_control_or_null();
-
-		if (prog_ctrl != NULL) {
-			int rv = allocmem_free_remove(prog_ctrl, ptr);
-			assert(rv == 0);
-		} else {
-			/* Outside of program context. Just free it. */
-			free(ptr);
-		}
+	if (ptr != NULL && allocmem_free_remove(ptr) != 0) {
+		/*
+		 * Not allocated by a program, for example a block from
+		 * outside which was passed to rtems_bsd_program_realloc().
+		 * Just free it.
+		 */
+		free(ptr);
 	}
 }
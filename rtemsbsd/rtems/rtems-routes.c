@@ -29,12 +29,21 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <time.h>
+#include <unistd.h>
 
+#include <ifaddrs.h>
 #include <net/if.h>
 #include <net/route.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/time.h>
+
+#include <rtems/rtems-routes.h>
 
 /*
  * Round up 'a' to next multiple of 'size', which must be a power of 2
@@ -139,3 +148,128 @@ int rtems_get_route(const struct sockaddr_in* sin, struct sockaddr** rti_info)
 
   return 0;
 }
+
+static bool
+default_route_present(const char* arg)
+{
+  struct sockaddr_in sin;
+  struct sockaddr*   rti_info[RTAX_MAX];
+  int                r;
+
+  (void) arg;
+
+  memset(&sin, 0, sizeof(sin));
+  memset(&rti_info[0], 0, sizeof(rti_info));
+  sin.sin_len = sizeof(sin);
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  r = rtems_get_route(&sin, rti_info);
+  return r == 0 && rti_info[RTAX_GATEWAY] != NULL;
+}
+
+static bool
+ifaddr_present(const char* ifname)
+{
+  struct ifaddrs* ifap;
+  struct ifaddrs* ifa;
+  bool            found = false;
+
+  if (getifaddrs(&ifap) != 0)
+    return false;
+
+  for (ifa = ifap; ifa != NULL && !found; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == NULL)
+      continue;
+    if (ifname != NULL) {
+      if (strcmp(ifa->ifa_name, ifname) != 0)
+        continue;
+    }
+    else if ((ifa->ifa_flags & IFF_LOOPBACK) != 0) {
+      continue;
+    }
+    if (ifa->ifa_addr->sa_family == AF_INET) {
+      found = true;
+    }
+    else if (ifa->ifa_addr->sa_family == AF_INET6) {
+      const struct sockaddr_in6* sin6 =
+        (const struct sockaddr_in6*) ifa->ifa_addr;
+      if (!IN6_IS_ADDR_LINKLOCAL(&sin6->sin6_addr))
+        found = true;
+    }
+  }
+
+  freeifaddrs(ifap);
+
+  return found;
+}
+
+static int64_t
+now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Check the condition each time the routing table or an interface address
+ * changes. The socket is opened before the first check so no change is lost.
+ */
+static int
+wait_route_event(bool (*present)(const char*), const char* arg, int timeout_ms)
+{
+  union {
+    struct rt_msghdr rtm;
+    char             buf[sizeof(struct rt_msghdr) + 512];
+  }       msg;
+  int64_t deadline;
+  int     s;
+
+  s = socket(AF_ROUTE, SOCK_RAW, AF_UNSPEC);
+  if (s < 0)
+    return -1;
+
+  deadline = now_ms() + timeout_ms;
+
+  while (!present(arg)) {
+    struct timeval tv;
+    int64_t        remaining;
+    ssize_t        r;
+
+    do {
+      remaining = deadline - now_ms();
+      if (remaining <= 0) {
+        close(s);
+        errno = ETIMEDOUT;
+        return -1;
+      }
+
+      tv.tv_sec = remaining / 1000;
+      tv.tv_usec = (remaining % 1000) * 1000;
+      setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+      r = read(s, &msg, sizeof(msg));
+
+      /*
+       * The replies to the route queries of the check are seen as well.
+       */
+    } while (r < 0 || msg.rtm.rtm_type == RTM_GET);
+  }
+
+  close(s);
+
+  return 0;
+}
+
+int
+rtems_wait_default_route(int timeout_ms)
+{
+  return wait_route_event(default_route_present, NULL, timeout_ms);
+}
+
+int
+rtems_wait_ifaddr(const char* ifname, int timeout_ms)
+{
+  return wait_route_event(ifaddr_present, ifname, timeout_ms);
+}
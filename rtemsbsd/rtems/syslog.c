@@ -46,8 +46,16 @@
 
 #include <rtems/bsd/bsd.h>
 
+#include <machine/rtems-bsd-syslog.h>
+
 static int syslog_mask = LOG_UPTO(LOG_NOTICE);
 
+static const char *syslog_ident;
+
+static int syslog_facility = LOG_USER;
+
+rtems_bsd_syslog_forward_handler rtems_bsd_syslog_forward;
+
 static bool
 syslog_do_log(int priority)
 {
@@ -73,6 +81,26 @@ vsyslog(int priority, const char *format, va_list ap)
 {
 
 	if (syslog_do_log(priority)) {
+		rtems_bsd_syslog_forward_handler forward;
+
+		forward = rtems_bsd_syslog_forward;
+
+		if (forward != NULL) {
+			va_list aq;
+			int error;
+
+			error = errno;
+
+			if ((priority & LOG_FACMASK) == 0) {
+				priority |= syslog_facility;
+			}
+
+			va_copy(aq, ap);
+			(*forward)(priority, syslog_ident, error, format, aq);
+			va_end(aq);
+			errno = error;
+		}
+
 		rtems_bsd_vprintf(priority, format, ap);
 	}
 }
@@ -80,13 +108,27 @@ vsyslog(int priority, const char *format, va_list ap)
 void
 openlog(const char *ident, int option, int facility)
 {
-	/* TODO */
+
+	(void)option;
+
+	/*
+	 * The identification and facility have a process-wide scope, see
+	 * setlogmask().  They are only used by the remote forwarding.
+	 */
+	if (ident != NULL) {
+		syslog_ident = ident;
+	}
+
+	if (facility != 0 && (facility & ~LOG_FACMASK) == 0) {
+		syslog_facility = facility;
+	}
 }
 
 void
 closelog(void)
 {
-	/* TODO */
+
+	syslog_ident = NULL;
 }
 
 int
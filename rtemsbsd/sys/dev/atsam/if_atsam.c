@@ -31,6 +31,9 @@
 
 #include <machine/rtems-bsd-kernel-space.h>
 
+#include <rtems/bsd/local/opt_inet.h>
+#include <rtems/bsd/local/opt_inet6.h>
+
 #include <bsp.h>
 
 #ifdef LIBBSP_ARM_ATSAM_BSP_H
@@ -53,9 +56,11 @@
 #include <net/if_var.h>
 #include <net/if_types.h>
 #include <net/if_media.h>
+#include <net/if_gso.h>
 
 #include <netinet/in.h>
 #include <netinet/if_ether.h>
+#include <netinet/tcp_lro.h>
 
 #include <dev/mii/mii.h>
 #include <dev/mii/miivar.h>
@@ -168,6 +173,9 @@ typedef struct if_atsam_softc {
 	size_t amount_tx_buf;
 	ring_buffer tx_ring;
 	struct callout tick_ch;
+#if defined(INET) || defined(INET6)
+	struct lro_ctrl lro;
+#endif
 
 	/*
 	 * Settings for a fixed speed.
@@ -492,6 +500,8 @@ static void if_atsam_rx_daemon(void *arg)
 	void *rx_bd_base;
 	struct mbuf *m;
 	struct mbuf *n;
+	struct mbuf *batch;
+	struct mbuf **batch_tail;
 	volatile sGmacRxDescriptor *buffer_desc;
 	uint32_t tmp_rx_bd_address;
 	size_t i;
@@ -563,6 +573,9 @@ static void if_atsam_rx_daemon(void *arg)
 		/* Wait for events */
 		if_atsam_event_receive(sc, ATSAMV7_ETH_RX_EVENT_INTERRUPT);
 
+		batch = NULL;
+		batch_tail = &batch;
+
 		/*
 		 * Check for all packets with a set ownership bit
 		 */
@@ -575,9 +588,14 @@ static void if_atsam_rx_daemon(void *arg)
 				if (n != NULL) {
 					rx_update_mbuf(m, buffer_desc);
 
-					IF_ATSAM_UNLOCK(sc);
-					sc->ifp->if_input(ifp, m);
-					IF_ATSAM_LOCK(sc);
+#if defined(INET) || defined(INET6)
+					if ((ifp->if_capenable & IFCAP_LRO) == 0 ||
+					    tcp_lro_rx_csum(&sc->lro, m) != 0)
+#endif
+					{
+						*batch_tail = m;
+						batch_tail = &m->m_nextpkt;
+					}
 					m = n;
 				} else {
 					(void)if_atsam_event_send(
@@ -607,6 +625,21 @@ static void if_atsam_rx_daemon(void *arg)
 				    + sc->rx_bd_fill_idx;
 			}
 		}
+
+		/* Pass the received frames up in one go */
+		if (batch != NULL) {
+			IF_ATSAM_UNLOCK(sc);
+			(*ifp->if_input_batch)(ifp, batch);
+			IF_ATSAM_LOCK(sc);
+		}
+#if defined(INET) || defined(INET6)
+		/* Pass aggregated segments up before waiting again */
+		if (!LIST_EMPTY(&sc->lro.lro_active)) {
+			IF_ATSAM_UNLOCK(sc);
+			tcp_lro_flush_all(&sc->lro);
+			IF_ATSAM_LOCK(sc);
+		}
+#endif
 		/* Setup the interrupts for RX completion and errors */
 		GMAC_EnableIt(pHw, GMAC_IER_RCOMP | GMAC_IER_ROVR, 0);
 	}
@@ -1169,6 +1202,17 @@ if_atsam_add_sysctls(device_t dev)
 	SYSCTL_ADD_UINT(ctx, child, OID_AUTO, "tx_interrupts",
 	    CTLFLAG_RD, &sc->stats.tx_interrupts, 0,
 	    "Tx interrupts");
+#if defined(INET) || defined(INET6)
+	SYSCTL_ADD_UQUAD(ctx, child, OID_AUTO, "lro_queued",
+	    CTLFLAG_RD, &sc->lro.lro_queued,
+	    "LRO segments queued");
+	SYSCTL_ADD_UQUAD(ctx, child, OID_AUTO, "lro_flushed",
+	    CTLFLAG_RD, &sc->lro.lro_flushed,
+	    "LRO packets flushed");
+	SYSCTL_ADD_UQUAD(ctx, child, OID_AUTO, "lro_bad_csum",
+	    CTLFLAG_RD, &sc->lro.lro_bad_csum,
+	    "LRO frames with bad checksum");
+#endif
 
 	tree = SYSCTL_ADD_NODE(ctx, statsnode, OID_AUTO, "hw", CTLFLAG_RD,
 			       NULL, "if_atsam hardware statistics");
@@ -1385,6 +1429,7 @@ if_atsam_ioctl(struct ifnet *ifp, ioctl_command_t command, caddr_t data)
 	int rv = 0;
 	bool prom_enable;
 	struct mii_data *mii;
+	int mask;
 
 	switch (command) {
 	case SIOCGIFMEDIA:
@@ -1404,6 +1449,20 @@ if_atsam_ioctl(struct ifnet *ifp, ioctl_command_t command, caddr_t data)
 			}
 		}
 		break;
+	case SIOCSIFCAP:
+		/* The checksum offloads are fixed, other changes are ignored */
+		mask = (ifp->if_capenable ^ ifr->ifr_reqcap) &
+		    ifp->if_capabilities;
+		if ((mask & IFCAP_LRO) != 0) {
+			/* Queued segments are flushed after each receive batch */
+			ifp->if_capenable ^= IFCAP_LRO;
+		}
+		if ((mask & IFCAP_TSO4) != 0) {
+			/* Emulated by the software segmentation stage */
+			ether_gso_setcap(ifp,
+			    (ifr->ifr_reqcap & IFCAP_TSO4) != 0);
+		}
+		break;
 	default:
 		rv = ether_ioctl(ifp, command, data);
 		break;
@@ -1495,6 +1554,13 @@ static int if_atsam_driver_attach(device_t dev)
 	ifp->if_flags = IFF_BROADCAST | IFF_SIMPLEX;
 	ifp->if_capabilities |= IFCAP_HWCSUM | IFCAP_HWCSUM_IPV6 |
 	    IFCAP_VLAN_HWCSUM;
+#if defined(INET) || defined(INET6)
+	if (tcp_lro_init(&sc->lro) == 0) {
+		sc->lro.ifp = ifp;
+		ifp->if_capabilities |= IFCAP_LRO;
+		ifp->if_capenable |= IFCAP_LRO;
+	}
+#endif
 	ifp->if_hwassist = CSUM_IP | CSUM_IP_UDP | CSUM_IP_TCP |
 	    CSUM_IP6_UDP | CSUM_IP6_TCP;
 	IFQ_SET_MAXLEN(&ifp->if_snd, TXBUF_COUNT - 1);
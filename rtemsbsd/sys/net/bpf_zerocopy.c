@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Zero-copy buffer mode for BPF (BPF_BUFMODE_ZBUF).
+ *
+ * The application provides two buffers with BIOCSETZBUF.  Each buffer starts
+ * with a struct bpf_zbuf_header followed by the packet data.  The kernel
+ * stores packets directly in the buffer of the store slot.  Once a buffer
+ * moves into the hold slot or the store buffer is full, the kernel publishes
+ * the length in bzh_kernel_len and increments bzh_kernel_gen.  The
+ * application owns the buffer while bzh_kernel_gen differs from bzh_user_gen
+ * and hands it back to the kernel by copying bzh_kernel_gen to bzh_user_gen.
+ * There is no read(2) copy and no system call is needed to acknowledge a
+ * buffer.
+ *
+ * On FreeBSD the user pages are wired and mapped into the kernel with
+ * sf_bufs.  RTEMS has a single address space, so the kernel uses the buffers
+ * of the application as is.  The application must not free the buffers
+ * before the descriptor is closed.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/lock.h>
+#include <sys/malloc.h>
+#include <sys/mbuf.h>
+#include <sys/mutex.h>
+#include <sys/proc.h>
+
+#include <machine/atomic.h>
+
+#include <net/if.h>
+#include <net/bpf.h>
+#include <net/bpf_zerocopy.h>
+#include <net/bpfdesc.h>
+
+/*
+ * A zero-copy buffer.  The descriptor slots bd_sbuf, bd_hbuf and bd_fbuf
+ * point to this structure and not to the packet data.
+ */
+struct zbuf {
+	void			*zb_uaddr;	/* Buffer of the application. */
+	size_t			 zb_size;	/* Size of the buffer. */
+	u_int			 zb_flags;	/* Flags on zbuf. */
+	struct bpf_zbuf_header	*zb_header;	/* Shared header. */
+};
+
+/*
+ * Set when the buffer was handed to the application and not yet reclaimed
+ * by the kernel.
+ */
+#define	ZBUF_FLAG_ASSIGNED	0x00000001
+
+static u_char *
+zbuf_data(struct zbuf *zb)
+{
+
+	return ((u_char *)(zb->zb_header + 1));
+}
+
+static struct zbuf *
+zbuf_setup(void *uaddr, size_t len)
+{
+	struct zbuf *zb;
+
+	zb = malloc(sizeof(*zb), M_BPF, M_WAITOK | M_ZERO);
+	zb->zb_uaddr = uaddr;
+	zb->zb_size = len;
+	zb->zb_header = uaddr;
+	bzero(zb->zb_header, sizeof(*zb->zb_header));
+	return (zb);
+}
+
+void
+bpf_zerocopy_append_bytes(struct bpf_d *d, caddr_t buf, u_int offset,
+    void *src, u_int len)
+{
+	struct zbuf *zb;
+
+	zb = (struct zbuf *)buf;
+	KASSERT(offset + len <= zb->zb_size - sizeof(struct bpf_zbuf_header),
+	    ("bpf_zerocopy_append_bytes: buffer overrun"));
+	memcpy(zbuf_data(zb) + offset, src, len);
+}
+
+void
+bpf_zerocopy_append_mbuf(struct bpf_d *d, caddr_t buf, u_int offset,
+    void *src, u_int len)
+{
+	struct zbuf *zb;
+
+	zb = (struct zbuf *)buf;
+	KASSERT(offset + len <= zb->zb_size - sizeof(struct bpf_zbuf_header),
+	    ("bpf_zerocopy_append_mbuf: buffer overrun"));
+	m_copydata((struct mbuf *)src, 0, len, zbuf_data(zb) + offset);
+}
+
+/*
+ * The store buffer has no room for the next packet and there is no free
+ * buffer to rotate in.  Hand the store buffer to the application so that it
+ * can process the packets it already has.  The buffer stays in the store
+ * slot, bpf_zerocopy_canwritebuf() prevents further writes.
+ */
+void
+bpf_zerocopy_buffull(struct bpf_d *d)
+{
+	struct zbuf *zb;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_buffull: not in zbuf mode"));
+
+	zb = (struct zbuf *)d->bd_sbuf;
+	KASSERT(zb != NULL, ("bpf_zerocopy_buffull: zb == NULL"));
+
+	if ((zb->zb_flags & ZBUF_FLAG_ASSIGNED) == 0 && d->bd_slen != 0) {
+		zb->zb_flags |= ZBUF_FLAG_ASSIGNED;
+		zb->zb_header->bzh_kernel_len = d->bd_slen;
+		atomic_add_rel_int(
+		    (volatile int *)&zb->zb_header->bzh_kernel_gen, 1);
+	}
+}
+
+/*
+ * A buffer moved into the hold slot, hand it to the application unless
+ * bpf_zerocopy_buffull() already did this.
+ */
+void
+bpf_zerocopy_bufheld(struct bpf_d *d)
+{
+	struct zbuf *zb;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_bufheld: not in zbuf mode"));
+
+	zb = (struct zbuf *)d->bd_hbuf;
+	KASSERT(zb != NULL, ("bpf_zerocopy_bufheld: zb == NULL"));
+
+	if ((zb->zb_flags & ZBUF_FLAG_ASSIGNED) == 0) {
+		zb->zb_flags |= ZBUF_FLAG_ASSIGNED;
+		zb->zb_header->bzh_kernel_len = d->bd_hlen;
+		atomic_add_rel_int(
+		    (volatile int *)&zb->zb_header->bzh_kernel_gen, 1);
+	}
+}
+
+/*
+ * The application acknowledged the former hold buffer and the kernel moved
+ * it into the free slot.
+ */
+void
+bpf_zerocopy_buf_reclaimed(struct bpf_d *d)
+{
+	struct zbuf *zb;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_buf_reclaimed: not in zbuf mode"));
+
+	zb = (struct zbuf *)d->bd_fbuf;
+	KASSERT(zb != NULL, ("bpf_zerocopy_buf_reclaimed: zb == NULL"));
+
+	zb->zb_flags &= ~ZBUF_FLAG_ASSIGNED;
+}
+
+/*
+ * The hold buffer may be reused once the application set bzh_user_gen to
+ * bzh_kernel_gen.
+ */
+int
+bpf_zerocopy_canfreebuf(struct bpf_d *d)
+{
+	struct bpf_zbuf_header *bzh;
+	struct zbuf *zb;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_canfreebuf: not in zbuf mode"));
+
+	zb = (struct zbuf *)d->bd_hbuf;
+	if (zb == NULL)
+		return (0);
+
+	bzh = zb->zb_header;
+	if (atomic_load_acq_int((volatile int *)&bzh->bzh_kernel_gen) ==
+	    atomic_load_acq_int((volatile int *)&bzh->bzh_user_gen))
+		return (1);
+
+	return (0);
+}
+
+/*
+ * A store buffer owned by the application must not be written.
+ */
+int
+bpf_zerocopy_canwritebuf(struct bpf_d *d)
+{
+	struct zbuf *zb;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_canwritebuf: not in zbuf mode"));
+
+	zb = (struct zbuf *)d->bd_sbuf;
+	KASSERT(zb != NULL, ("bpf_zerocopy_canwritebuf: zb == NULL"));
+
+	if (zb->zb_flags & ZBUF_FLAG_ASSIGNED)
+		return (0);
+
+	return (1);
+}
+
+/*
+ * Free the buffer descriptors on close.  The buffers belong to the
+ * application.
+ */
+void
+bpf_zerocopy_free(struct bpf_d *d)
+{
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_free: not in zbuf mode"));
+
+	free(d->bd_sbuf, M_BPF);
+	free(d->bd_hbuf, M_BPF);
+	free(d->bd_fbuf, M_BPF);
+}
+
+int
+bpf_zerocopy_ioctl_getzmax(struct thread *td, struct bpf_d *d, size_t *i)
+{
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_ioctl_getzmax: not in zbuf mode"));
+
+	*i = BPF_MAXBUFSIZE;
+	return (0);
+}
+
+/*
+ * Force a rotation of the store buffer, for example after a timeout, so that
+ * the application gets the packets of a partially filled buffer.  A hold
+ * buffer acknowledged by the application is reclaimed first, otherwise a
+ * descriptor with data in the store buffer would stay readable without a way
+ * to get the data.
+ */
+int
+bpf_zerocopy_ioctl_rotzbuf(struct thread *td, struct bpf_d *d,
+    struct bpf_zbuf *bz)
+{
+	struct zbuf *zb;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_ioctl_rotzbuf: not in zbuf mode"));
+
+	BPFD_LOCK(d);
+	if (d->bd_fbuf == NULL && bpf_zerocopy_canfreebuf(d)) {
+		d->bd_fbuf = d->bd_hbuf;
+		d->bd_hbuf = NULL;
+		d->bd_hlen = 0;
+		bpf_zerocopy_buf_reclaimed(d);
+	}
+	if (d->bd_hbuf == NULL && d->bd_slen != 0) {
+		ROTATE_BUFFERS(d);
+		zb = (struct zbuf *)d->bd_hbuf;
+		bz->bz_bufa = zb->zb_uaddr;
+		bz->bz_buflen = d->bd_hlen;
+	} else {
+		bz->bz_bufa = NULL;
+		bz->bz_buflen = 0;
+	}
+	BPFD_UNLOCK(d);
+	return (0);
+}
+
+static int
+zbuf_check(void *uaddr, size_t len)
+{
+
+	if (uaddr == NULL)
+		return (EINVAL);
+	if (((uintptr_t)uaddr & (BPF_ALIGNMENT - 1)) != 0)
+		return (EINVAL);
+	if ((uintptr_t)uaddr + len < (uintptr_t)uaddr)
+		return (EINVAL);
+	return (0);
+}
+
+/*
+ * Attach the two buffers of the application to the descriptor.  This is
+ * possible exactly once and only before the descriptor is attached to an
+ * interface.
+ */
+int
+bpf_zerocopy_ioctl_setzbuf(struct thread *td, struct bpf_d *d,
+    struct bpf_zbuf *bz)
+{
+	struct zbuf *zba, *zbb;
+	uintptr_t a, b;
+	int error;
+
+	KASSERT(d->bd_bufmode == BPF_BUFMODE_ZBUF,
+	    ("bpf_zerocopy_ioctl_setzbuf: not in zbuf mode"));
+
+	if (bz->bz_buflen <= sizeof(struct bpf_zbuf_header) ||
+	    bz->bz_buflen > BPF_MAXBUFSIZE)
+		return (EINVAL);
+
+	error = zbuf_check(bz->bz_bufa, bz->bz_buflen);
+	if (error != 0)
+		return (error);
+	error = zbuf_check(bz->bz_bufb, bz->bz_buflen);
+	if (error != 0)
+		return (error);
+
+	a = (uintptr_t)bz->bz_bufa;
+	b = (uintptr_t)bz->bz_bufb;
+	if (a < b + bz->bz_buflen && b < a + bz->bz_buflen)
+		return (EINVAL);
+
+	BPFD_LOCK(d);
+	if (d->bd_hbuf != NULL || d->bd_sbuf != NULL || d->bd_fbuf != NULL ||
+	    d->bd_bif != NULL) {
+		BPFD_UNLOCK(d);
+		return (EINVAL);
+	}
+	BPFD_UNLOCK(d);
+
+	zba = zbuf_setup(bz->bz_bufa, bz->bz_buflen);
+	zbb = zbuf_setup(bz->bz_bufb, bz->bz_buflen);
+
+	BPFD_LOCK(d);
+	if (d->bd_hbuf != NULL || d->bd_sbuf != NULL || d->bd_fbuf != NULL ||
+	    d->bd_bif != NULL) {
+		BPFD_UNLOCK(d);
+		free(zba, M_BPF);
+		free(zbb, M_BPF);
+		return (EINVAL);
+	}
+
+	/*
+	 * Point the free slot at zbb so that it is handed out second, the
+	 * application expects the kernel to fill bz_bufa first.
+	 */
+	d->bd_fbuf = (caddr_t)zbb;
+	d->bd_sbuf = (caddr_t)zba;
+	d->bd_slen = 0;
+	d->bd_hlen = 0;
+	d->bd_bufsize = bz->bz_buflen - sizeof(struct bpf_zbuf_header);
+	BPFD_UNLOCK(d);
+	return (0);
+}
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Software TCP segmentation offload for Ethernet interfaces.
+ *
+ * Most of the Ethernet controllers supported by RTEMS cannot segment TCP
+ * packets in hardware.  Without IFCAP_TSO4 the TCP output path runs once per
+ * MSS sized segment through TCP, IP, the packet filter and the Ethernet
+ * output.  For interfaces without IFCAP_TSO4 ether_gso_attach() puts the
+ * segmentation stage below in front of the transmit routine of the driver and
+ * advertises IFCAP_TSO4.  TCP then hands down super-segments of up to
+ * if_hw_tsomax bytes.  They pass the stack once and are split into MSS sized
+ * frames right before the driver.  The frames share the payload clusters of
+ * the super-segment and only the headers are copied.  The IPv4 header
+ * checksum and the TCP checksum of each frame are computed in one pass unless
+ * the driver offloads them.
+ *
+ * The segmentation stage also computes delayed TCP checksums for drivers
+ * without CSUM_IP_TCP, since TCP segmentation offload implies the TCP
+ * checksum offload in ip_output().
+ *
+ * The checksum offloads of the driver are taken from the current
+ * if_hwassist of the interface on each use, so that the drivers may change
+ * them at any time, for example in their SIOCSIFCAP handler.  The offloads emulated by the stage
+ * are recorded in if_gso_assist and are not attributed to the driver.
+ *
+ * The net.link.ether.gso.enable sysctl controls whether the interfaces
+ * advertise the emulated offload.  Drivers switch it for a single interface
+ * through ether_gso_setcap() in their SIOCSIFCAP handler.  Super-segments
+ * already in flight are segmented in any case.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <rtems/bsd/local/opt_inet.h>
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/lock.h>
+#include <sys/mbuf.h>
+#include <sys/socket.h>
+#include <sys/sx.h>
+#include <sys/sysctl.h>
+
+#include <machine/atomic.h>
+#include <machine/in_cksum.h>
+
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <net/if_var.h>
+#include <net/if_types.h>
+#include <net/if_gso.h>
+#include <net/vnet.h>
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+
+#ifdef INET
+/* Checksum offloads emulated by the segmentation stage */
+#define	ETHER_GSO_ASSIST	(CSUM_IP_TSO | CSUM_IP_TCP)
+
+static int ether_gso_enable = 1;
+
+static u_long ether_gso_packets;
+
+static u_long ether_gso_segments;
+
+static u_long ether_gso_drops;
+
+SYSCTL_DECL(_net_link_ether);
+
+static SYSCTL_NODE(_net_link_ether, OID_AUTO, gso, CTLFLAG_RW, 0,
+    "Software TCP segmentation offload");
+
+static void
+ether_gso_set(struct ifnet *ifp, int enable)
+{
+
+	if (enable) {
+		if ((ifp->if_capenable & IFCAP_TSO4) != 0)
+			return;
+
+		ifp->if_gso_assist = ETHER_GSO_ASSIST & ~ifp->if_hwassist;
+		ifp->if_capenable |= IFCAP_TSO4;
+		ifp->if_hwassist |= ETHER_GSO_ASSIST;
+	} else {
+		if ((ifp->if_capenable & IFCAP_TSO4) == 0)
+			return;
+
+		ifp->if_capenable &= ~IFCAP_TSO4;
+		ifp->if_hwassist &= ~ifp->if_gso_assist;
+		ifp->if_gso_assist = 0;
+	}
+}
+
+/*
+ * Returns the checksum offloads currently done by the driver.
+ */
+static uint64_t
+ether_gso_hwassist(const struct ifnet *ifp)
+{
+
+	return (ifp->if_hwassist & ~ifp->if_gso_assist);
+}
+
+static int
+ether_gso_sysctl_enable(SYSCTL_HANDLER_ARGS)
+{
+	struct ifnet *ifp;
+	int enable;
+	int error;
+
+	enable = ether_gso_enable;
+	error = sysctl_handle_int(oidp, &enable, 0, req);
+	if (error != 0 || req->newptr == NULL)
+		return (error);
+
+	enable = enable != 0;
+	IFNET_RLOCK();
+	ether_gso_enable = enable;
+	CK_STAILQ_FOREACH(ifp, &V_ifnet, if_link) {
+		if (ifp->if_gso_transmit != NULL)
+			ether_gso_set(ifp, enable);
+	}
+	IFNET_RUNLOCK();
+	return (0);
+}
+SYSCTL_PROC(_net_link_ether_gso, OID_AUTO, enable,
+    CTLTYPE_INT | CTLFLAG_RW | CTLFLAG_MPSAFE, NULL, 0,
+    ether_gso_sysctl_enable, "I",
+    "Advertise software TCP segmentation offload on Ethernet interfaces");
+
+SYSCTL_ULONG(_net_link_ether_gso, OID_AUTO, packets, CTLFLAG_RD,
+    &ether_gso_packets, 0, "Segmented super-segments");
+
+SYSCTL_ULONG(_net_link_ether_gso, OID_AUTO, segments, CTLFLAG_RD,
+    &ether_gso_segments, 0, "Frames produced by segmentation");
+
+SYSCTL_ULONG(_net_link_ether_gso, OID_AUTO, drops, CTLFLAG_RD,
+    &ether_gso_drops, 0, "Super-segments dropped due to errors");
+
+/*
+ * Returns the length of the Ethernet header and pulls up the Ethernet, IPv4
+ * and TCP headers into the first mbuf.  Returns 0 and frees the packet if this
+ * is not an IPv4 TCP packet.
+ */
+static int
+ether_gso_pullup(struct mbuf **mp, int *iphlen, int *thlen)
+{
+	struct mbuf *m;
+	struct ether_header *eh;
+	struct ip *ip;
+	struct tcphdr *th;
+	int ehlen;
+	uint16_t etype;
+
+	m = *mp;
+	ehlen = ETHER_HDR_LEN;
+	if (m->m_len < ehlen + (int)sizeof(*ip) &&
+	    (m = m_pullup(m, ehlen + sizeof(*ip))) == NULL)
+		goto bad;
+
+	eh = mtod(m, struct ether_header *);
+	etype = ntohs(eh->ether_type);
+	if (etype == ETHERTYPE_VLAN) {
+		struct ether_vlan_header *evl;
+
+		ehlen += ETHER_VLAN_ENCAP_LEN;
+		if (m->m_len < ehlen + (int)sizeof(*ip) &&
+		    (m = m_pullup(m, ehlen + sizeof(*ip))) == NULL)
+			goto bad;
+
+		evl = mtod(m, struct ether_vlan_header *);
+		etype = ntohs(evl->evl_proto);
+	}
+
+	if (etype != ETHERTYPE_IP)
+		goto bad;
+
+	ip = mtodo(m, ehlen);
+	if (ip->ip_p != IPPROTO_TCP)
+		goto bad;
+
+	*iphlen = ip->ip_hl << 2;
+	if (m->m_len < ehlen + *iphlen + (int)sizeof(*th) &&
+	    (m = m_pullup(m, ehlen + *iphlen + sizeof(*th))) == NULL)
+		goto bad;
+
+	th = mtodo(m, ehlen + *iphlen);
+	*thlen = th->th_off << 2;
+	if (m->m_len < ehlen + *iphlen + *thlen &&
+	    (m = m_pullup(m, ehlen + *iphlen + *thlen)) == NULL)
+		goto bad;
+
+	*mp = m;
+	return (ehlen);
+
+bad:
+	m_freem(m);
+	*mp = NULL;
+	return (0);
+}
+
+/*
+ * Computes the checksums of a frame according to the offloads of the driver.
+ * The headers must be in the first mbuf.
+ */
+static void
+ether_gso_cksum(struct ifnet *ifp, struct mbuf *m, int ehlen, int iphlen)
+{
+	struct ip *ip;
+	struct tcphdr *th;
+	uint64_t assist;
+
+	assist = ether_gso_hwassist(ifp);
+	ip = mtodo(m, ehlen);
+	th = mtodo(m, ehlen + iphlen);
+
+	if ((m->m_pkthdr.csum_flags & CSUM_IP) != 0 &&
+	    (assist & CSUM_IP) == 0) {
+		ip->ip_sum = in_cksum_skip(m, ehlen + iphlen, ehlen);
+		m->m_pkthdr.csum_flags &= ~CSUM_IP;
+	}
+
+	if ((m->m_pkthdr.csum_flags & CSUM_IP_TCP) != 0 &&
+	    (assist & CSUM_IP_TCP) == 0) {
+		th->th_sum = in_cksum_skip(m, ehlen + ntohs(ip->ip_len),
+		    ehlen + iphlen);
+		m->m_pkthdr.csum_flags &= ~CSUM_IP_TCP;
+	}
+}
+
+/*
+ * Splits a super-segment into MSS sized frames and hands them to the driver.
+ * Each frame gets a copy of the headers and references the payload of the
+ * super-segment.
+ */
+static int
+ether_gso_segment(struct ifnet *ifp, struct mbuf *m)
+{
+	struct ip *ip;
+	struct tcphdr *th;
+	struct mbuf *n;
+	int ehlen;
+	int iphlen;
+	int thlen;
+	int hlen;
+	int mss;
+	int total;
+	int off;
+	int len;
+	int error;
+	u_long segments;
+	uint32_t seq;
+	uint16_t id;
+
+	ehlen = ether_gso_pullup(&m, &iphlen, &thlen);
+	if (ehlen == 0) {
+		atomic_add_long((volatile long *)&ether_gso_drops, 1);
+		return (EINVAL);
+	}
+
+	hlen = ehlen + iphlen + thlen;
+	mss = m->m_pkthdr.tso_segsz;
+	total = m->m_pkthdr.len - hlen;
+	if (mss <= 0 || hlen + ETHER_ALIGN > MHLEN) {
+		m_freem(m);
+		atomic_add_long((volatile long *)&ether_gso_drops, 1);
+		return (EINVAL);
+	}
+
+	ip = mtodo(m, ehlen);
+	th = mtodo(m, ehlen + iphlen);
+	seq = ntohl(th->th_seq);
+	id = ntohs(ip->ip_id);
+	error = 0;
+	segments = 0;
+
+	for (off = 0; off < total; off += len) {
+		len = min(mss, total - off);
+
+		n = m_gethdr(M_NOWAIT, MT_DATA);
+		if (n == NULL) {
+			error = ENOBUFS;
+			break;
+		}
+
+		if (m_dup_pkthdr(n, m, M_NOWAIT) == 0) {
+			m_freem(n);
+			error = ENOBUFS;
+			break;
+		}
+
+		n->m_data += ETHER_ALIGN;
+		memcpy(mtod(n, char *), mtod(m, char *), hlen);
+		n->m_len = hlen;
+		n->m_next = m_copym(m, hlen + off, len, M_NOWAIT);
+		if (n->m_next == NULL) {
+			m_freem(n);
+			error = ENOBUFS;
+			break;
+		}
+
+		n->m_pkthdr.len = hlen + len;
+		n->m_pkthdr.csum_flags &= ~CSUM_TSO;
+		n->m_pkthdr.csum_flags |= CSUM_IP | CSUM_IP_TCP;
+		n->m_pkthdr.csum_data = offsetof(struct tcphdr, th_sum);
+		n->m_pkthdr.tso_segsz = 0;
+
+		ip = mtodo(n, ehlen);
+		ip->ip_len = htons(iphlen + thlen + len);
+		ip->ip_sum = 0;
+		if (ip->ip_id != 0)
+			ip->ip_id = htons(id + segments);
+
+		th = mtodo(n, ehlen + iphlen);
+		th->th_seq = htonl(seq + off);
+		if (off != 0)
+			th->th_flags &= ~TH_CWR;
+		if (off + len < total)
+			th->th_flags &= ~(TH_FIN | TH_PUSH);
+		th->th_sum = in_pseudo(ip->ip_src.s_addr, ip->ip_dst.s_addr,
+		    htons(thlen + len + IPPROTO_TCP));
+
+		ether_gso_cksum(ifp, n, ehlen, iphlen);
+
+		++segments;
+		error = (*ifp->if_gso_transmit)(ifp, n);
+		if (error != 0)
+			break;
+	}
+
+	m_freem(m);
+	atomic_add_long((volatile long *)&ether_gso_packets, 1);
+	atomic_add_long((volatile long *)&ether_gso_segments, segments);
+	if (error != 0)
+		atomic_add_long((volatile long *)&ether_gso_drops, 1);
+
+	return (error);
+}
+
+static int
+ether_gso_transmit(struct ifnet *ifp, struct mbuf *m)
+{
+	uint32_t flags;
+	int ehlen;
+	int iphlen;
+	int thlen;
+
+	flags = m->m_pkthdr.csum_flags;
+	if ((flags & CSUM_IP_TSO) != 0)
+		return (ether_gso_segment(ifp, m));
+
+	if ((flags & CSUM_IP_TCP & ~ether_gso_hwassist(ifp)) != 0) {
+		ehlen = ether_gso_pullup(&m, &iphlen, &thlen);
+		if (ehlen == 0) {
+			if_inc_counter(ifp, IFCOUNTER_OERRORS, 1);
+			return (EINVAL);
+		}
+
+		ether_gso_cksum(ifp, m, ehlen, iphlen);
+	}
+
+	return ((*ifp->if_gso_transmit)(ifp, m));
+}
+
+void
+ether_gso_attach(struct ifnet *ifp)
+{
+
+	if (ifp->if_type != IFT_ETHER ||
+	    (ifp->if_capabilities & IFCAP_TSO4) != 0)
+		return;
+
+	ifp->if_gso_transmit = ifp->if_transmit;
+	ifp->if_gso_assist = 0;
+	ifp->if_transmit = ether_gso_transmit;
+	ifp->if_capabilities |= IFCAP_TSO4;
+	ether_gso_set(ifp, ether_gso_enable);
+}
+
+void
+ether_gso_setcap(struct ifnet *ifp, int enable)
+{
+
+	if (ifp->if_gso_transmit != NULL)
+		ether_gso_set(ifp, enable);
+}
+#else /* !INET */
+void
+ether_gso_attach(struct ifnet *ifp)
+{
+
+	(void)ifp;
+}
+
+void
+ether_gso_setcap(struct ifnet *ifp, int enable)
+{
+
+	(void)ifp;
+	(void)enable;
+}
+#endif /* INET */
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+/*
+ * Adaptive switching between interrupt driven and polled operation of
+ * network devices.
+ *
+ * The device interrupt handlers run in the interrupt server task.  With one
+ * interrupt per frame or a few frames, each frame costs an interrupt, a task
+ * switch to the interrupt server and back.  In interrupt mode the interrupt
+ * handler processes at most the budget of received frames.  If it found at
+ * least the enter threshold of frames, then the device interrupts are
+ * disabled and the device is polled by an interrupt server request instead.
+ * Each poll processes at most the budget of frames and resubmits the request,
+ * so other interrupt handlers served by the same task get their turn.  After
+ * the idle rounds count of consecutive polls below the budget, the device
+ * interrupts are enabled again.
+ *
+ * Drivers with hardware interrupt coalescing provide a hook to switch it on
+ * and off.  It is switched on when the device enters polling mode, so that
+ * interrupts stay moderated while the load decreases.  It is switched off
+ * after the idle rounds count of interrupts with at most one frame, so that an
+ * idle device answers with low latency.  The drivers enable the coalescing
+ * initially.
+ *
+ * The interrupt handler and the poll request run in the same interrupt server
+ * task, so the state needs no lock.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/sysctl.h>
+
+#include <net/if_poll.h>
+
+#define	IF_POLL_BUDGET		64
+
+#define	IF_POLL_ENTER		16
+
+#define	IF_POLL_IDLE_ROUNDS	2
+
+static void
+if_poll_coalesce(struct if_poll *ip, bool enable)
+{
+
+	if (ip->ip_coalesce == NULL || ip->ip_coalescing == enable)
+		return;
+
+	ip->ip_coalescing = enable;
+	if (enable)
+		++ip->ip_coal_on;
+	else
+		++ip->ip_coal_off;
+
+	(*ip->ip_coalesce)(ip, enable);
+}
+
+static int
+if_poll_run(struct if_poll *ip, int budget)
+{
+	int work;
+
+	work = (*ip->ip_poll)(ip, budget);
+	ip->ip_frames += work;
+	if (work >= budget)
+		++ip->ip_exhausted;
+
+	return (work);
+}
+
+static void
+if_poll_request(void *arg)
+{
+	struct if_poll *ip;
+	int budget;
+	int work;
+
+	ip = arg;
+	++ip->ip_polls;
+	budget = max(ip->ip_budget, 1);
+	work = if_poll_run(ip, budget);
+
+	/* The driver disabled the interrupts before the detach */
+	if (ip->ip_detaching)
+		return;
+
+	if (work >= budget && ip->ip_enable) {
+		ip->ip_idle = 0;
+	} else if (++ip->ip_idle > ip->ip_idle_rounds || !ip->ip_enable) {
+		ip->ip_mode = IF_POLL_INTR;
+		ip->ip_idle = 0;
+		++ip->ip_to_intr;
+		(*ip->ip_intr)(ip, true);
+		return;
+	}
+
+	rtems_interrupt_server_request_submit(&ip->ip_request);
+}
+
+void
+if_poll_intr(struct if_poll *ip)
+{
+	int budget;
+	int work;
+
+	++ip->ip_intrs;
+
+	if (ip->ip_mode == IF_POLL_POLL) {
+		/* The driver enabled the interrupts, the request is pending */
+		(*ip->ip_intr)(ip, false);
+		return;
+	}
+
+	if (!ip->ip_enable) {
+		(void)if_poll_run(ip, INT_MAX);
+		return;
+	}
+
+	budget = max(ip->ip_budget, 1);
+	work = if_poll_run(ip, budget);
+
+	if (work >= min(max(ip->ip_enter, 1), budget)) {
+		ip->ip_mode = IF_POLL_POLL;
+		ip->ip_idle = 0;
+		++ip->ip_to_poll;
+		(*ip->ip_intr)(ip, false);
+		if_poll_coalesce(ip, true);
+		rtems_interrupt_server_request_submit(&ip->ip_request);
+	} else if (work <= 1) {
+		if (++ip->ip_idle > ip->ip_idle_rounds) {
+			ip->ip_idle = 0;
+			if_poll_coalesce(ip, false);
+		}
+	} else {
+		ip->ip_idle = 0;
+	}
+}
+
+void
+if_poll_attach(struct if_poll *ip, device_t dev)
+{
+	struct sysctl_ctx_list *ctx;
+	struct sysctl_oid_list *children;
+	struct sysctl_oid *tree;
+
+	ip->ip_mode = IF_POLL_INTR;
+	ip->ip_enable = 1;
+	ip->ip_budget = IF_POLL_BUDGET;
+	ip->ip_enter = IF_POLL_ENTER;
+	ip->ip_idle_rounds = IF_POLL_IDLE_ROUNDS;
+	ip->ip_coalescing = 1;
+	rtems_interrupt_server_request_initialize(
+	    RTEMS_INTERRUPT_SERVER_DEFAULT, &ip->ip_request, if_poll_request,
+	    ip);
+
+	ctx = device_get_sysctl_ctx(dev);
+	children = SYSCTL_CHILDREN(device_get_sysctl_tree(dev));
+	tree = SYSCTL_ADD_NODE(ctx, children, OID_AUTO, "poll", CTLFLAG_RD,
+	    NULL, "Adaptive polling");
+	children = SYSCTL_CHILDREN(tree);
+
+	SYSCTL_ADD_INT(ctx, children, OID_AUTO, "enable", CTLFLAG_RW,
+	    &ip->ip_enable, 0, "Switch to polling under load");
+	SYSCTL_ADD_INT(ctx, children, OID_AUTO, "budget", CTLFLAG_RW,
+	    &ip->ip_budget, 0, "Maximum frames per interrupt or poll");
+	SYSCTL_ADD_INT(ctx, children, OID_AUTO, "enter", CTLFLAG_RW,
+	    &ip->ip_enter, 0, "Frames in one interrupt which start polling");
+	SYSCTL_ADD_INT(ctx, children, OID_AUTO, "idle_rounds", CTLFLAG_RW,
+	    &ip->ip_idle_rounds, 0,
+	    "Light polls or interrupts before leaving polling or coalescing");
+	SYSCTL_ADD_INT(ctx, children, OID_AUTO, "mode", CTLFLAG_RD,
+	    &ip->ip_mode, 0, "Current mode (0 interrupts, 1 polling)");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "interrupts", CTLFLAG_RD,
+	    &ip->ip_intrs, 0, "Interrupts");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "polls", CTLFLAG_RD,
+	    &ip->ip_polls, 0, "Polls");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "frames", CTLFLAG_RD,
+	    &ip->ip_frames, 0, "Received frames");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "budget_exhausted", CTLFLAG_RD,
+	    &ip->ip_exhausted, 0, "Interrupts and polls which used the budget");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "to_poll", CTLFLAG_RD,
+	    &ip->ip_to_poll, 0, "Switches from interrupts to polling");
+	SYSCTL_ADD_U64(ctx, children, OID_AUTO, "to_intr", CTLFLAG_RD,
+	    &ip->ip_to_intr, 0, "Switches from polling to interrupts");
+	if (ip->ip_coalesce != NULL) {
+		SYSCTL_ADD_U64(ctx, children, OID_AUTO, "coalesce_on",
+		    CTLFLAG_RD, &ip->ip_coal_on, 0,
+		    "Interrupt coalescing switched on");
+		SYSCTL_ADD_U64(ctx, children, OID_AUTO, "coalesce_off",
+		    CTLFLAG_RD, &ip->ip_coal_off, 0,
+		    "Interrupt coalescing switched off");
+	}
+}
+
+void
+if_poll_detach(struct if_poll *ip)
+{
+
+	ip->ip_detaching = 1;
+	rtems_interrupt_server_request_destroy(&ip->ip_request);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _NET_IF_POLL_H_
+#define _NET_IF_POLL_H_
+
+#include <sys/types.h>
+#include <sys/bus.h>
+
+#include <rtems/irq-extension.h>
+
+struct if_poll;
+
+/*
+ * Processes at most budget received frames and reclaims completed transmit
+ * descriptors.  Returns the number of received frames.  Called with the driver
+ * lock not held.
+ */
+typedef int if_poll_fn_t(struct if_poll *, int budget);
+
+/*
+ * Enables or disables the receive and transmit completion interrupts of the
+ * device.  Completion events must stay pending in the device while the
+ * interrupts are disabled, so that enabling them raises the interrupt.
+ */
+typedef void if_poll_intr_fn_t(struct if_poll *, bool enable);
+
+/*
+ * Switches the hardware interrupt coalescing on or off.  Optional.
+ */
+typedef void if_poll_coalesce_fn_t(struct if_poll *, bool enable);
+
+enum if_poll_mode {
+	IF_POLL_INTR,
+	IF_POLL_POLL
+};
+
+struct if_poll {
+	void			*ip_softc;
+	if_poll_fn_t		*ip_poll;
+	if_poll_intr_fn_t	*ip_intr;
+	if_poll_coalesce_fn_t	*ip_coalesce;
+
+	/* The members below are private to if_poll.c */
+	rtems_interrupt_server_request ip_request;
+	int			ip_mode;	/* enum if_poll_mode */
+	int			ip_enable;
+	int			ip_budget;
+	int			ip_enter;
+	int			ip_idle_rounds;
+	int			ip_idle;
+	int			ip_coalescing;
+	volatile int		ip_detaching;
+	uint64_t		ip_intrs;
+	uint64_t		ip_polls;
+	uint64_t		ip_frames;
+	uint64_t		ip_exhausted;
+	uint64_t		ip_to_poll;
+	uint64_t		ip_to_intr;
+	uint64_t		ip_coal_on;
+	uint64_t		ip_coal_off;
+};
+
+/*
+ * Sets up the adaptive polling of a network device.  The ip_softc, ip_poll,
+ * ip_intr and ip_coalesce members must be initialized by the driver.  The
+ * settings and statistics are added to the sysctl tree of the device under
+ * the "poll" node.
+ */
+void	if_poll_attach(struct if_poll *ip, device_t dev);
+
+/*
+ * Waits for a pending poll request to finish and prevents it from resubmitting
+ * itself.  The device interrupts must be disabled by the driver before.
+ */
+void	if_poll_detach(struct if_poll *ip);
+
+/*
+ * Processes the receive and transmit completions signalled by an interrupt.
+ * The driver interrupt handler calls this after it acknowledged the interrupt
+ * and dealt with error conditions, with the driver lock not held.  If the
+ * interrupt carried enough work, then the interrupts are disabled and the
+ * device is polled from the interrupt server until it becomes idle.
+ */
+void	if_poll_intr(struct if_poll *ip);
+
+#endif /* _NET_IF_POLL_H_ */
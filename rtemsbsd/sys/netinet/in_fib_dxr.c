@@ -0,0 +1,605 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * IPv4 FIB lookup table with a 16 bit direct index and a range table (DXR,
+ * M. Zec and M. Mikuc, "Pushing the envelope: beyond two billion IP routing
+ * lookups per second on commodity CPUs").
+ *
+ * The table is compiled from the radix tree of the RIB by a task.  A route
+ * change increments the generation counter of the RIB head, which invalidates
+ * the table immediately and schedules a rebuild.  Bursts of route changes are
+ * coalesced into one rebuild.  Lookups use the radix tree until the rebuild
+ * is done.  The table is replaced atomically and the old table is freed after
+ * a net epoch grace period, so readers need no locks.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <rtems/bsd/local/opt_inet.h>
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/kernel.h>
+#include <sys/lock.h>
+#include <sys/malloc.h>
+#include <sys/mutex.h>
+#include <sys/rmlock.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <sys/taskqueue.h>
+#include <sys/epoch.h>
+
+#include <machine/atomic.h>
+
+#include <net/if.h>
+#include <net/if_var.h>
+#include <net/route.h>
+#include <net/route_var.h>
+
+#include <netinet/in.h>
+#include <netinet/in_var.h>
+#include <netinet/in_fib_dxr.h>
+
+#ifdef INET
+#define	DXR_DIRECT_BITS		16
+#define	DXR_DIRECT_SIZE		(1U << DXR_DIRECT_BITS)
+#define	DXR_RANGE_MASK		(DXR_DIRECT_SIZE - 1)
+#define	DXR_COUNT_BITS		12
+#define	DXR_COUNT_MASK		((1U << DXR_COUNT_BITS) - 1)
+#define	DXR_BASE_MAX		((1U << (32 - DXR_COUNT_BITS)) - 1)
+#define	DXR_NH_MAX		0xffffU
+
+/*
+ * A direct table entry either contains the next hop index in the upper bits
+ * and a zero count, or the index of the first range of the chunk in the upper
+ * bits and the count of ranges of the chunk in the lower bits.
+ */
+#define	DXR_DIRECT(base, count)	(((base) << DXR_COUNT_BITS) | (count))
+#define	DXR_DIRECT_BASE(e)	((e) >> DXR_COUNT_BITS)
+#define	DXR_DIRECT_COUNT(e)	((e) & DXR_COUNT_MASK)
+
+struct dxr_range {
+	uint16_t	dr_start;
+	uint16_t	dr_nh;
+};
+
+struct dxr {
+	uint32_t	d_direct[DXR_DIRECT_SIZE];
+	struct dxr_range *d_range;
+	struct rtentry	**d_nh;
+	uint32_t	d_range_count;
+	uint32_t	d_nh_count;
+	rt_gen_t	d_gen;
+};
+
+struct dxr_fib {
+	struct dxr	*df_dxr;
+	struct task	df_task;
+	uint32_t	df_fibnum;
+	volatile int	df_pending;
+	rt_gen_t	df_gen_attempted;
+};
+
+struct dxr_route {
+	uint32_t	dr_addr;
+	int		dr_plen;
+	struct rtentry	*dr_rte;
+};
+
+struct dxr_interval {
+	uint32_t	di_start;
+	uint32_t	di_nh;
+};
+
+struct dxr_walk {
+	struct dxr_route *dw_routes;
+	uint32_t	dw_count;
+	uint32_t	dw_max;
+};
+
+static MALLOC_DEFINE(M_DXR, "dxr", "IPv4 FIB lookup tables");
+
+static struct dxr_fib *dxr_fibs;
+
+static SYSCTL_NODE(_net_inet_ip, OID_AUTO, dxr, CTLFLAG_RW, 0,
+    "Compiled IPv4 FIB lookup tables");
+
+static int dxr_enable = 1;
+SYSCTL_INT(_net_inet_ip_dxr, OID_AUTO, enable, CTLFLAG_RWTUN, &dxr_enable, 0,
+    "Use compiled lookup tables for IPv4 FIB lookups");
+
+static u_long dxr_rebuilds;
+SYSCTL_ULONG(_net_inet_ip_dxr, OID_AUTO, rebuilds, CTLFLAG_RD, &dxr_rebuilds,
+    0, "Count of lookup table rebuilds");
+
+static u_long dxr_failures;
+SYSCTL_ULONG(_net_inet_ip_dxr, OID_AUTO, failures, CTLFLAG_RD, &dxr_failures,
+    0, "Count of lookup table rebuilds which exceeded the table limits");
+
+static u_long dxr_fallbacks;
+SYSCTL_ULONG(_net_inet_ip_dxr, OID_AUTO, fallbacks, CTLFLAG_RD,
+    &dxr_fallbacks, 0, "Count of lookups which used the radix tree");
+
+static u_int dxr_last_build_us;
+SYSCTL_UINT(_net_inet_ip_dxr, OID_AUTO, last_build_us, CTLFLAG_RD,
+    &dxr_last_build_us, 0, "Duration of the last rebuild in microseconds");
+
+static u_int dxr_routes;
+SYSCTL_UINT(_net_inet_ip_dxr, OID_AUTO, routes, CTLFLAG_RD, &dxr_routes, 0,
+    "Count of routes in the last built table");
+
+static u_int dxr_ranges;
+SYSCTL_UINT(_net_inet_ip_dxr, OID_AUTO, ranges, CTLFLAG_RD, &dxr_ranges, 0,
+    "Count of ranges in the last built table");
+
+static void
+dxr_schedule(struct dxr_fib *df, rt_gen_t gen)
+{
+
+	if (df->df_gen_attempted != gen &&
+	    atomic_cmpset_int(&df->df_pending, 0, 1))
+		taskqueue_enqueue(taskqueue_thread, &df->df_task);
+}
+
+int
+fib4_dxr_lookup(uint32_t fibnum, struct in_addr dst, struct rtentry **rte)
+{
+	struct dxr_fib *df;
+	struct rib_head *rh;
+	struct dxr *d;
+	struct dxr_range *r;
+	uint32_t addr;
+	uint32_t e;
+	uint32_t nh;
+	uint32_t lo;
+	uint32_t hi;
+
+	if (dxr_fibs == NULL || dxr_enable == 0)
+		return (EAGAIN);
+
+	df = &dxr_fibs[fibnum];
+	rh = rt_tables_get_rnh(fibnum, AF_INET);
+	d = (struct dxr *)atomic_load_acq_long((volatile long *)&df->df_dxr);
+
+	if (__predict_false(d == NULL || d->d_gen != rh->rnh_gen)) {
+		atomic_add_long((volatile long *)&dxr_fallbacks, 1);
+		dxr_schedule(df, rh->rnh_gen);
+		return (EAGAIN);
+	}
+
+	addr = ntohl(dst.s_addr);
+	e = d->d_direct[addr >> (32 - DXR_DIRECT_BITS)];
+	nh = DXR_DIRECT_BASE(e);
+
+	if (DXR_DIRECT_COUNT(e) != 0) {
+		uint16_t key;
+
+		r = &d->d_range[nh];
+		key = (uint16_t)(addr & DXR_RANGE_MASK);
+		lo = 0;
+		hi = DXR_DIRECT_COUNT(e) - 1;
+
+		while (lo < hi) {
+			uint32_t mid;
+
+			mid = (lo + hi + 1) / 2;
+			if (r[mid].dr_start <= key)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+
+		nh = r[lo].dr_nh;
+	}
+
+	*rte = d->d_nh[nh];
+	return (0);
+}
+
+static int
+dxr_prefix_len(const struct sockaddr_in *mask)
+{
+	uint32_t m;
+	int len;
+	int plen;
+
+	if (mask == NULL)
+		return (32);
+
+	m = 0;
+	len = mask->sin_len - (int)offsetof(struct sockaddr_in, sin_addr);
+	if (len > (int)sizeof(m))
+		len = sizeof(m);
+	if (len > 0)
+		memcpy(&m, &mask->sin_addr, len);
+
+	m = ntohl(m);
+	plen = 0;
+	while (plen < 32 && (m & (0x80000000U >> plen)) != 0)
+		++plen;
+
+	if (plen < 32 && (m << plen) != 0)
+		return (-1);
+
+	return (plen);
+}
+
+static int
+dxr_walk_route(struct radix_node *rn, void *arg)
+{
+	struct dxr_walk *dw;
+	struct rtentry *rt;
+	struct dxr_route *dr;
+	int plen;
+
+	dw = arg;
+	rt = (struct rtentry *)rn;
+
+	if (dw->dw_routes == NULL) {
+		++dw->dw_count;
+		return (0);
+	}
+
+	if (dw->dw_count == dw->dw_max)
+		return (ENOMEM);
+
+	plen = dxr_prefix_len((const struct sockaddr_in *)rt_mask(rt));
+	if (plen < 0)
+		return (EINVAL);
+
+	dr = &dw->dw_routes[dw->dw_count];
+	dr->dr_plen = plen;
+	dr->dr_addr = ntohl(((struct sockaddr_in *)rt_key(rt))->sin_addr.s_addr);
+	if (plen < 32)
+		dr->dr_addr &= ~(0xffffffffU >> plen);
+	dr->dr_rte = rt;
+
+	RT_LOCK(rt);
+	RT_ADDREF(rt);
+	RT_UNLOCK(rt);
+
+	++dw->dw_count;
+	return (0);
+}
+
+static int
+dxr_route_cmp(const void *a, const void *b)
+{
+	const struct dxr_route *ra;
+	const struct dxr_route *rb;
+
+	ra = a;
+	rb = b;
+
+	if (ra->dr_addr != rb->dr_addr)
+		return (ra->dr_addr < rb->dr_addr ? -1 : 1);
+
+	return (ra->dr_plen - rb->dr_plen);
+}
+
+static void
+dxr_emit(struct dxr_interval *iv, uint32_t *n, uint32_t start, uint32_t nh)
+{
+	uint32_t i;
+
+	i = *n;
+
+	if (i > 0 && iv[i - 1].di_start == start) {
+		/* A more specific prefix starts at the same address */
+		if (i > 1 && iv[i - 2].di_nh == nh)
+			*n = i - 1;
+		else
+			iv[i - 1].di_nh = nh;
+	} else if (i == 0 || iv[i - 1].di_nh != nh) {
+		iv[i].di_start = start;
+		iv[i].di_nh = nh;
+		*n = i + 1;
+	}
+}
+
+/*
+ * Flattens the sorted prefixes into intervals which cover the address space
+ * and are associated with the next hop of the most specific prefix.
+ */
+static uint32_t
+dxr_flatten(const struct dxr_route *routes, uint32_t count,
+    struct dxr_interval *iv)
+{
+	uint64_t stack_end[33];
+	uint32_t stack_nh[33];
+	uint32_t depth;
+	uint32_t n;
+	uint32_t i;
+
+	depth = 0;
+	n = 0;
+	dxr_emit(iv, &n, 0, 0);
+
+	for (i = 0; i < count; ++i) {
+		const struct dxr_route *dr;
+		uint64_t start;
+
+		dr = &routes[i];
+		start = dr->dr_addr;
+
+		/* Duplicated keys, e.g. for multipath routes */
+		if (i > 0 && dr->dr_addr == routes[i - 1].dr_addr &&
+		    dr->dr_plen == routes[i - 1].dr_plen)
+			continue;
+
+		while (depth > 0 && stack_end[depth - 1] < start) {
+			--depth;
+			dxr_emit(iv, &n, (uint32_t)(stack_end[depth] + 1),
+			    depth > 0 ? stack_nh[depth - 1] : 0);
+		}
+
+		dxr_emit(iv, &n, dr->dr_addr, i + 1);
+		stack_end[depth] = start + (1ULL << (32 - dr->dr_plen)) - 1;
+		stack_nh[depth] = i + 1;
+		++depth;
+	}
+
+	while (depth > 0) {
+		--depth;
+		if (stack_end[depth] < 0xffffffffULL)
+			dxr_emit(iv, &n, (uint32_t)(stack_end[depth] + 1),
+			    depth > 0 ? stack_nh[depth - 1] : 0);
+	}
+
+	return (n);
+}
+
+/*
+ * Fills the direct table and the range table (if not NULL) from the
+ * intervals.  Returns the count of ranges or zero if the table limits are
+ * exceeded.
+ */
+static uint32_t
+dxr_fill(struct dxr *d, const struct dxr_interval *iv, uint32_t n,
+    struct dxr_range *range)
+{
+	uint32_t range_count;
+	uint32_t chunk;
+	uint32_t j;
+
+	range_count = 0;
+	j = 0;
+
+	for (chunk = 0; chunk < DXR_DIRECT_SIZE; ++chunk) {
+		uint32_t chunk_start;
+		uint32_t chunk_end;
+		uint32_t k;
+		uint32_t count;
+
+		chunk_start = chunk << (32 - DXR_DIRECT_BITS);
+		chunk_end = chunk_start | DXR_RANGE_MASK;
+
+		while (j + 1 < n && iv[j + 1].di_start <= chunk_start)
+			++j;
+
+		k = j + 1;
+		while (k < n && iv[k].di_start <= chunk_end)
+			++k;
+
+		count = k - j;
+		if (count == 1) {
+			d->d_direct[chunk] = DXR_DIRECT(iv[j].di_nh, 0);
+			continue;
+		}
+
+		if (count > DXR_COUNT_MASK || range_count > DXR_BASE_MAX)
+			return (0);
+
+		if (range != NULL) {
+			uint32_t i;
+
+			d->d_direct[chunk] = DXR_DIRECT(range_count, count);
+			for (i = j; i < k; ++i) {
+				struct dxr_range *r;
+
+				r = &range[range_count + i - j];
+				r->dr_start = i == j ? 0 :
+				    (uint16_t)(iv[i].di_start & DXR_RANGE_MASK);
+				r->dr_nh = (uint16_t)iv[i].di_nh;
+			}
+		}
+
+		range_count += count;
+	}
+
+	/* Make sure that a table without ranges is not reported as failure */
+	return (range_count + 1);
+}
+
+static void
+dxr_free(struct dxr *d)
+{
+	uint32_t i;
+
+	if (d == NULL)
+		return;
+
+	for (i = 1; i < d->d_nh_count; ++i) {
+		struct rtentry *rt;
+
+		rt = d->d_nh[i];
+		RTFREE(rt);
+	}
+
+	free(d->d_range, M_DXR);
+	free(d->d_nh, M_DXR);
+	free(d, M_DXR);
+}
+
+static struct dxr *
+dxr_build(struct rib_head *rh, rt_gen_t *gen)
+{
+	RIB_RLOCK_TRACKER;
+	struct dxr_walk dw;
+	struct dxr_interval *iv;
+	struct dxr *d;
+	uint32_t n;
+	uint32_t range_count;
+	uint32_t i;
+	int error;
+
+	do {
+		memset(&dw, 0, sizeof(dw));
+		RIB_RLOCK(rh);
+		rh->rnh_walktree(&rh->head, dxr_walk_route, &dw);
+		*gen = rh->rnh_gen;
+		RIB_RUNLOCK(rh);
+
+		dw.dw_max = dw.dw_count;
+		dw.dw_count = 0;
+		dw.dw_routes = malloc((dw.dw_max + 1) * sizeof(*dw.dw_routes),
+		    M_DXR, M_WAITOK);
+
+		RIB_RLOCK(rh);
+		if (*gen == rh->rnh_gen) {
+			error = rh->rnh_walktree(&rh->head, dxr_walk_route,
+			    &dw);
+		} else {
+			error = EAGAIN;
+		}
+		RIB_RUNLOCK(rh);
+
+		if (error != 0) {
+			for (i = 0; i < dw.dw_count; ++i)
+				RTFREE(dw.dw_routes[i].dr_rte);
+			free(dw.dw_routes, M_DXR);
+		}
+	} while (error == EAGAIN);
+
+	if (error != 0)
+		return (NULL);
+
+	d = NULL;
+	iv = NULL;
+
+	if (dw.dw_count + 1 > DXR_NH_MAX)
+		goto done;
+
+	qsort(dw.dw_routes, dw.dw_count, sizeof(*dw.dw_routes),
+	    dxr_route_cmp);
+
+	iv = malloc((2 * dw.dw_count + 1) * sizeof(*iv), M_DXR, M_WAITOK);
+	n = dxr_flatten(dw.dw_routes, dw.dw_count, iv);
+
+	d = malloc(sizeof(*d), M_DXR, M_WAITOK | M_ZERO);
+	d->d_gen = *gen;
+	d->d_nh_count = dw.dw_count + 1;
+	d->d_nh = malloc(d->d_nh_count * sizeof(*d->d_nh), M_DXR, M_WAITOK);
+	d->d_nh[0] = NULL;
+	for (i = 0; i < dw.dw_count; ++i)
+		d->d_nh[i + 1] = dw.dw_routes[i].dr_rte;
+
+	range_count = dxr_fill(d, iv, n, NULL);
+	if (range_count == 0) {
+		dxr_free(d);
+		d = NULL;
+		goto done;
+	}
+
+	d->d_range_count = range_count - 1;
+	d->d_range = malloc((d->d_range_count + 1) * sizeof(*d->d_range),
+	    M_DXR, M_WAITOK);
+	(void)dxr_fill(d, iv, n, d->d_range);
+
+	dxr_routes = dw.dw_count;
+	dxr_ranges = d->d_range_count;
+
+done:
+	if (d == NULL) {
+		for (i = 0; i < dw.dw_count; ++i)
+			RTFREE(dw.dw_routes[i].dr_rte);
+	}
+
+	free(iv, M_DXR);
+	free(dw.dw_routes, M_DXR);
+	return (d);
+}
+
+static void
+dxr_build_task(void *arg, int pending)
+{
+	struct dxr_fib *df;
+	struct rib_head *rh;
+	struct dxr *d;
+	struct dxr *old;
+	sbintime_t begin;
+	rt_gen_t gen;
+
+	df = arg;
+	rh = rt_tables_get_rnh(df->df_fibnum, AF_INET);
+	atomic_store_rel_int(&df->df_pending, 0);
+
+	begin = sbinuptime();
+	d = dxr_build(rh, &gen);
+	df->df_gen_attempted = gen;
+	dxr_last_build_us = (u_int)((sbinuptime() - begin) / SBT_1US);
+
+	if (d != NULL)
+		++dxr_rebuilds;
+	else
+		++dxr_failures;
+
+	old = df->df_dxr;
+	atomic_store_rel_long((volatile long *)&df->df_dxr, (long)d);
+
+	if (old != NULL) {
+		epoch_wait_preempt(net_epoch_preempt);
+		dxr_free(old);
+	}
+}
+
+static void
+dxr_init(void *arg)
+{
+	struct dxr_fib *fibs;
+	uint32_t fibnum;
+
+	fibs = malloc(rt_numfibs * sizeof(*fibs), M_DXR, M_WAITOK | M_ZERO);
+
+	for (fibnum = 0; fibnum < rt_numfibs; ++fibnum) {
+		struct dxr_fib *df;
+
+		df = &fibs[fibnum];
+		df->df_fibnum = fibnum;
+		df->df_gen_attempted = (rt_gen_t)-1;
+		TASK_INIT(&df->df_task, 0, dxr_build_task, df);
+	}
+
+	dxr_fibs = fibs;
+}
+SYSINIT(dxr, SI_SUB_PROTO_DOMAIN, SI_ORDER_ANY, dxr_init, NULL);
+#endif /* INET */
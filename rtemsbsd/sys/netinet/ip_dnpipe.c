@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Network emulation pipes in the spirit of dummynet(4) for IPv4.
+ *
+ * A pipe emulates a link with a bandwidth, a propagation delay, a random
+ * packet loss and a queue in front of the link.  Packets enter a pipe in two
+ * ways:
+ *
+ *  - through a pfil(9) hook, if the pipe is bound to an interface name, for
+ *    example an epair(4) end or the loopback interface, or
+ *
+ *  - through pf(4), if the pipe is bound to a tag name and a pf rule puts
+ *    this tag on the packet ("pass out on lo0 tag wan").
+ *
+ * Packets wait first in the link queue for the emulated transmission and then
+ * in the delay line.  Once they are due they are re-injected with ip_output()
+ * or netisr_dispatch().  The packet tag remembers the direction, so that
+ * re-injected packets pass the pipes of this direction.
+ *
+ * The pipes are configured by the sysctls below net.inet.ip.dnpipe.<unit>.
+ * The hooks are only installed while at least one pipe is bound.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <rtems/bsd/local/opt_inet.h>
+
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/callout.h>
+#include <sys/kernel.h>
+#include <sys/limits.h>
+#include <sys/lock.h>
+#include <sys/mbuf.h>
+#include <sys/mutex.h>
+#include <sys/socket.h>
+#include <sys/sx.h>
+#include <sys/sysctl.h>
+
+#include <net/if.h>
+#include <net/if_var.h>
+#include <net/netisr.h>
+#include <net/pfil.h>
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_var.h>
+
+#ifdef INET
+#define	DNPIPE_COUNT		4
+#define	DNPIPE_QSIZE_DEFAULT	50
+#define	DNPIPE_DELAY_LINE_MAX	8192
+#define	DNPIPE_NAME_SIZE	64
+
+#define	DNPIPE_SYSCTL_IFNAME	0
+#define	DNPIPE_SYSCTL_PFTAG	1
+
+struct dnpipe_pkt {
+	sbintime_t	when;
+	int		dir;
+};
+
+struct dnpipe {
+	struct mtx	mtx;
+	struct callout	callout;
+	/* Packets which wait for the transmission on the emulated link */
+	struct mbufq	link_queue;
+	/* Packets which wait for the end of the emulated propagation delay */
+	struct mbufq	delay_line;
+	/* End of the transmission of the last packet on the emulated link */
+	sbintime_t	link_free;
+	sbintime_t	next_event;
+	/* Configuration */
+	u_int		delay;		/* ms */
+	u_int		bandwidth;	/* kbit/s, zero means unlimited */
+	u_int		loss;		/* parts per million */
+	u_int		qsize;		/* packets */
+	u_int		dir;		/* PFIL_IN and/or PFIL_OUT */
+	char		ifname[IFNAMSIZ];
+	char		pftag[DNPIPE_NAME_SIZE];
+	/* Statistics */
+	u_long		packets;
+	u_long		bytes;
+	u_long		loss_drops;
+	u_long		queue_drops;
+};
+
+static struct dnpipe dnpipes[DNPIPE_COUNT];
+
+static struct sx dnpipe_sx;
+
+static bool dnpipe_pfil_hooked;
+
+static SYSCTL_NODE(_net_inet_ip, OID_AUTO, dnpipe, CTLFLAG_RW, 0,
+    "Network emulation pipes");
+
+static struct dnpipe_pkt *
+dnpipe_pkt(struct mbuf *m)
+{
+	struct m_tag *mtag;
+
+	mtag = m_tag_find(m, PACKET_TAG_DUMMYNET, NULL);
+	if (mtag == NULL)
+		return (NULL);
+
+	return ((struct dnpipe_pkt *)(mtag + 1));
+}
+
+static sbintime_t
+dnpipe_tx_time(const struct dnpipe *p, int len)
+{
+
+	return ((sbintime_t)len * 8 * SBT_1S / ((sbintime_t)p->bandwidth *
+	    1000));
+}
+
+static void dnpipe_timeout(void *arg);
+
+static void
+dnpipe_schedule(struct dnpipe *p)
+{
+	struct mbuf *m;
+	sbintime_t next;
+
+	mtx_assert(&p->mtx, MA_OWNED);
+
+	next = SBT_MAX;
+
+	m = mbufq_first(&p->link_queue);
+	if (m != NULL)
+		next = dnpipe_pkt(m)->when;
+
+	m = mbufq_first(&p->delay_line);
+	if (m != NULL)
+		next = MIN(next, dnpipe_pkt(m)->when);
+
+	if (next == SBT_MAX)
+		return;
+
+	if (!callout_pending(&p->callout) || next < p->next_event) {
+		p->next_event = next;
+		callout_reset_sbt(&p->callout, next, 0, dnpipe_timeout, p,
+		    C_ABSOLUTE);
+	}
+}
+
+/*
+ * Takes the packet and queues it in the pipe.  A packet lost on the emulated
+ * link is dropped silently.
+ */
+static void
+dnpipe_enqueue(struct dnpipe *p, struct mbuf *m, struct dnpipe_pkt *pkt,
+    int dir)
+{
+	sbintime_t now;
+	int len;
+
+	mtx_assert(&p->mtx, MA_OWNED);
+
+	len = m->m_pkthdr.len;
+
+	if (p->loss != 0 && arc4random() % 1000000 < p->loss) {
+		++p->loss_drops;
+		m_freem(m);
+		return;
+	}
+
+	now = sbinuptime();
+	pkt->dir = dir;
+
+	if (p->bandwidth != 0) {
+		if (mbufq_len(&p->link_queue) >= p->qsize) {
+			++p->queue_drops;
+			m_freem(m);
+			return;
+		}
+
+		p->link_free = MAX(p->link_free, now) + dnpipe_tx_time(p, len);
+		pkt->when = p->link_free;
+		(void)mbufq_enqueue(&p->link_queue, m);
+	} else {
+		if (mbufq_len(&p->delay_line) >= DNPIPE_DELAY_LINE_MAX) {
+			++p->queue_drops;
+			m_freem(m);
+			return;
+		}
+
+		pkt->when = now + (sbintime_t)p->delay * SBT_1MS;
+		(void)mbufq_enqueue(&p->delay_line, m);
+	}
+
+	++p->packets;
+	p->bytes += len;
+	dnpipe_schedule(p);
+}
+
+static void
+dnpipe_timeout(void *arg)
+{
+	struct dnpipe *p;
+	struct mbufq due;
+	struct mbuf *m;
+	sbintime_t now;
+
+	p = arg;
+	mbufq_init(&due, INT_MAX);
+	now = sbinuptime();
+
+	mtx_lock(&p->mtx);
+
+	while ((m = mbufq_first(&p->link_queue)) != NULL) {
+		struct dnpipe_pkt *pkt;
+
+		pkt = dnpipe_pkt(m);
+		if (pkt->when > now)
+			break;
+
+		(void)mbufq_dequeue(&p->link_queue);
+		pkt->when += (sbintime_t)p->delay * SBT_1MS;
+		(void)mbufq_enqueue(&p->delay_line, m);
+	}
+
+	while ((m = mbufq_first(&p->delay_line)) != NULL) {
+		if (dnpipe_pkt(m)->when > now)
+			break;
+
+		(void)mbufq_dequeue(&p->delay_line);
+		(void)mbufq_enqueue(&due, m);
+	}
+
+	dnpipe_schedule(p);
+	mtx_unlock(&p->mtx);
+
+	while ((m = mbufq_dequeue(&due)) != NULL) {
+		if (dnpipe_pkt(m)->dir == PFIL_OUT)
+			(void)ip_output(m, NULL, NULL, IP_FORWARDING, NULL,
+			    NULL);
+		else
+			netisr_dispatch(NETISR_IP, m);
+	}
+}
+
+/*
+ * Returns the packet tag, allocates it if necessary.  Sets *passed to true
+ * if the packet left a pipe of this direction already.
+ */
+static struct dnpipe_pkt *
+dnpipe_classify_prepare(struct mbuf **mp, int dir, bool *passed)
+{
+	struct m_tag *mtag;
+	struct dnpipe_pkt *pkt;
+
+	pkt = dnpipe_pkt(*mp);
+	if (pkt != NULL) {
+		*passed = (pkt->dir == dir);
+		return (pkt);
+	}
+
+	*passed = false;
+	mtag = m_tag_get(PACKET_TAG_DUMMYNET, sizeof(*pkt), M_NOWAIT);
+	if (mtag == NULL)
+		return (NULL);
+
+	m_tag_prepend(*mp, mtag);
+	pkt = (struct dnpipe_pkt *)(mtag + 1);
+	pkt->dir = 0;
+	return (pkt);
+}
+
+static int
+dnpipe_input(struct mbuf **mp, int dir, const char *ifname,
+    const char *pftag)
+{
+	struct dnpipe_pkt *pkt;
+	bool passed;
+	size_t i;
+
+	pkt = NULL;
+
+	for (i = 0; i < nitems(dnpipes); ++i) {
+		struct dnpipe *p;
+		bool match;
+
+		p = &dnpipes[i];
+		mtx_lock(&p->mtx);
+
+		if ((p->dir & dir) == 0)
+			match = false;
+		else if (ifname != NULL)
+			match = (strcmp(p->ifname, ifname) == 0);
+		else
+			match = (strcmp(p->pftag, pftag) == 0);
+
+		if (match) {
+			pkt = dnpipe_classify_prepare(mp, dir, &passed);
+			if (pkt == NULL) {
+				mtx_unlock(&p->mtx);
+				m_freem(*mp);
+				*mp = NULL;
+				return (ENOBUFS);
+			}
+
+			if (!passed) {
+				dnpipe_enqueue(p, *mp, pkt, dir);
+				*mp = NULL;
+			}
+
+			mtx_unlock(&p->mtx);
+			return (0);
+		}
+
+		mtx_unlock(&p->mtx);
+	}
+
+	return (0);
+}
+
+static int
+dnpipe_check(void *arg, struct mbuf **mp, struct ifnet *ifp, int dir,
+    struct inpcb *inp)
+{
+
+	(void)arg;
+	(void)inp;
+
+	return (dnpipe_input(mp, dir, ifp->if_xname, NULL));
+}
+
+static int
+dnpipe_pf(struct mbuf **mp, struct ifnet *ifp, int dir, const char *tagname)
+{
+
+	(void)ifp;
+
+	return (dnpipe_input(mp, dir, NULL, tagname));
+}
+
+static void
+dnpipe_update_hooks(void)
+{
+	struct pfil_head *ph;
+	bool need_pfil;
+	bool need_pf;
+	size_t i;
+
+	need_pfil = false;
+	need_pf = false;
+
+	sx_xlock(&dnpipe_sx);
+
+	for (i = 0; i < nitems(dnpipes); ++i) {
+		struct dnpipe *p;
+
+		p = &dnpipes[i];
+		mtx_lock(&p->mtx);
+		need_pfil |= (p->ifname[0] != '\0');
+		need_pf |= (p->pftag[0] != '\0');
+		mtx_unlock(&p->mtx);
+	}
+
+	ph = pfil_head_get(PFIL_TYPE_AF, AF_INET);
+	if (ph != NULL && need_pfil != dnpipe_pfil_hooked) {
+		int error;
+
+		if (need_pfil)
+			error = pfil_add_hook(dnpipe_check, NULL,
+			    PFIL_ALL | PFIL_WAITOK, ph);
+		else
+			error = pfil_remove_hook(dnpipe_check, NULL,
+			    PFIL_ALL | PFIL_WAITOK, ph);
+
+		if (error == 0)
+			dnpipe_pfil_hooked = need_pfil;
+	}
+
+	ip_dnpipe_pf_ptr = need_pf ? dnpipe_pf : NULL;
+
+	sx_xunlock(&dnpipe_sx);
+}
+
+static int
+dnpipe_sysctl_name(SYSCTL_HANDLER_ARGS)
+{
+	char buf[DNPIPE_NAME_SIZE];
+	struct dnpipe *p;
+	char *name;
+	size_t size;
+	int error;
+
+	p = arg1;
+
+	if (arg2 == DNPIPE_SYSCTL_IFNAME) {
+		name = p->ifname;
+		size = sizeof(p->ifname);
+	} else {
+		name = p->pftag;
+		size = sizeof(p->pftag);
+	}
+
+	mtx_lock(&p->mtx);
+	strlcpy(buf, name, size);
+	mtx_unlock(&p->mtx);
+
+	error = sysctl_handle_string(oidp, buf, size, req);
+	if (error != 0 || req->newptr == NULL)
+		return (error);
+
+	mtx_lock(&p->mtx);
+	strlcpy(name, buf, size);
+	mtx_unlock(&p->mtx);
+
+	dnpipe_update_hooks();
+	return (0);
+}
+
+static int
+dnpipe_sysctl_uint(SYSCTL_HANDLER_ARGS)
+{
+	struct dnpipe *p;
+	u_int *field;
+	u_int val;
+	int error;
+
+	p = arg1;
+	field = (u_int *)((char *)p + arg2);
+
+	mtx_lock(&p->mtx);
+	val = *field;
+	mtx_unlock(&p->mtx);
+
+	error = sysctl_handle_int(oidp, &val, 0, req);
+	if (error != 0 || req->newptr == NULL)
+		return (error);
+
+	if (field == &p->loss && val > 1000000)
+		return (EINVAL);
+
+	if (field == &p->qsize && val == 0)
+		return (EINVAL);
+
+	if (field == &p->dir && (val & ~PFIL_ALL) != 0)
+		return (EINVAL);
+
+	mtx_lock(&p->mtx);
+	*field = val;
+	mtx_unlock(&p->mtx);
+	return (0);
+}
+
+static void
+dnpipe_init(void *arg)
+{
+	size_t i;
+
+	(void)arg;
+
+	sx_init(&dnpipe_sx, "dnpipe");
+
+	for (i = 0; i < nitems(dnpipes); ++i) {
+		struct sysctl_oid_list *children;
+		struct sysctl_oid *node;
+		struct dnpipe *p;
+		char unit[4];
+
+		p = &dnpipes[i];
+		mtx_init(&p->mtx, "dnpipe", NULL, MTX_DEF);
+		callout_init(&p->callout, 1);
+		mbufq_init(&p->link_queue, INT_MAX);
+		mbufq_init(&p->delay_line, INT_MAX);
+		p->qsize = DNPIPE_QSIZE_DEFAULT;
+		p->dir = PFIL_ALL;
+
+		snprintf(unit, sizeof(unit), "%zu", i);
+		node = SYSCTL_ADD_NODE(NULL,
+		    SYSCTL_STATIC_CHILDREN(_net_inet_ip_dnpipe), OID_AUTO,
+		    unit, CTLFLAG_RW, NULL, "Network emulation pipe");
+		children = SYSCTL_CHILDREN(node);
+
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "ifname",
+		    CTLTYPE_STRING | CTLFLAG_RW, p, DNPIPE_SYSCTL_IFNAME,
+		    dnpipe_sysctl_name, "A",
+		    "Name of the interface which feeds the pipe");
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "pftag",
+		    CTLTYPE_STRING | CTLFLAG_RW, p, DNPIPE_SYSCTL_PFTAG,
+		    dnpipe_sysctl_name, "A",
+		    "Name of the pf tag which feeds the pipe");
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "dir",
+		    CTLTYPE_UINT | CTLFLAG_RW, p, offsetof(struct dnpipe, dir),
+		    dnpipe_sysctl_uint, "IU",
+		    "Directions fed into the pipe (1: in, 2: out, 3: both)");
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "delay",
+		    CTLTYPE_UINT | CTLFLAG_RW, p,
+		    offsetof(struct dnpipe, delay), dnpipe_sysctl_uint, "IU",
+		    "Propagation delay in milliseconds");
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "bandwidth",
+		    CTLTYPE_UINT | CTLFLAG_RW, p,
+		    offsetof(struct dnpipe, bandwidth), dnpipe_sysctl_uint,
+		    "IU", "Bandwidth in kbit/s, zero means unlimited");
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "loss",
+		    CTLTYPE_UINT | CTLFLAG_RW, p,
+		    offsetof(struct dnpipe, loss), dnpipe_sysctl_uint, "IU",
+		    "Packet loss in parts per million");
+		SYSCTL_ADD_PROC(NULL, children, OID_AUTO, "qsize",
+		    CTLTYPE_UINT | CTLFLAG_RW, p,
+		    offsetof(struct dnpipe, qsize), dnpipe_sysctl_uint, "IU",
+		    "Link queue size in packets");
+		SYSCTL_ADD_ULONG(NULL, children, OID_AUTO, "packets",
+		    CTLFLAG_RD, &p->packets, "Packets queued");
+		SYSCTL_ADD_ULONG(NULL, children, OID_AUTO, "bytes",
+		    CTLFLAG_RD, &p->bytes, "Bytes queued");
+		SYSCTL_ADD_ULONG(NULL, children, OID_AUTO, "loss_drops",
+		    CTLFLAG_RD, &p->loss_drops, "Packets lost on the link");
+		SYSCTL_ADD_ULONG(NULL, children, OID_AUTO, "queue_drops",
+		    CTLFLAG_RD, &p->queue_drops,
+		    "Packets dropped due to a full queue");
+	}
+}
+SYSINIT(dnpipe, SI_SUB_PROTO_FIREWALL, SI_ORDER_ANY, dnpipe_init, NULL);
+#endif /* INET */
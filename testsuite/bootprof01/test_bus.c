@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * A bus with a slow attach, which is deferred by the test.  The attach of each
+ * unit sleeps and then adds a child device.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/systm.h>
+#include <sys/bus.h>
+#include <sys/kernel.h>
+#include <sys/module.h>
+
+#include <rtems.h>
+
+#include "test_bootprof01.h"
+
+test_bus_state test_bus_states[TEST_BUS_COUNT];
+
+static int
+test_bus_probe(device_t dev)
+{
+
+	device_set_desc(dev, "Slow Test Bus");
+	return (BUS_PROBE_DEFAULT);
+}
+
+static int
+test_bus_attach(device_t dev)
+{
+	test_bus_state *state;
+	int unit;
+
+	unit = device_get_unit(dev);
+	KASSERT(unit >= 0 && unit < TEST_BUS_COUNT, ("bad unit"));
+	state = &test_bus_states[unit];
+
+	state->attach_task = rtems_task_self();
+	state->attach_begin = rtems_clock_get_uptime_nanoseconds();
+
+	/* The sleep releases Giant */
+	pause("tstbus", MAX(TEST_BUS_ATTACH_MS * hz / 1000, 1));
+
+	if (device_add_child(dev, "tstdev", unit) == NULL) {
+		return (ENXIO);
+	}
+
+	bus_generic_attach(dev);
+	state->attach_end = rtems_clock_get_uptime_nanoseconds();
+	return (0);
+}
+
+static device_method_t test_bus_methods[] = {
+	DEVMETHOD(device_probe, test_bus_probe),
+	DEVMETHOD(device_attach, test_bus_attach),
+	DEVMETHOD(device_detach, bus_generic_detach),
+
+	DEVMETHOD(bus_print_child, bus_generic_print_child),
+
+	DEVMETHOD_END
+};
+
+static driver_t test_bus_driver = {
+	"tstbus",
+	test_bus_methods,
+	0
+};
+
+static devclass_t test_bus_devclass;
+
+DRIVER_MODULE(tstbus, nexus, test_bus_driver, test_bus_devclass, 0, 0);
+
+static int
+test_dev_probe(device_t dev)
+{
+
+	device_set_desc(dev, "Test Device");
+	return (BUS_PROBE_DEFAULT);
+}
+
+static int
+test_dev_attach(device_t dev)
+{
+
+	(void)dev;
+	return (0);
+}
+
+static device_method_t test_dev_methods[] = {
+	DEVMETHOD(device_probe, test_dev_probe),
+	DEVMETHOD(device_attach, test_dev_attach),
+
+	DEVMETHOD_END
+};
+
+static driver_t test_dev_driver = {
+	"tstdev",
+	test_dev_methods,
+	0
+};
+
+static devclass_t test_dev_devclass;
+
+DRIVER_MODULE(tstdev, tstbus, test_dev_driver, test_dev_devclass, 0, 0);
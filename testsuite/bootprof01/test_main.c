@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/sysctl.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+#include "test_bootprof01.h"
+
+#define TEST_NAME "LIBBSD BOOT PROFILE 1"
+
+RTEMS_BSD_DEFINE_NEXUS_DEVICE(tstbus, 0, 0, NULL);
+RTEMS_BSD_DEFINE_NEXUS_DEVICE(tstbus, 1, 0, NULL);
+
+static void
+early_initialization(void)
+{
+	rtems_status_code sc;
+
+	sc = rtems_bsd_boot_profile_enable(0);
+	assert(sc == RTEMS_INVALID_NUMBER);
+
+	sc = rtems_bsd_boot_profile_enable(1024);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bsd_boot_profile_enable(1024);
+	assert(sc == RTEMS_INCORRECT_STATE);
+
+	sc = rtems_bsd_boot_defer_attach("");
+	assert(sc == RTEMS_INVALID_NAME);
+
+	sc = rtems_bsd_boot_defer_attach("miibus");
+	assert(sc == RTEMS_INVALID_NAME);
+
+	sc = rtems_bsd_boot_defer_attach("nodriver");
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bsd_boot_defer_slow_buses();
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bsd_boot_defer_attach("tstbus");
+	assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static void
+test_deferred_buses(void)
+{
+	rtems_status_code sc;
+	uint64_t init_end;
+	int unit;
+
+	init_end = rtems_clock_get_uptime_nanoseconds();
+
+	/* The attach of the deferred buses sleeps, so they are not done yet */
+	for (unit = 0; unit < TEST_BUS_COUNT; ++unit) {
+		sc = rtems_bsd_wait_device("tstbus", unit, 1);
+		assert(sc == RTEMS_TIMEOUT);
+	}
+
+	/* The children are attached by the deferred attach of the bus */
+	for (unit = 0; unit < TEST_BUS_COUNT; ++unit) {
+		sc = rtems_bsd_wait_device("tstdev", unit, RTEMS_NO_TIMEOUT);
+		assert(sc == RTEMS_SUCCESSFUL);
+
+		sc = rtems_bsd_wait_device("tstbus", unit, 1);
+		assert(sc == RTEMS_SUCCESSFUL);
+	}
+
+	for (unit = 0; unit < TEST_BUS_COUNT; ++unit) {
+		const test_bus_state *state;
+		int other;
+
+		state = &test_bus_states[unit];
+		assert(state->attach_task != 0);
+		assert(state->attach_task != rtems_task_self());
+		assert(state->attach_end > init_end);
+
+		/* Each bus is attached by its own task in parallel */
+		for (other = 0; other < TEST_BUS_COUNT; ++other) {
+			if (other != unit) {
+				assert(state->attach_task !=
+				    test_bus_states[other].attach_task);
+				assert(state->attach_begin <
+				    test_bus_states[other].attach_end);
+			}
+		}
+	}
+}
+
+static void
+test_main(void)
+{
+	rtems_status_code sc;
+	size_t len;
+	char *buf;
+	int rv;
+
+	test_deferred_buses();
+
+	sc = rtems_bsd_boot_defer_attach("nodriver");
+	assert(sc == RTEMS_INCORRECT_STATE);
+
+	sc = rtems_bsd_wait_device("nexus", 0, 1);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bsd_wait_device("nodevice", 0, 2);
+	assert(sc == RTEMS_TIMEOUT);
+
+	sc = rtems_bsd_wait_device(NULL, 0, 1);
+	assert(sc == RTEMS_INVALID_NAME);
+
+	rtems_bsd_boot_profile_report(stdout, 20);
+
+	len = 0;
+	rv = sysctlbyname("debug.boot_profile", NULL, &len, NULL, 0);
+	assert(rv == 0);
+	assert(len > 0);
+
+	buf = malloc(len);
+	assert(buf != NULL);
+
+	rv = sysctlbyname("debug.boot_profile", buf, &len, NULL, 0);
+	assert(rv == 0);
+	assert(strncmp(buf, "boot profile: ", 14) == 0);
+	assert(strstr(buf, "disabled") == NULL);
+	assert(strstr(buf, "sysinit ") != NULL);
+	assert(strstr(buf, "attach ") != NULL);
+	assert(strstr(buf, "attach tstbus0") != NULL);
+	assert(strstr(buf, "attach tstdev1") != NULL);
+	free(buf);
+
+	exit(0);
+}
+
+#define DEFAULT_EARLY_INITIALIZATION
+
+#include <rtems/bsd/test/default-init.h>
@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include <net/if.h>
+#include <net/bpf.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+
+#include <machine/atomic.h>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+#define TEST_NAME "LIBBSD BPF ZBUF 1"
+
+#define TEST_PORT 7777
+
+#define BUFFER_SIZE 4096
+
+#define PAYLOAD_SIZE 100
+
+#define POISON 0xa5
+
+struct test_context {
+	int bpf;
+	int sd;
+	struct bpf_zbuf_header *bufa;
+	struct bpf_zbuf_header *bufb;
+	uint32_t seq;
+	rtems_id main_task;
+	volatile bool stop_sender;
+};
+
+static struct test_context test_instance;
+
+static void
+send_packet(struct test_context *ctx)
+{
+	struct sockaddr_in addr;
+	char payload[PAYLOAD_SIZE];
+	ssize_t n;
+
+	memset(payload, 0, sizeof(payload));
+	memcpy(payload, &ctx->seq, sizeof(ctx->seq));
+	++ctx->seq;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TEST_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	/* The loopback interface passes the packet to BPF during the send */
+	n = sendto(ctx->sd, payload, sizeof(payload), 0,
+	    (const struct sockaddr *)&addr, sizeof(addr));
+	assert(n == (ssize_t)sizeof(payload));
+}
+
+static u_int
+kernel_gen(const struct bpf_zbuf_header *bzh)
+{
+
+	return ((u_int)atomic_load_acq_int(
+	    (volatile int *)&bzh->bzh_kernel_gen));
+}
+
+static bool
+user_owns(const struct bpf_zbuf_header *bzh)
+{
+
+	return (kernel_gen(bzh) != bzh->bzh_user_gen);
+}
+
+static void
+acknowledge(struct bpf_zbuf_header *bzh)
+{
+
+	atomic_store_rel_int((volatile int *)&bzh->bzh_user_gen,
+	    (int)bzh->bzh_kernel_gen);
+}
+
+/*
+ * Checks the packets in the buffer and returns their count.  The sequence
+ * numbers must continue the ones of the previous buffer.
+ */
+static u_int
+check_buffer(const struct bpf_zbuf_header *bzh, uint32_t *seq)
+{
+	const u_char *p;
+	const u_char *end;
+	u_int count;
+
+	p = (const u_char *)(bzh + 1);
+	end = p + bzh->bzh_kernel_len;
+	count = 0;
+
+	while (p < end) {
+		const struct bpf_hdr *bh;
+		const u_char *pkt;
+		const struct ip *ip;
+		const struct udphdr *uh;
+		uint32_t family;
+		uint32_t pkt_seq;
+
+		bh = (const struct bpf_hdr *)p;
+		assert(bh->bh_caplen == bh->bh_datalen);
+		assert(bh->bh_caplen == sizeof(family) + sizeof(*ip) +
+		    sizeof(*uh) + PAYLOAD_SIZE);
+
+		pkt = p + bh->bh_hdrlen;
+		memcpy(&family, pkt, sizeof(family));
+		assert(family == AF_INET);
+
+		ip = (const struct ip *)(pkt + sizeof(family));
+		assert(ip->ip_p == IPPROTO_UDP);
+
+		uh = (const struct udphdr *)(ip + 1);
+		assert(uh->uh_dport == htons(TEST_PORT));
+
+		memcpy(&pkt_seq, uh + 1, sizeof(pkt_seq));
+		assert(pkt_seq == *seq);
+		++*seq;
+
+		++count;
+		p += BPF_WORDALIGN(bh->bh_hdrlen + bh->bh_caplen);
+	}
+
+	assert(p == end);
+	return (count);
+}
+
+static void
+rotate(struct test_context *ctx, struct bpf_zbuf *bz)
+{
+	int rv;
+
+	memset(bz, 0, sizeof(*bz));
+	rv = ioctl(ctx->bpf, BIOCROTZBUF, bz);
+	assert(rv == 0);
+}
+
+static void
+test_setup(struct test_context *ctx)
+{
+	struct sockaddr_in addr;
+	struct bpf_zbuf bz;
+	struct ifreq ifr;
+	u_int bufmode;
+	size_t zmax;
+	u_int flag;
+	int rv;
+
+	ctx->bpf = open("/dev/bpf", O_RDWR);
+	assert(ctx->bpf >= 0);
+
+	bufmode = BPF_BUFMODE_ZBUF;
+	rv = ioctl(ctx->bpf, BIOCSETBUFMODE, &bufmode);
+	assert(rv == 0);
+
+	rv = ioctl(ctx->bpf, BIOCGETZMAX, &zmax);
+	assert(rv == 0);
+	assert(zmax >= BUFFER_SIZE);
+
+	rv = posix_memalign((void **)&ctx->bufa, BPF_ALIGNMENT, BUFFER_SIZE);
+	assert(rv == 0);
+	rv = posix_memalign((void **)&ctx->bufb, BPF_ALIGNMENT, BUFFER_SIZE);
+	assert(rv == 0);
+
+	/* Misaligned buffers are rejected */
+	memset(&bz, 0, sizeof(bz));
+	bz.bz_bufa = (char *)ctx->bufa + 1;
+	bz.bz_bufb = ctx->bufb;
+	bz.bz_buflen = BUFFER_SIZE - BPF_ALIGNMENT;
+	rv = ioctl(ctx->bpf, BIOCSETZBUF, &bz);
+	assert(rv == -1);
+
+	bz.bz_bufa = ctx->bufa;
+	bz.bz_bufb = ctx->bufb;
+	bz.bz_buflen = BUFFER_SIZE;
+	rv = ioctl(ctx->bpf, BIOCSETZBUF, &bz);
+	assert(rv == 0);
+
+	/* The buffers can be set only once */
+	rv = ioctl(ctx->bpf, BIOCSETZBUF, &bz);
+	assert(rv == -1);
+
+	assert(ctx->bufa->bzh_kernel_gen == 0);
+	assert(ctx->bufa->bzh_user_gen == 0);
+	assert(ctx->bufb->bzh_kernel_gen == 0);
+	assert(ctx->bufb->bzh_user_gen == 0);
+
+	memset(&ifr, 0, sizeof(ifr));
+	strlcpy(ifr.ifr_name, "lo0", sizeof(ifr.ifr_name));
+	rv = ioctl(ctx->bpf, BIOCSETIF, &ifr);
+	assert(rv == 0);
+
+	flag = 1;
+	rv = ioctl(ctx->bpf, BIOCIMMEDIATE, &flag);
+	assert(rv == 0);
+
+	ctx->sd = socket(PF_INET, SOCK_DGRAM, 0);
+	assert(ctx->sd >= 0);
+
+	/* Receive the packets, so that no ICMP port unreachable is sent */
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TEST_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	rv = bind(ctx->sd, (const struct sockaddr *)&addr, sizeof(addr));
+	assert(rv == 0);
+}
+
+static void
+test_rotate(struct test_context *ctx)
+{
+	struct bpf_zbuf bz;
+	uint32_t seq;
+	u_int count;
+
+	seq = 0;
+
+	/* Nothing to rotate */
+	rotate(ctx, &bz);
+	assert(bz.bz_bufa == NULL);
+	assert(bz.bz_buflen == 0);
+
+	/* The kernel fills buffer A first */
+	send_packet(ctx);
+	send_packet(ctx);
+	assert(!user_owns(ctx->bufa));
+	rotate(ctx, &bz);
+	assert(bz.bz_bufa == ctx->bufa);
+	assert(bz.bz_buflen > 0);
+	assert(user_owns(ctx->bufa));
+	assert(ctx->bufa->bzh_kernel_gen == 1);
+	assert(ctx->bufa->bzh_user_gen == 0);
+	assert(ctx->bufa->bzh_kernel_len == bz.bz_buflen);
+	count = check_buffer(ctx->bufa, &seq);
+	assert(count == 2);
+
+	/* Buffer A is not acknowledged, so buffer B stays in the kernel */
+	send_packet(ctx);
+	rotate(ctx, &bz);
+	assert(bz.bz_bufa == NULL);
+	assert(!user_owns(ctx->bufb));
+
+	/* After the acknowledgment the kernel hands out buffer B */
+	acknowledge(ctx->bufa);
+	assert(!user_owns(ctx->bufa));
+	rotate(ctx, &bz);
+	assert(bz.bz_bufa == ctx->bufb);
+	assert(user_owns(ctx->bufb));
+	assert(ctx->bufb->bzh_kernel_gen == 1);
+	assert(ctx->bufa->bzh_kernel_gen == 1);
+	count = check_buffer(ctx->bufb, &seq);
+	assert(count == 1);
+	acknowledge(ctx->bufb);
+}
+
+static void
+test_full(struct test_context *ctx)
+{
+	struct bpf_stat bs;
+	struct bpf_zbuf bz;
+	uint32_t seq;
+	u_int count;
+	u_int i;
+	int rv;
+
+	seq = ctx->seq;
+
+	/*
+	 * Buffer A is the store buffer.  The kernel rotates it without
+	 * BIOCROTZBUF once it is full.
+	 */
+	for (i = 0; i < BUFFER_SIZE / PAYLOAD_SIZE &&
+	    !user_owns(ctx->bufa); ++i) {
+		send_packet(ctx);
+	}
+
+	assert(user_owns(ctx->bufa));
+	assert(ctx->bufa->bzh_kernel_gen == 2);
+	count = check_buffer(ctx->bufa, &seq);
+	assert(count > 1);
+
+	/* The packet which did not fit went to buffer B */
+	assert(seq == ctx->seq - 1);
+	assert(!user_owns(ctx->bufb));
+
+	/* Fill buffer B while buffer A is still owned by the application */
+	for (i = 0; i < BUFFER_SIZE / PAYLOAD_SIZE &&
+	    !user_owns(ctx->bufb); ++i) {
+		send_packet(ctx);
+	}
+
+	/*
+	 * No free buffer, so the full store buffer is handed out and the
+	 * packet which did not fit is dropped.  The same happens to packets
+	 * until the application returns a buffer.
+	 */
+	assert(user_owns(ctx->bufb));
+	assert(ctx->bufb->bzh_kernel_gen == 2);
+	send_packet(ctx);
+	assert(ctx->bufb->bzh_kernel_gen == 2);
+
+	rv = ioctl(ctx->bpf, BIOCGSTATS, &bs);
+	assert(rv == 0);
+	assert(bs.bs_recv == ctx->seq);
+	assert(bs.bs_drop == 2);
+
+	count = check_buffer(ctx->bufb, &seq);
+	assert(count > 1);
+	assert(seq == ctx->seq - 2);
+
+	acknowledge(ctx->bufa);
+	acknowledge(ctx->bufb);
+
+	/* Both buffers were returned, the next packet goes to buffer A */
+	send_packet(ctx);
+	rotate(ctx, &bz);
+	assert(bz.bz_bufa == ctx->bufa);
+	assert(ctx->bufa->bzh_kernel_gen == 3);
+	seq = ctx->seq - 1;
+	count = check_buffer(ctx->bufa, &seq);
+	assert(count == 1);
+	acknowledge(ctx->bufa);
+}
+
+static void
+sender_task(rtems_task_argument arg)
+{
+	struct test_context *ctx;
+	struct sockaddr_in addr;
+	char payload[PAYLOAD_SIZE];
+	rtems_status_code sc;
+	int sd;
+	int rv;
+
+	ctx = (struct test_context *)arg;
+
+	sd = socket(PF_INET, SOCK_DGRAM, 0);
+	assert(sd >= 0);
+
+	memset(payload, 0, sizeof(payload));
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TEST_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	while (!ctx->stop_sender) {
+		(void)sendto(sd, payload, sizeof(payload), 0,
+		    (const struct sockaddr *)&addr, sizeof(addr));
+	}
+
+	rv = close(sd);
+	assert(rv == 0);
+
+	sc = rtems_event_transient_send(ctx->main_task);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	rtems_task_exit();
+}
+
+static bool
+is_poisoned(const void *buf)
+{
+	const u_char *p;
+	size_t i;
+
+	p = buf;
+	for (i = 0; i < BUFFER_SIZE; ++i) {
+		if (p[i] != POISON)
+			return (false);
+	}
+
+	return (true);
+}
+
+/*
+ * The kernel stores packets into the buffers until the descriptor is closed.
+ * Once it is closed, the application may free or reuse the buffers while
+ * packets still arrive on the interface.
+ */
+static void
+test_close(struct test_context *ctx)
+{
+	rtems_status_code sc;
+	rtems_id id;
+	u_int gen;
+	int i;
+	int rv;
+
+	ctx->main_task = rtems_task_self();
+	ctx->stop_sender = false;
+	gen = kernel_gen(ctx->bufa) + kernel_gen(ctx->bufb);
+
+	sc = rtems_task_create(rtems_build_name('S', 'E', 'N', 'D'),
+	    RTEMS_MAXIMUM_PRIORITY - 1, 32 * 1024, RTEMS_DEFAULT_MODES,
+	    RTEMS_FLOATING_POINT, &id);
+	assert(sc == RTEMS_SUCCESSFUL);
+	sc = rtems_task_start(id, sender_task, (rtems_task_argument)ctx);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	/* Keep returning the buffers, so that the kernel always has one */
+	for (i = 0; i < 10; ++i) {
+		rtems_task_wake_after(1);
+
+		if (user_owns(ctx->bufa))
+			acknowledge(ctx->bufa);
+		if (user_owns(ctx->bufb))
+			acknowledge(ctx->bufb);
+	}
+
+	assert(kernel_gen(ctx->bufa) + kernel_gen(ctx->bufb) != gen);
+
+	rv = close(ctx->bpf);
+	assert(rv == 0);
+
+	memset(ctx->bufa, POISON, BUFFER_SIZE);
+	memset(ctx->bufb, POISON, BUFFER_SIZE);
+	rtems_task_wake_after(10);
+
+	ctx->stop_sender = true;
+	sc = rtems_event_transient_receive(RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	assert(is_poisoned(ctx->bufa));
+	assert(is_poisoned(ctx->bufb));
+}
+
+static void
+test_main(void)
+{
+	struct test_context *ctx;
+	int exit_code;
+	int rv;
+
+	ctx = &test_instance;
+
+	exit_code = rtems_bsd_ifconfig_lo0();
+	assert(exit_code == 0);
+
+	test_setup(ctx);
+	test_rotate(ctx);
+	test_full(ctx);
+	test_close(ctx);
+
+	rv = close(ctx->sd);
+	assert(rv == 0);
+
+	free(ctx->bufa);
+	free(ctx->bufb);
+
+	exit(0);
+}
+
+#include <rtems/bsd/test/default-init.h>
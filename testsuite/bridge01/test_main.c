@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <net/bpf.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <machine/rtems-bsd-commands.h>
+
+#include <rtems.h>
+
+#define TEST_NAME "LIBBSD BRIDGE 1"
+
+#define TEST_XML_NAME "TestBridge01"
+
+#define FRAME_SIZE 1000
+
+#define BURST_COUNT 32
+
+#define FRAME_COUNT (320 * BURST_COUNT)
+
+#define ETHERTYPE_TEST 0x88b5
+
+static const uint8_t host_a[ETHER_ADDR_LEN] =
+    { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0a };
+
+static const uint8_t host_b[ETHER_ADDR_LEN] =
+    { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0b };
+
+static uint8_t frame[FRAME_SIZE];
+
+static void
+ifconfig(char *ifname, char *arg0, char *arg1, char *arg2, char *arg3)
+{
+	char *argv[] = {
+		"ifconfig",
+		ifname,
+		arg0,
+		arg1,
+		arg2,
+		arg3,
+		NULL
+	};
+	int argc;
+	int exit_code;
+
+	argc = 0;
+	while (argv[argc] != NULL)
+		++argc;
+
+	exit_code = rtems_bsd_command_ifconfig(argc, argv);
+	assert(exit_code == EX_OK);
+}
+
+static int
+open_bpf(const char *ifname)
+{
+	struct ifreq ifr;
+	u_int val;
+	int fd;
+	int rv;
+
+	fd = open("/dev/bpf", O_RDWR);
+	assert(fd >= 0);
+
+	memset(&ifr, 0, sizeof(ifr));
+	strlcpy(ifr.ifr_name, ifname, sizeof(ifr.ifr_name));
+	rv = ioctl(fd, BIOCSETIF, &ifr);
+	assert(rv == 0);
+
+	/* Keep our source addresses */
+	val = 1;
+	rv = ioctl(fd, BIOCSHDRCMPLT, &val);
+	assert(rv == 0);
+
+	/* Count only frames which went through the bridge */
+	val = BPF_D_IN;
+	rv = ioctl(fd, BIOCSDIRECTION, &val);
+	assert(rv == 0);
+
+	return (fd);
+}
+
+static u_int
+get_received(int fd)
+{
+	struct bpf_stat bs;
+	int rv;
+
+	rv = ioctl(fd, BIOCGSTATS, &bs);
+	assert(rv == 0);
+	return (bs.bs_recv);
+}
+
+static void
+send_frame(int fd, const uint8_t *dst, const uint8_t *src)
+{
+	struct ether_header *eh;
+	ssize_t n;
+
+	eh = (struct ether_header *)&frame[0];
+	memcpy(eh->ether_dhost, dst, ETHER_ADDR_LEN);
+	memcpy(eh->ether_shost, src, ETHER_ADDR_LEN);
+	eh->ether_type = htons(ETHERTYPE_TEST);
+
+	n = write(fd, frame, sizeof(frame));
+	assert(n == (ssize_t)sizeof(frame));
+}
+
+static void
+wait_for_frames(int fd, u_int expected)
+{
+	int i;
+
+	/* The epair(4) interfaces deliver the frames through a netisr */
+	for (i = 0; i < 1000; ++i) {
+		if (get_received(fd) >= expected)
+			return;
+
+		usleep(1000);
+	}
+
+	assert(get_received(fd) >= expected);
+}
+
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+	int rv;
+
+	rv = clock_gettime(CLOCK_MONOTONIC, &ts);
+	assert(rv == 0);
+	return ((uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec);
+}
+
+static void
+test_main(void)
+{
+	uint64_t t0;
+	uint64_t t1;
+	u_int rx_a;
+	u_int rx_b;
+	int fd_a;
+	int fd_b;
+	int i;
+	int rv;
+
+	/*
+	 * Host A sits behind epair0a and host B behind epair1b.  The other
+	 * ends of the pairs are members of bridge0.
+	 */
+	ifconfig("epair0", "create", NULL, NULL, NULL);
+	ifconfig("epair1", "create", NULL, NULL, NULL);
+	ifconfig("bridge0", "create", NULL, NULL, NULL);
+	ifconfig("bridge0", "addm", "epair0b", "addm", "epair1a");
+	ifconfig("bridge0", "up", NULL, NULL, NULL);
+	ifconfig("epair0a", "up", NULL, NULL, NULL);
+	ifconfig("epair0b", "up", NULL, NULL, NULL);
+	ifconfig("epair1a", "up", NULL, NULL, NULL);
+	ifconfig("epair1b", "up", NULL, NULL, NULL);
+
+	fd_a = open_bpf("epair0a");
+	fd_b = open_bpf("epair1b");
+
+	/* Let the bridge learn both hosts */
+	send_frame(fd_b, host_a, host_b);
+	wait_for_frames(fd_a, 1);
+	send_frame(fd_a, host_b, host_a);
+	wait_for_frames(fd_b, 1);
+	ifconfig("bridge0", "addr", NULL, NULL, NULL);
+
+	rx_a = get_received(fd_a);
+	rx_b = get_received(fd_b);
+
+	/* Send in bursts to stay below the epair(4) queue limit */
+	t0 = now_ns();
+	for (i = 0; i < FRAME_COUNT; i += BURST_COUNT) {
+		int j;
+
+		for (j = 0; j < BURST_COUNT; ++j) {
+			send_frame(fd_a, host_b, host_a);
+			send_frame(fd_b, host_a, host_b);
+		}
+
+		wait_for_frames(fd_a, rx_a + i + BURST_COUNT);
+		wait_for_frames(fd_b, rx_b + i + BURST_COUNT);
+	}
+	t1 = now_ns();
+
+	/* Known unicast destinations must not be flooded back */
+	assert(get_received(fd_a) == rx_a + FRAME_COUNT);
+	assert(get_received(fd_b) == rx_b + FRAME_COUNT);
+
+	rv = close(fd_a);
+	assert(rv == 0);
+	rv = close(fd_b);
+	assert(rv == 0);
+
+	/* Member removal and destruction defers the frees to the epoch */
+	ifconfig("bridge0", "deletem", "epair1a", NULL, NULL);
+	ifconfig("bridge0", "destroy", NULL, NULL, NULL);
+	ifconfig("epair0a", "destroy", NULL, NULL, NULL);
+	ifconfig("epair1a", "destroy", NULL, NULL, NULL);
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <Frames>%i</Frames>\n", 2 * FRAME_COUNT);
+	printf("  <FrameSize>%i</FrameSize>\n", FRAME_SIZE);
+	printf("  <DurationNanoseconds>%" PRIu64 "</DurationNanoseconds>\n",
+	    t1 - t0);
+	printf("  <FramesPerSecond>%" PRIu64 "</FramesPerSecond>\n",
+	    (uint64_t)2 * FRAME_COUNT * 1000000000 / (t1 - t0 + 1));
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <machine/rtems-bsd-sysinit.h>
+
+SYSINIT_MODULE_REFERENCE(if_epair);
+
+#include <rtems/bsd/test/default-init.h>
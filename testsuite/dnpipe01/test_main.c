@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+#include <sys/time.h>
+
+#include <netinet/in.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+#include <rtems/counter.h>
+
+#define TEST_NAME "LIBBSD DNPIPE 1"
+
+#define TEST_XML_NAME "TestDNPipe01"
+
+#define TEST_PORT 5432
+
+#define PIPE "net.inet.ip.dnpipe.0."
+
+#define DATAGRAM_SIZE 1000
+
+#define DATAGRAM_COUNT 100
+
+static char datagram[DATAGRAM_SIZE];
+
+static void
+set_uint(const char *name, u_int val)
+{
+	int rv;
+
+	rv = sysctlbyname(name, NULL, NULL, &val, sizeof(val));
+	assert(rv == 0);
+}
+
+static u_long
+get_ulong(const char *name)
+{
+	u_long val;
+	size_t len;
+	int rv;
+
+	len = sizeof(val);
+	rv = sysctlbyname(name, &val, &len, NULL, 0);
+	assert(rv == 0);
+	return (val);
+}
+
+static void
+set_string(const char *name, const char *val)
+{
+	int rv;
+
+	rv = sysctlbyname(name, NULL, NULL, val, strlen(val) + 1);
+	assert(rv == 0);
+}
+
+static void
+configure_pipe(u_int delay, u_int bandwidth, u_int loss, u_int qsize)
+{
+
+	set_uint(PIPE "delay", delay);
+	set_uint(PIPE "bandwidth", bandwidth);
+	set_uint(PIPE "loss", loss);
+	set_uint(PIPE "qsize", qsize);
+}
+
+static int
+open_socket(in_port_t port)
+{
+	struct sockaddr_in addr;
+	struct timeval tv;
+	int sd;
+	int rv;
+
+	sd = socket(PF_INET, SOCK_DGRAM, 0);
+	assert(sd >= 0);
+
+	tv.tv_sec = 2;
+	tv.tv_usec = 0;
+	rv = setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	assert(rv == 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	rv = bind(sd, (const struct sockaddr *)&addr, sizeof(addr));
+	assert(rv == 0);
+
+	return (sd);
+}
+
+static void
+send_datagram(int sd)
+{
+	struct sockaddr_in addr;
+	ssize_t n;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TEST_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	n = sendto(sd, datagram, sizeof(datagram), 0,
+	    (const struct sockaddr *)&addr, sizeof(addr));
+	assert(n == (ssize_t)sizeof(datagram));
+}
+
+static bool
+receive_datagram(int sd)
+{
+	char buf[DATAGRAM_SIZE];
+	ssize_t n;
+
+	n = recv(sd, buf, sizeof(buf), 0);
+	if (n < 0) {
+		assert(errno == EAGAIN);
+		return (false);
+	}
+
+	assert(n == (ssize_t)sizeof(buf));
+	return (true);
+}
+
+static uint64_t
+elapsed_ns(rtems_counter_ticks begin)
+{
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(rtems_counter_read(), begin)));
+}
+
+static uint64_t
+test_delay(int tx, int rx)
+{
+	rtems_counter_ticks begin;
+	uint64_t ns;
+	bool ok;
+
+	configure_pipe(50, 0, 0, 50);
+
+	begin = rtems_counter_read();
+	send_datagram(tx);
+	ok = receive_datagram(rx);
+	ns = elapsed_ns(begin);
+
+	assert(ok);
+	assert(ns >= 40000000);
+
+	return (ns);
+}
+
+static void
+test_loss(int tx, int rx)
+{
+	u_long drops;
+	bool ok;
+
+	configure_pipe(0, 0, 1000000, 50);
+	drops = get_ulong(PIPE "loss_drops");
+
+	send_datagram(tx);
+	ok = receive_datagram(rx);
+
+	assert(!ok);
+	assert(get_ulong(PIPE "loss_drops") == drops + 1);
+}
+
+static uint64_t
+test_bandwidth(int tx, int rx)
+{
+	rtems_counter_ticks begin;
+	uint64_t ns;
+	int i;
+
+	/* 1 Mbit/s, so the datagrams need about 830ms on the emulated link */
+	configure_pipe(0, 1000, 0, DATAGRAM_COUNT);
+
+	begin = rtems_counter_read();
+
+	for (i = 0; i < DATAGRAM_COUNT; ++i) {
+		send_datagram(tx);
+	}
+
+	for (i = 0; i < DATAGRAM_COUNT; ++i) {
+		bool ok;
+
+		ok = receive_datagram(rx);
+		assert(ok);
+	}
+
+	ns = elapsed_ns(begin);
+	assert(ns >= 700000000);
+
+	return (ns);
+}
+
+static void
+test_queue_drops(int tx, int rx)
+{
+	u_long drops;
+	int received;
+	int i;
+
+	configure_pipe(0, 1000, 0, 10);
+	drops = get_ulong(PIPE "queue_drops");
+
+	for (i = 0; i < DATAGRAM_COUNT; ++i) {
+		send_datagram(tx);
+	}
+
+	received = 0;
+
+	while (receive_datagram(rx)) {
+		++received;
+	}
+
+	assert(received < DATAGRAM_COUNT);
+	assert(get_ulong(PIPE "queue_drops") - drops ==
+	    (u_long)(DATAGRAM_COUNT - received));
+}
+
+static void
+test_main(void)
+{
+	uint64_t delay_ns;
+	uint64_t bandwidth_ns;
+	int exit_code;
+	int tx;
+	int rx;
+	int rv;
+
+	exit_code = rtems_bsd_ifconfig_lo0();
+	assert(exit_code == 0);
+
+	tx = open_socket(0);
+	rx = open_socket(TEST_PORT);
+
+	set_uint(PIPE "dir", 2);
+	set_string(PIPE "ifname", "lo0");
+
+	delay_ns = test_delay(tx, rx);
+	test_loss(tx, rx);
+	bandwidth_ns = test_bandwidth(tx, rx);
+	test_queue_drops(tx, rx);
+
+	set_string(PIPE "ifname", "");
+
+	rv = close(tx);
+	assert(rv == 0);
+	rv = close(rx);
+	assert(rv == 0);
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <DelayNanoseconds>%" PRIu64 "</DelayNanoseconds>\n",
+	    delay_ns);
+	printf("  <BandwidthNanoseconds>%" PRIu64 "</BandwidthNanoseconds>\n",
+	    bandwidth_ns);
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <machine/rtems-bsd-sysinit.h>
+
+#define RTEMS_BSD_CONFIG_NET_DNPIPE
+
+#include <rtems/bsd/test/default-init.h>
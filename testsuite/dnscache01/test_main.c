@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The test runs a small DNS server on the loopback interface which counts
+ * the queries per name.  The resolver of the test uses this server.
+ */
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+
+#include <assert.h>
+#include <netdb.h>
+#include <resolv.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+#define TEST_NAME "LIBBSD DNS CACHE 1"
+
+#define SLOW_CLIENTS 4
+
+static const char resolv_conf[] =
+    "nameserver 127.0.0.1\n"
+    "options timeout:1 attempts:1\n";
+
+static struct {
+	u_int host;
+	u_int slow;
+	u_int down;
+	u_int missing;
+} queries;
+
+static rtems_id main_task;
+
+static size_t
+put16(u_char *p, uint16_t v)
+{
+
+	p[0] = (u_char)(v >> 8);
+	p[1] = (u_char)v;
+	return (2);
+}
+
+static size_t
+put32(u_char *p, uint32_t v)
+{
+
+	put16(p, (uint16_t)(v >> 16));
+	put16(p + 2, (uint16_t)v);
+	return (4);
+}
+
+/* Adds an A record or a SOA record for the question name */
+static size_t
+put_rr(u_char *p, uint16_t type, uint32_t ttl, uint32_t addr)
+{
+	size_t n;
+
+	n = put16(p, 0xc000 | HFIXEDSZ);
+	n += put16(p + n, type);
+	n += put16(p + n, ns_c_in);
+	n += put32(p + n, ttl);
+
+	if (type == ns_t_a) {
+		n += put16(p + n, 4);
+		n += put32(p + n, addr);
+	} else {
+		n += put16(p + n, 2 + 5 * 4);
+		p[n++] = 0;
+		p[n++] = 0;
+		n += put32(p + n, 1);
+		n += put32(p + n, 3600);
+		n += put32(p + n, 600);
+		n += put32(p + n, 86400);
+		n += put32(p + n, 30);
+	}
+
+	return (n);
+}
+
+static void
+server_task(rtems_task_argument arg)
+{
+	struct sockaddr_in addr;
+	rtems_status_code sc;
+	int sd;
+	int rv;
+
+	(void)arg;
+
+	sd = socket(PF_INET, SOCK_DGRAM, 0);
+	assert(sd >= 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(NAMESERVER_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	rv = bind(sd, (const struct sockaddr *)&addr, sizeof(addr));
+	assert(rv == 0);
+
+	sc = rtems_event_transient_send(main_task);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	while (true) {
+		u_char msg[PACKETSZ];
+		char name[MAXDNAME];
+		struct sockaddr_in peer;
+		socklen_t peerlen;
+		ssize_t n;
+		size_t len;
+		HEADER *hp;
+
+		peerlen = sizeof(peer);
+		n = recvfrom(sd, msg, sizeof(msg), 0,
+		    (struct sockaddr *)&peer, &peerlen);
+		assert(n > 0);
+
+		rv = dn_expand(msg, msg + n, msg + HFIXEDSZ, name,
+		    sizeof(name));
+		assert(rv > 0);
+		len = HFIXEDSZ + (size_t)rv + 2 * INT16SZ;
+		assert(len <= (size_t)n);
+
+		hp = (HEADER *)msg;
+		hp->qr = 1;
+		hp->ra = 1;
+		hp->ancount = 0;
+		hp->nscount = 0;
+		hp->arcount = 0;
+
+		if (strcmp(name, "host.example") == 0) {
+			++queries.host;
+			hp->ancount = htons(1);
+			len += put_rr(&msg[len], ns_t_a, 2, 0xc0000201);
+		} else if (strcmp(name, "slow.example") == 0) {
+			++queries.slow;
+			rv = usleep(500000);
+			assert(rv == 0);
+			hp->ancount = htons(1);
+			len += put_rr(&msg[len], ns_t_a, 60, 0xc0000202);
+		} else if (strcmp(name, "down.example") == 0) {
+			++queries.down;
+			continue;
+		} else {
+			++queries.missing;
+			hp->rcode = ns_r_nxdomain;
+			hp->nscount = htons(1);
+			len += put_rr(&msg[len], ns_t_soa, 60, 0);
+		}
+
+		n = sendto(sd, msg, len, 0, (const struct sockaddr *)&peer,
+		    peerlen);
+		assert(n == (ssize_t)len);
+	}
+}
+
+static int
+resolve(const char *name, in_addr_t *ip)
+{
+	struct addrinfo hints;
+	struct addrinfo *res;
+	int rv;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	rv = getaddrinfo(name, NULL, &hints, &res);
+	if (rv == 0) {
+		const struct sockaddr_in *sin;
+
+		sin = (const struct sockaddr_in *)res->ai_addr;
+		*ip = ntohl(sin->sin_addr.s_addr);
+		freeaddrinfo(res);
+	}
+
+	return (rv);
+}
+
+static u_long
+get_counter(const char *name)
+{
+	u_long val;
+	size_t len;
+	int rv;
+
+	len = sizeof(val);
+	rv = sysctlbyname(name, &val, &len, NULL, 0);
+	assert(rv == 0);
+	return (val);
+}
+
+static void
+slow_client_task(rtems_task_argument arg)
+{
+	rtems_status_code sc;
+	in_addr_t ip;
+	int rv;
+
+	rv = resolve("slow.example", &ip);
+	assert(rv == 0);
+	assert(ip == 0xc0000202);
+
+	sc = rtems_event_send(main_task, RTEMS_EVENT_0 << arg);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	rtems_task_delete(RTEMS_SELF);
+}
+
+static void
+start_task(rtems_task_entry entry, rtems_task_argument arg)
+{
+	rtems_status_code sc;
+	rtems_id id;
+
+	sc = rtems_task_create(rtems_build_name('D', 'N', 'S', ' '),
+	    110, 32 * 1024,
+	    RTEMS_DEFAULT_MODES, RTEMS_FLOATING_POINT, &id);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_task_start(id, entry, arg);
+	assert(sc == RTEMS_SUCCESSFUL);
+}
+
+static u_int
+get_uint(const char *name)
+{
+	u_int val;
+	size_t len;
+	int rv;
+
+	len = sizeof(val);
+	rv = sysctlbyname(name, &val, &len, NULL, 0);
+	assert(rv == 0);
+	return (val);
+}
+
+static int64_t
+uptime_ms(void)
+{
+	struct timespec ts;
+	int rv;
+
+	rv = clock_gettime(CLOCK_MONOTONIC, &ts);
+	assert(rv == 0);
+	return ((int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static void
+test_main(void)
+{
+	rtems_status_code sc;
+	rtems_event_set events;
+	in_addr_t ip;
+	int64_t begin;
+	u_int missing;
+	FILE *file;
+	size_t n;
+	int exit_code;
+	int rv;
+	int i;
+
+	main_task = rtems_task_self();
+
+	exit_code = rtems_bsd_ifconfig_lo0();
+	assert(exit_code == 0);
+
+	file = fopen("/etc/resolv.conf", "w");
+	assert(file != NULL);
+	n = fwrite(resolv_conf, sizeof(resolv_conf) - 1, 1, file);
+	assert(n == 1);
+	rv = fclose(file);
+	assert(rv == 0);
+
+	start_task(server_task, 0);
+	sc = rtems_event_transient_receive(RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	/* Positive answers are cached for their time to live */
+	rv = resolve("host.example", &ip);
+	assert(rv == 0);
+	assert(ip == 0xc0000201);
+	assert(queries.host == 1);
+
+	rv = resolve("host.example", &ip);
+	assert(rv == 0);
+	assert(ip == 0xc0000201);
+	assert(queries.host == 1);
+	assert(get_counter("net.dnscache.hits") == 1);
+
+	sleep(3);
+
+	rv = resolve("host.example", &ip);
+	assert(rv == 0);
+	assert(queries.host == 2);
+
+	/* Negative answers are cached for the time to live of the SOA */
+	rv = resolve("missing.example", &ip);
+	assert(rv == EAI_NONAME);
+	missing = queries.missing;
+	assert(missing >= 1);
+
+	rv = resolve("missing.example", &ip);
+	assert(rv == EAI_NONAME);
+	assert(queries.missing == missing);
+
+	/* A server which does not answer is asked once */
+	begin = uptime_ms();
+	rv = resolve("down.example", &ip);
+	assert(rv != 0);
+	assert(queries.down == 1);
+	assert(uptime_ms() - begin >= 900);
+
+	begin = uptime_ms();
+	rv = resolve("down.example", &ip);
+	assert(rv != 0);
+	assert(queries.down == 1);
+	assert(uptime_ms() - begin < 100);
+	assert(get_counter("net.dnscache.negative_hits") == 1);
+
+	/* Concurrent lookups of the same name share one query */
+	for (i = 0; i < SLOW_CLIENTS; ++i) {
+		start_task(slow_client_task, (rtems_task_argument)i);
+	}
+
+	sc = rtems_event_receive((RTEMS_EVENT_0 << SLOW_CLIENTS) - 1,
+	    RTEMS_EVENT_ALL | RTEMS_WAIT, RTEMS_NO_TIMEOUT, &events);
+	assert(sc == RTEMS_SUCCESSFUL);
+	assert(queries.slow == 1);
+	assert(get_counter("net.dnscache.coalesced") == SLOW_CLIENTS - 1);
+
+	rtems_bsd_dns_cache_report(stdout);
+
+	assert(get_uint("net.dnscache.entries") != 0);
+	rtems_bsd_dns_cache_flush();
+	assert(get_uint("net.dnscache.entries") == 0);
+
+	rv = resolve("host.example", &ip);
+	assert(rv == 0);
+	assert(queries.host == 3);
+
+	exit(0);
+}
+
+#include <rtems/bsd/test/default-init.h>
@@ -75,5 +75,9 @@ plt.plot(x, y, label = 'Enter List Op Exit', marker = 'o')
 y = getCounterSums('EnterListOpExitPreempt')
 plt.plot(x, y, label = 'Enter List Op Exit Preempt', marker = 'o')
 
+y = getCounterSums('EnterCallExit')
+if y:
+	plt.plot(x, y, label = 'Enter Call Exit', marker = 'o')
+
 plt.legend(loc = 'best')
 plt.show()
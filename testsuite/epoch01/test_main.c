@@ -38,6 +38,8 @@
 #include <sys/mutex.h>
 #include <sys/epoch.h>
 
+#include <machine/atomic.h>
+
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
@@ -57,6 +59,12 @@
 
 #define CPU_COUNT 32
 
+#define CALL_ITEM_COUNT 256
+
+#define DRAIN_ROUND_COUNT 8
+
+#define DRAIN_ITEM_COUNT 8
+
 typedef struct {
 	uint32_t counter[CPU_COUNT];
 	uint32_t removals[CPU_COUNT];
@@ -70,12 +78,22 @@ typedef struct test_item {
 	size_t worker_index;
 } test_item;
 
+typedef struct {
+	struct epoch_context ec;
+	volatile bool busy;
+	size_t worker_index;
+} test_call_item;
+
 typedef struct {
 	rtems_test_parallel_context base;
 	size_t active_workers;
 	CK_SLIST_HEAD(, test_item) item_list;
 	rtems_mutex mtx[2];
 	test_item items[CPU_COUNT];
+	test_call_item call_items[CPU_COUNT][CALL_ITEM_COUNT];
+	uint32_t reclaimed[CPU_COUNT];
+	struct epoch_context drain_items[DRAIN_ROUND_COUNT][DRAIN_ITEM_COUNT];
+	uint32_t drain_reclaimed;
 	test_stats stats;
 } test_context;
 
@@ -433,6 +451,123 @@ test_enter_mutex_exit_preempt_fini(rtems_test_parallel_context *base,
 	test_fini(base, "EnterMutexExitPreempt", active_workers);
 }
 
+static rtems_interval
+test_call_init(rtems_test_parallel_context *base, void *arg,
+    size_t active_workers)
+{
+	test_context *ctx;
+	size_t i;
+	size_t j;
+
+	ctx = (test_context *)base;
+	memset(ctx->reclaimed, 0, sizeof(ctx->reclaimed));
+
+	for (i = 0; i < active_workers; ++i) {
+		for (j = 0; j < CALL_ITEM_COUNT; ++j) {
+			test_call_item *item = &ctx->call_items[i][j];
+
+			item->busy = false;
+			item->worker_index = i;
+		}
+	}
+
+	return (test_init(&ctx->base, arg, active_workers));
+}
+
+static void
+test_call_callback(epoch_context_t ec)
+{
+	test_context *ctx;
+	test_call_item *item;
+
+	ctx = &test_instance;
+	item = __containerof(ec, test_call_item, ec);
+	atomic_add_32(&ctx->reclaimed[item->worker_index], 1);
+	item->busy = false;
+}
+
+static void
+test_drain_callback(epoch_context_t ec)
+{
+	test_context *ctx;
+
+	(void)ec;
+	ctx = &test_instance;
+	atomic_add_32(&ctx->drain_reclaimed, 1);
+}
+
+static void
+test_enter_call_exit_body(rtems_test_parallel_context *base, void *arg,
+    size_t active_workers, size_t worker_index)
+{
+	test_context *ctx;
+	epoch_t e;
+	uint32_t counter;
+	size_t i;
+
+	ctx = (test_context *)base;
+	e = global_epoch;
+	counter = 0;
+	i = 0;
+
+	while (!rtems_test_parallel_stop_job(&ctx->base)) {
+		test_call_item *item;
+
+		item = &ctx->call_items[worker_index][i];
+
+		if (item->busy) {
+			continue;
+		}
+
+		item->busy = true;
+		i = (i + 1) % CALL_ITEM_COUNT;
+
+		epoch_enter(e);
+		++counter;
+		epoch_exit(e);
+
+		epoch_call(e, &item->ec, test_call_callback);
+	}
+
+	ctx->stats.counter[worker_index] = counter;
+}
+
+static void
+test_enter_call_exit_fini(rtems_test_parallel_context *base, void *arg,
+    size_t active_workers)
+{
+	test_context *ctx;
+	size_t i;
+
+	ctx = (test_context *)base;
+
+	/* Spread pending callbacks across the buckets of several epochs */
+	ctx->drain_reclaimed = 0;
+
+	for (i = 0; i < DRAIN_ROUND_COUNT; ++i) {
+		size_t j;
+
+		for (j = 0; j < DRAIN_ITEM_COUNT; ++j) {
+			epoch_call(global_epoch, &ctx->drain_items[i][j],
+			    test_drain_callback);
+		}
+
+		epoch_wait(global_epoch);
+	}
+
+	epoch_drain_callbacks(global_epoch);
+
+	assert(atomic_load_acq_32(&ctx->drain_reclaimed) ==
+	    DRAIN_ROUND_COUNT * DRAIN_ITEM_COUNT);
+
+	for (i = 0; i < active_workers; ++i) {
+		assert(atomic_load_acq_32(&ctx->reclaimed[i]) ==
+		    ctx->stats.counter[i]);
+	}
+
+	test_fini(base, "EnterCallExit", active_workers);
+}
+
 static const rtems_test_parallel_job test_jobs[] = {
 	{
 		.init = test_init,
@@ -464,6 +599,11 @@ static const rtems_test_parallel_job test_jobs[] = {
 		.body = test_enter_mutex_exit_preempt_body,
 		.fini = test_enter_mutex_exit_preempt_fini,
 		.cascade = true
+	}, {
+		.init = test_call_init,
+		.body = test_enter_call_exit_body,
+		.fini = test_enter_call_exit_fini,
+		.cascade = true
 	}
 };
 
@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Sends TCP data from epair0a to a fake peer behind epair0b through
+ * ip_output().  The frames are captured at the input of epair0b and checked.
+ * The time to send the data in MSS sized packets without the software
+ * segmentation stage is compared to the time to send it in super-segments
+ * through the stage.  The TCP output itself is not part of the measurement.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/systm.h>
+#include <sys/mbuf.h>
+#include <sys/socket.h>
+
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <net/if_var.h>
+#include <net/if_gso.h>
+
+#include <netinet/in.h>
+#include <netinet/in_systm.h>
+#include <netinet/ip.h>
+#include <netinet/ip_var.h>
+#include <netinet/tcp.h>
+
+#include <machine/in_cksum.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+
+#include <machine/rtems-bsd-commands.h>
+
+#include <rtems.h>
+#include <rtems/counter.h>
+#include <rtems/thread.h>
+
+#define TEST_NAME "LIBBSD GSO 1"
+
+#define TEST_XML_NAME "TestGSO01"
+
+#define MSS 1448
+
+#define SEGMENT_COUNT 44
+
+#define SUPER_SIZE (SEGMENT_COUNT * MSS)
+
+#define ROUND_COUNT 200
+
+#define HDR_LEN (sizeof(struct ip) + sizeof(struct tcphdr))
+
+#define ADDR_A 0xc0000201
+
+#define ADDR_B 0xc0000202
+
+#define PORT_A 5001
+
+#define PORT_B 5002
+
+#define ISS 0x10000000
+
+static uint8_t payload[SUPER_SIZE];
+
+static struct {
+	rtems_binary_semaphore done;
+	void (*input)(struct ifnet *, struct mbuf *);
+	u_int frames;
+	u_int expected;
+	uint32_t seq;
+	bool ip_sum_offloaded;
+} rx;
+
+static void
+ifconfig(char *ifname, char *arg0, char *arg1, char *arg2)
+{
+	char *argv[] = {
+		"ifconfig",
+		ifname,
+		arg0,
+		arg1,
+		arg2,
+		NULL
+	};
+	int argc;
+	int exit_code;
+
+	argc = 0;
+	while (argv[argc] != NULL)
+		++argc;
+
+	exit_code = rtems_bsd_command_ifconfig(argc, argv);
+	assert(exit_code == EX_OK);
+}
+
+static void
+add_peer(void)
+{
+	char *argv[] = {
+		"arp",
+		"-s",
+		"192.0.2.2",
+		"02:00:00:00:00:0b",
+		NULL
+	};
+	int exit_code;
+
+	exit_code = rtems_bsd_command_arp(nitems(argv) - 1, argv);
+	assert(exit_code == EX_OK);
+}
+
+static uint32_t
+cksum_add(uint32_t sum, const void *buf, size_t len)
+{
+	const uint8_t *p;
+	size_t i;
+
+	p = buf;
+	for (i = 0; i + 1 < len; i += 2)
+		sum += ((uint32_t)p[i] << 8) | p[i + 1];
+
+	if (i < len)
+		sum += (uint32_t)p[i] << 8;
+
+	return (sum);
+}
+
+static uint16_t
+cksum_fold(uint32_t sum)
+{
+
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return ((uint16_t)sum);
+}
+
+/* Checks the frames sent by the segmentation stage to the fake peer */
+static void
+test_input(struct ifnet *ifp, struct mbuf *m)
+{
+	uint8_t frame[ETHER_HDR_LEN + HDR_LEN + MSS];
+	struct ether_header *eh;
+	struct ip *ip;
+	struct tcphdr *th;
+	uint32_t sum;
+	uint32_t off;
+	int len;
+	int tcplen;
+	int datalen;
+
+	(void)ifp;
+	len = m->m_pkthdr.len;
+	assert(len > (int)(ETHER_HDR_LEN + HDR_LEN));
+	assert(len <= (int)sizeof(frame));
+	m_copydata(m, 0, len, frame);
+	m_freem(m);
+
+	eh = (struct ether_header *)&frame[0];
+	assert(ntohs(eh->ether_type) == ETHERTYPE_IP);
+
+	ip = (struct ip *)&frame[ETHER_HDR_LEN];
+	assert(ntohs(ip->ip_len) == len - ETHER_HDR_LEN);
+	assert(ip->ip_src.s_addr == htonl(ADDR_A));
+	assert(ip->ip_dst.s_addr == htonl(ADDR_B));
+
+	if (rx.ip_sum_offloaded)
+		assert(ip->ip_sum == 0);
+	else
+		assert(cksum_fold(cksum_add(0, ip, sizeof(*ip))) == 0xffff);
+
+	th = (struct tcphdr *)(ip + 1);
+	tcplen = len - ETHER_HDR_LEN - (int)sizeof(*ip);
+	datalen = tcplen - (int)sizeof(*th);
+	sum = cksum_add(0, &ip->ip_src, 2 * sizeof(ip->ip_src));
+	sum += IPPROTO_TCP + tcplen;
+	sum = cksum_add(sum, th, tcplen);
+	assert(cksum_fold(sum) == 0xffff);
+
+	assert(ntohl(th->th_seq) == rx.seq);
+	off = (rx.seq - ISS) % SUPER_SIZE;
+	assert(memcmp(th + 1, &payload[off], datalen) == 0);
+	assert(((th->th_flags & TH_PUSH) != 0) ==
+	    (off + datalen == SUPER_SIZE));
+	rx.seq += datalen;
+
+	++rx.frames;
+	if (rx.frames == rx.expected)
+		rtems_binary_semaphore_post(&rx.done);
+}
+
+static void
+wait_for_frames(u_int count)
+{
+	int rv;
+
+	rv = rtems_binary_semaphore_wait_timed_ticks(&rx.done,
+	    rtems_clock_get_ticks_per_second());
+	assert(rv == 0);
+	assert(rx.frames == count);
+}
+
+static void
+send_packet(uint32_t seq, int off, int len, bool tso)
+{
+	struct mbuf *m;
+	struct mbuf *n;
+	struct ip *ip;
+	struct tcphdr *th;
+	int done;
+	int error;
+
+	m = m_gethdr(M_WAITOK, MT_DATA);
+	m->m_data += max_linkhdr;
+	m->m_len = HDR_LEN;
+	m->m_pkthdr.len = HDR_LEN + len;
+
+	ip = mtod(m, struct ip *);
+	memset(ip, 0, HDR_LEN);
+	ip->ip_len = htons(HDR_LEN + len);
+	ip->ip_off = htons(IP_DF);
+	ip->ip_ttl = 64;
+	ip->ip_p = IPPROTO_TCP;
+	ip->ip_src.s_addr = htonl(ADDR_A);
+	ip->ip_dst.s_addr = htonl(ADDR_B);
+
+	th = (struct tcphdr *)(ip + 1);
+	th->th_sport = htons(PORT_A);
+	th->th_dport = htons(PORT_B);
+	th->th_seq = htonl(seq);
+	th->th_ack = htonl(1);
+	th->th_off = sizeof(*th) >> 2;
+	th->th_flags = TH_ACK;
+	if (off + len == SUPER_SIZE)
+		th->th_flags |= TH_PUSH;
+	th->th_win = htons(TCP_MAXWIN);
+
+	/* Place the payload in clusters like the socket buffer does */
+	m->m_next = m_getm2(NULL, len, M_WAITOK, MT_DATA, 0);
+	done = 0;
+	for (n = m->m_next; n != NULL; n = n->m_next) {
+		n->m_len = min(len - done, M_TRAILINGSPACE(n));
+		memcpy(mtod(n, char *), &payload[off + done], n->m_len);
+		done += n->m_len;
+	}
+	assert(done == len);
+
+	m->m_pkthdr.csum_flags = CSUM_TCP;
+	m->m_pkthdr.csum_data = offsetof(struct tcphdr, th_sum);
+	if (tso) {
+		m->m_pkthdr.csum_flags |= CSUM_TSO;
+		m->m_pkthdr.tso_segsz = MSS;
+		th->th_sum = in_pseudo(ip->ip_src.s_addr, ip->ip_dst.s_addr,
+		    htons(IPPROTO_TCP));
+	} else {
+		th->th_sum = in_pseudo(ip->ip_src.s_addr, ip->ip_dst.s_addr,
+		    htons(IPPROTO_TCP + sizeof(*th) + len));
+	}
+
+	error = ip_output(m, NULL, NULL, 0, NULL, NULL);
+	assert(error == 0);
+}
+
+static uint64_t
+send_rounds(int rounds, bool tso)
+{
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	int i;
+
+	begin = rtems_counter_read();
+
+	for (i = 0; i < rounds; ++i) {
+		int off;
+
+		rx.expected += SEGMENT_COUNT;
+
+		if (tso) {
+			send_packet(rx.seq, 0, SUPER_SIZE, true);
+		} else {
+			for (off = 0; off < SUPER_SIZE; off += MSS)
+				send_packet(rx.seq + off, off, MSS, false);
+		}
+
+		/* Stay below the epair(4) queue limit */
+		wait_for_frames(rx.expected);
+	}
+
+	end = rtems_counter_read();
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static void
+test_main(void)
+{
+	struct ifnet *ifp_a;
+	struct ifnet *ifp_b;
+	uint64_t mss_ns;
+	uint64_t gso_ns;
+	size_t i;
+
+	for (i = 0; i < sizeof(payload); ++i)
+		payload[i] = (uint8_t)(i % 251);
+
+	rtems_binary_semaphore_init(&rx.done, "GSO");
+	rx.seq = ISS;
+
+	ifconfig("epair0", "create", NULL, NULL);
+	ifconfig("epair0a", "inet", "192.0.2.1/24", "up");
+	ifconfig("epair0b", "up", NULL, NULL);
+	add_peer();
+
+	ifp_a = ifunit_ref("epair0a");
+	assert(ifp_a != NULL);
+	ifp_b = ifunit_ref("epair0b");
+	assert(ifp_b != NULL);
+
+	/* The epair(4) interfaces have no offloads, so all are emulated */
+	assert((ifp_a->if_capabilities & IFCAP_TSO4) != 0);
+	assert((ifp_a->if_capenable & IFCAP_TSO4) != 0);
+	assert(ifp_a->if_hwassist == (CSUM_IP_TSO | CSUM_IP_TCP));
+	assert(ifp_a->if_gso_assist == (CSUM_IP_TSO | CSUM_IP_TCP));
+
+	rx.input = ifp_b->if_input;
+	ifp_b->if_input = test_input;
+
+	/* Without the emulated offload, the stack sends MSS sized packets */
+	ether_gso_setcap(ifp_a, 0);
+	assert((ifp_a->if_capenable & IFCAP_TSO4) == 0);
+	assert(ifp_a->if_hwassist == 0);
+	assert(ifp_a->if_gso_assist == 0);
+	(void)send_rounds(1, false);
+	mss_ns = send_rounds(ROUND_COUNT, false);
+
+	ether_gso_setcap(ifp_a, 1);
+	assert((ifp_a->if_capenable & IFCAP_TSO4) != 0);
+	assert(ifp_a->if_hwassist == (CSUM_IP_TSO | CSUM_IP_TCP));
+	(void)send_rounds(1, true);
+	gso_ns = send_rounds(ROUND_COUNT, true);
+
+	/* Delayed checksums of packets without TSO */
+	(void)send_rounds(1, false);
+
+	/*
+	 * The stage must follow offload changes of the driver made after the
+	 * attach.  The epair(4) does not compute the IP header checksum, so it
+	 * stays zero if it is offloaded.
+	 */
+	ifp_a->if_hwassist |= CSUM_IP;
+	rx.ip_sum_offloaded = true;
+	(void)send_rounds(1, true);
+	(void)send_rounds(1, false);
+	ifp_a->if_hwassist &= ~CSUM_IP;
+	rx.ip_sum_offloaded = false;
+	(void)send_rounds(1, true);
+
+	ifp_b->if_input = rx.input;
+	if_rele(ifp_b);
+	if_rele(ifp_a);
+	ifconfig("epair0a", "destroy", NULL, NULL);
+	rtems_binary_semaphore_destroy(&rx.done);
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <Bytes>%i</Bytes>\n", ROUND_COUNT * SUPER_SIZE);
+	printf("  <MSS>%i</MSS>\n", MSS);
+	printf("  <MSSNanoseconds>%" PRIu64 "</MSSNanoseconds>\n", mss_ns);
+	printf("  <GSONanoseconds>%" PRIu64 "</GSONanoseconds>\n", gso_ns);
+	printf("  <MSSBytesPerSecond>%" PRIu64 "</MSSBytesPerSecond>\n",
+	    (uint64_t)ROUND_COUNT * SUPER_SIZE * 1000000000 / (mss_ns + 1));
+	printf("  <GSOBytesPerSecond>%" PRIu64 "</GSOBytesPerSecond>\n",
+	    (uint64_t)ROUND_COUNT * SUPER_SIZE * 1000000000 / (gso_ns + 1));
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <machine/rtems-bsd-sysinit.h>
+
+SYSINIT_MODULE_REFERENCE(if_epair);
+
+#include <rtems/bsd/test/default-init.h>
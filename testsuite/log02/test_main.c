@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/types.h>
+#include <sys/syslog.h>
+#include <sys/systm.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+#define TEST_NAME "LIBBSD LOG 2"
+
+#define MSG_COUNT 16
+
+typedef struct {
+	char text[MSG_COUNT][128];
+	int level[MSG_COUNT];
+	size_t len;
+	volatile size_t count;
+} test_context;
+
+static test_context test_instance;
+
+static void
+vprintf_putchar(int c, void *arg)
+{
+	test_context *ctx;
+
+	ctx = arg;
+
+	if (ctx->len + 1 < sizeof(ctx->text[0])) {
+		ctx->text[ctx->count][ctx->len] = (char) c;
+		++ctx->len;
+	}
+}
+
+static int
+vprintf_handler(int level, const char *fmt, va_list ap)
+{
+	test_context *ctx;
+	int n;
+
+	ctx = &test_instance;
+	assert(ctx->count < MSG_COUNT);
+
+	ctx->len = 0;
+	n = kvprintf(fmt, vprintf_putchar, ctx, 10, ap);
+	ctx->text[ctx->count][ctx->len] = '\0';
+	ctx->level[ctx->count] = level;
+	++ctx->count;
+	return (n);
+}
+
+static void
+check(test_context *ctx, size_t i, int level, const char *text)
+{
+
+	assert(ctx->level[i] == level);
+	assert(strcmp(&ctx->text[i][0], text) == 0);
+}
+
+static void
+wait_for_messages(test_context *ctx, size_t count)
+{
+	int i;
+
+	for (i = 0; i < 100 && ctx->count < count; ++i) {
+		rtems_status_code sc;
+
+		sc = rtems_task_wake_after(1);
+		assert(sc == RTEMS_SUCCESSFUL);
+	}
+
+	assert(ctx->count == count);
+}
+
+static void
+test_main(void)
+{
+	test_context *ctx;
+	rtems_status_code sc;
+	char buf[8];
+
+	ctx = &test_instance;
+
+	rtems_bsd_set_vprintf_handler(vprintf_handler);
+
+	sc = rtems_bsd_vprintf_deferred_start(0, 250);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bsd_vprintf_deferred_start(0, 250);
+	assert(sc == RTEMS_INCORRECT_STATE);
+
+	/* The output task has a lower priority, so nothing is output yet */
+	strlcpy(buf, "abc", sizeof(buf));
+	printf("printf %i %s %lu %jx", -1, buf, 2UL, (uintmax_t)0xff);
+	strlcpy(buf, "xyz", sizeof(buf));
+	log(LOG_INFO, "log %*d|%-*s|%%", 4, 5, 3, "a");
+	syslog(LOG_WARNING, "syslog %s", (const char *)NULL);
+	printf("reg=%b", 3, "\10\2BITTWO\1BITONE");
+	printf("out:	%4D", "AAAA", ":");
+	errno = ENOMSG;
+	printf("%m");
+	errno = 0;
+	assert(ctx->count == 0);
+
+	/* Critical messages are output immediately */
+	log(LOG_CRIT, "crit %i", 1);
+	assert(ctx->count == 1);
+	check(ctx, 0, LOG_CRIT, "crit 1");
+
+	wait_for_messages(ctx, 7);
+	check(ctx, 1, LOG_PRINTF, "printf -1 abc 2 ff");
+	check(ctx, 2, LOG_INFO, "log    5|a  |%");
+	check(ctx, 3, LOG_WARNING, "syslog (null)");
+	check(ctx, 4, LOG_PRINTF, "reg=3<BITTWO,BITONE>");
+	check(ctx, 5, LOG_PRINTF, "out:	41:41:41:41");
+	check(ctx, 6, LOG_PRINTF, "No message of desired type");
+
+	rtems_bsd_vprintf_deferred_dump(stdout);
+
+	exit(0);
+}
+
+#include <rtems/bsd/test/default-init.h>
@@ -56,6 +56,11 @@ test_main(void)
 		    NULL);
 	} while (rv != 0);
 
+	rv = mount_and_make_target_path(&remote_target[0], "/nfs-tcp",
+	    RTEMS_FILESYSTEM_TYPE_NFS, RTEMS_FILESYSTEM_READ_WRITE,
+	    "proto=tcp");
+	assert(rv == 0);
+
 	rtems_task_delete(RTEMS_SELF);
 	assert(0);
 }
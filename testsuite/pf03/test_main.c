@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+
+#include <net/if.h>
+#include <net/pfvar.h>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/counter.h>
+
+#define TEST_NAME "LIBBSD PF 3"
+
+#define TEST_XML_NAME "TestPF03"
+
+#define TABLE_NAME "blocklist"
+
+#define ENTRY_COUNT 20000
+
+#define ENTRY_BATCH 1000
+
+#define PACKET_COUNT 20000
+
+#define PACKET_BATCH 2000
+
+static struct pfr_addr entries[ENTRY_BATCH];
+
+static struct pfr_addr packets[PACKET_COUNT];
+
+static u_int8_t radix_fback[PACKET_COUNT];
+
+static uint32_t test_seed = 12345;
+
+static uint32_t
+test_random(void)
+{
+
+	test_seed = test_seed * 1103515245 + 12345;
+	return ((test_seed >> 16) | (test_seed << 16));
+}
+
+static void
+init_table(struct pfr_table *tbl)
+{
+
+	memset(tbl, 0, sizeof(*tbl));
+	strlcpy(tbl->pfrt_name, TABLE_NAME, sizeof(tbl->pfrt_name));
+}
+
+static void
+set_table_compile(int enable)
+{
+	int rv;
+
+	rv = sysctlbyname("net.pf.table_compile", NULL, NULL, &enable,
+	    sizeof(enable));
+	assert(rv == 0);
+}
+
+static u_long
+get_table_compiles(void)
+{
+	u_long compiles;
+	size_t len;
+	int rv;
+
+	len = sizeof(compiles);
+	rv = sysctlbyname("net.pf.table_compiles", &compiles, &len, NULL, 0);
+	assert(rv == 0);
+	return (compiles);
+}
+
+static void
+add_table(int dev)
+{
+	struct pfioc_table io;
+	struct pfr_table tbl;
+	int rv;
+
+	init_table(&tbl);
+	tbl.pfrt_flags = PFR_TFLAG_PERSIST;
+
+	memset(&io, 0, sizeof(io));
+	io.pfrio_buffer = &tbl;
+	io.pfrio_esize = sizeof(tbl);
+	io.pfrio_size = 1;
+	rv = ioctl(dev, DIOCRADDTABLES, &io);
+	assert(rv == 0);
+	assert(io.pfrio_nadd == 1);
+}
+
+static size_t
+add_entries(int dev)
+{
+	size_t added;
+
+	added = 0;
+
+	while (added < ENTRY_COUNT) {
+		struct pfioc_table io;
+		size_t i;
+		int rv;
+
+		for (i = 0; i < ENTRY_BATCH; ++i) {
+			struct pfr_addr *ad;
+			uint32_t m;
+			int net;
+
+			ad = &entries[i];
+			memset(ad, 0, sizeof(*ad));
+
+			/* Mostly hosts and a few wide networks */
+			if (test_random() % 4 == 0) {
+				net = 8 + (int)(test_random() % 24);
+			} else {
+				net = 32;
+			}
+
+			m = 0xffffffffU << (32 - net);
+			ad->pfra_af = AF_INET;
+			ad->pfra_net = (u_int8_t)net;
+			ad->pfra_not = (test_random() % 16 == 0);
+			ad->pfra_ip4addr.s_addr = htonl(test_random() & m);
+		}
+
+		memset(&io, 0, sizeof(io));
+		init_table(&io.pfrio_table);
+		io.pfrio_buffer = entries;
+		io.pfrio_esize = sizeof(entries[0]);
+		io.pfrio_size = ENTRY_BATCH;
+		rv = ioctl(dev, DIOCRADDADDRS, &io);
+		assert(rv == 0);
+		added += (size_t)io.pfrio_nadd;
+	}
+
+	return (added);
+}
+
+static uint64_t
+replay_packets(int dev, bool check)
+{
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	size_t i;
+
+	begin = rtems_counter_read();
+
+	for (i = 0; i < PACKET_COUNT; i += PACKET_BATCH) {
+		struct pfioc_table io;
+		int rv;
+
+		memset(&io, 0, sizeof(io));
+		init_table(&io.pfrio_table);
+		io.pfrio_buffer = &packets[i];
+		io.pfrio_esize = sizeof(packets[0]);
+		io.pfrio_size = PACKET_BATCH;
+		rv = ioctl(dev, DIOCRTSTADDRS, &io);
+		assert(rv == 0);
+	}
+
+	end = rtems_counter_read();
+
+	for (i = 0; i < PACKET_COUNT; ++i) {
+		if (check) {
+			assert(packets[i].pfra_fback == radix_fback[i]);
+		} else {
+			radix_fback[i] = (u_int8_t)packets[i].pfra_fback;
+		}
+
+		packets[i].pfra_fback = PFR_FB_NONE;
+	}
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static void
+test_main(void)
+{
+	uint64_t radix_ns;
+	uint64_t compiled_ns;
+	u_long compiles;
+	size_t entry_count;
+	size_t matches;
+	size_t i;
+	int dev;
+	int rv;
+
+	dev = open("/dev/pf", O_RDWR);
+	assert(dev >= 0);
+
+	set_table_compile(0);
+	add_table(dev);
+	entry_count = add_entries(dev);
+
+	for (i = 0; i < PACKET_COUNT; ++i) {
+		struct pfr_addr *ad;
+
+		ad = &packets[i];
+		ad->pfra_af = AF_INET;
+		ad->pfra_net = 32;
+		ad->pfra_ip4addr.s_addr = htonl(test_random());
+	}
+
+	(void)replay_packets(dev, false);
+	radix_ns = replay_packets(dev, true);
+
+	matches = 0;
+
+	for (i = 0; i < PACKET_COUNT; ++i) {
+		if (radix_fback[i] != PFR_FB_NONE) {
+			++matches;
+		}
+	}
+
+	compiles = get_table_compiles();
+	set_table_compile(1);
+	assert(get_table_compiles() == compiles + 1);
+	compiled_ns = replay_packets(dev, true);
+
+	rv = close(dev);
+	assert(rv == 0);
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <Entries>%zu</Entries>\n", entry_count);
+	printf("  <Packets>%i</Packets>\n", PACKET_COUNT);
+	printf("  <Matches>%zu</Matches>\n", matches);
+	printf("  <RadixNanoseconds>%" PRIu64 "</RadixNanoseconds>\n",
+	    radix_ns);
+	printf("  <CompiledNanoseconds>%" PRIu64 "</CompiledNanoseconds>\n",
+	    compiled_ns);
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <machine/rtems-bsd-sysinit.h>
+
+#define RTEMS_BSD_CONFIG_FIREWALL_PF
+
+#include <rtems/bsd/test/default-init.h>
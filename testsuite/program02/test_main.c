@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define RTEMS_BSD_PROGRAM_NO_EXIT_WRAP
+#define RTEMS_BSD_PROGRAM_NO_PRINTF_WRAP
+#define RTEMS_BSD_PROGRAM_NO_FOPEN_WRAP
+#define RTEMS_BSD_PROGRAM_NO_FCLOSE_WRAP
+#include <machine/rtems-bsd-program.h>
+#include <machine/rtems-bsd-commands.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+#include <rtems/counter.h>
+#include <rtems/libcsupport.h>
+
+#define TEST_NAME "LIBBSD PROGRAM 2"
+
+#define TEST_XML_NAME "TestProgram02"
+
+#define ALLOC_COUNT 20000
+
+#define RULE_COUNT 2000
+
+#define ETC_PF_CONF "/etc/pf.conf"
+
+#define ETC_PF_OS "/etc/pf.os"
+
+#define ETC_PROTOCOLS "/etc/protocols"
+
+static void *blocks[ALLOC_COUNT];
+
+typedef enum {
+	FREE_NONE,
+	FREE_OLDEST_FIRST,
+	FREE_NEWEST_FIRST
+} free_order;
+
+static int
+alloc_program(void *arg)
+{
+	free_order order;
+	size_t i;
+
+	order = (free_order)(uintptr_t)arg;
+
+	for (i = 0; i < ALLOC_COUNT; ++i) {
+		blocks[i] = malloc(16 + i % 64);
+		assert(blocks[i] != NULL);
+	}
+
+	for (i = 0; i < ALLOC_COUNT; i += 2) {
+		blocks[i] = realloc(blocks[i], 128);
+		assert(blocks[i] != NULL);
+	}
+
+	switch (order) {
+	case FREE_OLDEST_FIRST:
+		for (i = 0; i < ALLOC_COUNT; ++i) {
+			free(blocks[i]);
+		}
+		break;
+	case FREE_NEWEST_FIRST:
+		for (i = ALLOC_COUNT; i > 0; --i) {
+			free(blocks[i - 1]);
+		}
+		break;
+	default:
+		/* Freed by rtems_bsd_program_call() */
+		break;
+	}
+
+	return (0);
+}
+
+static uint64_t
+measure_alloc(free_order order)
+{
+	rtems_resource_snapshot snapshot;
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	int exit_code;
+
+	rtems_resource_snapshot_take(&snapshot);
+
+	begin = rtems_counter_read();
+	exit_code = rtems_bsd_program_call("alloc", alloc_program,
+	    (void *)(uintptr_t)order);
+	end = rtems_counter_read();
+	assert(exit_code == 0);
+
+	assert(rtems_resource_snapshot_check(&snapshot));
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static void
+write_file(const char *name, const char *content)
+{
+	FILE *file;
+	int rv;
+
+	file = fopen(name, "w");
+	assert(file != NULL);
+	rv = fputs(content, file);
+	assert(rv >= 0);
+	rv = fclose(file);
+	assert(rv == 0);
+}
+
+static void
+prepare_files(void)
+{
+	FILE *file;
+	int rv;
+	int i;
+
+	(void)mkdir("/etc", S_IRWXU | S_IRWXG | S_IRWXO);
+
+	write_file(ETC_PF_OS, "# empty\n");
+	write_file(ETC_PROTOCOLS,
+	    "ip	0	IP\n"
+	    "tcp	6	TCP\n"
+	    "udp	17	UDP\n");
+
+	file = fopen(ETC_PF_CONF, "w");
+	assert(file != NULL);
+
+	rv = fprintf(file, "block all\n");
+	assert(rv > 0);
+
+	for (i = 0; i < RULE_COUNT; ++i) {
+		rv = fprintf(file, "pass in quick inet proto %s from "
+		    "10.%i.%i.0/24 to any port %i keep state\n",
+		    (i & 1) != 0 ? "udp" : "tcp", (i >> 8) & 0xff, i & 0xff,
+		    1024 + i);
+		assert(rv > 0);
+	}
+
+	rv = fclose(file);
+	assert(rv == 0);
+}
+
+static uint64_t
+measure_pfctl(void)
+{
+	char *pfctl[] = { "pfctl", "-q", "-f", ETC_PF_CONF, NULL };
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	int exit_code;
+
+	begin = rtems_counter_read();
+	exit_code = rtems_bsd_command_pfctl(RTEMS_BSD_ARGC(pfctl), pfctl);
+	end = rtems_counter_read();
+	assert(exit_code == EXIT_SUCCESS);
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static void
+test_main(void)
+{
+	uint64_t exit_ns;
+	uint64_t oldest_ns;
+	uint64_t newest_ns;
+	uint64_t pfctl_ns;
+
+	exit_ns = measure_alloc(FREE_NONE);
+	oldest_ns = measure_alloc(FREE_OLDEST_FIRST);
+	newest_ns = measure_alloc(FREE_NEWEST_FIRST);
+
+	prepare_files();
+	pfctl_ns = measure_pfctl();
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <Allocations>%i</Allocations>\n", ALLOC_COUNT);
+	printf("  <FreeOnExitNanoseconds>%" PRIu64
+	    "</FreeOnExitNanoseconds>\n", exit_ns);
+	printf("  <FreeOldestFirstNanoseconds>%" PRIu64
+	    "</FreeOldestFirstNanoseconds>\n", oldest_ns);
+	printf("  <FreeNewestFirstNanoseconds>%" PRIu64
+	    "</FreeNewestFirstNanoseconds>\n", newest_ns);
+	printf("  <PfctlRules>%i</PfctlRules>\n", RULE_COUNT);
+	printf("  <PfctlNanoseconds>%" PRIu64 "</PfctlNanoseconds>\n",
+	    pfctl_ns);
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <machine/rtems-bsd-sysinit.h>
+
+#define RTEMS_BSD_CONFIG_FIREWALL_PF
+
+#include <rtems/bsd/test/default-init.h>
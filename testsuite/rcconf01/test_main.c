@@ -56,6 +56,7 @@ static const char* rc_conf_regex = \
 static bool test_regex_results[NUM_OF_TEST_REGEX_];
 static int  test_regex_last_num;
 static int  test_service_last_num;
+static int  test_service_concurrent_runs;
 
 static const char* rc_conf_not_found = \
   "# invalid directive.\n" \
@@ -182,6 +183,20 @@ test_service_5(rtems_bsd_rc_conf* rc_conf)
   return 0;
 }
 
+static int
+test_service_concurrent(rtems_bsd_rc_conf* rc_conf)
+{
+  rtems_bsd_rc_conf_argc_argv* aa;
+  puts("test_service_concurrent");
+  assert(test_service_last_num >= 2);
+  assert((aa = rtems_bsd_rc_conf_argc_argv_create()) != NULL);
+  assert(rtems_bsd_rc_conf_find(rc_conf, "test_regex_1", aa) == 0);
+  rtems_bsd_rc_conf_argc_argv_destroy(aa);
+  usleep(100000);
+  ++test_service_concurrent_runs;
+  return 0;
+}
+
 static int
 test_service_bad(rtems_bsd_rc_conf* rc_conf)
 {
@@ -208,12 +223,26 @@ test_regex_check(void)
     assert(test_regex_results[i]);
 }
 
+static void
+test_service_profile_check(void)
+{
+  rtems_bsd_rc_conf_service_profile profile;
+  assert(rtems_bsd_rc_conf_service_profile_get("test_service_concurrent",
+                                               &profile) == 0);
+  assert(profile.result == 0);
+  assert(profile.queued <= profile.start);
+  assert(profile.end - profile.start >= 100000000ULL);
+  assert(rtems_bsd_rc_conf_service_profile_get("no_service", &profile) < 0);
+  assert(errno == ENOENT);
+}
+
 static void
 test_regex_reset(void)
 {
   memset(&test_regex_results[0], 0, sizeof(test_regex_results));
   test_regex_last_num = 0;
   test_service_last_num = 0;
+  test_service_concurrent_runs = 0;
  }
 
 static void
@@ -224,6 +253,8 @@ test_etc_rc_conf(void)
   test_regex_reset();
   assert(rtems_bsd_run_etc_rc_conf(0, true) == 0);
   test_regex_check();
+  assert(test_service_concurrent_runs == 1);
+  test_service_profile_check();
 }
 
 static void
@@ -285,6 +316,15 @@ setup(void)
   assert(rtems_bsd_rc_conf_service_add("test_service_bad",
                                        "yyyy:xxxx;",
                                        test_service_bad) < 0);
+  assert(rtems_bsd_rc_conf_service_add("test_service_bad",
+                                       "start:xxxx;",
+                                       test_service_bad) < 0);
+  assert(rtems_bsd_rc_conf_service_add("test_service_bad",
+                                       "wait:xxxx;",
+                                       test_service_bad) < 0);
+  assert(rtems_bsd_rc_conf_service_add("test_service_concurrent",
+                                       "after:test_service_2;start:concurrent;",
+                                       test_service_concurrent) == 0);
   assert(rtems_bsd_rc_conf_service_add("test_service",
                                        "after:first;",
                                        test_service) == 0);
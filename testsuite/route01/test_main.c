@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <machine/rtems-bsd-kernel-space.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/systm.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+
+#include <net/if.h>
+#include <net/route.h>
+
+#include <netinet/in.h>
+#include <netinet/in_fib.h>
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtems.h>
+#include <rtems/counter.h>
+
+#define TEST_NAME "LIBBSD ROUTE 1"
+
+#define TEST_XML_NAME "TestRoute01"
+
+#define ROUTE_COUNT 4000
+
+#define LOOKUP_COUNT 100000
+
+static uint32_t addrs[LOOKUP_COUNT];
+
+static struct nhop4_basic nhs[LOOKUP_COUNT];
+
+static uint32_t test_seed = 12345;
+
+/* Make the next hops distinguishable by their flags */
+static const int route_flags[] = {
+	0,
+	RTF_BLACKHOLE,
+	RTF_REJECT
+};
+
+static uint32_t
+test_random(void)
+{
+
+	test_seed = test_seed * 1103515245 + 12345;
+	return ((test_seed >> 16) | (test_seed << 16));
+}
+
+static void
+init_sin(struct sockaddr_in *sin, uint32_t addr)
+{
+
+	memset(sin, 0, sizeof(*sin));
+	sin->sin_len = sizeof(*sin);
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = htonl(addr);
+}
+
+static void
+set_dxr_enable(int enable)
+{
+	int rv;
+
+	rv = sysctlbyname("net.inet.ip.dxr.enable", NULL, NULL, &enable,
+	    sizeof(enable));
+	assert(rv == 0);
+}
+
+static u_long
+get_dxr_rebuilds(void)
+{
+	u_long rebuilds;
+	size_t len;
+	int rv;
+
+	len = sizeof(rebuilds);
+	rv = sysctlbyname("net.inet.ip.dxr.rebuilds", &rebuilds, &len, NULL,
+	    0);
+	assert(rv == 0);
+	return (rebuilds);
+}
+
+static void
+add_routes(void)
+{
+	size_t i;
+	size_t added;
+
+	added = 0;
+
+	for (i = 0; added < ROUTE_COUNT; ++i) {
+		struct sockaddr_in dst;
+		struct sockaddr_in gw;
+		struct sockaddr_in mask;
+		uint32_t addr;
+		uint32_t m;
+		int plen;
+		int error;
+
+		plen = 8 + (int)(test_random() % 21);
+		m = 0xffffffffU << (32 - plen);
+		addr = test_random() & m;
+
+		if ((addr >> 24) == 0 || (addr >> 24) == 127 ||
+		    (addr >> 24) >= 224) {
+			continue;
+		}
+
+		init_sin(&dst, addr);
+		init_sin(&gw, INADDR_LOOPBACK);
+		init_sin(&mask, m);
+
+		error = rtrequest_fib(RTM_ADD, (struct sockaddr *)&dst,
+		    (struct sockaddr *)&gw, (struct sockaddr *)&mask,
+		    RTF_GATEWAY | RTF_STATIC | route_flags[added % 3], NULL,
+		    0);
+		assert(error == 0 || error == EEXIST);
+
+		if (error == 0) {
+			++added;
+		}
+	}
+}
+
+static void
+wait_for_rebuild(void)
+{
+	struct nhop4_basic nh;
+	struct in_addr dst;
+	u_long rebuilds;
+
+	rebuilds = get_dxr_rebuilds();
+	dst.s_addr = htonl(0x0a000001);
+	(void)fib4_lookup_nh_basic(0, dst, 0, 0, &nh);
+
+	while (get_dxr_rebuilds() == rebuilds) {
+		rtems_task_wake_after(1);
+	}
+}
+
+static uint64_t
+lookup_all(bool check)
+{
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	size_t i;
+
+	begin = rtems_counter_read();
+
+	for (i = 0; i < LOOKUP_COUNT; ++i) {
+		struct nhop4_basic nh;
+		struct in_addr dst;
+		int error;
+
+		dst.s_addr = addrs[i];
+		memset(&nh, 0, sizeof(nh));
+		error = fib4_lookup_nh_basic(0, dst, 0, 0, &nh);
+
+		if (check) {
+			assert((error == 0) == (nhs[i].nh_ifp != NULL));
+			assert(nh.nh_ifp == nhs[i].nh_ifp);
+			assert(nh.nh_addr.s_addr == nhs[i].nh_addr.s_addr);
+			assert(nh.nh_flags == nhs[i].nh_flags);
+		} else if (error == 0) {
+			nhs[i] = nh;
+		} else {
+			memset(&nhs[i], 0, sizeof(nhs[i]));
+		}
+	}
+
+	end = rtems_counter_read();
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static void
+test_main(void)
+{
+	uint64_t radix_ns;
+	uint64_t dxr_ns;
+	size_t i;
+
+	add_routes();
+
+	for (i = 0; i < LOOKUP_COUNT; ++i) {
+		addrs[i] = htonl(test_random());
+	}
+
+	set_dxr_enable(0);
+	(void)lookup_all(false);
+	radix_ns = lookup_all(true);
+
+	set_dxr_enable(1);
+	wait_for_rebuild();
+	dxr_ns = lookup_all(true);
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <Routes>%i</Routes>\n", ROUTE_COUNT);
+	printf("  <Lookups>%i</Lookups>\n", LOOKUP_COUNT);
+	printf("  <RadixNanoseconds>%" PRIu64 "</RadixNanoseconds>\n",
+	    radix_ns);
+	printf("  <DXRNanoseconds>%" PRIu64 "</DXRNanoseconds>\n", dxr_ns);
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <rtems/bsd/test/default-init.h>
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+
+#define TEST_NAME "LIBBSD SYSLOG 1"
+
+#define TEST_PORT "5514"
+
+static int
+open_server(void)
+{
+	struct sockaddr_in addr;
+	struct timeval tv;
+	int sd;
+	int rv;
+
+	sd = socket(AF_INET, SOCK_DGRAM, 0);
+	assert(sd >= 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)atoi(TEST_PORT));
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	rv = bind(sd, (const struct sockaddr *)&addr, sizeof(addr));
+	assert(rv == 0);
+
+	tv.tv_sec = 5;
+	tv.tv_usec = 0;
+	rv = setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	assert(rv == 0);
+
+	return (sd);
+}
+
+static void
+check_message(const char *line, const char *pri, const char *msg)
+{
+	const char *p;
+
+	assert(strncmp(line, pri, strlen(pri)) == 0);
+
+	/* Skip timestamp and hostname */
+	p = strstr(line, " test - - - ");
+	assert(p != NULL);
+	p += strlen(" test - - - ");
+	assert(strncmp(p, msg, strlen(msg)) == 0);
+	assert(p[strlen(msg)] == '\0' || p[strlen(msg)] == '\n');
+}
+
+static void
+test_main(void)
+{
+	rtems_bsd_syslog_remote_config config;
+	rtems_bsd_syslog_remote_stats stats;
+	rtems_status_code sc;
+	char buf[2048];
+	char *second;
+	char *third;
+	ssize_t n;
+	int exit_code;
+	int sd;
+	int i;
+
+	exit_code = rtems_bsd_ifconfig_lo0();
+	assert(exit_code == 0);
+
+	sd = open_server();
+
+	memset(&config, 0, sizeof(config));
+	config.host = "127.0.0.1";
+	config.port = TEST_PORT;
+	config.batch_size = sizeof(buf);
+	config.flush_interval = rtems_clock_get_ticks_per_second();
+	config.priority = 200;
+
+	sc = rtems_bsd_syslog_remote_start(&config);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bsd_syslog_remote_start(&config);
+	assert(sc == RTEMS_INCORRECT_STATE);
+
+	openlog("test", LOG_PID, LOG_LOCAL0);
+
+	/* Three messages are sent in one datagram */
+	syslog(LOG_NOTICE, "first %i", 1);
+	syslog(LOG_ERR | LOG_DAEMON, "second %s\n", "2");
+	errno = ENOMSG;
+	syslog(LOG_WARNING, "third %m %%m");
+
+	/* Filtered by the syslog mask */
+	syslog(LOG_DEBUG, "debug");
+
+	n = recv(sd, buf, sizeof(buf) - 1, 0);
+	assert(n > 0);
+	buf[n] = '\0';
+
+	second = strchr(buf, '\n');
+	assert(second != NULL);
+	++second;
+	third = strchr(second, '\n');
+	assert(third != NULL);
+	++third;
+	assert(strchr(third, '\n') == NULL);
+
+	check_message(buf, "<133>1 ", "first 1");
+	check_message(second, "<27>1 ", "second 2");
+	check_message(third, "<132>1 ",
+	    "third No message of desired type %m");
+
+	/* The statistics are updated after the send */
+	for (i = 0; i < 100; ++i) {
+		rtems_bsd_syslog_remote_get_stats(&stats);
+		if (stats.sent == 3) {
+			break;
+		}
+
+		sc = rtems_task_wake_after(1);
+		assert(sc == RTEMS_SUCCESSFUL);
+	}
+
+	assert(stats.queued == 3);
+	assert(stats.sent == 3);
+	assert(stats.batches == 1);
+	assert(stats.dropped == 0);
+	assert(stats.send_errors == 0);
+
+	closelog();
+
+	exit(0);
+}
+
+#include <rtems/bsd/test/default-init.h>
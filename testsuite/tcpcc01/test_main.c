@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/bsd/bsd.h>
+#include <rtems/counter.h>
+
+#define TEST_NAME "LIBBSD TCPCC 1"
+
+#define TEST_XML_NAME "TestTCPCC01"
+
+#define TEST_PORT 4321
+
+#define TRANSFER_SIZE (32 * 1024 * 1024)
+
+#define CHUNK_SIZE (64 * 1024)
+
+/*
+ * Large socket buffers so that the window and not the buffer limits the
+ * transfer.
+ */
+#define SOCKET_BUFFER_SIZE (1024 * 1024)
+
+/*
+ * Emulated path with a bandwidth-delay product of about 600KiB.  Data and
+ * acknowledgements both leave through lo0, so the round-trip time is twice the
+ * pipe delay.
+ */
+#define PATH_DELAY_MS 25
+
+#define PATH_BANDWIDTH_KBITPS 100000
+
+#define PATH_QSIZE 50
+
+static const char * const algorithms[] = {
+	"newreno",
+	"cubic",
+	"htcp"
+};
+
+static char chunk[CHUNK_SIZE];
+
+static char sink[CHUNK_SIZE];
+
+static sem_t server_done;
+
+static size_t server_received;
+
+static void
+set_buffer_sizes(int sd)
+{
+	int size;
+	int rv;
+
+	size = SOCKET_BUFFER_SIZE;
+	rv = setsockopt(sd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	assert(rv == 0);
+	rv = setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	assert(rv == 0);
+}
+
+static void
+set_pipe_uint(const char *name, u_int val)
+{
+	int rv;
+
+	rv = sysctlbyname(name, NULL, NULL, &val, sizeof(val));
+	assert(rv == 0);
+}
+
+static void
+set_pipe_string(const char *name, const char *val)
+{
+	int rv;
+
+	rv = sysctlbyname(name, NULL, NULL, val, strlen(val) + 1);
+	assert(rv == 0);
+}
+
+static void
+setup_path(void)
+{
+
+	set_pipe_uint("net.inet.ip.dnpipe.0.dir", 2);
+	set_pipe_uint("net.inet.ip.dnpipe.0.delay", PATH_DELAY_MS);
+	set_pipe_uint("net.inet.ip.dnpipe.0.bandwidth", PATH_BANDWIDTH_KBITPS);
+	set_pipe_uint("net.inet.ip.dnpipe.0.qsize", PATH_QSIZE);
+	set_pipe_string("net.inet.ip.dnpipe.0.ifname", "lo0");
+}
+
+static void
+set_default_algorithm(const char *name)
+{
+	char buf[TCP_CA_NAME_MAX];
+	size_t len;
+	int rv;
+
+	rv = sysctlbyname("net.inet.tcp.cc.algorithm", NULL, NULL, name,
+	    strlen(name) + 1);
+	assert(rv == 0);
+
+	len = sizeof(buf);
+	rv = sysctlbyname("net.inet.tcp.cc.algorithm", buf, &len, NULL, 0);
+	assert(rv == 0);
+	assert(strcmp(buf, name) == 0);
+}
+
+static void
+check_algorithm(int sd, const char *name)
+{
+	char buf[TCP_CA_NAME_MAX];
+	socklen_t len;
+	int rv;
+
+	len = sizeof(buf);
+	rv = getsockopt(sd, IPPROTO_TCP, TCP_CONGESTION, buf, &len);
+	assert(rv == 0);
+	assert(strcmp(buf, name) == 0);
+}
+
+static void *
+server_thread(void *arg)
+{
+	int ld;
+
+	ld = (int)(intptr_t)arg;
+
+	while (true) {
+		int sd;
+		ssize_t n;
+		size_t received;
+		int rv;
+
+		sd = accept(ld, NULL, NULL);
+		assert(sd >= 0);
+
+		received = 0;
+
+		while ((n = read(sd, sink, sizeof(sink))) > 0) {
+			received += (size_t)n;
+		}
+
+		assert(n == 0);
+
+		rv = close(sd);
+		assert(rv == 0);
+
+		server_received = received;
+		rv = sem_post(&server_done);
+		assert(rv == 0);
+	}
+
+	return (NULL);
+}
+
+static int
+start_server(void)
+{
+	struct sockaddr_in addr;
+	pthread_t t;
+	int ld;
+	int rv;
+	int eno;
+
+	ld = socket(PF_INET, SOCK_STREAM, 0);
+	assert(ld >= 0);
+
+	set_buffer_sizes(ld);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TEST_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	rv = bind(ld, (const struct sockaddr *)&addr, sizeof(addr));
+	assert(rv == 0);
+
+	rv = listen(ld, 1);
+	assert(rv == 0);
+
+	eno = pthread_create(&t, NULL, server_thread, (void *)(intptr_t)ld);
+	assert(eno == 0);
+
+	return (ld);
+}
+
+static uint64_t
+transfer(const char *name)
+{
+	struct sockaddr_in addr;
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	size_t sent;
+	int sd;
+	int rv;
+
+	sd = socket(PF_INET, SOCK_STREAM, 0);
+	assert(sd >= 0);
+
+	set_buffer_sizes(sd);
+
+	rv = setsockopt(sd, IPPROTO_TCP, TCP_CONGESTION, name,
+	    strlen(name) + 1);
+	assert(rv == 0);
+	check_algorithm(sd, name);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_len = sizeof(addr);
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(TEST_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	begin = rtems_counter_read();
+
+	rv = connect(sd, (const struct sockaddr *)&addr, sizeof(addr));
+	assert(rv == 0);
+
+	sent = 0;
+
+	while (sent < TRANSFER_SIZE) {
+		ssize_t n;
+
+		n = write(sd, chunk, sizeof(chunk));
+		assert(n > 0);
+		sent += (size_t)n;
+	}
+
+	rv = close(sd);
+	assert(rv == 0);
+
+	rv = sem_wait(&server_done);
+	assert(rv == 0);
+
+	end = rtems_counter_read();
+
+	assert(server_received == sent);
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static void
+test_default_algorithm(void)
+{
+	size_t i;
+
+	for (i = 0; i < nitems(algorithms); ++i) {
+		int sd;
+		int rv;
+
+		set_default_algorithm(algorithms[i]);
+
+		sd = socket(PF_INET, SOCK_STREAM, 0);
+		assert(sd >= 0);
+
+		check_algorithm(sd, algorithms[i]);
+
+		rv = close(sd);
+		assert(rv == 0);
+	}
+
+	set_default_algorithm("newreno");
+}
+
+static void
+test_unknown_algorithm(void)
+{
+	static const char name[] = "nonexistent";
+	int sd;
+	int rv;
+
+	sd = socket(PF_INET, SOCK_STREAM, 0);
+	assert(sd >= 0);
+
+	errno = 0;
+	rv = setsockopt(sd, IPPROTO_TCP, TCP_CONGESTION, name, sizeof(name));
+	assert(rv == -1);
+	assert(errno == EINVAL);
+	check_algorithm(sd, "newreno");
+
+	rv = close(sd);
+	assert(rv == 0);
+}
+
+static void
+test_main(void)
+{
+	size_t i;
+	int exit_code;
+	int rv;
+
+	exit_code = rtems_bsd_ifconfig_lo0();
+	assert(exit_code == 0);
+
+	rv = sem_init(&server_done, 0, 0);
+	assert(rv == 0);
+
+	memset(chunk, 0xa5, sizeof(chunk));
+
+	test_default_algorithm();
+	test_unknown_algorithm();
+
+	(void)start_server();
+	setup_path();
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <RoundTripMilliseconds>%i</RoundTripMilliseconds>\n",
+	    2 * PATH_DELAY_MS);
+	printf("  <BandwidthKbitPerSecond>%i</BandwidthKbitPerSecond>\n",
+	    PATH_BANDWIDTH_KBITPS);
+
+	for (i = 0; i < nitems(algorithms); ++i) {
+		uint64_t ns;
+
+		ns = transfer(algorithms[i]);
+
+		printf("  <Transfer algorithm=\"%s\">\n", algorithms[i]);
+		printf("    <Bytes>%i</Bytes>\n", TRANSFER_SIZE);
+		printf("    <Nanoseconds>%" PRIu64 "</Nanoseconds>\n", ns);
+		printf("    <MegabitsPerSecond>%" PRIu64
+		    "</MegabitsPerSecond>\n",
+		    ((uint64_t)TRANSFER_SIZE * 8 * 1000) / ns);
+		printf("  </Transfer>\n");
+	}
+
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#include <machine/rtems-bsd-sysinit.h>
+
+#define RTEMS_BSD_CONFIG_NET_DNPIPE
+#define RTEMS_BSD_CONFIG_NET_TCP_CC_CUBIC
+#define RTEMS_BSD_CONFIG_NET_TCP_CC_HTCP
+
+#include <rtems/bsd/test/default-init.h>
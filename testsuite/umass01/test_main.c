@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2026 embedded brains GmbH.  All rights reserved.
+ *
+ *  embedded brains GmbH
+ *  Dornierstr. 4
+ *  82178 Puchheim
+ *  Germany
+ *  <rtems@embedded-brains.de>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/stat.h>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rtems.h>
+#include <rtems/bdbuf.h>
+#include <rtems/counter.h>
+#include <rtems/media.h>
+
+#define TEST_NAME "LIBBSD UMASS 1"
+
+#define TEST_XML_NAME "TestUMASS01"
+
+#define FILE_SIZE (16 * 1024 * 1024)
+
+#define CHUNK_SIZE (64 * 1024)
+
+static char chunk[CHUNK_SIZE];
+
+static char mount_path[64];
+
+static rtems_id mount_sema;
+
+static rtems_status_code
+media_listener(rtems_media_event event, rtems_media_state state,
+    const char *src, const char *dest, void *arg)
+{
+	rtems_status_code sc;
+
+	(void)src;
+	(void)arg;
+
+	if (event == RTEMS_MEDIA_EVENT_MOUNT &&
+	    state == RTEMS_MEDIA_STATE_SUCCESS && mount_path[0] == '\0') {
+		strlcpy(mount_path, dest, sizeof(mount_path));
+		sc = rtems_semaphore_release(mount_sema);
+		assert(sc == RTEMS_SUCCESSFUL);
+	}
+
+	return (RTEMS_SUCCESSFUL);
+}
+
+static uint64_t
+write_file(const char *path)
+{
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	size_t i;
+	int fd;
+	int rv;
+
+	begin = rtems_counter_read();
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, S_IRWXU);
+	assert(fd >= 0);
+
+	for (i = 0; i < FILE_SIZE; i += CHUNK_SIZE) {
+		ssize_t n;
+
+		memset(chunk, (int)(i / CHUNK_SIZE), sizeof(chunk));
+		n = write(fd, chunk, sizeof(chunk));
+		assert(n == (ssize_t)sizeof(chunk));
+	}
+
+	rv = fsync(fd);
+	assert(rv == 0);
+
+	rv = close(fd);
+	assert(rv == 0);
+
+	end = rtems_counter_read();
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static uint64_t
+read_file(const char *path)
+{
+	rtems_counter_ticks begin;
+	rtems_counter_ticks end;
+	size_t i;
+	int fd;
+	int rv;
+
+	begin = rtems_counter_read();
+
+	fd = open(path, O_RDONLY);
+	assert(fd >= 0);
+
+	for (i = 0; i < FILE_SIZE; i += CHUNK_SIZE) {
+		ssize_t n;
+
+		n = read(fd, chunk, sizeof(chunk));
+		assert(n == (ssize_t)sizeof(chunk));
+		assert(chunk[0] == (char)(i / CHUNK_SIZE));
+		assert(chunk[CHUNK_SIZE - 1] == (char)(i / CHUNK_SIZE));
+	}
+
+	rv = close(fd);
+	assert(rv == 0);
+
+	end = rtems_counter_read();
+
+	return (rtems_counter_ticks_to_nanoseconds(
+	    rtems_counter_difference(end, begin)));
+}
+
+static uint64_t
+kib_per_second(uint64_t ns)
+{
+
+	return ((uint64_t)FILE_SIZE * 1000000000 / 1024 / (ns + 1));
+}
+
+static void
+test_main(void)
+{
+	rtems_status_code sc;
+	char path[128];
+	uint64_t write_ns;
+	uint64_t read_ns;
+	int n;
+	int rv;
+
+	puts("insert a USB mass storage device with a FAT file system");
+
+	sc = rtems_semaphore_obtain(mount_sema, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	n = snprintf(path, sizeof(path), "%s/umass01.bin", mount_path);
+	assert(n < (int)sizeof(path));
+
+	/* The file is much larger than the block device buffer cache */
+	write_ns = write_file(path);
+	read_ns = read_file(path);
+
+	rv = unlink(path);
+	assert(rv == 0);
+
+	printf("<" TEST_XML_NAME ">\n");
+	printf("  <Bytes>%i</Bytes>\n", FILE_SIZE);
+	printf("  <WriteNanoseconds>%" PRIu64 "</WriteNanoseconds>\n",
+	    write_ns);
+	printf("  <WriteKiBPerSecond>%" PRIu64 "</WriteKiBPerSecond>\n",
+	    kib_per_second(write_ns));
+	printf("  <ReadNanoseconds>%" PRIu64 "</ReadNanoseconds>\n", read_ns);
+	printf("  <ReadKiBPerSecond>%" PRIu64 "</ReadKiBPerSecond>\n",
+	    kib_per_second(read_ns));
+	printf("</" TEST_XML_NAME ">\n");
+
+	exit(0);
+}
+
+#define DEFAULT_EARLY_INITIALIZATION
+
+static void
+early_initialization(void)
+{
+	rtems_status_code sc;
+
+	sc = rtems_semaphore_create(rtems_build_name('M', 'N', 'T', ' '), 0,
+	    RTEMS_SIMPLE_BINARY_SEMAPHORE, 0, &mount_sema);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_bdbuf_init();
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_media_initialize();
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_media_listener_add(media_listener, NULL);
+	assert(sc == RTEMS_SUCCESSFUL);
+
+	sc = rtems_media_server_initialize(200, 32 * 1024,
+	    RTEMS_DEFAULT_MODES, RTEMS_DEFAULT_ATTRIBUTES);
+	assert(sc == RTEMS_SUCCESSFUL);
+}
+
+#define CONFIGURE_MICROSECONDS_PER_TICK 1000
+
+#define CONFIGURE_MAXIMUM_DRIVERS 32
+
+#define CONFIGURE_FILESYSTEM_DOSFS
+
+#include <rtems/bsd/test/default-init.h>